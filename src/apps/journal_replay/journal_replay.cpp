@@ -0,0 +1,151 @@
+#include "common/logger.hpp"
+#include "modules/matching_engine_module/replay.h"
+#include "modules/matching_engine_module/snapshot.h"
+#include <charconv>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Offline replay of a matching engine journal, e.g. a trading day, at the speed of the matching engines.
+ * The order books start from the latest snapshot of an instrument when a snapshot directory is given, otherwise from empty
+ * order books. The replies are not sent but folded into a checksum, a replay with an expected checksum verifies that the
+ * replies of a changed engine are the same.
+ */
+using namespace moboware::modules;
+
+namespace {
+struct Options {
+  std::string journalDirectory;
+  std::optional<std::string> snapshotDirectory;
+  std::optional<std::string> writeSnapshotDirectory;
+  std::optional<std::uint64_t> expectedChecksum;
+  SelfTradePrevention selfTradePrevention{SelfTradePrevention::None};   // has to be the self trade prevention of the live engines
+};
+
+void PrintUsage(const char *application)
+{
+  fmt::print(stderr,
+             "usage: {} <journal directory> [--snapshot <directory>] [--write-snapshot <directory>] [--expected-checksum <checksum>] "
+             "[--self-trade-prevention <None|CancelNewest|CancelOldest|DecrementBoth>]\n",
+             application);
+}
+
+auto ReadCommandline(const int argc, const char *argv[]) -> std::optional<Options>
+{
+  if (argc < 2) {
+    return std::nullopt;
+  }
+
+  Options options;
+  options.journalDirectory = argv[1];
+  for (int index{2}; index < argc; index++) {
+    const std::string_view option{argv[index]};
+    if (index + 1 >= argc) {
+      return std::nullopt;   // every option has a value
+    }
+
+    const std::string value{argv[++index]};
+    if (option == "--snapshot") {
+      options.snapshotDirectory = value;
+    } else if (option == "--write-snapshot") {
+      options.writeSnapshotDirectory = value;
+    } else if (option == "--expected-checksum") {
+      std::uint64_t checksum{};
+      const auto [end, ec]{std::from_chars(value.data(), value.data() + value.size(), checksum)};
+      if (ec != std::errc{} or end != value.data() + value.size()) {
+        return std::nullopt;
+      }
+      options.expectedChecksum = checksum;
+    } else if (option == "--self-trade-prevention") {
+      const auto selfTradePrevention{ToSelfTradePrevention(value)};
+      if (not selfTradePrevention) {
+        return std::nullopt;
+      }
+      options.selfTradePrevention = *selfTradePrevention;
+    } else {
+      return std::nullopt;
+    }
+  }
+  return options;
+}
+}   // namespace
+
+int main(const int argc, const char *argv[])
+{
+  const auto options{ReadCommandline(argc, argv)};
+  if (not options) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // the order entry events are logged on info level, that would be the bottleneck of the replay
+  Logger::GetInstance().SetLevel(Logger::LogLevel::Warning);
+
+  const auto replayChannel{std::make_shared<ReplayChannel>()};
+  std::map<std::string, std::unique_ptr<MatchingEngine>, std::less<>> matchingEngines;
+  bool isSnapshotFailed{false};
+
+  // the matching engine of an instrument is created on its first record
+  JournalReplay journalReplay([&](const std::string_view instrument) -> MatchingEngine * {
+    const auto iter{matchingEngines.find(instrument)};
+    if (iter != std::end(matchingEngines)) {
+      return iter->second.get();
+    }
+
+    auto matchingEngine{std::make_unique<MatchingEngine>(replayChannel, std::string(instrument))};
+    matchingEngine->SetSelfTradePrevention(options->selfTradePrevention);
+    if (options->snapshotDirectory) {
+      const auto snapshotPath{snapshot::FindLatestSnapshot(*options->snapshotDirectory, instrument)};
+      if (snapshotPath and not matchingEngine->LoadSnapshot(*snapshotPath)) {
+        isSnapshotFailed = true;
+      }
+    }
+    return matchingEngines.emplace(std::string(instrument), std::move(matchingEngine)).first->second.get();
+  });
+
+  JournalReader journalReader;
+  if (not journalReader.Open(options->journalDirectory)) {
+    return EXIT_FAILURE;
+  }
+
+  const auto startTime{std::chrono::steady_clock::now()};
+  journalReplay.Replay(journalReader);
+  const auto replayTime{std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - startTime)};
+
+  const auto &stats{journalReplay.GetStats()};
+  const auto recordsPerSecond{replayTime.count() > 0 ? static_cast<double>(stats.appliedRecords) / replayTime.count() : 0.0};
+  fmt::print("segments:{}, records:{}, replayed:{}, in snapshot:{}, diverged:{}, last sequence:{}\n",
+             journalReader.GetSegmentCount(),
+             stats.records,
+             stats.appliedRecords,
+             stats.skippedRecords,
+             stats.divergedRecords,
+             journalReader.GetLastSequence());
+  fmt::print("replay time:{:.3f} s, {:.0f} records/s\n", replayTime.count(), recordsPerSecond);
+  fmt::print("replies:{}, checksum:{}\n", replayChannel->GetReplyCount(), replayChannel->GetChecksum());
+
+  for (const auto &[instrument, matchingEngine] : matchingEngines) {
+    fmt::print("instrument:{}, input sequence:{}, bid levels:{}, ask levels:{}\n",
+               instrument,
+               matchingEngine->GetInputSequence(),
+               matchingEngine->GetBidOrderBook().GetOrderBookMap().size(),
+               matchingEngine->GetAskOrderBook().GetOrderBookMap().size());
+
+    if (options->writeSnapshotDirectory and not matchingEngine->WriteSnapshot(*options->writeSnapshotDirectory)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (isSnapshotFailed or stats.divergedRecords > 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (options->expectedChecksum and *options->expectedChecksum != replayChannel->GetChecksum()) {
+    fmt::print(stderr, "checksum {} is not the expected checksum {}\n", replayChannel->GetChecksum(), *options->expectedChecksum);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
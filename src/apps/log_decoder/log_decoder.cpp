@@ -0,0 +1,28 @@
+#include "common/binary_log.h"
+#include "common/logger.hpp"
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Offline decoder of the binary log files, formats the lines of the files as the text log to the standard output.
+ * The files are decoded in the order of the command line, e.g. the rotated files of a day in the order of their index.
+ */
+using namespace moboware::common::binary_log;
+
+int main(const int argc, const char *argv[])
+{
+  if (argc < 2) {
+    fmt::print(stderr, "usage: {} <binary log file>...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  for (int index{1}; index < argc; index++) {
+    BinaryLogReader reader;
+    const auto isRead{reader.Read(argv[index], [](const std::string_view line) { std::fwrite(line.data(), 1, line.size(), stdout); })};
+    std::fflush(stdout);
+    if (not isRead) {
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -46,6 +46,16 @@ bool Application::LoadConfig(const std::string &configFile, const std::filesyste
   // read logging settings
   if (rootDocument.as_object().contains("Logging")) {
     const auto loggingNode = rootDocument.at("Logging");
+    // the format and the max size apply to the log file that is opened next
+    if (loggingNode.as_object().contains("Format")) {
+      const auto logFormat{loggingNode.at("Format").as_string().c_str()};
+      Logger::GetInstance().SetFormat(Logger::GetInstance().GetFormat(logFormat));
+    }
+
+    if (loggingNode.as_object().contains("MaxFileSize")) {
+      Logger::GetInstance().SetMaxFileSize(static_cast<std::size_t>(loggingNode.at("MaxFileSize").as_int64()));
+    }
+
     if (loggingNode.as_object().contains("LogDirectory")) {
       const auto logDirectory{loggingNode.at("LogDirectory").as_string().c_str()};
       std::filesystem::path logFile{logDirectory};
@@ -56,6 +66,30 @@ bool Application::LoadConfig(const std::string &configFile, const std::filesyste
 
     const auto logLevel{loggingNode.at("LogLevel").as_string().c_str()};
     Logger::GetInstance().SetLevel(Logger::GetInstance().GetLevel(logLevel));
+
+    // the level per module, e.g. "matching_engine_module": "WARN", a module is a part of the path of the source files
+    if (loggingNode.as_object().contains("ModuleLogLevel")) {
+      for (const auto &moduleLevelValue : loggingNode.at("ModuleLogLevel").as_object()) {
+        const std::string module{moduleLevelValue.key()};
+        const auto level{moduleLevelValue.value().as_string().c_str()};
+        Logger::GetInstance().SetModuleLevel(module, Logger::GetInstance().GetLevel(level));
+      }
+    }
+
+    if (loggingNode.as_object().contains("Mode")) {
+      const auto logMode{loggingNode.at("Mode").as_string().c_str()};
+      Logger::GetInstance().SetMode(Logger::GetInstance().GetMode(logMode));
+    }
+
+    // the overflow policy per level, e.g. "INFO": "DROP_FIRST"
+    if (loggingNode.as_object().contains("OverflowPolicy")) {
+      for (const auto &overflowPolicyValue : loggingNode.at("OverflowPolicy").as_object()) {
+        const std::string level{overflowPolicyValue.key()};
+        const auto overflowPolicy{overflowPolicyValue.value().as_string().c_str()};
+        Logger::GetInstance().SetOverflowPolicy(Logger::GetInstance().GetLevel(level),   //
+                                                Logger::GetInstance().GetOverflowPolicy(overflowPolicy));
+      }
+    }
   }
 
   // read channel settings
@@ -30,6 +30,10 @@ public:
 
   void SendWebSocketData(const boost::asio::const_buffer& readBuffer, const boost::asio::ip::tcp::endpoint& endpoint) final;
 
+  void PublishWebSocketData(const common::SharedBuffer_t& sharedBuffer,
+                            const std::vector<boost::asio::ip::tcp::endpoint>& endpoints,
+                            const common::ConflationKey_t conflationKey) final;
+
   void OnWebSocketDataReceived(const boost::beast::flat_buffer& readBuffer, const boost::asio::ip::tcp::endpoint& endpoint);
 
 private:
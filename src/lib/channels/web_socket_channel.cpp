@@ -45,6 +45,34 @@ bool WebSocketChannel::LoadChannelConfig(const boost::json::value &channelConfig
 
     m_Address = channelConfig.at(AddressKey).as_string().c_str();
   }
+
+  // optional outbound write queue settings of the sessions
+  if (channelConfig.as_object().contains("WriteQueue")) {
+    const auto &writeQueueValue{channelConfig.at("WriteQueue")};
+    common::WriteQueueConfig writeQueueConfig;
+
+    if (writeQueueValue.as_object().contains("HighWaterMark")) {
+      writeQueueConfig.highWaterMark = writeQueueValue.at("HighWaterMark").as_int64();
+    }
+    if (writeQueueValue.as_object().contains("LowWaterMark")) {
+      writeQueueConfig.lowWaterMark = writeQueueValue.at("LowWaterMark").as_int64();
+    }
+    if (writeQueueValue.as_object().contains("SlowConsumerPolicy")) {
+      const std::string policy{writeQueueValue.at("SlowConsumerPolicy").as_string().c_str()};
+      const auto slowConsumerPolicy{ToSlowConsumerPolicy(policy)};
+      if (not slowConsumerPolicy) {
+        LOG_DEBUG("Unknown SlowConsumerPolicy {}, expected Drop, Conflate or Disconnect", policy);
+        return false;
+      }
+      writeQueueConfig.slowConsumerPolicy = *slowConsumerPolicy;
+    }
+
+    if (writeQueueConfig.lowWaterMark > writeQueueConfig.highWaterMark) {
+      LOG_DEBUG("WriteQueue LowWaterMark {} is above the HighWaterMark {}", writeQueueConfig.lowWaterMark, writeQueueConfig.highWaterMark);
+      return false;
+    }
+    m_WebSocketServer->SetWriteQueueConfig(writeQueueConfig);
+  }
   return true;
 }
 
@@ -76,6 +104,12 @@ bool WebSocketChannel::Start()
       this->OnWebSocketDataReceived(readBuffer, endpoint);
     });
 
+  m_WebSocketServer->SetWebSocketSessionClosed([this](const boost::asio::ip::tcp::endpoint &endpoint) {
+    std::for_each(std::begin(GetModules()),
+                  std::end(GetModules()),   //
+                  [&endpoint](const ModulePtr_t &module) { module->OnWebSocketSessionClosed(endpoint); });
+  });
+
   if (not m_WebSocketServer->Start(m_Address, m_Port)) {
     LOG_DEBUG("Start channel failed {}", GetChannelName());
     return false;
@@ -93,6 +127,16 @@ void WebSocketChannel::SendWebSocketData(const boost::asio::const_buffer &sendBu
   }
 }
 
+void WebSocketChannel::PublishWebSocketData(const common::SharedBuffer_t &sharedBuffer,
+                                            const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+                                            const common::ConflationKey_t conflationKey)
+{
+  const auto numberOfSessions{m_WebSocketServer->PublishWebSocketData(sharedBuffer, endpoints, conflationKey)};
+  if (numberOfSessions != endpoints.size()) {
+    LOG_DEBUG("Published to {} of {} sessions", numberOfSessions, endpoints.size());
+  }
+}
+
 void WebSocketChannel::OnWebSocketDataReceived(const boost::beast::flat_buffer &readBuffer, const boost::asio::ip::tcp::endpoint &endpoint)
 {
   LOG_DEBUG("Web Socket data Received, tag:{}:{},{}",
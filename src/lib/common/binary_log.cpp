@@ -0,0 +1,290 @@
+#include "common/binary_log.h"
+#include "common/logger.hpp"
+#include "common/mapped_file.h"
+#include <fmt/args.h>
+#include <vector>
+
+using namespace moboware::common;
+using namespace moboware::common::binary_log;
+
+namespace {
+/// @brief Read position in the data of a binary log file, a read past the end fails
+class Cursor {
+public:
+  Cursor(const char *data, const std::size_t size)
+    : m_Begin(data)
+    , m_Position(data)
+    , m_End(data + size)
+  {
+  }
+
+  [[nodiscard]] bool ReadBytes(void *data, const std::size_t size)
+  {
+    if (static_cast<std::size_t>(m_End - m_Position) < size) {
+      return false;
+    }
+    std::memcpy(data, m_Position, size);
+    m_Position += size;
+    return true;
+  }
+
+  /// @brief skip the bytes when the data continues with them
+  [[nodiscard]] bool Skip(const std::string_view bytes)
+  {
+    if (static_cast<std::size_t>(m_End - m_Position) < bytes.size() or std::string_view(m_Position, bytes.size()) != bytes) {
+      return false;
+    }
+    m_Position += bytes.size();
+    return true;
+  }
+
+  [[nodiscard]] bool ReadByte(std::uint8_t &value)
+  {
+    return ReadBytes(&value, sizeof(value));
+  }
+
+  [[nodiscard]] bool ReadVarint(std::uint64_t &value)
+  {
+    value = 0;
+    for (unsigned shift{}; shift < 64 and m_Position < m_End; shift += 7) {
+      const auto byte{static_cast<std::uint8_t>(*m_Position++)};
+      value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  [[nodiscard]] bool ReadZigzag(std::int64_t &value)
+  {
+    std::uint64_t encoded{};
+    if (not ReadVarint(encoded)) {
+      return false;
+    }
+    value = static_cast<std::int64_t>(encoded >> 1) ^ -static_cast<std::int64_t>(encoded & 1);
+    return true;
+  }
+
+  [[nodiscard]] bool ReadString(std::string_view &text)
+  {
+    std::uint64_t length{};
+    if (not ReadVarint(length) or static_cast<std::uint64_t>(m_End - m_Position) < length) {
+      return false;
+    }
+    text = std::string_view(m_Position, length);
+    m_Position += length;
+    return true;
+  }
+
+  [[nodiscard]] inline bool AtEnd() const noexcept
+  {
+    return m_Position == m_End;
+  }
+
+  [[nodiscard]] inline auto GetOffset() const noexcept -> std::size_t
+  {
+    return static_cast<std::size_t>(m_Position - m_Begin);
+  }
+
+private:
+  const char *const m_Begin;
+  const char *m_Position;
+  const char *const m_End;
+};
+
+struct Site {
+  Logger::LogLevel level{};
+  std::uint64_t line{};
+  std::string_view file;
+  std::string_view format;
+};
+
+/// @brief the strings are views on the mapped file, the file is mapped while the lines are formatted
+bool ReadArgument(Cursor &cursor, fmt::dynamic_format_arg_store<fmt::format_context> &arguments)
+{
+  std::uint8_t type{};
+  if (not cursor.ReadByte(type)) {
+    return false;
+  }
+
+  switch (static_cast<ArgumentType>(type)) {
+  case ArgumentType::Int: {
+    std::int64_t value{};
+    if (not cursor.ReadZigzag(value)) {
+      return false;
+    }
+    arguments.push_back(value);
+    return true;
+  }
+  case ArgumentType::UInt: {
+    std::uint64_t value{};
+    if (not cursor.ReadVarint(value)) {
+      return false;
+    }
+    arguments.push_back(value);
+    return true;
+  }
+  case ArgumentType::Double: {
+    double value{};
+    if (not cursor.ReadBytes(&value, sizeof(value))) {
+      return false;
+    }
+    arguments.push_back(value);
+    return true;
+  }
+  case ArgumentType::Bool: {
+    std::uint8_t value{};
+    if (not cursor.ReadByte(value)) {
+      return false;
+    }
+    arguments.push_back(value != 0);
+    return true;
+  }
+  case ArgumentType::Char: {
+    std::uint8_t value{};
+    if (not cursor.ReadByte(value)) {
+      return false;
+    }
+    arguments.push_back(static_cast<char>(value));
+    return true;
+  }
+  case ArgumentType::String: {
+    std::string_view value;
+    if (not cursor.ReadString(value)) {
+      return false;
+    }
+    arguments.push_back(value);
+    return true;
+  }
+  }
+  return false;
+}
+}   // namespace
+
+bool BinaryLogReader::Read(const std::string &path, const LineFn_t &lineFn)
+{
+  MappedFile file;
+  if (not file.Open(path)) {
+    return false;
+  }
+
+  constexpr std::string_view magic(Magic.data(), Magic.size());
+  Cursor cursor(file.GetData(), file.GetSize());
+  std::int64_t time{};
+  if (not cursor.Skip(magic) or not cursor.ReadBytes(&time, sizeof(time))) {
+    LOG_ERROR("File {} is not a binary log file", path);
+    return false;
+  }
+
+  std::vector<Site> sites;
+  std::vector<std::uint64_t> threadIds;
+  fmt::memory_buffer line;
+
+  const auto readRecord{[&]() -> bool {
+    if (cursor.Skip(magic)) {
+      // the next session of the application, the sites and threads start again
+      sites.clear();
+      threadIds.clear();
+      return cursor.ReadBytes(&time, sizeof(time));
+    }
+
+    std::uint8_t type{};
+    if (not cursor.ReadByte(type)) {
+      return false;
+    }
+
+    switch (static_cast<RecordType>(type)) {
+    case RecordType::Site: {
+      std::uint64_t id{};
+      std::uint8_t level{};
+      Site site;
+      if (not cursor.ReadVarint(id) or not cursor.ReadByte(level) or level > static_cast<std::uint8_t>(Logger::LogLevel::Fatal) or
+          not cursor.ReadVarint(site.line) or not cursor.ReadString(site.file) or not cursor.ReadString(site.format) or id > sites.size()) {
+        return false;
+      }
+      site.level = static_cast<Logger::LogLevel>(level);
+      if (id == sites.size()) {
+        sites.push_back(site);
+      } else {
+        sites[id] = site;
+      }
+      return true;
+    }
+    case RecordType::Thread: {
+      std::uint64_t index{};
+      std::uint64_t threadId{};
+      if (not cursor.ReadVarint(index) or not cursor.ReadVarint(threadId) or index > threadIds.size()) {
+        return false;
+      }
+      if (index == threadIds.size()) {
+        threadIds.push_back(threadId);
+      } else {
+        threadIds[index] = threadId;
+      }
+      return true;
+    }
+    case RecordType::Line: {
+      std::uint64_t siteId{};
+      std::int64_t elapsed{};
+      std::uint64_t threadIndex{};
+      std::uint64_t argumentCount{};
+      if (not cursor.ReadVarint(siteId) or siteId >= sites.size() or not cursor.ReadZigzag(elapsed) or
+          not cursor.ReadVarint(threadIndex) or threadIndex >= threadIds.size() or not cursor.ReadVarint(argumentCount)) {
+        return false;
+      }
+      time += elapsed;
+
+      fmt::dynamic_format_arg_store<fmt::format_context> arguments;
+      for (std::uint64_t index{}; index < argumentCount; index++) {
+        if (not ReadArgument(cursor, arguments)) {
+          return false;
+        }
+      }
+
+      // the same line as the text log
+      const auto &site{sites[siteId]};
+      const auto lineTime{std::chrono::time_point_cast<std::chrono::seconds>(
+        std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time))))};
+      line.clear();
+      fmt::format_to(std::back_inserter(line),
+                     "[{:%Y%m%d %H:%M:%S}][{}][{:#x}][{}:{}]",
+                     lineTime,
+                     site.level,
+                     threadIds[threadIndex],
+                     site.file,
+                     site.line);
+      try {
+        fmt::vformat_to(std::back_inserter(line), site.format, arguments);
+      } catch (const fmt::format_error &e) {
+        fmt::format_to(std::back_inserter(line), "[format error: {}] {}", e.what(), site.format);
+      }
+      line.push_back('\n');
+
+      lineFn(std::string_view(line.data(), line.size()));
+      m_LineCount++;
+      return true;
+    }
+    case RecordType::Text: {
+      std::uint64_t threadIndex{};
+      std::string_view text;
+      if (not cursor.ReadVarint(threadIndex) or not cursor.ReadString(text)) {
+        return false;
+      }
+      lineFn(text);
+      m_LineCount++;
+      return true;
+    }
+    }
+    return false;
+  }};
+
+  while (not cursor.AtEnd()) {
+    const auto offset{cursor.GetOffset()};
+    if (not readRecord()) {
+      LOG_ERROR("Binary log file {} is corrupt or truncated at offset {}", path, offset);
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <fmt/format.h>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief Binary log file format, the log lines of the deferred mode are written without formatting and are formatted offline by the log
+ * decoder. A file starts with the magic and the system time of the start in nanoseconds, followed by records of a type byte and:
+ *   - Site: id, level, line, file and format string of a log statement, written before the first line of the statement in the file
+ *   - Thread: index and id of a logging thread, written before the first line of the thread in the file
+ *   - Line: site id, time since the previous line in nanoseconds, thread index and the arguments, every argument is a type byte and the
+ *     value. Enums and other types are formatted to a string when they are written.
+ *   - Text: thread index and a formatted line, for the lines that are formatted on the logging thread
+ * The integers are variable length encoded, small values take a single byte, the signed integers are zigzag encoded. A file is complete
+ * in itself, a rotated file starts with the site and thread records again. A file that is appended to by a restarted application
+ * continues with the magic and start time of the new session.
+ */
+namespace moboware::common::binary_log {
+
+constexpr std::array<char, 8> Magic{'M', 'B', 'W', 'L', 'O', 'G', '0', '1'};
+
+enum class RecordType : std::uint8_t {
+  Site = 1,
+  Thread,
+  Line,
+  Text
+};
+
+enum class ArgumentType : std::uint8_t {
+  Int = 1,
+  UInt,
+  Double,
+  Bool,
+  Char,
+  String
+};
+
+inline void WriteByte(fmt::memory_buffer &buffer, const std::uint8_t value)
+{
+  buffer.push_back(static_cast<char>(value));
+}
+
+inline void WriteVarint(fmt::memory_buffer &buffer, std::uint64_t value)
+{
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+inline void WriteZigzag(fmt::memory_buffer &buffer, const std::int64_t value)
+{
+  WriteVarint(buffer, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+inline void WriteString(fmt::memory_buffer &buffer, const std::string_view text)
+{
+  WriteVarint(buffer, text.size());
+  buffer.append(text.data(), text.data() + text.size());
+}
+
+inline void WriteHeader(fmt::memory_buffer &buffer, const std::int64_t startTime)
+{
+  buffer.append(std::begin(Magic), std::end(Magic));
+  const auto *const time{reinterpret_cast<const char *>(&startTime)};
+  buffer.append(time, time + sizeof(startTime));
+}
+
+/// @brief Write a decoded argument of a log line with its type
+template <typename T> void WriteArgument(fmt::memory_buffer &buffer, const T &argument)
+{
+  if constexpr (std::is_same_v<T, bool>) {
+    WriteByte(buffer, static_cast<std::uint8_t>(ArgumentType::Bool));
+    WriteByte(buffer, argument ? 1 : 0);
+  } else if constexpr (std::is_same_v<T, char>) {
+    WriteByte(buffer, static_cast<std::uint8_t>(ArgumentType::Char));
+    WriteByte(buffer, static_cast<std::uint8_t>(argument));
+  } else if constexpr (std::signed_integral<T>) {
+    WriteByte(buffer, static_cast<std::uint8_t>(ArgumentType::Int));
+    WriteZigzag(buffer, argument);
+  } else if constexpr (std::unsigned_integral<T>) {
+    WriteByte(buffer, static_cast<std::uint8_t>(ArgumentType::UInt));
+    WriteVarint(buffer, argument);
+  } else if constexpr (std::floating_point<T>) {
+    WriteByte(buffer, static_cast<std::uint8_t>(ArgumentType::Double));
+    const auto value{static_cast<double>(argument)};
+    const auto *const data{reinterpret_cast<const char *>(&value)};
+    buffer.append(data, data + sizeof(value));
+  } else if constexpr (std::is_same_v<T, std::string_view>) {
+    WriteByte(buffer, static_cast<std::uint8_t>(ArgumentType::String));
+    WriteString(buffer, argument);
+  } else {
+    // the decoder does not know the type, e.g. the names of an enum
+    fmt::memory_buffer text;
+    fmt::vformat_to(std::back_inserter(text), "{}", fmt::make_format_args(argument));
+    WriteByte(buffer, static_cast<std::uint8_t>(ArgumentType::String));
+    WriteString(buffer, std::string_view(text.data(), text.size()));
+  }
+}
+
+/// @brief Reader of a binary log file that formats the lines as the text log
+class BinaryLogReader {
+public:
+  /// @brief Called with every formatted line, including the newline
+  using LineFn_t = std::function<void(const std::string_view line)>;
+
+  BinaryLogReader() = default;
+  BinaryLogReader(const BinaryLogReader &) = delete;
+  BinaryLogReader(BinaryLogReader &&) = delete;
+  BinaryLogReader &operator=(const BinaryLogReader &) = delete;
+  BinaryLogReader &operator=(BinaryLogReader &&) = delete;
+  ~BinaryLogReader() = default;
+
+  /// @brief Read the file and format all lines
+  /// @return false when the file can not be read or is corrupt, the lines up to the error are formatted, the error is logged
+  [[nodiscard]] bool Read(const std::string &path, const LineFn_t &lineFn);
+
+  [[nodiscard]] inline auto GetLineCount() const noexcept -> std::uint64_t
+  {
+    return m_LineCount;
+  }
+
+private:
+  std::uint64_t m_LineCount{};
+};
+}   // namespace moboware::common::binary_log
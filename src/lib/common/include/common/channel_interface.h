@@ -1,9 +1,11 @@
 #pragma once
 #include "common/session.h"
+#include "common/shared_buffer.h"
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace moboware::common {
 
@@ -18,5 +20,17 @@ public:
   virtual ~ChannelInterface() = default;
 
   virtual void SendWebSocketData(const boost::asio::const_buffer& readBuffer, const boost::asio::ip::tcp::endpoint& endpoint) = 0;
+
+  /// @brief Fan out one encoded message to a set of sessions. The default sends a copy to every endpoint, a channel that can
+  /// queue the shared buffer itself sends the same buffer to all sessions.
+  /// @param conflationKey, the state the message updates, a slow consumer may skip a queued message that is superseded by a newer one
+  virtual void PublishWebSocketData(const SharedBuffer_t& sharedBuffer,
+                                    const std::vector<boost::asio::ip::tcp::endpoint>& endpoints,
+                                    [[maybe_unused]] const ConflationKey_t conflationKey)
+  {
+    for (const auto& endpoint : endpoints) {
+      SendWebSocketData(ToConstBuffer(sharedBuffer), endpoint);
+    }
+  }
 };
 }
\ No newline at end of file
@@ -30,10 +30,14 @@ public:
 
   virtual bool LoadConfig(const boost::json::value& moduleValue) = 0;
   virtual void OnWebSocketDataReceived(const boost::beast::flat_buffer& readBuffer, const boost::asio::ip::tcp::endpoint& endpoint) = 0;
+  // called when the web socket session of the endpoint is closed, the module can release the state of the session
+  virtual void OnWebSocketSessionClosed(const boost::asio::ip::tcp::endpoint& endpoint) {}
 
 protected:
   const std::shared_ptr<common::ChannelInterface>& GetChannelInterface() const { return m_ChannelInterface; }
 
+  const std::shared_ptr<Service>& GetService() const { return m_Service; }
+
   const std::string& GetModuleName() const { return m_ModuleName; }
 
 private:
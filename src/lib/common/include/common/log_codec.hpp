@@ -0,0 +1,175 @@
+#pragma once
+
+#include "common/binary_log.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fmt/format.h>
+#include <iterator>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+/**
+ * @brief Encoding of the arguments of a log line into raw bytes on the logging thread, and the decoding and formatting of the bytes
+ * on the log consumer thread. The arguments are encoded in the order of the format string:
+ *   - value arguments, arithmetic types and enums, are copied as they are and formatted with their own type
+ *   - string arguments, everything that converts to a std::string_view, are copied as a length and the characters
+ *   - all other arguments are formatted on the logging thread with "{}" and copied as a string, they can not be kept by value since they
+ *     may own or refer to memory that is gone when the consumer formats the line. A format specification of such an argument is applied
+ *     to the formatted string.
+ * Types can be deferred by value by a specialization of IsValueArgument, the type must be trivially copyable and may not refer to
+ * other memory.
+ * The encoded arguments are formatted to a text line or transcoded to the arguments of a line of the binary log, see binary_log.h.
+ */
+namespace moboware::common::log {
+
+template <typename T> struct IsValueArgument : std::bool_constant<std::is_arithmetic_v<T> or std::is_enum_v<T>> {};
+
+template <typename T>
+concept ValueArgument = IsValueArgument<T>::value;
+
+template <typename T>
+concept StringArgument = not ValueArgument<T> and std::is_convertible_v<const T &, std::string_view>;
+
+/// @brief Type of the argument when it is decoded on the consumer thread
+template <typename T> using Decoded_t = std::conditional_t<ValueArgument<T>, T, std::string_view>;
+
+/// @brief Format the encoded arguments with the format string to the buffer
+using FormatFn_t = void (*)(fmt::memory_buffer &buffer, fmt::string_view format, const std::byte *arguments);
+
+/// @brief Write the encoded arguments to the buffer as the arguments of a binary log line
+using TranscodeFn_t = void (*)(fmt::memory_buffer &buffer, const std::byte *arguments);
+
+class ArgumentEncoder final {
+public:
+  ArgumentEncoder(std::byte *data, const std::size_t capacity)
+    : m_Position(data)
+    , m_End(data + capacity)
+    , m_Begin(data)
+  {
+  }
+
+  template <typename T> void Encode(const T &argument)
+  {
+    if constexpr (ValueArgument<T>) {
+      static_assert(std::is_trivially_copyable_v<T>, "A value argument has to be trivially copyable");
+      if (Reserve(sizeof(T))) {
+        std::memcpy(m_Position, &argument, sizeof(T));
+        m_Position += sizeof(T);
+      }
+    } else if constexpr (StringArgument<T>) {
+      EncodeString(std::string_view(argument));
+    } else {
+      // formatted directly into the record, the length is written in front of the string when the length is known
+      if (not Reserve(sizeof(std::uint32_t))) {
+        return;
+      }
+      auto *const text{reinterpret_cast<char *>(m_Position + sizeof(std::uint32_t))};
+      const auto available{static_cast<std::size_t>(m_End - m_Position) - sizeof(std::uint32_t)};
+      const auto result{fmt::format_to_n(text, available, "{}", argument)};
+      if (result.size > available) {
+        m_IsOverflow = true;
+        return;
+      }
+      WriteLength(result.size);
+      m_Position += sizeof(std::uint32_t) + result.size;
+    }
+  }
+
+  /// @brief the arguments do not fit in the capacity, the encoded data is not usable
+  [[nodiscard]] inline bool IsOverflow() const noexcept
+  {
+    return m_IsOverflow;
+  }
+
+  [[nodiscard]] inline auto GetSize() const noexcept -> std::size_t
+  {
+    return static_cast<std::size_t>(m_Position - m_Begin);
+  }
+
+private:
+  void EncodeString(const std::string_view text)
+  {
+    if (Reserve(sizeof(std::uint32_t) + text.size())) {
+      WriteLength(text.size());
+      std::memcpy(m_Position + sizeof(std::uint32_t), text.data(), text.size());
+      m_Position += sizeof(std::uint32_t) + text.size();
+    }
+  }
+
+  [[nodiscard]] inline bool Reserve(const std::size_t size) noexcept
+  {
+    if (m_IsOverflow or static_cast<std::size_t>(m_End - m_Position) < size) {
+      m_IsOverflow = true;
+      return false;
+    }
+    return true;
+  }
+
+  inline void WriteLength(const std::size_t length) noexcept
+  {
+    const auto length32{static_cast<std::uint32_t>(length)};
+    std::memcpy(m_Position, &length32, sizeof(length32));
+  }
+
+  std::byte *m_Position;
+  std::byte *const m_End;
+  std::byte *const m_Begin;
+  bool m_IsOverflow{false};
+};
+
+class ArgumentDecoder final {
+public:
+  explicit ArgumentDecoder(const std::byte *data)
+    : m_Position(data)
+  {
+  }
+
+  template <typename T> auto Decode() -> Decoded_t<T>
+  {
+    if constexpr (ValueArgument<T>) {
+      T value;
+      std::memcpy(&value, m_Position, sizeof(T));
+      m_Position += sizeof(T);
+      return value;
+    } else {
+      std::uint32_t length{};
+      std::memcpy(&length, m_Position, sizeof(length));
+      const std::string_view text(reinterpret_cast<const char *>(m_Position + sizeof(length)), length);
+      m_Position += sizeof(length) + length;
+      return text;
+    }
+  }
+
+private:
+  const std::byte *m_Position;
+};
+
+/// @brief Decode the arguments that are encoded from TArgs and format them, the instantiation for the argument types of a log line is
+/// stored with the encoded arguments
+template <typename... TArgs> void FormatArguments(fmt::memory_buffer &buffer, const fmt::string_view format, const std::byte *arguments)
+{
+  [[maybe_unused]] ArgumentDecoder decoder(arguments);
+  // the elements of a braced initializer are evaluated in order, the arguments are decoded in the order they are encoded
+  const std::tuple<Decoded_t<TArgs>...> values{decoder.Decode<TArgs>()...};
+  std::apply([&](const auto &...value) { fmt::vformat_to(std::back_inserter(buffer), format, fmt::make_format_args(value...)); }, values);
+}
+
+/// @brief Decode the arguments that are encoded from TArgs and write them with their types to the buffer
+template <typename... TArgs> void TranscodeArguments(fmt::memory_buffer &buffer, const std::byte *arguments)
+{
+  [[maybe_unused]] ArgumentDecoder decoder(arguments);
+  binary_log::WriteVarint(buffer, sizeof...(TArgs));
+  // the operands of a comma fold are evaluated in order
+  (binary_log::WriteArgument(buffer, decoder.Decode<TArgs>()), ...);
+}
+
+/// @brief The functions of the consumer thread for the encoded arguments of one list of argument types
+struct ArgumentsCodec {
+  FormatFn_t formatFn;
+  TranscodeFn_t transcodeFn;
+};
+
+template <typename... TArgs> inline constexpr ArgumentsCodec ArgumentsCodecOf{&FormatArguments<TArgs...>, &TranscodeArguments<TArgs...>};
+}   // namespace moboware::common::log
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace moboware::common {
+
+/// @brief Append only file of the log consumer thread. The appended lines are copied into page aligned blocks and a batch of blocks is
+/// written with a single writev system call.
+/// The file is rotated when it exceeds its max size or when the date changes. The name of a file is the date and the name of the log file,
+/// a file that is rotated on its size gets an index: 20240101_server.log, 20240101_server.1.log, ... The rotation is done by the consumer
+/// thread between two batches, the logging threads write into their rings and are not paused by it.
+/// Without an open file the lines are written to the standard output.
+class LogFile {
+public:
+  LogFile() = default;
+  LogFile(const LogFile &) = delete;
+  LogFile(LogFile &&) = delete;
+  LogFile &operator=(const LogFile &) = delete;
+  LogFile &operator=(LogFile &&) = delete;
+  /// @brief writes the appended lines and closes the file
+  ~LogFile();
+
+  /// @brief Open the latest file of today of the log file for appending, the appended lines are written to the file from now on
+  /// @return false when the file can not be opened, the error is printed to the standard error
+  [[nodiscard]] bool Open(const std::filesystem::path &logFilePath);
+
+  /// @brief Write the appended lines and close the file, the next lines are written to the standard output
+  void Close();
+
+  /// @brief the size of a file after which it is rotated, 0 rotates the file on the date only
+  inline void SetMaxFileSize(const std::size_t maxFileSize) noexcept
+  {
+    m_MaxFileSize = maxFileSize;
+  }
+
+  /// @brief Copy the data into the blocks, a full batch of blocks is written
+  void Append(const char *data, const std::size_t size);
+
+  /// @brief Write the appended data
+  void Flush();
+
+  /// @brief Open the next file when the file exceeds its max size or when the date has changed, the appended data is written to the
+  /// current file first
+  /// @return true when the next file is opened
+  bool RotateIfDue();
+
+  [[nodiscard]] inline bool IsOpen() const noexcept
+  {
+    return m_IsOpen;
+  }
+
+  [[nodiscard]] inline auto GetPath() const noexcept -> const std::string &
+  {
+    return m_Path;
+  }
+
+  /// @brief number of files that are opened, it changes when a file is opened or rotated
+  [[nodiscard]] inline auto GetFileSequence() const noexcept -> std::uint64_t
+  {
+    return m_FileSequence;
+  }
+
+private:
+  static constexpr std::size_t PageSize{4 * 1024};
+  static constexpr std::size_t BlockSize{64 * 1024};
+  static constexpr std::size_t MaxBatchBlocks{16};
+
+  struct alignas(PageSize) Block {
+    std::array<char, BlockSize> data;
+  };
+
+  [[nodiscard]] bool OpenFile(const std::chrono::sys_days day, const std::size_t index);
+  [[nodiscard]] auto GetFilePath(const std::chrono::sys_days day, const std::size_t index) const -> std::filesystem::path;
+
+  std::filesystem::path m_LogFilePath;
+  std::string m_Path;
+  int m_Fd{STDOUT_FILENO};
+  bool m_IsOpen{false};
+  std::size_t m_FileSize{};
+  std::size_t m_MaxFileSize{};
+  std::chrono::sys_days m_FileDay{};
+  std::size_t m_FileIndex{};
+  std::uint64_t m_FileSequence{};
+
+  std::vector<std::unique_ptr<Block>> m_Blocks;   // the used blocks first, the blocks are kept for the next batches
+  std::size_t m_UsedBlocks{};
+  std::size_t m_BlockOffset{};   // bytes used in the last used block
+};
+}   // namespace moboware::common
@@ -1,9 +1,16 @@
 #pragma once
 
+#include "common/binary_log.h"
 #include "common/lock_less_ring_buffer.h"
+#include "common/log_codec.hpp"
+#include "common/log_file.h"
 #include "common/singleton.h"
-#include <boost/lockfree/queue.hpp>
+#include "common/spsc_record_buffer.hpp"
+#include "common/tsc_clock.hpp"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fmt/chrono.h>
 #include <fmt/compile.h>
@@ -12,66 +19,48 @@
 #include <fmt/ostream.h>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
-/**
- * @brief TrivialBuffer is a simple buffer that complies with the trivial rules, has a default destructor to comply e.g.
- *          Has an array to hold a fixed size buffer
- * @tparam T
- * @tparam buffer_size, default buffer length of the array
- */
-template <typename T, std::size_t buffer_size = 10 * 1024>   //
-class TrivialBuffer {
-public:
-  TrivialBuffer() = default;
-  ~TrivialBuffer() = default;
-
-  using value_type = T;
-  using reference = T &;
-  using const_reference = const T &;
-  using iterator = typename std::vector<T>::iterator;
-  using const_iterator = typename std::vector<T>::const_iterator;
-
-  void push_back(const T &value)
-  {
-    if (_index < buffer_size) {
-      _array[_index++] = value;
-    }
-  }
-
-  const T *data() const
-  {
-    return _array.data();
-  }
-
-  std::size_t size() const
-  {
-    return _index;
-  }
+// the log levels of the compile time minimum level, a log statement below the minimum level compiles to nothing
+#define MOBOWARE_LOG_LEVEL_TRACE 1
+#define MOBOWARE_LOG_LEVEL_DEBUG 2
+#define MOBOWARE_LOG_LEVEL_INFO 3
+#define MOBOWARE_LOG_LEVEL_WARN 4
+#define MOBOWARE_LOG_LEVEL_ERROR 5
+#define MOBOWARE_LOG_LEVEL_FATAL 6
 
-  void clear()
-  {
-    _index = 0;
-  }
-
-private:
-  std::array<T, buffer_size> _array;
-  std::size_t _index{};
-};
+#ifndef MOBOWARE_LOG_MIN_LEVEL
+#define MOBOWARE_LOG_MIN_LEVEL MOBOWARE_LOG_LEVEL_TRACE
+#endif
 
 /**
  * @brief Logger implementation that uses the fmt library formatting rules
- * The logger has several levels to log messages on, but the formatted data is send to a consumer thread that will write it to the console or log
- * file. The formatted data is send to the consumer thread via a lock-less queue and has a initial queue length limitation of 10K messages of a
- * max length of 5K length
+ * The logger has several levels to log messages on, the log lines are written to the console or log file by a consumer thread. Every logging
+ * thread has its own lock-less ring buffer of variable length records, so the logging threads do not share any cache line and a record
+ * takes the length of its line only. The consumer thread drains the rings of all threads and writes the records in the order of their
+ * time stamp counter value. A log line has a max length of 5K.
+ * In the formatted mode the logging thread formats the line into its record.
+ * In the deferred mode the logging thread does not format at all, it writes the address of the static log site of the log statement, a time
+ * stamp counter value and the encoded arguments, see log_codec.hpp, into its record. The consumer thread converts the time and formats the
+ * line. A log line that has arguments which do not fit a record is formatted on the calling thread as in the formatted mode.
+ * A logging thread does not wait for the consumer by default, the overflow policy of the level decides what happens to a line when the ring
+ * of the thread is full. The dropped lines are counted and reported in the log.
+ * The consumer thread writes the lines of a drain round in large batches, see log_file.h, the file is rotated on its size and date. In the
+ * binary format the lines of the deferred mode are written unformatted with their encoded arguments, see binary_log.h, the log decoder
+ * formats them offline.
+ * The levels below MOBOWARE_LOG_MIN_LEVEL are removed at compile time. At runtime a source file logs at the level of its module, see
+ * SetModuleLevel, a log statement tests the level of its file with an atomic that it looks up once.
  * see fmt lib: https://fmt.dev/latest/api.html
  */
 class Logger : public moboware::common::Singleton<Logger> {
 public:
-  static const auto MaxLogLineLength{5 * 1024};
-  using LogBuffer_t = TrivialBuffer<char, MaxLogLineLength>;
-  static const auto LogQueueLength{10 * 1'024u};   // max length the queue
-  using LogQueue_t = boost::lockfree::queue<LogBuffer_t>;
+  static const auto MaxLogLineLength{5 * 1024u};
+  static constexpr auto ThreadLogLength{256 * 1'024u};   // bytes of the ring of a logging thread
 
   enum class LogLevel : std::uint8_t {
     None = 0,
@@ -83,15 +72,43 @@ public:
     Fatal
   };
 
+  static constexpr auto LogLevelCount{static_cast<std::size_t>(LogLevel::Fatal) + 1};
+  static constexpr LogLevel MinLogLevel{static_cast<LogLevel>(MOBOWARE_LOG_MIN_LEVEL)};
+  static_assert(MinLogLevel >= LogLevel::Trace and MinLogLevel <= LogLevel::Fatal, "MOBOWARE_LOG_MIN_LEVEL is not a log level");
+
+  enum class OverflowPolicy : std::uint8_t {
+    Block = 0,   // wait until the consumer has freed space, the logging thread stalls
+    Drop,        // drop the line when the ring is full
+    DropFirst    // drop the line when less than a quarter of the ring is free, the rest of the ring is kept for the other levels
+  };
+
+  enum class LogMode : std::uint8_t {
+    Formatted = 0,   // the line is formatted on the logging thread
+    Deferred         // the arguments are encoded on the logging thread and formatted on the consumer thread
+  };
+
+  enum class LogFormat : std::uint8_t {
+    Text = 0,   // formatted lines
+    Binary      // the lines of the deferred mode are not formatted, the console is always text
+  };
+
+  /// @brief The static part of a log statement, a log site exists once per statement and its address identifies the statement
+  struct LogSite {
+    LogLevel level;
+    const char *file;
+    std::uint32_t line;
+    fmt::string_view format;
+  };
+
   Logger()
   {
-    m_LogQueue.reserve(LogQueueLength);
-
-    // create thread that reads the logline from the lock free queue
+    // create thread that reads the records from the rings of the logging threads
     const auto threadFunction{[&](const std::stop_token &stop_token) {
       while (not stop_token.stop_requested()) {
         WaitAndWrite();
       }
+      // the lines that are logged before the stop
+      WriteRecords();
     }};
 
     m_LogConsumerThread = std::jthread(threadFunction);
@@ -108,18 +125,106 @@ public:
   Logger &operator=(Logger &&) = delete;
 
   template <typename... Args>
-  void _log2(const LogLevel level,                //
-             const std::filesystem::path &file,   //
-             const std::uint32_t lineNumber,      //
+  void _log2(const LogSite &site,   //
              fmt::format_string<Args...> format,
              Args &&...args)
   {
-    this->_log(level, file, lineNumber, format, fmt::make_format_args(args...));
+    if (m_LogMode == LogMode::Deferred) {
+      this->_logDeferred(site, args...);
+    } else {
+      this->_log(site, format, fmt::make_format_args(args...));
+    }
+  }
+
+  inline void SetMode(const Logger::LogMode logMode)
+  {
+    m_LogMode = logMode;
+  }
+
+  inline Logger::LogMode GetMode(const std::string &modeStr)
+  {
+    static std::map<std::string, Logger::LogMode> modes{
+      {"FORMATTED", LogMode::Formatted}, //
+      {"DEFERRED",  LogMode::Deferred }  //
+    };
+    const auto iter{modes.find(modeStr)};
+
+    if (iter != std::end(modes)) {
+      return iter->second;
+    }
+    return Logger::LogMode::Formatted;
+  }
+
+  /// @brief the format of the next opened log file, a file keeps its format until it is rotated
+  inline void SetFormat(const Logger::LogFormat logFormat)
+  {
+    const std::scoped_lock lock(m_LogFileMutex);
+    m_LogFormat = logFormat;
+  }
+
+  inline Logger::LogFormat GetFormat(const std::string &formatStr)
+  {
+    static std::map<std::string, Logger::LogFormat> formats{
+      {"TEXT",   LogFormat::Text  }, //
+      {"BINARY", LogFormat::Binary}  //
+    };
+    const auto iter{formats.find(formatStr)};
+
+    if (iter != std::end(formats)) {
+      return iter->second;
+    }
+    return Logger::LogFormat::Text;
+  }
+
+  /// @brief the size of a log file after which the next file is opened, 0 opens the next file on the next day only
+  inline void SetMaxFileSize(const std::size_t maxFileSize)
+  {
+    const std::scoped_lock lock(m_LogFileMutex);
+    m_LogFile.SetMaxFileSize(maxFileSize);
+  }
+
+  inline void SetOverflowPolicy(const Logger::LogLevel level, const Logger::OverflowPolicy overflowPolicy)
+  {
+    m_OverflowPolicies[static_cast<std::size_t>(level)] = overflowPolicy;
+  }
+
+  inline Logger::OverflowPolicy GetOverflowPolicy(const std::string &overflowPolicyStr)
+  {
+    static std::map<std::string, Logger::OverflowPolicy> overflowPolicies{
+      {"BLOCK",      OverflowPolicy::Block    }, //
+      {"DROP",       OverflowPolicy::Drop     }, //
+      {"DROP_FIRST", OverflowPolicy::DropFirst}  //
+    };
+    const auto iter{overflowPolicies.find(overflowPolicyStr)};
+
+    if (iter != std::end(overflowPolicies)) {
+      return iter->second;
+    }
+    return Logger::OverflowPolicy::Drop;
+  }
+
+  /// @brief the lines of the level that are dropped since the start, the count is updated by the consumer thread when it drains the rings
+  [[nodiscard]] inline auto GetDroppedLines(const Logger::LogLevel level) const noexcept -> std::uint64_t
+  {
+    return m_DroppedLines[static_cast<std::size_t>(level)].load(std::memory_order_relaxed);
   }
 
+  /// @brief the level of the source files that are not part of a module with its own level
   inline void SetLevel(const Logger::LogLevel level)
   {
+    const std::scoped_lock lock(m_FileLevelsMutex);
     m_GlobalLogLevel = level;
+    UpdateFileLevels();
+  }
+
+  /// @brief The level of the source files of a module, a module is a part of the path of its files, e.g. "matching_engine_module", "socket"
+  /// or "order_book.cpp". A file gets the level of the most specific module in its path, the module that ends last, e.g. the file name
+  /// before its directory.
+  inline void SetModuleLevel(const std::string &module, const Logger::LogLevel level)
+  {
+    const std::scoped_lock lock(m_FileLevelsMutex);
+    m_ModuleLevels[module] = level;
+    UpdateFileLevels();
   }
 
   inline Logger::LogLevel GetLevel(const std::string &levelStr)
@@ -141,98 +246,496 @@ public:
     return Logger::LogLevel::Info;
   }
 
+  /// @brief Open the log file, the name gets the date and the latest file of today is appended to. The consumer thread writes the next
+  /// lines to the file.
   bool SetLogFile(const std::filesystem::path &logFilePath)
   {
-    if (m_LogFileStream.is_open()) {
-      m_LogFileStream.close();
+    const std::scoped_lock lock(m_LogFileMutex);
+    return m_LogFile.Open(logFilePath);
+  }
+
+  /// @brief The level of a source file, the level is updated when the levels change. A log statement looks up the level of its file once
+  /// and keeps the reference, so the test of a level does not access the logger.
+  [[nodiscard]] auto GetFileLevel(const std::string_view file) -> const std::atomic<LogLevel> &
+  {
+    const std::scoped_lock lock(m_FileLevelsMutex);
+    auto iter{m_FileLevels.find(file)};
+    if (iter == std::end(m_FileLevels)) {
+      iter = m_FileLevels.try_emplace(std::string(file)).first;
+      iter->second.store(GetModuleLevel(iter->first), std::memory_order_relaxed);
+    }
+    return iter->second;
+  }
+
+  [[nodiscard]] static constexpr bool IsCompiledLevel(const Logger::LogLevel level) noexcept
+  {
+    return level >= MinLogLevel;
+  }
+
+  [[nodiscard]] static inline bool TestLevel(const std::atomic<LogLevel> &fileLevel, const Logger::LogLevel level) noexcept
+  {
+    const auto minLevel{fileLevel.load(std::memory_order_relaxed)};
+    return minLevel != Logger::LogLevel::None and level >= minLevel;
+  }
+
+  void WaitAndWrite()
+  {
+    // main thread function to wait for events and write to an out stream
+    // the logging threads do not signal every record, the rings are polled
+    (void)Wait(PollPeriod);
+    WriteRecords();
+  }
+
+private:
+  static constexpr std::chrono::milliseconds PollPeriod{1};
+  static constexpr auto MaxDrainRecords{64 * 1'024u};   // records that are written before the next poll
+  static constexpr auto RotateCheckRecords{1'024u};
+  static constexpr auto DropFirstFreeLength{ThreadLogLength / 4};
+  static constexpr std::chrono::seconds DropReportPeriod{1};
+
+  /// @brief The header of a record in the ring of a logging thread. A record with a codec has the encoded arguments of the log statement as
+  /// data, a record without a codec has the formatted line.
+  struct RecordHeader {
+    std::uint64_t ticks{};
+    const LogSite *site{};
+    const moboware::common::log::ArgumentsCodec *codec{};
+  };
+
+  using RecordBuffer_t = moboware::common::SpscRecordBuffer<ThreadLogLength>;
+  static constexpr auto MaxRecordLength{sizeof(RecordHeader) + MaxLogLineLength};
+  static_assert(MaxRecordLength + DropFirstFreeLength <= RecordBuffer_t::GetMaxRecordSize());
+
+  using LineCounts_t = std::array<std::uint64_t, LogLevelCount>;
+
+  /// @brief The records of one logging thread
+  struct ThreadLog {
+    RecordBuffer_t ring;
+    const pthread_t threadId{pthread_self()};
+    std::atomic<bool> isClosed{false};   // the thread has ended, the ring is released when it is drained
+    // the lines that are dropped by the logging thread, per level
+    std::array<std::atomic<std::uint64_t>, LogLevelCount> droppedLines{};
+    // consumer thread only, the dropped lines that are counted by the consumer
+    LineCounts_t countedDroppedLines{};
+  };
+
+  /// @brief Registers the ring of a thread with the consumer and closes it when the thread ends
+  class ThreadLogHandle {
+  public:
+    explicit ThreadLogHandle(Logger &logger)
+      : m_ThreadLog(std::make_shared<ThreadLog>())
+    {
+      const std::scoped_lock lock(logger.m_ThreadLogsMutex);
+      logger.m_ThreadLogs.push_back(m_ThreadLog);
     }
 
-    const auto now{std::chrono::system_clock::now()};
+    ThreadLogHandle(const ThreadLogHandle &) = delete;
+    ThreadLogHandle(ThreadLogHandle &&) = delete;
+    ThreadLogHandle &operator=(const ThreadLogHandle &) = delete;
+    ThreadLogHandle &operator=(ThreadLogHandle &&) = delete;
 
-    const auto fileName{fmt::format("{:%Y%m%d}_{}",   //
-                                    now,
-                                    logFilePath.filename().c_str())};
+    ~ThreadLogHandle()
+    {
+      m_ThreadLog->isClosed.store(true, std::memory_order_release);
+    }
 
-    auto logFileStreamPath{logFilePath};
-    logFileStreamPath.replace_filename(fileName);
-    const std::string s{logFileStreamPath.string().c_str()};
-    std::cout << logFileStreamPath.string().c_str() << "," << s << std::endl;
-    m_LogFileStream.open(s.c_str(), std::ios_base::out | std::ios_base::app);
+    [[nodiscard]] inline auto GetThreadLog() const noexcept -> ThreadLog &
+    {
+      return *m_ThreadLog;
+    }
 
-    if (m_LogFileStream.is_open()) {
-      const std::string_view buffer{"Start new log file entry"};
-      m_LogFileStream.write(buffer.data(), buffer.size());
+  private:
+    const std::shared_ptr<ThreadLog> m_ThreadLog;
+  };
 
-      return true;
+  /// @brief A ring that is drained by the consumer, with its oldest record
+  struct DrainLog {
+    ThreadLog *threadLog{};
+    std::span<const std::byte> record;
+    std::uint64_t ticks{};
+    bool isClosed{};
+  };
+
+  /// @brief the level of the most specific module in the path of the file, the global level when there is none
+  [[nodiscard]] auto GetModuleLevel(const std::string_view file) const -> LogLevel
+  {
+    auto level{m_GlobalLogLevel};
+    std::size_t moduleEnd{};
+    std::size_t moduleLength{};
+    for (const auto &[module, moduleLevel] : m_ModuleLevels) {
+      const auto position{file.rfind(module)};
+      if (position == std::string_view::npos) {
+        continue;
+      }
+      // the module that ends last, of two modules that end at the same position the longest
+      const auto end{position + module.size()};
+      if (end > moduleEnd or (end == moduleEnd and module.size() > moduleLength)) {
+        level = moduleLevel;
+        moduleEnd = end;
+        moduleLength = module.size();
+      }
     }
-    return false;
+    return level;
   }
 
-  [[nodiscard]] inline bool TestLevel(const Logger::LogLevel level) const
+  void UpdateFileLevels()
   {
-    if (m_GlobalLogLevel != Logger::LogLevel::None &&   //
-        level >= m_GlobalLogLevel) {
-      return true;
+    for (auto &[file, fileLevel] : m_FileLevels) {
+      fileLevel.store(GetModuleLevel(file), std::memory_order_relaxed);
     }
+  }
 
-    return false;
+  /// @brief the ring of the calling thread, created on the first log line of the thread
+  [[nodiscard]] inline auto GetThreadLog() -> ThreadLog &
+  {
+    thread_local const ThreadLogHandle threadLogHandle(*this);
+    return threadLogHandle.GetThreadLog();
   }
 
-  void WaitAndWrite()
+  /// @brief Reserve a record of the max length in the ring of the thread
+  /// @return nullptr when the line is dropped by the overflow policy of the level
+  [[nodiscard]] auto ReserveRecord(ThreadLog &threadLog, const LogLevel level) -> std::byte *
   {
-    // main thread function to wait for events and write to an out stream
-    if (Wait() and not m_LogQueue.empty()) {
-      // read until empty
-      const auto popFn{[&](const LogBuffer_t &buffer) {
-        if (m_LogFileStream.is_open()) {
-          m_LogFileStream.write(buffer.data(), buffer.size());
-        } else {
-          std::cout.write(buffer.data(), buffer.size());
-        }
-      }};
-      m_LogQueue.consume_all(popFn);
+    const auto levelIndex{static_cast<std::size_t>(level)};
+    const auto overflowPolicy{m_OverflowPolicies[levelIndex]};
+
+    auto *data{threadLog.ring.Reserve(MaxRecordLength, overflowPolicy == OverflowPolicy::DropFirst ? DropFirstFreeLength : 0)};
+    if (data == nullptr and overflowPolicy != OverflowPolicy::Block) {
+      // only this thread writes its counters
+      auto &droppedLines{threadLog.droppedLines[levelIndex]};
+      droppedLines.store(droppedLines.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return nullptr;
     }
+
+    while (data == nullptr) {
+      // the ring is full, wake up the consumer and retry
+      Signal(true);
+      data = threadLog.ring.Reserve(MaxRecordLength);
+    }
+    return data;
   }
 
-private:
-  inline void _log(const LogLevel level,                //
-                   const std::filesystem::path &file,   //
-                   const std::uint32_t lineNumber,      //
-                   fmt::string_view format,             //
-                   fmt::format_args args)               //
+  template <typename... Args> void _logDeferred(const LogSite &site, const Args &...args)
+  {
+    const auto ticks{moboware::common::TscClock::Now()};
+    auto &threadLog{GetThreadLog()};
+    auto *const data{ReserveRecord(threadLog, site.level)};
+    if (data == nullptr) {
+      return;
+    }
+
+    moboware::common::log::ArgumentEncoder encoder(data + sizeof(RecordHeader), MaxLogLineLength);
+    (encoder.Encode(args), ...);
+    if (encoder.IsOverflow()) {   // the arguments do not fit a record, format the line on this thread
+      CommitFormatted(threadLog, data, ticks, site, site.format, fmt::make_format_args(args...));
+      return;
+    }
+
+    const RecordHeader header{ticks, &site, &moboware::common::log::ArgumentsCodecOf<std::remove_cvref_t<Args>...>};
+    std::memcpy(data, &header, sizeof(header));
+    threadLog.ring.Commit(sizeof(RecordHeader) + encoder.GetSize());
+  }
+
+  inline void _log(const LogSite &site,       //
+                   fmt::string_view format,   //
+                   fmt::format_args args)     //
+  {
+    const auto ticks{moboware::common::TscClock::Now()};
+    auto &threadLog{GetThreadLog()};
+    auto *const data{ReserveRecord(threadLog, site.level)};
+    if (data != nullptr) {
+      CommitFormatted(threadLog, data, ticks, site, format, args);
+    }
+  }
+
+  /// @brief Format the line into the reserved record, a line that is longer than the max length is truncated
+  void CommitFormatted(ThreadLog &threadLog,
+                       std::byte *data,
+                       const std::uint64_t ticks,
+                       const LogSite &site,
+                       fmt::string_view format,
+                       fmt::format_args args)
   {
     // format the pre log line
     const auto time{GetNowString()};
     const auto id{pthread_self()};
 
-    LogBuffer_t buffer;
-    vformat_to(std::back_insert_iterator(buffer),
-               "[{}][{}][{:#x}][{}:{}]",
-               fmt::make_format_args(        //
-                 time,                       //
-                 level,                      //
-                 id,                         //
-                 file.filename().native(),   //
-                 lineNumber));
+    // the newline always fits
+    constexpr auto maxLength{MaxLogLineLength - 1};
+    auto *const text{reinterpret_cast<char *>(data + sizeof(RecordHeader))};
+    const auto prefix{vformat_to_n(text,
+                                   maxLength,
+                                   "[{}][{}][{:#x}][{}:{}]",
+                                   fmt::make_format_args(         //
+                                     time,                        //
+                                     site.level,                  //
+                                     id,                          //
+                                     GetFileName(site.file),      //
+                                     site.line))};
+    auto length{std::min<std::size_t>(prefix.size, maxLength)};
     // format the log line
-    vformat_to(std::back_insert_iterator(buffer), format, args);
-    vformat_to(std::back_insert_iterator(buffer), "{}", fmt::make_format_args("\n"));
+    const auto line{vformat_to_n(text + length, maxLength - length, format, args)};
+    length = std::min<std::size_t>(length + line.size, maxLength);
+    text[length++] = '\n';
+
+    const RecordHeader header{ticks, &site, nullptr};
+    std::memcpy(data, &header, sizeof(header));
+    threadLog.ring.Commit(sizeof(RecordHeader) + length);
+  }
 
-    if (not m_LogQueue.bounded_push(buffer)) {   // failed to push due to queue full, wait and retry
-      bool done{false};
-      while (not done) {
-        std::cout << "Log Queue full!!!" << std::endl;
-        Signal(true);
+  /// @brief Drain the rings of all threads, may only be called from the consumer thread.
+  /// The rings are merged on the time of the records, the oldest record of all rings is written first.
+  void WriteRecords()
+  {
+    {
+      const std::scoped_lock lock(m_ThreadLogsMutex);
+      for (const auto &threadLog : m_ThreadLogs) {
+        // the closed flag is read before the drain, the records of a closed thread are all drained
+        m_DrainLogs.push_back(DrainLog{threadLog.get(), {}, 0, threadLog->isClosed.load(std::memory_order_acquire)});
+      }
+    }
+    if (m_DrainLogs.empty()) {
+      return;
+    }
 
-        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    m_TscClock.Calibrate();
 
-        if (m_LogQueue.push(buffer)) {
-          done = true;
+    const std::scoped_lock fileLock(m_LogFileMutex);
+
+    for (auto &drainLog : m_DrainLogs) {
+      SetFrontRecord(drainLog);
+    }
+
+    for (auto count{0u}; count < MaxDrainRecords; count++) {
+      DrainLog *oldest{};
+      for (auto &drainLog : m_DrainLogs) {
+        if (not drainLog.record.empty() and (oldest == nullptr or drainLog.ticks < oldest->ticks)) {
+          oldest = &drainLog;
         }
       }
+      if (oldest == nullptr) {
+        break;   // all rings are empty
+      }
+
+      // the file is rotated by the consumer, the logging threads continue to write into their rings
+      if (count % RotateCheckRecords == 0) {
+        StartFileIfDue();
+      }
+      FormatRecord(oldest->record, oldest->threadLog->threadId);
+      oldest->threadLog->ring.Pop();
+      SetFrontRecord(*oldest);
+    }
+
+    for (auto &drainLog : m_DrainLogs) {
+      CountDroppedLines(*drainLog.threadLog);
+    }
+    if (std::chrono::steady_clock::now() - m_DropReportTime >= DropReportPeriod) {
+      WriteDropReport();
+    }
+
+    // the rings are owned by the handles of the threads and the logger, the rings of ended threads are released when they are drained and
+    // their dropped lines are counted
+    const auto isReleased{[](const DrainLog &drainLog) { return drainLog.isClosed and drainLog.record.empty(); }};
+    if (std::any_of(std::begin(m_DrainLogs), std::end(m_DrainLogs), isReleased)) {
+      const std::scoped_lock lock(m_ThreadLogsMutex);
+      std::erase_if(m_ThreadLogs, [&](const std::shared_ptr<ThreadLog> &threadLog) {
+        return std::any_of(std::begin(m_DrainLogs), std::end(m_DrainLogs), [&](const DrainLog &drainLog) {
+          return drainLog.threadLog == threadLog.get() and isReleased(drainLog);
+        });
+      });
+    }
+    m_DrainLogs.clear();
+
+    // the lines of the round are written at once
+    m_LogFile.Flush();
+  }
+
+  /// @brief Rotate the log file when it is due, a new file starts with the header of its format
+  void StartFileIfDue()
+  {
+    (void)m_LogFile.RotateIfDue();
+    if (m_LogFile.GetFileSequence() == m_FileSequence) {
+      return;
+    }
+
+    m_FileSequence = m_LogFile.GetFileSequence();
+    m_FileFormat = m_LogFile.IsOpen() ? m_LogFormat : LogFormat::Text;
+    if (m_FileFormat == LogFormat::Binary) {
+      // the sites and threads are written again in every file, a file is decoded on its own
+      m_BinarySites.clear();
+      m_BinaryThreads.clear();
+      m_BinaryTime = GetNanoseconds(std::chrono::system_clock::now());
+      moboware::common::binary_log::WriteHeader(m_WriteBuffer, m_BinaryTime);
+    } else {
+      const std::string_view start{"Start new log file entry\n"};
+      m_WriteBuffer.append(start.data(), start.data() + start.size());
+    }
+    AppendWriteBuffer();
+  }
+
+  /// @brief Add the lines that are dropped by the thread since the last count to the counts of the next report
+  void CountDroppedLines(ThreadLog &threadLog)
+  {
+    for (std::size_t levelIndex{}; levelIndex < LogLevelCount; levelIndex++) {
+      const auto droppedLines{threadLog.droppedLines[levelIndex].load(std::memory_order_relaxed)};
+      const auto newDroppedLines{droppedLines - threadLog.countedDroppedLines[levelIndex]};
+      if (newDroppedLines > 0) {
+        threadLog.countedDroppedLines[levelIndex] = droppedLines;
+        m_ReportDroppedLines[levelIndex] += newDroppedLines;
+        m_DroppedLines[levelIndex].fetch_add(newDroppedLines, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// @brief Write the lines that are dropped since the last report, per level
+  void WriteDropReport()
+  {
+    m_DropReportTime = std::chrono::steady_clock::now();
+    if (std::all_of(std::begin(m_ReportDroppedLines), std::end(m_ReportDroppedLines), [](const auto count) { return count == 0; })) {
+      return;
+    }
+
+    const auto time{GetTimeString(std::chrono::system_clock::now())};
+    fmt::memory_buffer report;
+    vformat_to(std::back_inserter(report),
+               "[{}][{}][{:#x}][{}:{}]Dropped log lines",
+               fmt::make_format_args(      //
+                 time,                     //
+                 LogLevel::Warning,        //
+                 pthread_self(),           //
+                 GetFileName(__FILE__),    //
+                 __LINE__));
+    for (std::size_t levelIndex{}; levelIndex < LogLevelCount; levelIndex++) {
+      if (m_ReportDroppedLines[levelIndex] > 0) {
+        const auto level{static_cast<LogLevel>(levelIndex)};
+        vformat_to(std::back_inserter(report), ", {}:{}", fmt::make_format_args(level, m_ReportDroppedLines[levelIndex]));
+      }
+    }
+    report.push_back('\n');
+    WriteText(pthread_self(), std::string_view(report.data(), report.size()));
+    m_ReportDroppedLines = {};
+  }
+
+  static void SetFrontRecord(DrainLog &drainLog)
+  {
+    drainLog.record = drainLog.threadLog->ring.Front();
+    if (not drainLog.record.empty()) {
+      std::memcpy(&drainLog.ticks, drainLog.record.data(), sizeof(drainLog.ticks));
+    }
+  }
+
+  void FormatRecord(const std::span<const std::byte> record, const pthread_t threadId)
+  {
+    RecordHeader header;
+    std::memcpy(&header, record.data(), sizeof(header));
+    const auto data{record.subspan(sizeof(RecordHeader))};
+
+    if (header.codec == nullptr) {
+      // the formatted line
+      WriteText(threadId, std::string_view(reinterpret_cast<const char *>(data.data()), data.size()));
+      return;
+    }
+
+    const auto &site{*header.site};
+    if (m_FileFormat == LogFormat::Binary) {
+      WriteBinaryLine(site, header, threadId, data.data());
+    } else {
+      const auto time{GetTimeString(m_TscClock.ToSystemTime(header.ticks))};
+      vformat_to(std::back_inserter(m_WriteBuffer),
+                 "[{}][{}][{:#x}][{}:{}]",
+                 fmt::make_format_args(      //
+                   time,                     //
+                   site.level,               //
+                   threadId,                 //
+                   GetFileName(site.file),   //
+                   site.line));
+      try {
+        header.codec->formatFn(m_WriteBuffer, site.format, data.data());
+      } catch (const fmt::format_error &e) {
+        fmt::format_to(std::back_inserter(m_WriteBuffer), "[format error: {}] {}", e.what(), site.format);
+      }
+      m_WriteBuffer.push_back('\n');
+    }
+    AppendWriteBuffer();
+  }
+
+  /// @brief Write a formatted line, a binary file keeps it as text
+  void WriteText(const pthread_t threadId, const std::string_view text)
+  {
+    if (m_FileFormat == LogFormat::Binary) {
+      using namespace moboware::common::binary_log;
+      const auto threadIndex{GetBinaryThreadIndex(threadId)};
+      WriteByte(m_WriteBuffer, static_cast<std::uint8_t>(RecordType::Text));
+      WriteVarint(m_WriteBuffer, threadIndex);
+      WriteString(m_WriteBuffer, text);
+      AppendWriteBuffer();
+    } else {
+      m_LogFile.Append(text.data(), text.size());
+    }
+  }
+
+  /// @brief Write the site, the time and the arguments of a deferred line, the site is written once per file
+  void WriteBinaryLine(const LogSite &site, const RecordHeader &header, const pthread_t threadId, const std::byte *arguments)
+  {
+    using namespace moboware::common::binary_log;
+    const auto threadIndex{GetBinaryThreadIndex(threadId)};
+    const auto [siteIter, isNewSite]{m_BinarySites.try_emplace(&site, static_cast<std::uint32_t>(m_BinarySites.size()))};
+    if (isNewSite) {
+      WriteByte(m_WriteBuffer, static_cast<std::uint8_t>(RecordType::Site));
+      WriteVarint(m_WriteBuffer, siteIter->second);
+      WriteByte(m_WriteBuffer, static_cast<std::uint8_t>(site.level));
+      WriteVarint(m_WriteBuffer, site.line);
+      WriteString(m_WriteBuffer, GetFileName(site.file));
+      WriteString(m_WriteBuffer, std::string_view(site.format.data(), site.format.size()));
+    }
+
+    // the time since the previous line is small, the lines of a round are in time order
+    const auto time{GetNanoseconds(m_TscClock.ToSystemTime(header.ticks))};
+    WriteByte(m_WriteBuffer, static_cast<std::uint8_t>(RecordType::Line));
+    WriteVarint(m_WriteBuffer, siteIter->second);
+    WriteZigzag(m_WriteBuffer, time - m_BinaryTime);
+    WriteVarint(m_WriteBuffer, threadIndex);
+    header.codec->transcodeFn(m_WriteBuffer, arguments);
+    m_BinaryTime = time;
+  }
+
+  /// @brief the index of the thread in the binary file, the thread is written once per file
+  [[nodiscard]] auto GetBinaryThreadIndex(const pthread_t threadId) -> std::uint32_t
+  {
+    using namespace moboware::common::binary_log;
+    const auto [threadIter, isNewThread]{m_BinaryThreads.try_emplace(threadId, static_cast<std::uint32_t>(m_BinaryThreads.size()))};
+    if (isNewThread) {
+      WriteByte(m_WriteBuffer, static_cast<std::uint8_t>(RecordType::Thread));
+      WriteVarint(m_WriteBuffer, threadIter->second);
+      WriteVarint(m_WriteBuffer, threadId);
+    }
+    return threadIter->second;
+  }
+
+  inline void AppendWriteBuffer()
+  {
+    m_LogFile.Append(m_WriteBuffer.data(), m_WriteBuffer.size());
+    m_WriteBuffer.clear();
+  }
+
+  [[nodiscard]] static inline auto GetNanoseconds(const std::chrono::system_clock::time_point point) -> std::int64_t
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(point.time_since_epoch()).count();
+  }
+
+  /// @brief the time is formatted once per second
+  [[nodiscard]] inline auto GetTimeString(const std::chrono::system_clock::time_point point) -> std::string_view
+  {
+    const auto second{std::chrono::time_point_cast<std::chrono::seconds>(point)};
+    if (second != m_TimeStringSecond) {
+      m_TimeStringSecond = second;
+      m_TimeString = fmt::format("{:%Y%m%d %H:%M:%S}", second);
     }
+    return m_TimeString;
+  }
 
-    Signal(false);
+  [[nodiscard]] static inline auto GetFileName(const std::string_view file) -> std::string_view
+  {
+    return file.substr(file.find_last_of('/') + 1);
   }
 
   void Signal(const bool tickleThread = true)
@@ -256,14 +759,49 @@ private:
     return fmt::format("{:%Y%m%d %H:%M:%S}", point);
   }
 
-  LogQueue_t m_LogQueue;
-  std::ofstream m_LogFileStream{};
+  // the log file is written by the consumer thread, it is opened and configured by other threads
+  std::mutex m_LogFileMutex;
+  moboware::common::LogFile m_LogFile;
+  LogFormat m_LogFormat{LogFormat::Text};
+
+  // the rings of the logging threads
+  std::mutex m_ThreadLogsMutex;
+  std::vector<std::shared_ptr<ThreadLog>> m_ThreadLogs;
+
+  // consumer thread only
+  std::vector<DrainLog> m_DrainLogs;
+  moboware::common::TscClock m_TscClock;
+  fmt::memory_buffer m_WriteBuffer;
+  std::chrono::sys_seconds m_TimeStringSecond{};
+  std::string m_TimeString;
+  LineCounts_t m_ReportDroppedLines{};
+  std::chrono::steady_clock::time_point m_DropReportTime{};
+  std::uint64_t m_FileSequence{};
+  LogFormat m_FileFormat{LogFormat::Text};
+  std::unordered_map<const LogSite *, std::uint32_t> m_BinarySites;
+  std::unordered_map<pthread_t, std::uint32_t> m_BinaryThreads;
+  std::int64_t m_BinaryTime{};   // nanoseconds of the previous binary line
+
+  std::array<std::atomic<std::uint64_t>, LogLevelCount> m_DroppedLines{};
 
   std::jthread m_LogConsumerThread;
   std::condition_variable m_ConditionVariable;
   std::mutex m_WaitMutex;
 
+  // the levels of the source files, the file levels are referred to by the log statements and are never erased
+  std::mutex m_FileLevelsMutex;
   LogLevel m_GlobalLogLevel{LogLevel::Info};
+  std::map<std::string, LogLevel> m_ModuleLevels;
+  std::map<std::string, std::atomic<LogLevel>, std::less<>> m_FileLevels;
+  LogMode m_LogMode{LogMode::Formatted};
+  // the logging threads do not wait for the consumer by default
+  std::array<OverflowPolicy, LogLevelCount> m_OverflowPolicies{OverflowPolicy::Drop,        // None
+                                                               OverflowPolicy::DropFirst,   // Trace
+                                                               OverflowPolicy::DropFirst,   // Debug
+                                                               OverflowPolicy::DropFirst,   // Info
+                                                               OverflowPolicy::Drop,        // Warning
+                                                               OverflowPolicy::Drop,        // Error
+                                                               OverflowPolicy::Drop};       // Fatal
 };
 
 // user defined log level formatter
@@ -301,45 +839,33 @@ inline auto fmt::formatter<Logger::LogLevel>::format(Logger::LogLevel l, fmt::fo
   return formatter<string_view>::format(name, ctx);
 }
 
-#define LOG_TRACE(format, ...)                                                                                                                  \
+// the level of the file is looked up once per log statement, a statement below the compile time minimum level is discarded
+#define MOBOWARE_LOG(level, format, ...)                                                                                                        \
   {                                                                                                                                             \
-    if (Logger::GetInstance().TestLevel(Logger::LogLevel::Trace)) {                                                                             \
-      Logger::GetInstance()._log2(Logger::LogLevel::Trace, __FILE__, __LINE__, format, ##__VA_ARGS__);                                          \
+    if constexpr (Logger::IsCompiledLevel(level)) {                                                                                             \
+      static const auto &fileLogLevel{Logger::GetInstance().GetFileLevel(__FILE__)};                                                            \
+      if (Logger::TestLevel(fileLogLevel, level)) {                                                                                             \
+        static constexpr Logger::LogSite logSite{level, __FILE__, __LINE__, format};                                                            \
+        Logger::GetInstance()._log2(logSite, format, ##__VA_ARGS__);                                                                            \
+      }                                                                                                                                         \
     }                                                                                                                                           \
   }
 
+#define LOG_TRACE(format, ...)                                                                                                                  \
+  MOBOWARE_LOG(Logger::LogLevel::Trace, format, ##__VA_ARGS__)
+
 #define LOG_DEBUG(format, ...)                                                                                                                  \
-  {                                                                                                                                             \
-    if (Logger::GetInstance().TestLevel(Logger::LogLevel::Debug)) {                                                                             \
-      Logger::GetInstance()._log2(Logger::LogLevel::Debug, __FILE__, __LINE__, format, ##__VA_ARGS__);                                          \
-    }                                                                                                                                           \
-  }
+  MOBOWARE_LOG(Logger::LogLevel::Debug, format, ##__VA_ARGS__)
 
 #define LOG_INFO(format, ...)                                                                                                                   \
-  {                                                                                                                                             \
-    if (Logger::GetInstance().TestLevel(Logger::LogLevel::Info)) {                                                                              \
-      Logger::GetInstance()._log2(Logger::LogLevel::Info, __FILE__, __LINE__, format, ##__VA_ARGS__);                                           \
-    }                                                                                                                                           \
-  }
+  MOBOWARE_LOG(Logger::LogLevel::Info, format, ##__VA_ARGS__)
 
 #define LOG_ERROR(format, ...)                                                                                                                  \
-  {                                                                                                                                             \
-    if (Logger::GetInstance().TestLevel(Logger::LogLevel::Error)) {                                                                             \
-      Logger::GetInstance()._log2(Logger::LogLevel::Error, __FILE__, __LINE__, format, ##__VA_ARGS__);                                          \
-    }                                                                                                                                           \
-  }
+  MOBOWARE_LOG(Logger::LogLevel::Error, format, ##__VA_ARGS__)
 
 #define LOG_WARN(format, ...)                                                                                                                   \
-  {                                                                                                                                             \
-    if (Logger::GetInstance().TestLevel(Logger::LogLevel::Warning)) {                                                                           \
-      Logger::GetInstance()._log2(Logger::LogLevel::Warning, __FILE__, __LINE__, format, ##__VA_ARGS__);                                        \
-    }                                                                                                                                           \
-  }
+  MOBOWARE_LOG(Logger::LogLevel::Warning, format, ##__VA_ARGS__)
 
 #define LOG_FATAL(format, ...)                                                                                                                  \
-  {                                                                                                                                             \
-    if (Logger::GetInstance().TestLevel(Logger::LogLevel::Fatal)) {                                                                             \
-      Logger::GetInstance()._log2(Logger::LogLevel::Fatal, __FILE__, __LINE__, format, ##__VA_ARGS__);                                          \
-    }                                                                                                                                           \
-  }
+  MOBOWARE_LOG(Logger::LogLevel::Fatal, format, ##__VA_ARGS__)
 //}   // namespace moboware::common::logger
\ No newline at end of file
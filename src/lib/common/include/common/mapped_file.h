@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace moboware::common {
+
+/// @brief File that is memory mapped as a whole, for the append only files of a single writer and for reading them back.
+/// A created file is pre-allocated on disk to its full size, so writing into the mapping does not extend the file and causes no
+/// system calls, only page faults on the first touch of a page. The data is in the page cache as soon as it is written, it
+/// survives a crash of the process, Sync flushes it to the disk.
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile(MappedFile &&) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+  /// @brief unmaps the file, a created file is truncated to the used size
+  ~MappedFile();
+
+  /// @brief Create a new file of the size, pre-allocated and mapped for writing. An existing file is not overwritten.
+  /// @return false when the file exists or can not be created, the error is logged
+  [[nodiscard]] bool Create(const std::string &path, const std::size_t size);
+
+  /// @brief Map an existing file for reading
+  /// @return false when the file can not be opened, the error is logged
+  [[nodiscard]] bool Open(const std::string &path);
+
+  /// @brief Flush the written range of a created file to the disk, blocks until the data is written
+  /// @return false on an io error, the error is logged
+  bool Sync(const std::size_t offset, const std::size_t length);
+
+  /// @brief Unmap the file, a created file is truncated to the used size so the pre-allocated tail is not kept
+  void Close();
+
+  [[nodiscard]] inline bool IsOpen() const noexcept
+  {
+    return m_Data != nullptr;
+  }
+
+  [[nodiscard]] inline auto GetData() noexcept -> char *
+  {
+    return m_Data;
+  }
+
+  [[nodiscard]] inline auto GetData() const noexcept -> const char *
+  {
+    return m_Data;
+  }
+
+  [[nodiscard]] inline auto GetSize() const noexcept -> std::size_t
+  {
+    return m_Size;
+  }
+
+  [[nodiscard]] inline auto GetPath() const noexcept -> const std::string &
+  {
+    return m_Path;
+  }
+
+  /// @brief number of bytes written into a created file, the file is truncated to it on close
+  inline void SetUsedSize(const std::size_t usedSize) noexcept
+  {
+    m_UsedSize = usedSize;
+  }
+
+private:
+  std::string m_Path;
+  int m_Fd{-1};
+  char *m_Data{};
+  std::size_t m_Size{};
+  std::size_t m_UsedSize{};
+  bool m_IsWritable{};
+};
+}   // namespace moboware::common
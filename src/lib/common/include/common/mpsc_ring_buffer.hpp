@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace moboware::common {
+
+/**
+ * @brief Bounded multiple producer, single consumer ring buffer of elements of type T.
+ * Every slot has a sequence number that tells the producers and the consumer if the slot is free or filled, so there are no locks needed:
+ *   - producers claim a slot by a compare and exchange of the head position and publish the element with a release store on the slot sequence
+ *   - the single consumer owns the tail position and frees the slot with a release store of the sequence of the next round
+ * The elements are constructed in place in the slot and moved out on pop, there are no allocations after construction.
+ * With a single producer the ring buffer is a SPSC ring buffer, the compare and exchange on the head will never fail.
+ * @tparam T element type, must be move constructible
+ * @tparam Capacity, number of slots, must be a power of 2
+ */
+template <typename T, const std::size_t Capacity = 1024>   //
+class MpscRingBuffer final {
+public:
+  static_assert(Capacity >= 2 and (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+  static constexpr std::size_t CACHE_LINE_SIZE{64};
+
+  using Element_t = T;
+
+  MpscRingBuffer()
+    : m_Slots(std::make_unique<Slot[]>(Capacity))
+  {
+    for (std::size_t position = 0; position < Capacity; position++) {
+      m_Slots[position].sequence.store(position, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRingBuffer(const MpscRingBuffer &) = delete;
+  MpscRingBuffer(MpscRingBuffer &&) = delete;
+  MpscRingBuffer &operator=(const MpscRingBuffer &) = delete;
+  MpscRingBuffer &operator=(MpscRingBuffer &&) = delete;
+  ~MpscRingBuffer() = default;
+
+  /// @brief Construct an element in the next free slot, can be called from multiple threads
+  /// @return false when the buffer is full
+  template <typename... TArgs> [[nodiscard]] bool Push(TArgs &&...args)
+  {
+    auto headPosition{m_Head.load(std::memory_order_relaxed)};
+    Slot *slot{};
+
+    while (true) {
+      slot = &m_Slots[headPosition & Mask];
+      const auto sequence{slot->sequence.load(std::memory_order_acquire)};
+      const auto difference{static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(headPosition)};
+
+      if (difference == 0) {
+        // the slot is free, claim it
+        if (m_Head.compare_exchange_weak(headPosition, headPosition + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;   // The buffer is full!!!
+      } else {
+        // another producer claimed the slot, retry on the new head
+        headPosition = m_Head.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->element.emplace(std::forward<TArgs>(args)...);
+    // publish the element to the consumer
+    slot->sequence.store(headPosition + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Pop the oldest element, may only be called from the consumer thread
+  /// @param popFn, function that is called with the element, the element is destroyed after the call
+  /// @return false when the buffer is empty
+  template <typename TPopFn> bool Pop(TPopFn &&popFn)
+  {
+    auto &slot{m_Slots[m_Tail & Mask]};
+    if (slot.sequence.load(std::memory_order_acquire) != m_Tail + 1) {
+      return false;   // buffer is empty
+    }
+
+    popFn(*slot.element);
+    slot.element.reset();
+
+    // free the slot for the producers of the next round
+    slot.sequence.store(m_Tail + Capacity, std::memory_order_release);
+    m_Tail++;
+    return true;
+  }
+
+  /// @brief Is the buffer empty, only reliable on the consumer thread
+  [[nodiscard]] inline bool Empty() const noexcept
+  {
+    return m_Slots[m_Tail & Mask].sequence.load(std::memory_order_acquire) != m_Tail + 1;
+  }
+
+  [[nodiscard]] inline std::size_t GetCapacity() const noexcept
+  {
+    return Capacity;
+  }
+
+private:
+  static constexpr std::size_t Mask{Capacity - 1};
+
+  struct alignas(CACHE_LINE_SIZE) Slot {
+    std::atomic<std::size_t> sequence{};
+    std::optional<T> element;
+  };
+
+  std::unique_ptr<Slot[]> m_Slots;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_Head{};
+  alignas(CACHE_LINE_SIZE) std::size_t m_Tail{};
+};
+}   // namespace moboware::common
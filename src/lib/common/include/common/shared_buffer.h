@@ -0,0 +1,27 @@
+#pragma once
+#include <boost/asio/buffer.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace moboware::common {
+
+/// @brief Immutable message that is encoded once and shared by all the sessions it is sent to. Every session that queues the
+/// message holds a reference, the message is freed when the last session has written it.
+using SharedBuffer_t = std::shared_ptr<const std::string>;
+
+/// @brief Identifies the state that a message updates, e.g. a price level of an instrument. A newer message with the same key supersedes
+/// a queued message that is not written yet, a message without a key is never replaced.
+using ConflationKey_t = std::uint64_t;
+constexpr ConflationKey_t NoConflationKey{};
+
+[[nodiscard]] inline auto MakeSharedBuffer(const char *data, const std::size_t size) -> SharedBuffer_t
+{
+  return std::make_shared<const std::string>(data, size);
+}
+
+[[nodiscard]] inline auto ToConstBuffer(const SharedBuffer_t &sharedBuffer) -> boost::asio::const_buffer
+{
+  return {sharedBuffer->data(), sharedBuffer->size()};
+}
+}   // namespace moboware::common
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <span>
+
+namespace moboware::common {
+
+/**
+ * @brief Bounded single producer, single consumer ring buffer of variable length records in a byte array.
+ * A record is a length followed by the data and takes its aligned length in the buffer, so small records take little space. The data of a
+ * record is contiguous, a record that does not fit before the end of the buffer starts at the begin of the buffer and the rest of the
+ * buffer is skipped with a wrap marker.
+ * The producer reserves space for the maximum length of a record, writes the data in place and commits the written length, the consumer
+ * reads the oldest record in place and pops it when it is done with it. There are no allocations after construction.
+ * @tparam Capacity, number of bytes, must be a power of 2
+ */
+template <const std::size_t Capacity = 64 * 1024>   //
+class SpscRecordBuffer final {
+public:
+  static_assert(Capacity >= 64 and (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+  static constexpr std::size_t CACHE_LINE_SIZE{64};
+  static constexpr std::size_t RecordAlignment{8};
+
+  SpscRecordBuffer()
+    : m_Buffer(std::make_unique<std::byte[]>(Capacity))
+  {
+  }
+
+  SpscRecordBuffer(const SpscRecordBuffer &) = delete;
+  SpscRecordBuffer(SpscRecordBuffer &&) = delete;
+  SpscRecordBuffer &operator=(const SpscRecordBuffer &) = delete;
+  SpscRecordBuffer &operator=(SpscRecordBuffer &&) = delete;
+  ~SpscRecordBuffer() = default;
+
+  /// @brief Reserve space for a record, may only be called from the producer thread. The record is not visible to the consumer until it is
+  /// committed, a reservation that is not committed is dropped by the next reservation.
+  /// @param maxSize, maximum length of the data of the record, at most GetMaxRecordSize()
+  /// @param keepFreeSize, bytes that have to stay free after the record, e.g. to keep space for more important records
+  /// @return pointer to the data of the record, nullptr when there is not enough free space
+  [[nodiscard]] auto Reserve(const std::size_t maxSize, const std::size_t keepFreeSize = 0) -> std::byte *
+  {
+    const auto headPosition{m_Head.load(std::memory_order_relaxed)};
+    const auto offset{headPosition & Mask};
+    const auto recordSize{GetRecordSize(maxSize)};
+
+    // a record that does not fit before the end of the buffer skips the end
+    const auto skipSize{Capacity - offset < recordSize ? Capacity - offset : 0};
+    if (not HasFreeSpace(headPosition, skipSize + recordSize + keepFreeSize)) {
+      return nullptr;   // The buffer is full!!!
+    }
+
+    m_ReservedSkipSize = skipSize;
+    if (skipSize > 0) {
+      WriteLength(offset, WrapMarker);
+    }
+    const auto recordOffset{(offset + skipSize) & Mask};
+    return &m_Buffer[recordOffset + sizeof(RecordLength_t) + HeaderPadding];
+  }
+
+  /// @brief Publish the reserved record to the consumer, may only be called from the producer thread
+  /// @param size, length of the written data of the record, at most the reserved length
+  void Commit(const std::size_t size)
+  {
+    const auto headPosition{m_Head.load(std::memory_order_relaxed)};
+    const auto recordOffset{(headPosition + m_ReservedSkipSize) & Mask};
+    WriteLength(recordOffset, static_cast<RecordLength_t>(size));
+
+    // publish the record to the consumer
+    m_Head.store(headPosition + m_ReservedSkipSize + GetRecordSize(size), std::memory_order_release);
+  }
+
+  /// @brief The data of the oldest record, may only be called from the consumer thread
+  /// @return the data of the record, an empty span when the buffer is empty
+  [[nodiscard]] auto Front() -> std::span<const std::byte>
+  {
+    auto tailPosition{m_Tail.load(std::memory_order_relaxed)};
+    if (tailPosition == m_CachedHead) {
+      m_CachedHead = m_Head.load(std::memory_order_acquire);
+      if (tailPosition == m_CachedHead) {
+        return {};   // buffer is empty
+      }
+    }
+
+    auto length{ReadLength(tailPosition & Mask)};
+    if (length == WrapMarker) {
+      // the record is at the begin of the buffer, free the skipped end
+      tailPosition += Capacity - (tailPosition & Mask);
+      m_Tail.store(tailPosition, std::memory_order_release);
+      length = ReadLength(0);
+    }
+    return {&m_Buffer[(tailPosition & Mask) + sizeof(RecordLength_t) + HeaderPadding], length};
+  }
+
+  /// @brief Free the oldest record, may only be called from the consumer thread after Front() returned the record
+  void Pop()
+  {
+    const auto tailPosition{m_Tail.load(std::memory_order_relaxed)};
+    const auto length{ReadLength(tailPosition & Mask)};
+
+    // free the record for the producer
+    m_Tail.store(tailPosition + GetRecordSize(length), std::memory_order_release);
+  }
+
+  /// @brief Is the buffer empty, only reliable on the consumer thread
+  [[nodiscard]] inline bool Empty() const noexcept
+  {
+    return m_Tail.load(std::memory_order_relaxed) == m_Head.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] inline std::size_t GetCapacity() const noexcept
+  {
+    return Capacity;
+  }
+
+  /// @brief a record may take at most half of the buffer, so a record that wraps fits in an empty buffer
+  [[nodiscard]] static constexpr std::size_t GetMaxRecordSize() noexcept
+  {
+    return Capacity / 2 - sizeof(RecordLength_t) - HeaderPadding;
+  }
+
+private:
+  using RecordLength_t = std::uint32_t;
+  static constexpr std::size_t Mask{Capacity - 1};
+  static constexpr RecordLength_t WrapMarker{std::numeric_limits<RecordLength_t>::max()};
+  // the data of a record is aligned
+  static constexpr std::size_t HeaderPadding{RecordAlignment - sizeof(RecordLength_t)};
+
+  [[nodiscard]] static constexpr auto GetRecordSize(const std::size_t size) noexcept -> std::size_t
+  {
+    return (sizeof(RecordLength_t) + HeaderPadding + size + RecordAlignment - 1) & ~(RecordAlignment - 1);
+  }
+
+  [[nodiscard]] inline bool HasFreeSpace(const std::size_t headPosition, const std::size_t size) noexcept
+  {
+    if (headPosition + size - m_CachedTail > Capacity) {
+      m_CachedTail = m_Tail.load(std::memory_order_acquire);
+      return headPosition + size - m_CachedTail <= Capacity;
+    }
+    return true;
+  }
+
+  inline void WriteLength(const std::size_t offset, const RecordLength_t length) noexcept
+  {
+    std::memcpy(&m_Buffer[offset], &length, sizeof(length));
+  }
+
+  [[nodiscard]] inline auto ReadLength(const std::size_t offset) const noexcept -> RecordLength_t
+  {
+    RecordLength_t length{};
+    std::memcpy(&length, &m_Buffer[offset], sizeof(length));
+    return length;
+  }
+
+  std::unique_ptr<std::byte[]> m_Buffer;
+
+  // producer side
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_Head{};
+  std::size_t m_CachedTail{};
+  std::size_t m_ReservedSkipSize{};
+
+  // consumer side
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_Tail{};
+  std::size_t m_CachedHead{};
+};
+}   // namespace moboware::common
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string_view>
+
+namespace moboware::common {
+
+/// @brief Pin the calling thread to one cpu core
+/// @param cpu, core number
+/// @return false when the thread could not be pinned, e.g. the core does not exist
+[[nodiscard]] bool SetThreadAffinity(const int cpu);
+
+/// @brief Set the name of the calling thread, as shown by top/gdb. The name is truncated to 15 characters.
+void SetThreadName(const std::string_view name);
+}   // namespace moboware::common
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace moboware::common {
+
+/**
+ * @brief Hierarchical timing wheel of entries that expire on a tick. Level 0 has a slot per tick, every next level has a slot
+ * per full turn of the level below it. An entry is added to the slot of the lowest level that covers its expiry, when the wheel
+ * turns to a slot of a higher level the entries of that slot are cascaded to the lower levels. Adding an entry and expiring it
+ * are O(1), an entry is moved at most once per level.
+ * The ticks where the lower levels are empty are skipped, so advancing an idle wheel does not visit every tick. An expiry beyond
+ * the range of the wheel is parked in the highest level until it is in range.
+ * The slots keep their capacity, in steady state adding and expiring entries does not allocate. The wheel is not thread safe.
+ * @tparam TEntry, entry type
+ * @tparam SlotBits, number of slots per level as a power of 2
+ * @tparam Levels, number of levels, the range of the wheel is 2^(SlotBits * Levels) ticks
+ */
+template <typename TEntry, const std::size_t SlotBits = 8, const std::size_t Levels = 4>   //
+class TimingWheel final {
+public:
+  static_assert(SlotBits > 0 and Levels > 0 and SlotBits * Levels < 64);
+
+  using Tick_t = std::uint64_t;
+
+  static constexpr std::size_t SlotsPerLevel{std::size_t{1} << SlotBits};
+  static constexpr Tick_t Range{Tick_t{1} << (SlotBits * Levels)};
+
+  /// @param startTick, current tick of the wheel
+  explicit TimingWheel(const Tick_t startTick = 0)
+    : m_CurrentTick(startTick)
+  {
+  }
+
+  TimingWheel(const TimingWheel &) = delete;
+  TimingWheel(TimingWheel &&) = delete;
+  TimingWheel &operator=(const TimingWheel &) = delete;
+  TimingWheel &operator=(TimingWheel &&) = delete;
+  ~TimingWheel() = default;
+
+  /// @brief Add an entry, an expiry that is not after the current tick expires on the next tick
+  /// @param expiryTick
+  /// @param entry
+  void Add(const Tick_t expiryTick, const TEntry &entry)
+  {
+    AddSlotEntry(SlotEntry{expiryTick > m_CurrentTick ? expiryTick : m_CurrentTick + 1, entry});
+    m_Size++;
+  }
+
+  /// @brief Restart an empty wheel on the tick, the wheel can be moved back in time, e.g. to replay the expiries of the past
+  /// @return false when the wheel is not empty
+  bool Reset(const Tick_t tick) noexcept
+  {
+    if (m_Size != 0) {
+      return false;
+    }
+    m_CurrentTick = tick;
+    return true;
+  }
+
+  /// @brief Turn the wheel to the tick and expire the entries of the passed ticks, in tick order
+  /// @param tick
+  /// @param expireFn, called with every expired entry
+  template <typename TExpireFn> void Advance(const Tick_t tick, TExpireFn &&expireFn);
+
+  [[nodiscard]] inline auto GetCurrentTick() const noexcept -> Tick_t
+  {
+    return m_CurrentTick;
+  }
+
+  [[nodiscard]] inline auto GetSize() const noexcept -> std::size_t
+  {
+    return m_Size;
+  }
+
+  [[nodiscard]] inline auto IsEmpty() const noexcept -> bool
+  {
+    return m_Size == 0;
+  }
+
+private:
+  static constexpr Tick_t SlotMask{SlotsPerLevel - 1};
+
+  struct SlotEntry {
+    Tick_t expiryTick{};
+    TEntry entry;
+  };
+
+  using Slot_t = std::vector<SlotEntry>;
+
+  [[nodiscard]] static constexpr auto GetLevelShift(const std::size_t level) noexcept -> std::size_t
+  {
+    return SlotBits * level;
+  }
+
+  /// @brief add the entry to the lowest level that covers the expiry, the expiry is after the current tick
+  void AddSlotEntry(SlotEntry &&slotEntry)
+  {
+    const auto delta{slotEntry.expiryTick - m_CurrentTick};
+
+    std::size_t level{};
+    while (level < Levels - 1 and delta >= (Tick_t{1} << GetLevelShift(level + 1))) {
+      level++;
+    }
+
+    // out of range, parked in the last slot of the highest level that is in range and cascaded again from there
+    const auto slotTick{delta < Range ? slotEntry.expiryTick : m_CurrentTick + Range - 1};
+    m_Levels[level].slots[(slotTick >> GetLevelShift(level)) & SlotMask].push_back(std::move(slotEntry));
+    m_Levels[level].size++;
+  }
+
+  /// @brief move the entries of the slot of the current tick of the level to the lower levels
+  void Cascade(const std::size_t level)
+  {
+    auto &slot{m_Levels[level].slots[(m_CurrentTick >> GetLevelShift(level)) & SlotMask]};
+    m_Levels[level].size -= slot.size();
+
+    // the cascade slot keeps its capacity, the entries are moved into the reused swap slot first as the re-added entries of an
+    // out of range expiry can go back into the same slot
+    std::swap(slot, m_CascadeSlot);
+    for (auto &slotEntry : m_CascadeSlot) {
+      AddSlotEntry(std::move(slotEntry));
+    }
+    m_CascadeSlot.clear();
+  }
+
+  struct Level {
+    std::array<Slot_t, SlotsPerLevel> slots;
+    std::size_t size{};   // number of entries in the slots of the level
+  };
+
+  std::array<Level, Levels> m_Levels;
+  Slot_t m_CascadeSlot;
+  Slot_t m_ExpiredSlot;
+  Tick_t m_CurrentTick{};
+  std::size_t m_Size{};
+};
+
+template <typename TEntry, const std::size_t SlotBits, const std::size_t Levels>
+template <typename TExpireFn>
+void TimingWheel<TEntry, SlotBits, Levels>::Advance(const Tick_t tick, TExpireFn &&expireFn)
+{
+  while (m_CurrentTick < tick) {
+    if (m_Size == 0) {
+      m_CurrentTick = tick;
+      return;
+    }
+
+    // skip to the next turn of the first level with entries, the lower levels are empty and have nothing to expire or cascade
+    std::size_t level{};
+    while (m_Levels[level].size == 0) {
+      level++;
+    }
+    const auto shift{GetLevelShift(level)};
+    const auto nextTick{level == 0 ? m_CurrentTick + 1 : ((m_CurrentTick >> shift) + 1) << shift};
+    m_CurrentTick = nextTick < tick ? nextTick : tick;
+
+    // the higher levels first, their entries can cascade into the slot of a lower level that is cascaded next
+    for (auto cascadeLevel{Levels - 1}; cascadeLevel > 0; cascadeLevel--) {
+      if ((m_CurrentTick & ((Tick_t{1} << GetLevelShift(cascadeLevel)) - 1)) == 0 and m_Levels[cascadeLevel].size > 0) {
+        Cascade(cascadeLevel);
+      }
+    }
+
+    auto &slot{m_Levels[0].slots[m_CurrentTick & SlotMask]};
+    if (slot.empty()) {
+      continue;
+    }
+
+    // the expire function can add new entries, the expired entries are taken out of the wheel first
+    std::swap(slot, m_ExpiredSlot);
+    m_Levels[0].size -= m_ExpiredSlot.size();
+    m_Size -= m_ExpiredSlot.size();
+    for (const auto &slotEntry : m_ExpiredSlot) {
+      expireFn(slotEntry.entry);
+    }
+    m_ExpiredSlot.clear();
+  }
+}
+}   // namespace moboware::common
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace moboware::common {
+
+/**
+ * @brief Clock on the time stamp counter of the cpu, reading the counter is a single instruction without a system call, so the hot
+ * threads only take a tick count and the conversion to the wall clock time is done by the thread that needs the time, e.g. the log
+ * consumer thread.
+ * The ticks are converted with the rate that is measured between the construction and the last calibration, the rate gets more
+ * accurate the longer the clock runs. The counter of modern x86 cpus runs at a constant rate and is synchronized between the cores.
+ * On other architectures the ticks are steady clock nanoseconds.
+ */
+class TscClock final {
+public:
+  TscClock()
+    : m_AnchorTicks(Now())
+    , m_AnchorSteadyTime(std::chrono::steady_clock::now())
+    , m_AnchorSystemTime(std::chrono::system_clock::now())
+  {
+    // a first estimate of the rate, the counter has to run a while for a usable rate
+    while (std::chrono::steady_clock::now() - m_AnchorSteadyTime < MinCalibrationPeriod) {
+    }
+    Calibrate();
+  }
+
+  TscClock(const TscClock &) = delete;
+  TscClock(TscClock &&) = delete;
+  TscClock &operator=(const TscClock &) = delete;
+  TscClock &operator=(TscClock &&) = delete;
+  ~TscClock() = default;
+
+  [[nodiscard]] static inline auto Now() noexcept -> std::uint64_t
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+
+  /// @brief Measure the rate of the counter over the period since the construction, may only be called from the converting thread
+  void Calibrate() noexcept
+  {
+    const auto ticks{Now()};
+    const auto elapsed{std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - m_AnchorSteadyTime)};
+    if (elapsed >= MinCalibrationPeriod) {
+      m_TicksPerNanosecond = static_cast<double>(ticks - m_AnchorTicks) / elapsed.count();
+    }
+  }
+
+  [[nodiscard]] inline auto ToSystemTime(const std::uint64_t ticks) const noexcept -> std::chrono::system_clock::time_point
+  {
+    const auto elapsedTicks{static_cast<double>(static_cast<std::int64_t>(ticks - m_AnchorTicks))};
+    const std::chrono::duration<double, std::nano> elapsed{elapsedTicks / m_TicksPerNanosecond};
+    return m_AnchorSystemTime + std::chrono::duration_cast<std::chrono::system_clock::duration>(elapsed);
+  }
+
+  [[nodiscard]] inline auto GetTicksPerNanosecond() const noexcept -> double
+  {
+    return m_TicksPerNanosecond;
+  }
+
+private:
+  static constexpr std::chrono::milliseconds MinCalibrationPeriod{2};
+
+  const std::uint64_t m_AnchorTicks;
+  const std::chrono::steady_clock::time_point m_AnchorSteadyTime;
+  const std::chrono::system_clock::time_point m_AnchorSystemTime;
+  double m_TicksPerNanosecond{1.0};
+};
+}   // namespace moboware::common
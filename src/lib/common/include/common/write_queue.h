@@ -0,0 +1,146 @@
+#pragma once
+#include "common/shared_buffer.h"
+#include <boost/asio/buffer.hpp>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace moboware::common {
+
+/// @brief what to do with the messages of a session that does not read its data fast enough
+enum class SlowConsumerPolicy : std::uint8_t {
+  Drop,         // drop the new messages with a conflation key until the queue is below the low water mark. Messages without a
+                // conflation key, e.g. the private replies of the session, are always queued.
+  Conflate,     // a new message replaces the queued message with the same conflation key that is not written yet, only the latest
+                // state is sent. Messages without a conflation key, e.g. the private replies of the session, are always queued.
+  Disconnect    // close the session
+};
+
+[[nodiscard]] auto ToSlowConsumerPolicy(const std::string_view policy) -> std::optional<SlowConsumerPolicy>;
+
+struct WriteQueueConfig {
+  /// @brief queued bytes at which the session becomes a slow consumer
+  std::size_t highWaterMark{4 * 1024 * 1024};
+  /// @brief queued bytes at which a slow consumer is back to normal
+  std::size_t lowWaterMark{1 * 1024 * 1024};
+  SlowConsumerPolicy slowConsumerPolicy{SlowConsumerPolicy::Disconnect};
+};
+
+/// @brief Outbound message queue of a session. The producers copy the messages into the pending batch, the writer of the session
+/// swaps the pending batch with the write batch and writes it while the producers fill the next pending batch. The messages that
+/// are pushed while a write is in flight are coalesced into one write. The batches keep their capacity, so in steady state
+/// queueing a message does not allocate.
+/// A shared message is not copied, the queue holds a reference to it until it is written. The shared messages are written one
+/// by one, they are not coalesced with the copied messages.
+/// Push can be called from any thread, the write functions are only called by the writer, e.g. on the strand of the session.
+class WriteQueue {
+public:
+  enum class PushResult : std::uint8_t {
+    Queued,       // the message is queued behind the write in flight
+    StartWrite,   // the message is queued and the writer is idle, the caller has to start the writer
+    Dropped,      // the message is dropped by the slow consumer policy or because the session is disconnected
+    Disconnect    // the session is a slow consumer and has to be closed by the caller
+  };
+
+  /// @brief a write of the writer, one or more messages of the same frame type in a contiguous buffer
+  struct Write {
+    boost::asio::const_buffer buffer;
+    bool isBinary{};
+  };
+
+  struct Stats {
+    std::uint64_t queuedMessages{};
+    std::uint64_t droppedMessages{};
+    std::uint64_t conflatedMessages{};
+    std::uint64_t slowConsumerCount{};   // number of times the high water mark was reached
+  };
+
+  explicit WriteQueue(const WriteQueueConfig &config);
+  WriteQueue(const WriteQueue &) = delete;
+  WriteQueue(WriteQueue &&) = delete;
+  WriteQueue &operator=(const WriteQueue &) = delete;
+  WriteQueue &operator=(WriteQueue &&) = delete;
+  ~WriteQueue() = default;
+
+  /// @brief Queue a copy of the message
+  [[nodiscard]] auto Push(const boost::asio::const_buffer &message,
+                          const bool isBinary,
+                          const ConflationKey_t conflationKey = NoConflationKey) -> PushResult;
+
+  /// @brief Queue a reference to a shared message
+  [[nodiscard]] auto Push(const SharedBuffer_t &message, const bool isBinary, const ConflationKey_t conflationKey = NoConflationKey)
+    -> PushResult;
+
+  /// @brief Get the next write for the writer, the previous write has to be completed. When the write batch is written the
+  /// pending batch becomes the write batch.
+  /// @return the next write or nullopt when there is nothing to write, the writer is idle until a Push returns StartWrite
+  [[nodiscard]] auto GetNextWrite() -> std::optional<Write>;
+
+  /// @brief Stop the writer after a failed write, the queued messages and the next pushed messages are dropped
+  void Close();
+
+  [[nodiscard]] auto GetStats() const -> Stats;
+  [[nodiscard]] auto GetQueuedBytes() const -> std::size_t;
+
+private:
+  struct Message {
+    std::size_t offset{};   // offset in the data of the batch or, for a shared message, the index of the shared buffer
+    std::size_t size{};
+    bool isBinary{};
+    bool isShared{};
+    bool isConflated{};   // superseded by a newer message with the same conflation key, it is not written
+    ConflationKey_t conflationKey{NoConflationKey};
+  };
+
+  struct Batch {
+    std::vector<char> data;
+    std::vector<SharedBuffer_t> sharedBuffers;
+    std::vector<Message> messages;
+    std::size_t bytes{};   // copied and shared bytes, without the conflated messages
+    // index of the latest message of a conflation key, only kept while the session is a slow consumer with the conflate policy
+    std::unordered_map<ConflationKey_t, std::size_t> conflationIndex;
+    bool isConflationIndexed{false};
+
+    void Clear()
+    {
+      data.clear();
+      sharedBuffers.clear();
+      messages.clear();
+      bytes = 0;
+      conflationIndex.clear();
+      isConflationIndexed = false;
+    }
+  };
+
+  /// @brief apply the slow consumer policy and start the writer when it is idle, lock is held
+  /// @param messageSize
+  /// @param conflationKey
+  /// @param addMessageFn, adds the message to the pending batch when it is not dropped
+  template <typename TAddMessageFn>
+  [[nodiscard]] auto Push(const std::size_t messageSize, const ConflationKey_t conflationKey, TAddMessageFn &&addMessageFn) -> PushResult;
+
+  /// @brief mark the pending message with the same conflation key as superseded by the message that is added next, lock is held
+  void Conflate(const ConflationKey_t conflationKey);
+
+  /// @brief update the slow consumer state with the queued bytes when the message is added, lock is held
+  [[nodiscard]] bool IsSlowConsumer(const std::size_t messageSize);
+
+  const WriteQueueConfig m_Config;
+
+  mutable std::mutex m_Mutex;
+  Batch m_PendingBatch;               // filled by the producers
+  std::size_t m_WriteBatchBytes{};    // bytes of the write batch that are not written yet
+  bool m_IsWriting{false};            // the writer is busy with a write batch
+  bool m_IsSlowConsumer{false};
+  bool m_IsDisconnected{false};
+  Stats m_Stats;
+
+  // writer side only
+  Batch m_WriteBatch;
+  std::size_t m_WriteIndex{};       // next message of the write batch
+  std::size_t m_LastWriteSize{};    // size of the write in flight
+};
+}   // namespace moboware::common
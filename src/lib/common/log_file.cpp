@@ -0,0 +1,168 @@
+#include "common/log_file.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace moboware::common;
+
+// the log file can not log its own errors, they are printed to the standard error
+
+LogFile::~LogFile()
+{
+  Close();
+}
+
+bool LogFile::Open(const std::filesystem::path &logFilePath)
+{
+  m_LogFilePath = logFilePath;
+
+  // continue with the latest file of today
+  const auto today{std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now())};
+  std::size_t index{};
+  std::error_code ec;
+  while (std::filesystem::exists(GetFilePath(today, index + 1), ec)) {
+    index++;
+  }
+  return OpenFile(today, index);
+}
+
+void LogFile::Close()
+{
+  Flush();
+  if (m_IsOpen) {
+    ::close(m_Fd);
+    m_Fd = STDOUT_FILENO;
+    m_IsOpen = false;
+  }
+}
+
+void LogFile::Append(const char *data, const std::size_t size)
+{
+  auto remaining{size};
+  while (remaining > 0) {
+    if (m_UsedBlocks == 0 or m_BlockOffset == BlockSize) {
+      if (m_UsedBlocks == MaxBatchBlocks) {
+        Flush();
+      }
+      if (m_UsedBlocks == m_Blocks.size()) {
+        m_Blocks.push_back(std::make_unique<Block>());
+      }
+      m_UsedBlocks++;
+      m_BlockOffset = 0;
+    }
+
+    // a line may continue in the next block, the blocks are written in order
+    const auto length{std::min(remaining, BlockSize - m_BlockOffset)};
+    std::memcpy(m_Blocks[m_UsedBlocks - 1]->data.data() + m_BlockOffset, data, length);
+    m_BlockOffset += length;
+    data += length;
+    remaining -= length;
+  }
+}
+
+void LogFile::Flush()
+{
+  if (m_UsedBlocks == 0) {
+    return;
+  }
+
+  std::array<::iovec, MaxBatchBlocks> blocks{};
+  for (std::size_t index{}; index < m_UsedBlocks; index++) {
+    blocks[index].iov_base = m_Blocks[index]->data.data();
+    blocks[index].iov_len = index + 1 == m_UsedBlocks ? m_BlockOffset : BlockSize;
+  }
+
+  auto *block{blocks.data()};
+  auto blockCount{static_cast<int>(m_UsedBlocks)};
+  while (blockCount > 0) {
+    auto written{::writev(m_Fd, block, blockCount)};
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      fmt::print(stderr, "Failed to write log file {}, {}\n", m_Path, std::strerror(errno));
+      break;
+    }
+    m_FileSize += static_cast<std::size_t>(written);
+
+    // continue after a partial write
+    while (blockCount > 0 and static_cast<std::size_t>(written) >= block->iov_len) {
+      written -= static_cast<ssize_t>(block->iov_len);
+      block++;
+      blockCount--;
+    }
+    if (blockCount > 0) {
+      block->iov_base = static_cast<char *>(block->iov_base) + written;
+      block->iov_len -= static_cast<std::size_t>(written);
+    }
+  }
+
+  m_UsedBlocks = 0;
+  m_BlockOffset = 0;
+}
+
+bool LogFile::RotateIfDue()
+{
+  if (not m_IsOpen) {
+    return false;
+  }
+
+  const auto today{std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now())};
+  if (today != m_FileDay) {
+    return OpenFile(today, 0);
+  }
+  // the appended data is part of the file
+  const auto pendingSize{m_UsedBlocks == 0 ? 0 : (m_UsedBlocks - 1) * BlockSize + m_BlockOffset};
+  if (m_MaxFileSize > 0 and m_FileSize + pendingSize >= m_MaxFileSize) {
+    return OpenFile(today, m_FileIndex + 1);
+  }
+  return false;
+}
+
+bool LogFile::OpenFile(const std::chrono::sys_days day, const std::size_t index)
+{
+  // the data that is appended before the rotation belongs to the current file
+  Flush();
+
+  const auto path{GetFilePath(day, index).string()};
+  const auto fd{::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)};
+  if (fd < 0) {
+    fmt::print(stderr, "Failed to open log file {}, {}\n", path, std::strerror(errno));
+    return false;
+  }
+
+  struct ::stat fileStat {};
+  ::fstat(fd, &fileStat);
+
+  if (m_IsOpen) {
+    ::close(m_Fd);
+  }
+  m_Fd = fd;
+  m_IsOpen = true;
+  m_Path = path;
+  m_FileSize = static_cast<std::size_t>(fileStat.st_size);
+  m_FileDay = day;
+  m_FileIndex = index;
+  m_FileSequence++;
+  return true;
+}
+
+auto LogFile::GetFilePath(const std::chrono::sys_days day, const std::size_t index) const -> std::filesystem::path
+{
+  const auto fileName{index == 0 ? fmt::format("{:%Y%m%d}_{}", day, m_LogFilePath.filename().string())
+                                 : fmt::format("{:%Y%m%d}_{}.{}{}",
+                                               day,
+                                               m_LogFilePath.stem().string(),
+                                               index,
+                                               m_LogFilePath.extension().string())};
+  auto filePath{m_LogFilePath};
+  filePath.replace_filename(fileName);
+  return filePath;
+}
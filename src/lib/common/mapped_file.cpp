@@ -0,0 +1,124 @@
+#include "common/mapped_file.h"
+#include "common/logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace moboware::common;
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+bool MappedFile::Create(const std::string &path, const std::size_t size)
+{
+  Close();
+
+  const auto fd{::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644)};
+  if (fd < 0) {
+    LOG_ERROR("Failed to create file {}, {}", path, std::strerror(errno));
+    return false;
+  }
+
+  // reserve the blocks now, a write into the mapping can not fail on a full disk later
+  const auto result{::posix_fallocate(fd, 0, static_cast<off_t>(size))};
+  if (result != 0) {
+    LOG_ERROR("Failed to allocate {} bytes for file {}, {}", size, path, std::strerror(result));
+    ::close(fd);
+    ::unlink(path.c_str());
+    return false;
+  }
+
+  auto *const data{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+  if (data == MAP_FAILED) {
+    LOG_ERROR("Failed to map file {}, {}", path, std::strerror(errno));
+    ::close(fd);
+    ::unlink(path.c_str());
+    return false;
+  }
+  ::madvise(data, size, MADV_SEQUENTIAL);
+
+  m_Path = path;
+  m_Fd = fd;
+  m_Data = static_cast<char *>(data);
+  m_Size = size;
+  m_UsedSize = 0;
+  m_IsWritable = true;
+  return true;
+}
+
+bool MappedFile::Open(const std::string &path)
+{
+  Close();
+
+  const auto fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (fd < 0) {
+    LOG_ERROR("Failed to open file {}, {}", path, std::strerror(errno));
+    return false;
+  }
+
+  struct stat fileStat {};
+  if (::fstat(fd, &fileStat) != 0 or fileStat.st_size == 0) {
+    LOG_ERROR("Failed to get the size of file {} or the file is empty", path);
+    ::close(fd);
+    return false;
+  }
+
+  const auto size{static_cast<std::size_t>(fileStat.st_size)};
+  auto *const data{::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)};
+  if (data == MAP_FAILED) {
+    LOG_ERROR("Failed to map file {}, {}", path, std::strerror(errno));
+    ::close(fd);
+    return false;
+  }
+  ::madvise(data, size, MADV_SEQUENTIAL);
+
+  m_Path = path;
+  m_Fd = fd;
+  m_Data = static_cast<char *>(data);
+  m_Size = size;
+  m_UsedSize = size;
+  m_IsWritable = false;
+  return true;
+}
+
+bool MappedFile::Sync(const std::size_t offset, const std::size_t length)
+{
+  if (not m_IsWritable or length == 0) {
+    return true;
+  }
+
+  // msync needs a page aligned start address
+  static const auto pageSize{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))};
+  const auto alignedOffset{offset - (offset % pageSize)};
+  if (::msync(m_Data + alignedOffset, offset + length - alignedOffset, MS_SYNC) != 0) {
+    LOG_ERROR("Failed to sync file {}, {}", m_Path, std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_Data == nullptr) {
+    return;
+  }
+
+  ::munmap(m_Data, m_Size);
+  if (m_IsWritable and m_UsedSize < m_Size) {
+    if (::ftruncate(m_Fd, static_cast<off_t>(m_UsedSize)) != 0) {
+      LOG_WARN("Failed to truncate file {} to {} bytes, {}", m_Path, m_UsedSize, std::strerror(errno));
+    }
+  }
+  ::close(m_Fd);
+
+  m_Fd = -1;
+  m_Data = nullptr;
+  m_Size = 0;
+  m_UsedSize = 0;
+  m_IsWritable = false;
+}
@@ -0,0 +1,35 @@
+#include "common/thread_affinity.h"
+#include "common/logger.hpp"
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+
+using namespace moboware::common;
+
+bool moboware::common::SetThreadAffinity(const int cpu)
+{
+  if (cpu < 0 or cpu >= CPU_SETSIZE) {
+    LOG_ERROR("Invalid cpu {} for thread affinity", cpu);
+    return false;
+  }
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpu, &cpuSet);
+
+  const auto result{::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &cpuSet)};
+  if (result != 0) {
+    LOG_ERROR("Failed to set thread affinity to cpu {}, error {}", cpu, result);
+    return false;
+  }
+
+  LOG_INFO("Thread pinned to cpu {}", cpu);
+  return true;
+}
+
+void moboware::common::SetThreadName(const std::string_view name)
+{
+  // the kernel limits the thread name to 16 characters including the terminating zero
+  const std::string threadName{name.substr(0, 15)};
+  ::pthread_setname_np(::pthread_self(), threadName.c_str());
+}
@@ -0,0 +1,223 @@
+#include "common/write_queue.h"
+#include "common/logger.hpp"
+#include <algorithm>
+#include <iterator>
+
+using namespace moboware::common;
+
+auto moboware::common::ToSlowConsumerPolicy(const std::string_view policy) -> std::optional<SlowConsumerPolicy>
+{
+  if (policy == "Drop") {
+    return SlowConsumerPolicy::Drop;
+  } else if (policy == "Conflate") {
+    return SlowConsumerPolicy::Conflate;
+  } else if (policy == "Disconnect") {
+    return SlowConsumerPolicy::Disconnect;
+  }
+  return std::nullopt;
+}
+
+WriteQueue::WriteQueue(const WriteQueueConfig &config)
+  : m_Config(config)
+{
+}
+
+bool WriteQueue::IsSlowConsumer(const std::size_t messageSize)
+{
+  const auto queuedBytes{m_PendingBatch.bytes + m_WriteBatchBytes};
+  if (m_IsSlowConsumer) {
+    if (queuedBytes <= m_Config.lowWaterMark) {
+      LOG_INFO("Slow consumer recovered, queued bytes:{}, dropped:{}, conflated:{}",
+               queuedBytes,
+               m_Stats.droppedMessages,
+               m_Stats.conflatedMessages);
+      m_IsSlowConsumer = false;
+      // the pending messages are not conflated anymore
+      m_PendingBatch.conflationIndex.clear();
+      m_PendingBatch.isConflationIndexed = false;
+    }
+  } else if (queuedBytes + messageSize > m_Config.highWaterMark) {
+    LOG_WARN("Slow consumer, queued bytes:{}, high water mark:{}", queuedBytes, m_Config.highWaterMark);
+    m_IsSlowConsumer = true;
+    m_Stats.slowConsumerCount++;
+  }
+  return m_IsSlowConsumer;
+}
+
+void WriteQueue::Conflate(const ConflationKey_t conflationKey)
+{
+  auto &messages{m_PendingBatch.messages};
+  auto &conflationIndex{m_PendingBatch.conflationIndex};
+  if (not m_PendingBatch.isConflationIndexed) {
+    // the messages that are queued before the session became a slow consumer
+    for (std::size_t index{}; index < messages.size(); index++) {
+      if (messages[index].conflationKey != NoConflationKey) {
+        conflationIndex[messages[index].conflationKey] = index;
+      }
+    }
+    m_PendingBatch.isConflationIndexed = true;
+  }
+
+  // the message that is added next is the latest of its key
+  const auto [iter, isInserted]{conflationIndex.try_emplace(conflationKey, messages.size())};
+  if (isInserted) {
+    return;
+  }
+
+  auto &message{messages[iter->second]};
+  message.isConflated = true;
+  if (message.isShared) {
+    m_PendingBatch.sharedBuffers[message.offset].reset();
+  }
+  m_PendingBatch.bytes -= message.size;
+  m_Stats.conflatedMessages++;
+  iter->second = messages.size();
+}
+
+template <typename TAddMessageFn>
+auto WriteQueue::Push(const std::size_t messageSize, const ConflationKey_t conflationKey, TAddMessageFn &&addMessageFn) -> PushResult
+{
+  if (m_IsDisconnected) {
+    m_Stats.droppedMessages++;
+    return PushResult::Dropped;
+  }
+
+  if (IsSlowConsumer(messageSize)) {
+    switch (m_Config.slowConsumerPolicy) {
+    case SlowConsumerPolicy::Drop:
+      // only the market data is dropped, a private reply of the session is never lost
+      if (conflationKey != NoConflationKey) {
+        m_Stats.droppedMessages++;
+        return PushResult::Dropped;
+      }
+      break;
+    case SlowConsumerPolicy::Conflate:
+      // the write batch is in flight, only a pending message is replaced
+      if (conflationKey != NoConflationKey) {
+        Conflate(conflationKey);
+      }
+      break;
+    case SlowConsumerPolicy::Disconnect:
+      m_IsDisconnected = true;
+      m_Stats.droppedMessages++;
+      m_PendingBatch.Clear();
+      return PushResult::Disconnect;
+    }
+  }
+
+  addMessageFn();
+  m_PendingBatch.bytes += messageSize;
+  m_Stats.queuedMessages++;
+
+  if (m_IsWriting) {
+    return PushResult::Queued;
+  }
+  m_IsWriting = true;
+  return PushResult::StartWrite;
+}
+
+auto WriteQueue::Push(const boost::asio::const_buffer &message, const bool isBinary, const ConflationKey_t conflationKey) -> PushResult
+{
+  const std::lock_guard lock(m_Mutex);
+  return Push(message.size(), conflationKey, [&]() {
+    const auto *const messageData{static_cast<const char *>(message.data())};
+    m_PendingBatch.messages.push_back(Message{m_PendingBatch.data.size(), message.size(), isBinary, false, false, conflationKey});
+    m_PendingBatch.data.insert(std::end(m_PendingBatch.data), messageData, messageData + message.size());
+  });
+}
+
+auto WriteQueue::Push(const SharedBuffer_t &message, const bool isBinary, const ConflationKey_t conflationKey) -> PushResult
+{
+  const std::lock_guard lock(m_Mutex);
+  return Push(message->size(), conflationKey, [&]() {
+    m_PendingBatch.messages.push_back(Message{m_PendingBatch.sharedBuffers.size(), message->size(), isBinary, true, false, conflationKey});
+    m_PendingBatch.sharedBuffers.push_back(message);
+  });
+}
+
+auto WriteQueue::GetNextWrite() -> std::optional<Write>
+{
+  while (true) {
+    const bool isBatchWritten{m_WriteIndex == m_WriteBatch.messages.size()};
+    if (isBatchWritten) {
+      m_WriteBatch.Clear();
+      m_WriteIndex = 0;
+    }
+
+    {
+      const std::lock_guard lock(m_Mutex);
+      m_WriteBatchBytes -= m_LastWriteSize;   // the previous write is completed
+      m_LastWriteSize = 0;
+
+      if (isBatchWritten) {
+        // continue with the messages that are queued in the mean time
+        std::swap(m_WriteBatch, m_PendingBatch);
+        m_WriteBatchBytes = m_WriteBatch.bytes;
+        if (m_WriteBatch.messages.empty()) {
+          m_IsWriting = false;
+          return std::nullopt;
+        }
+      }
+    }
+
+    // skip the messages that are superseded while they were queued
+    while (m_WriteIndex < m_WriteBatch.messages.size() and m_WriteBatch.messages[m_WriteIndex].isConflated) {
+      m_WriteIndex++;
+    }
+    if (m_WriteIndex < m_WriteBatch.messages.size()) {
+      break;
+    }
+  }
+
+  const auto &firstMessage{m_WriteBatch.messages[m_WriteIndex++]};
+  if (firstMessage.isShared) {
+    m_LastWriteSize = firstMessage.size;
+    return Write{ToConstBuffer(m_WriteBatch.sharedBuffers[firstMessage.offset]), firstMessage.isBinary};
+  }
+
+  // a text message is a web socket message of its own, a client parses one JSON document per message. Consecutive binary messages
+  // are length delimited and are written as one web socket message when they are contiguous in the data of the batch, a conflated
+  // message ends the write.
+  std::size_t writeSize{firstMessage.size};
+  if (firstMessage.isBinary) {
+    while (m_WriteIndex < m_WriteBatch.messages.size() and   //
+           m_WriteBatch.messages[m_WriteIndex].isBinary and
+           not m_WriteBatch.messages[m_WriteIndex].isShared and
+           not m_WriteBatch.messages[m_WriteIndex].isConflated) {
+      writeSize += m_WriteBatch.messages[m_WriteIndex++].size;
+    }
+  }
+
+  m_LastWriteSize = writeSize;
+  return Write{boost::asio::const_buffer(m_WriteBatch.data.data() + firstMessage.offset, writeSize), firstMessage.isBinary};
+}
+
+void WriteQueue::Close()
+{
+  const std::lock_guard lock(m_Mutex);
+  m_IsDisconnected = true;
+  m_IsWriting = false;
+  const auto countUnwritten{[](const Batch &batch, const std::size_t fromIndex) {
+    return static_cast<std::size_t>(std::count_if(std::next(std::begin(batch.messages), static_cast<std::ptrdiff_t>(fromIndex)),
+                                                  std::end(batch.messages),
+                                                  [](const Message &message) { return not message.isConflated; }));
+  }};
+  m_Stats.droppedMessages += countUnwritten(m_PendingBatch, 0) + countUnwritten(m_WriteBatch, m_WriteIndex);
+  m_PendingBatch.Clear();
+  m_WriteBatch.Clear();
+  m_WriteIndex = 0;
+  m_WriteBatchBytes = 0;
+  m_LastWriteSize = 0;
+}
+
+auto WriteQueue::GetStats() const -> Stats
+{
+  const std::lock_guard lock(m_Mutex);
+  return m_Stats;
+}
+
+auto WriteQueue::GetQueuedBytes() const -> std::size_t
+{
+  const std::lock_guard lock(m_Mutex);
+  return m_PendingBatch.bytes + m_WriteBatchBytes;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "common/channel_interface.h"
+#include "modules/matching_engine_module/journal.h"
+#include "modules/matching_engine_module/order_data.h"
+#include "modules/matching_engine_module/snapshot.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace moboware::modules {
+
+/// @brief what the matching engine does when an order would trade with a resting order of the same account
+enum class SelfTradePrevention : std::uint8_t {
+  None,            // the orders trade
+  CancelNewest,    // the left volume of the incoming order is cancelled, the resting order stays
+  CancelOldest,    // the resting order is cancelled, the incoming order continues to match
+  DecrementBoth    // the smaller volume is removed from both orders without a trade, an order without volume is cancelled
+};
+
+[[nodiscard]] auto ToSelfTradePrevention(const std::string_view selfTradePrevention) -> std::optional<SelfTradePrevention>;
+
+/**
+ * @brief MatchingEngine interface, the module, the engine threads and the journal replay use a matching engine through it so an
+ * instrument can be configured with the std::map or the price ladder order books
+ */
+class IMatchingEngine {
+public:
+  IMatchingEngine() = default;
+  virtual ~IMatchingEngine() = default;
+
+  virtual void OrderInsert(OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void OrderAmend(const OrderAmendData &orderAmend, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void OrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void OrderMassCancel(const OrderMassCancelData &orderMassCancel, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void CancelSessionOrders(const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void ExpireOrders(const OrderTime_t now) = 0;
+
+  virtual void GetOrderBook(const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void SubscribeMarketData(const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void UnsubscribeMarketData(const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+
+  virtual void SetJournal(Journal *journal) noexcept = 0;
+  virtual void SetSelfTradePrevention(const SelfTradePrevention selfTradePrevention) noexcept = 0;
+  virtual void SetChannelInterface(const std::shared_ptr<common::ChannelInterface> &channelInterface) noexcept = 0;
+  virtual bool SetExpiryTime(const OrderTime_t time) noexcept = 0;
+  [[nodiscard]] virtual auto GetInputSequence() const noexcept -> std::uint64_t = 0;
+
+  [[nodiscard]] virtual auto CaptureSnapshot() -> snapshot::SnapshotImage = 0;
+  [[nodiscard]] virtual bool WriteSnapshot(const std::string &directory) = 0;
+  [[nodiscard]] virtual bool LoadSnapshot(const std::string &path) = 0;
+};
+}   // namespace moboware::modules
@@ -18,6 +18,12 @@ public:
 
   virtual void HandleOrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
 
-  virtual void GetOrderBook(const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+  virtual void HandleOrderMassCancel(const OrderMassCancelData &orderMassCancel, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+
+  virtual void GetOrderBook(const std::string &instrument, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+
+  virtual void SubscribeMarketData(const std::string &instrument, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
+
+  virtual void UnsubscribeMarketData(const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint) = 0;
 };
 }   // namespace moboware::modules
@@ -0,0 +1,343 @@
+#pragma once
+#include "common/mapped_file.h"
+#include "common/mpsc_ring_buffer.hpp"
+#include "modules/matching_engine_module/order_entry_protocol.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace moboware::modules {
+
+/// @brief Binary layout of the journal of the matching engine inputs.
+/// A journal is a sequence of segment files, every segment starts with a SegmentHeader followed by the records. A record starts
+/// with a RecordHeader, the length in the header is the length of the whole record. The segments are pre-allocated and zero
+/// filled, a zero record length is the end of the records of a segment. The sequence numbers of the records are consecutive over
+/// the segments, the file name of a segment has the sequence of its first record.
+/// The order entry fields of a record are the fixed layout messages of the binary order entry protocol.
+namespace journal {
+
+static constexpr std::array<char, 8> SegmentMagic{'M', 'B', 'J', 'R', 'N', 'L', '\0', '\0'};
+static constexpr std::uint32_t JournalVersion{1};
+
+enum class RecordType : std::uint8_t {
+  Unknown = 0,
+  Insert,
+  Amend,
+  Cancel,
+  MassCancel,
+  CancelSessionOrders,
+  ExpireOrders
+};
+
+#pragma pack(push, 1)
+
+struct SegmentHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t headerLength;
+  std::uint64_t firstSequence;   // sequence of the first record of the segment
+  std::int64_t createTime;       // system clock nano seconds
+};
+
+/// @brief session of the input, an ip v4 address is stored as an ip v4 mapped ip v6 address
+struct Session {
+  std::uint8_t address[16];
+  std::uint16_t port;
+};
+
+struct RecordHeader {
+  std::uint32_t length;   // length of the whole record
+  RecordType type;
+  ReplyFormat replyFormat;
+  std::uint8_t reserved[2];
+  std::uint64_t sequence;        // assigned by the journal writer
+  std::uint64_t inputSequence;   // sequence of the input of the matching engine of the instrument
+  std::int64_t time;             // order time or time of the input, high resolution clock nano seconds
+  Session session;
+  std::uint8_t reserved2[6];
+  binary::Instrument_t instrument;
+};
+
+struct InsertRecord {
+  static constexpr RecordType Type{RecordType::Insert};
+
+  RecordHeader header;
+  binary::OrderInsertMessage message;
+  binary::OrderIdString_t id;
+};
+
+struct AmendRecord {
+  static constexpr RecordType Type{RecordType::Amend};
+
+  RecordHeader header;
+  binary::OrderAmendMessage message;
+};
+
+struct CancelRecord {
+  static constexpr RecordType Type{RecordType::Cancel};
+
+  RecordHeader header;
+  binary::OrderCancelMessage message;
+};
+
+struct MassCancelRecord {
+  static constexpr RecordType Type{RecordType::MassCancel};
+
+  RecordHeader header;
+  binary::MassCancelMessage message;
+};
+
+/// @brief the resting orders of the session of the header are cancelled, the session is closed
+struct CancelSessionOrdersRecord {
+  static constexpr RecordType Type{RecordType::CancelSessionOrders};
+
+  RecordHeader header;
+};
+
+/// @brief the good till date orders that are expired at the time of the header are cancelled
+struct ExpireOrdersRecord {
+  static constexpr RecordType Type{RecordType::ExpireOrders};
+
+  RecordHeader header;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(SegmentHeader) == 32);
+static_assert(sizeof(RecordHeader) == 72);
+
+static constexpr std::size_t MaxRecordLength{std::max({sizeof(InsertRecord),
+                                                       sizeof(AmendRecord),
+                                                       sizeof(CancelRecord),
+                                                       sizeof(MassCancelRecord),
+                                                       sizeof(CancelSessionOrdersRecord),
+                                                       sizeof(ExpireOrdersRecord)})};
+
+[[nodiscard]] auto ToSession(const boost::asio::ip::tcp::endpoint &endpoint) -> Session;
+[[nodiscard]] auto ToEndpoint(const Session &session) -> boost::asio::ip::tcp::endpoint;
+
+[[nodiscard]] inline auto ToJournalTime(const OrderTime_t time) noexcept -> std::int64_t
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+[[nodiscard]] inline auto ToOrderTime(const std::int64_t time) noexcept -> OrderTime_t
+{
+  return OrderTime_t(std::chrono::duration_cast<OrderTime_t::duration>(std::chrono::nanoseconds(time)));
+}
+
+/// @brief file name of the segment that starts with the sequence
+[[nodiscard]] auto GetSegmentFileName(const std::uint64_t firstSequence) -> std::string;
+}   // namespace journal
+
+/// @brief when the journal writer flushes the written records to the disk
+enum class FsyncPolicy : std::uint8_t {
+  None,       // the os writes the pages to the disk, the journal survives a crash of the process but not of the os
+  Interval,   // the records are flushed at the fsync interval
+  Batch       // every batch of records that the writer takes from the ring is flushed before the next batch
+};
+
+[[nodiscard]] auto ToFsyncPolicy(const std::string_view policy) -> std::optional<FsyncPolicy>;
+
+struct JournalConfig {
+  std::string directory{"journal"};
+  std::size_t segmentSize{64 * 1024 * 1024};
+  FsyncPolicy fsyncPolicy{FsyncPolicy::None};
+  std::chrono::milliseconds fsyncInterval{100};
+  /// @brief sequence of the first record that is appended
+  std::uint64_t firstSequence{1};
+};
+
+/// @brief Event sourced journal of the inputs of the matching engines, written in the order the matching engines execute them.
+/// The matching engines copy a fixed layout record of the input into a lock free MPSC ring, a dedicated writer thread takes the
+/// records from the ring, assigns the sequence numbers and copies them into a memory mapped, pre-allocated segment file. Appending
+/// a record does no system calls, the producer only waits when the ring is full.
+/// The writer flushes the segment by the fsync policy, when a segment is full the next segment is created.
+class Journal {
+public:
+  static constexpr std::size_t RingLength{16 * 1024};
+
+  /// @brief statistics of the journal, the counters are totals since the journal is opened
+  struct Stats {
+    std::uint64_t writtenRecords{};
+    std::uint64_t ringFullCount{};   // number of times a producer had to wait for space in the ring
+    std::uint64_t syncCount{};
+    std::uint64_t segmentCount{};
+  };
+
+  explicit Journal(const JournalConfig &config);
+  Journal(const Journal &) = delete;
+  Journal(Journal &&) = delete;
+  Journal &operator=(const Journal &) = delete;
+  Journal &operator=(Journal &&) = delete;
+  /// @brief stops the writer thread after the records in the ring are written, the producers have to be stopped
+  ~Journal() = default;
+
+  /// @brief Create the first segment and start the writer thread
+  /// @return false when the segment can not be created, the error is logged
+  [[nodiscard]] bool Open();
+
+  /// @brief Append an input of a matching engine, can be called from multiple threads. The inputs of one matching engine have
+  /// to be appended by its single writer, in the order of execution.
+  /// @param inputSequence, sequence of the input of the matching engine
+  void Append(const std::uint64_t inputSequence, const OrderInsertData &orderInsert, const boost::asio::ip::tcp::endpoint &endpoint);
+  void Append(const std::uint64_t inputSequence, const OrderAmendData &orderAmend, const boost::asio::ip::tcp::endpoint &endpoint);
+  void Append(const std::uint64_t inputSequence, const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint);
+  void Append(const std::uint64_t inputSequence,
+              const std::string_view instrument,
+              const OrderMassCancelData &orderMassCancel,
+              const boost::asio::ip::tcp::endpoint &endpoint);
+  void AppendCancelSessionOrders(const std::uint64_t inputSequence,
+                                 const std::string_view instrument,
+                                 const boost::asio::ip::tcp::endpoint &endpoint);
+  void AppendExpireOrders(const std::uint64_t inputSequence, const std::string_view instrument, const OrderTime_t now);
+
+  /// @brief Get the statistics, can be called from any thread
+  [[nodiscard]] auto GetStats() const noexcept -> Stats;
+
+  /// @brief sequence of the last written record, 0 when nothing is written yet
+  [[nodiscard]] auto GetLastSequence() const noexcept -> std::uint64_t
+  {
+    return m_LastSequence.load(std::memory_order_acquire);
+  }
+
+private:
+  /// @brief sleep of the writer thread when the ring is empty, the producers never have to wake up the writer
+  static constexpr std::chrono::microseconds WriterIdleSleep{100};
+
+  /// @brief ring slot with a copy of one record
+  struct Entry {
+    template <typename TRecord> explicit Entry(const TRecord &record)
+    {
+      static_assert(sizeof(TRecord) <= journal::MaxRecordLength);
+      std::memcpy(data.data(), &record, sizeof(TRecord));
+    }
+
+    std::array<char, journal::MaxRecordLength> data;
+  };
+
+  using Ring_t = common::MpscRingBuffer<Entry, RingLength>;
+
+  template <typename TRecord>
+  [[nodiscard]] static auto InitRecord(const std::uint64_t inputSequence, const std::string_view instrument, const std::int64_t time)
+    -> TRecord;
+  template <typename TRecord> void Push(const TRecord &record);
+
+  void Run(const std::stop_token &stopToken);
+  /// @brief create the segment that starts with the next sequence
+  [[nodiscard]] bool CreateSegment();
+  void CloseSegment();
+  /// @brief copy the record into the segment, false when the next segment can not be created
+  bool Write(const Entry &entry);
+  void Sync();
+
+  const JournalConfig m_Config;
+  Ring_t m_Ring;
+
+  // owned by the writer thread
+  common::MappedFile m_Segment;
+  std::size_t m_WriteOffset{};
+  std::size_t m_SyncOffset{};
+  std::uint64_t m_NextSequence{};
+  std::chrono::steady_clock::time_point m_LastSyncTime;
+
+  std::atomic<std::uint64_t> m_LastSequence{};
+  std::atomic<std::uint64_t> m_WrittenRecords{};
+  std::atomic<std::uint64_t> m_RingFullCount{};
+  std::atomic<std::uint64_t> m_SyncCount{};
+  std::atomic<std::uint64_t> m_SegmentCount{};
+
+  std::jthread m_Thread;   // started last, joined first
+};
+
+template <typename TRecord> void Journal::Push(const TRecord &record)
+{
+  bool isRingFull{false};
+  while (not m_Ring.Push(record)) {
+    // the writer can not keep up, the inputs are not dropped so the producer waits for space in the ring
+    if (not isRingFull) {
+      isRingFull = true;
+      m_RingFullCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::this_thread::yield();
+  }
+}
+
+/// @brief Reader of the journal segments of a directory, for the replay of the inputs.
+/// The segments are mapped one by one and the records are read in place, in sequence order. A zero or torn record, or a record
+/// that is not the next sequence, is the end of the written records of a segment. The next segment has to continue with the next
+/// sequence, otherwise the reading stops.
+class JournalReader {
+public:
+  JournalReader() = default;
+  JournalReader(const JournalReader &) = delete;
+  JournalReader(JournalReader &&) = delete;
+  JournalReader &operator=(const JournalReader &) = delete;
+  JournalReader &operator=(JournalReader &&) = delete;
+  ~JournalReader() = default;
+
+  /// @brief List the segments of the journal directory, a directory that does not exist is an empty journal
+  /// @return false when the directory can not be listed, the error is logged
+  [[nodiscard]] bool Open(const std::string &directory);
+
+  /// @brief Read the records of all segments
+  /// @param recordFn, called with the header of every record, the record is valid during the call
+  /// @return number of read records
+  template <typename TRecordFn> auto ForEach(TRecordFn &&recordFn) -> std::uint64_t;
+
+  /// @brief sequence of the last read record, 0 when no record is read
+  [[nodiscard]] inline auto GetLastSequence() const noexcept -> std::uint64_t
+  {
+    return m_LastSequence;
+  }
+
+  [[nodiscard]] inline auto GetSegmentCount() const noexcept -> std::size_t
+  {
+    return m_SegmentPaths.size();
+  }
+
+private:
+  /// @brief map a segment and validate its header, the first sequence has to follow the last read record
+  /// @return false when the segment is not a journal segment or there is a gap in the sequences, the error is logged
+  [[nodiscard]] bool OpenSegment(const std::string &path, common::MappedFile &segment) const;
+
+  std::vector<std::string> m_SegmentPaths;   // sorted on the first sequence
+  std::uint64_t m_LastSequence{};
+};
+
+template <typename TRecordFn> auto JournalReader::ForEach(TRecordFn &&recordFn) -> std::uint64_t
+{
+  m_LastSequence = 0;
+
+  std::uint64_t records{};
+  for (const auto &path : m_SegmentPaths) {
+    common::MappedFile segment;
+    if (not OpenSegment(path, segment)) {
+      break;
+    }
+
+    const auto &segmentHeader{*reinterpret_cast<const journal::SegmentHeader *>(segment.GetData())};
+    auto sequence{segmentHeader.firstSequence};
+    std::size_t offset{segmentHeader.headerLength};
+    while (offset + sizeof(journal::RecordHeader) <= segment.GetSize()) {
+      const auto &recordHeader{*reinterpret_cast<const journal::RecordHeader *>(segment.GetData() + offset)};
+      if (recordHeader.length < sizeof(journal::RecordHeader) or offset + recordHeader.length > segment.GetSize() or
+          recordHeader.sequence != sequence) {
+        break;   // end of the written records of the segment
+      }
+
+      recordFn(recordHeader);
+      m_LastSequence = sequence++;
+      offset += recordHeader.length;
+      records++;
+    }
+  }
+  return records;
+}
+}   // namespace moboware::modules
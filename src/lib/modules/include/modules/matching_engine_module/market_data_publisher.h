@@ -0,0 +1,49 @@
+#pragma once
+#include "common/channel_interface.h"
+#include "modules/matching_engine_module/order_data.h"
+#include "modules/matching_engine_module/reply_encoder.h"
+#include <algorithm>
+#include <array>
+#include <boost/asio/ip/tcp.hpp>
+#include <vector>
+
+namespace moboware::modules {
+
+/// @brief Publisher of the public market data of one instrument to the subscribed sessions.
+/// Every update is encoded once per format that has subscribers, the encoded message is a shared buffer that is fanned out to
+/// all subscribers of that format, the sessions queue a reference to the same buffer instead of a copy per session.
+/// The publisher is owned by the matching engine of the instrument and has the same single writer, it is not thread safe.
+class MarketDataPublisher {
+public:
+  explicit MarketDataPublisher(const std::shared_ptr<common::ChannelInterface> &channelInterface);
+  MarketDataPublisher(const MarketDataPublisher &) = delete;
+  MarketDataPublisher(MarketDataPublisher &&) = delete;
+  MarketDataPublisher &operator=(const MarketDataPublisher &) = delete;
+  MarketDataPublisher &operator=(MarketDataPublisher &&) = delete;
+  ~MarketDataPublisher() = default;
+
+  /// @brief Subscribe a session, a session that is already subscribed changes to the format
+  void Subscribe(const boost::asio::ip::tcp::endpoint &endpoint, const ReplyFormat format);
+
+  /// @return false when the session was not subscribed
+  bool Unsubscribe(const boost::asio::ip::tcp::endpoint &endpoint);
+
+  [[nodiscard]] inline bool HasSubscribers() const noexcept
+  {
+    return std::any_of(std::begin(m_Subscribers), std::end(m_Subscribers), [](const auto &endpoints) { return not endpoints.empty(); });
+  }
+
+  [[nodiscard]] auto GetNumberOfSubscribers() const noexcept -> std::size_t;
+
+  void Publish(const LevelUpdate &levelUpdate);
+  void Publish(const PublicTrade &publicTrade);
+
+private:
+  template <typename TUpdate> void PublishUpdate(const TUpdate &update, const common::ConflationKey_t conflationKey);
+
+  const std::shared_ptr<common::ChannelInterface> m_ChannelInterface;
+  ReplyEncoder m_Encoder;
+  /// @brief subscribed endpoints per format, indexed on the ReplyFormat
+  std::array<std::vector<boost::asio::ip::tcp::endpoint>, 2> m_Subscribers;
+};
+}   // namespace moboware::modules
@@ -1,35 +1,151 @@
 #pragma once
 #include "common/channel_interface.h"
+#include "common/timing_wheel.hpp"
+#include "modules/matching_engine_module/i_matching_engine.h"
 #include "modules/matching_engine_module/i_order_handler.h"
+#include "modules/matching_engine_module/journal.h"
+#include "modules/matching_engine_module/market_data_publisher.h"
 #include "modules/matching_engine_module/order_book.h"
+#include "modules/matching_engine_module/reply_encoder.h"
+#include "modules/matching_engine_module/snapshot.h"
+#include "modules/matching_engine_module/symbol_table.h"
 #include <map>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 namespace moboware::modules {
 
-class MatchingEngine {
+/// @brief Matching engine of one instrument.
+/// The matching engine is not thread safe, it has a single writer: the engine thread of the instrument or the module handler
+/// that holds the instrument lock.
+/// After every order entry event the changed price levels and the trades are published as market data to the sessions that
+/// subscribed to the instrument.
+/// A resting order with an order duration is good till date, it is cancelled when it expires. The expiries are kept in a
+/// hierarchical timing wheel that is turned by ExpireOrders, the expired orders are removed in batches per price level.
+/// The resting orders are kept in order lists per account and per session, a mass cancel only visits the orders it cancels.
+/// With self trade prevention an order never trades with a resting order of the same account. The accounts are compared on
+/// their interned handles in the match walk, an integer compare per fill. A cancelled order gets a cancel reply.
+/// With a journal every input that changes the order book is appended to the journal before it is executed. The inputs are
+/// numbered by the input sequence of the engine, a snapshot of the order books has the sequence of its last input, so the order
+/// books are rebuilt from the latest snapshot and a replay of the journal records after it.
+/// After the first snapshot the engine tracks the price levels that change, a next snapshot only copies the changed levels and
+/// shares the unchanged levels with the previous snapshot. The file is written from the copy by the snapshot writer thread.
+/// @tparam TOrderBidBook, order book type of the bid side
+/// The price ladder order books cover the price range of the price ladder config, the std::map order books ignore it.
+/// @tparam TOrderAskBook, order book type of the ask side
+template <typename TOrderBidBook, typename TOrderAskBook> class BasicMatchingEngine : public IMatchingEngine {
 public:
-  explicit MatchingEngine(const std::shared_ptr<common::ChannelInterface> &channelInterface);
-  MatchingEngine(const MatchingEngine &) = delete;
-  MatchingEngine(MatchingEngine &&) = delete;
-  MatchingEngine &operator=(const MatchingEngine &) = delete;
-  MatchingEngine &operator=(MatchingEngine &&) = delete;
-  virtual ~MatchingEngine() = default;
+  explicit BasicMatchingEngine(const std::shared_ptr<common::ChannelInterface> &channelInterface,
+                               const std::string &instrument = {},
+                               const PriceLadderConfig &priceLadderConfig = {});
+  BasicMatchingEngine(const BasicMatchingEngine &) = delete;
+  BasicMatchingEngine(BasicMatchingEngine &&) = delete;
+  BasicMatchingEngine &operator=(const BasicMatchingEngine &) = delete;
+  BasicMatchingEngine &operator=(BasicMatchingEngine &&) = delete;
+  ~BasicMatchingEngine() override = default;
 
-  void OrderInsert(OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint);
-  void OrderAmend(const OrderAmendData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint);
-  void OrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint);
+  void OrderInsert(OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint) override;
+  void OrderAmend(const OrderAmendData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint) override;
+  void OrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint) override;
 
-  [[nodiscard]] const OrderBidBook_t &GetBidOrderBook() const
+  /// @brief Cancel the resting orders in the scope of the mass cancel, a cancel reply is sent to the session of every cancelled
+  /// order. The instrument scope is the instrument of the matching engine. The sender of the mass cancel gets a reply with the
+  /// instrument as id and the client id of the mass cancel, also when no order is cancelled.
+  void OrderMassCancel(const OrderMassCancelData &orderMassCancel, const boost::asio::ip::tcp::endpoint &endpoint) override;
+
+  /// @brief Cancel the resting orders of a closed session, no replies are sent
+  void CancelSessionOrders(const boost::asio::ip::tcp::endpoint &endpoint) override;
+
+  /// @brief Set the journal of the inputs, nullptr disables the journaling. The journal has to outlive the matching engine.
+  void SetJournal(Journal *journal) noexcept override
+  {
+    m_Journal = journal;
+  }
+
+  /// @brief Set the self trade prevention, a replay of the journal needs the self trade prevention of the live engine
+  void SetSelfTradePrevention(const SelfTradePrevention selfTradePrevention) noexcept override
+  {
+    m_SelfTradePrevention = selfTradePrevention;
+  }
+
+  [[nodiscard]] auto GetSelfTradePrevention() const noexcept -> SelfTradePrevention
+  {
+    return m_SelfTradePrevention;
+  }
+
+  /// @brief sequence of the last input that changed the order books, 0 when there is no input yet
+  [[nodiscard]] auto GetInputSequence() const noexcept -> std::uint64_t override
+  {
+    return m_InputSequence;
+  }
+
+  /// @brief Set the channel of the replies, a replay sends the replies to its own channel. The market data keeps the channel of
+  /// the construction.
+  void SetChannelInterface(const std::shared_ptr<common::ChannelInterface> &channelInterface) noexcept override
+  {
+    m_ChannelInterface = channelInterface;
+  }
+
+  /// @brief Move the expiry wheel to the time when it has no expiries, a replay runs the expiries at the times of the journal
+  /// @return false when the wheel has expiries, the time is not changed
+  bool SetExpiryTime(const OrderTime_t time) noexcept override
+  {
+    return m_ExpiryWheel.Reset(ToExpiryTick(time));
+  }
+
+  /// @brief Capture the order books for a snapshot. The first capture copies all price levels and starts the tracking of the
+  /// changed levels, the next captures only copy the levels that changed since the previous capture.
+  [[nodiscard]] auto CaptureSnapshot() -> snapshot::SnapshotImage override;
+
+  /// @brief Write a snapshot of the order books into the directory, on the calling thread
+  /// @return false when the snapshot can not be written, the error is logged
+  [[nodiscard]] bool WriteSnapshot(const std::string &directory) override;
+
+  /// @brief Load a snapshot into the empty order books, the sessions, the order ids, the input sequence and the expiries are
+  /// restored
+  /// @return false when the file is not a snapshot of the instrument or the order books are not empty, the error is logged
+  [[nodiscard]] bool LoadSnapshot(const std::string &path) override;
+
+  [[nodiscard]] const TOrderBidBook &GetBidOrderBook() const
   {
     return m_Bids;
   }
 
-  [[nodiscard]] const OrderAskBook_t &GetAskOrderBook() const
+  [[nodiscard]] const TOrderAskBook &GetAskOrderBook() const
   {
     return m_Asks;
   }
 
-  void GetOrderBook(const boost::asio::ip::tcp::endpoint &endpoint);
+  /// @brief Send a snapshot of the order book, a level update per price level, to the session
+  void GetOrderBook(const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) override;
+
+  /// @brief Subscribe the session to the market data of the instrument, the session receives a snapshot of the order book followed
+  /// by the incremental updates
+  void SubscribeMarketData(const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) override;
+  void UnsubscribeMarketData(const boost::asio::ip::tcp::endpoint &endpoint) override;
+
+  [[nodiscard]] const MarketDataPublisher &GetMarketDataPublisher() const
+  {
+    return m_MarketDataPublisher;
+  }
+
+  /// @brief Cancel the good till date orders that are expired at the time, a cancel reply is sent to the session of every
+  /// expired order
+  void ExpireOrders(const OrderTime_t now) override;
+
+  /// @brief number of good till date orders in the expiry wheel, including the orders that are traded or cancelled before
+  /// their expiry
+  [[nodiscard]] auto GetNumberOfExpiries() const noexcept -> std::size_t
+  {
+    return m_ExpiryWheel.GetSize();
+  }
+
+  /// @brief number of sessions with a handle, the handle of a session without resting orders is recycled
+  [[nodiscard]] auto GetNumberOfSessions() const noexcept -> std::size_t
+  {
+    return m_SessionHandles.size();
+  }
 
 protected:
   virtual void CreateAndSendMessage(const OrderReply &orderInsertReply, const boost::asio::ip::tcp::endpoint &endpoint);
@@ -37,14 +153,154 @@ protected:
   virtual void CreateAndSendMessage(const Trade &trade, const boost::asio::ip::tcp::endpoint &endpoint);
 
 private:
-  template <typename TOrderBook1, typename TOrderBook2>
-  void ExecuteOrder(TOrderBook1 &orderBook, TOrderBook2 &otherSideOrderBook, const boost::asio::ip::tcp::endpoint &endpoint);
+  /// @brief Evaluate the order type and match the new order against the other side, before the left volume is inserted in the
+  /// order book. A market, IOC or FOK order never rests in the order book, the left volume of a market or IOC order gets a cancel
+  /// reply. A post only order never trades, a stop order is rejected.
+  template <typename TOppositeOrderBook, typename TOrderBook>
+  void InsertOrder(TOppositeOrderBook &oppositeSideOrderBook,
+                   TOrderBook &mySideOrderBook,
+                   const Order &order,
+                   const OrderInsertData &orderInsert,
+                   const boost::asio::ip::tcp::endpoint &endpoint);
+
+  /// @brief volume of the other side the order can trade with, counted up to the volume of the order
+  template <typename TOppositeOrderBook>
+  [[nodiscard]] auto GetMatchVolume(const TOppositeOrderBook &oppositeSideOrderBook, const Order &order) const -> VolumeType_t;
+  /// @brief volume of the other side the order can trade with before it meets a resting order of its own account, counted up to
+  /// the volume of the order. The orders of the levels are visited, only used for a fill or kill order with self trade prevention.
+  template <typename TOppositeOrderBook>
+  [[nodiscard]] auto GetMatchVolumeBeforeSelfTrade(const TOppositeOrderBook &oppositeSideOrderBook, const Order &order) const
+    -> VolumeType_t;
+
+  /// @brief trade the new order with the best levels of the other side
+  /// @return left volume of the order
+  template <typename TOppositeOrderBook>
+  [[nodiscard]] auto MatchOrder(TOppositeOrderBook &oppositeSideOrderBook,
+                                const Order &order,
+                                const OrderInsertData &orderInsert,
+                                const boost::asio::ip::tcp::endpoint &endpoint) -> VolumeType_t;
+
+  [[nodiscard]] static inline bool IsMatchPrice(const Order &order, const PriceType_t bestPrice) noexcept
+  {
+    return order.GetType() == OrderType::Market or   // a market order trades at any price
+           (order.GetIsBuySide() ? order.GetPrice() >= bestPrice : bestPrice >= order.GetPrice());
+  }
+
+  /// @brief send the trade of a resting order to the session of the order, in the reply format of that session
+  void SendTrade(const OrderNode &node, const VolumeType_t tradedVolume);
+
+  /// @brief match the best orders of both sides after a resting order is amended, the trades are sent to the sessions of the
+  /// resting orders
+  template <typename TOrderBook1, typename TOrderBook2> void ExecuteOrder(TOrderBook1 &orderBook, TOrderBook2 &otherSideOrderBook);
+
+  /// @brief remove volume from the top order of the best level without a trade, an order without volume is removed from the
+  /// book and its session gets a cancel reply
+  template <typename TOrderBook> void ReduceTopOrder(TOrderBook &orderBook, const VolumeType_t volume);
+  /// @brief send a cancel reply to the session of a resting order, in the reply format of that session
+  void SendCancelReply(const OrderNode &node);
 
-  std::recursive_mutex m_Mutex;
+  /// @brief Get the handle of the session of the endpoint, the session is added on its first resting order. A new session reuses
+  /// the handle of a session without resting orders, the idle sessions are released before the session table grows.
+  /// @param endpoint
+  /// @param format, reply format of the last order entry message of the session
+  [[nodiscard]] auto GetSessionHandle(const boost::asio::ip::tcp::endpoint &endpoint, const ReplyFormat format) -> SessionHandle_t;
+  [[nodiscard]] auto FindSessionHandle(const boost::asio::ip::tcp::endpoint &endpoint) const -> std::optional<SessionHandle_t>;
+  /// @brief the session has no resting orders on either side
+  [[nodiscard]] bool IsIdleSession(const SessionHandle_t session) const;
+  /// @brief remove the endpoint of the session, the handle is reused by the next new session
+  void ReleaseSession(const SessionHandle_t session);
+  /// @brief release the sessions that have no resting orders left
+  void ReleaseIdleSessions();
 
-  const std::shared_ptr<common::ChannelInterface> m_ChannelInterface;
+  /// @brief add a resting good till date order to the expiry wheel
+  void AddExpiry(const OrderNode &node, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint);
 
-  OrderBidBook_t m_Bids;   // the order bids are descending sorted
-  OrderAskBook_t m_Asks;   // the asks are ascending sorted
+  /// @brief remember a changed price level for the market data of the event when there are subscribers, and for the next
+  /// snapshot when the changed levels are tracked
+  void SetLevelChanged(const bool isBuySide, const PriceType_t price);
+  /// @brief side of the resting order with the id, the side of the message when no order has the id. The order ids are unique per
+  /// matching engine, an amend or cancel with the wrong side acts on the order on the other side.
+  [[nodiscard]] bool GetOrderSide(const bool isBuySide, const Id_t &id) const;
+  /// @brief a resting order of either side has the id
+  [[nodiscard]] bool IsRestingOrderId(const Id_t &id) const;
+  /// @brief price of a resting order before it is changed, only looked up when the changed levels are needed
+  [[nodiscard]] auto GetRestingPrice(const bool isBuySide, const Id_t &id) const -> PriceType_t;
+  /// @brief publish the price levels that are changed by the event
+  void PublishChangedLevels();
+  [[nodiscard]] auto GetLevelUpdate(const bool isBuySide, const PriceType_t price) const -> LevelUpdate;
+  [[nodiscard]] auto ToLevelUpdate(const bool isBuySide, const PriceType_t price, const OrderLevel &orderLevel) const -> LevelUpdate;
+
+  /// @brief copy the orders of the level for a snapshot
+  [[nodiscard]] auto ToSnapshotLevel(const OrderLevel &orderLevel, bool &isTruncated) const -> snapshot::SnapshotLevel_t;
+  /// @brief copy the changed level of the order book into the captured levels, a removed level is removed
+  template <typename TOrderBook>
+  void CaptureSnapshotLevel(const TOrderBook &orderBook,
+                            std::map<PriceType_t, snapshot::SnapshotLevel_t> &snapshotLevels,
+                            const PriceType_t price,
+                            bool &isTruncated) const;
+  /// @brief stop the tracking of the changed levels, the next capture copies all levels
+  void ResetSnapshotLevels();
+
+  std::shared_ptr<common::ChannelInterface> m_ChannelInterface;
+  const std::string m_Instrument;
+  /// @brief reused output buffer of the replies, the replies are written synchronously so one buffer serves all sessions. The
+  /// format is set by every order entry message to the format of the session of that message.
+  ReplyEncoder m_ReplyEncoder;
+  Journal *m_Journal{};
+  std::uint64_t m_InputSequence{};
+  SelfTradePrevention m_SelfTradePrevention{SelfTradePrevention::None};
+
+  SymbolTable m_SymbolTable;   // interned accounts and instruments of the resting orders
+
+  /// @brief session that entered resting orders, the replies to the orders that are cancelled by an other session go to it
+  struct Session {
+    boost::asio::ip::tcp::endpoint endpoint;
+    ReplyFormat replyFormat{ReplyFormat::Json};
+    bool isActive{};   // a released handle is not active until it is reused
+  };
+  std::map<boost::asio::ip::tcp::endpoint, SessionHandle_t> m_SessionHandles;
+  std::vector<Session> m_Sessions;                     // handle -> session, handle 0 is no session
+  std::vector<SessionHandle_t> m_FreeSessionHandles;   // released handles, reused before the session table grows
+  OrderId_t m_LastOrderId{};
+
+  TOrderBidBook m_Bids;   // the order bids are descending sorted
+  TOrderAskBook m_Asks;   // the asks are ascending sorted
+
+  /// @brief expiry of a resting good till date order. The node is only the order as long as the order id matches, a traded or
+  /// cancelled order is not removed from the wheel.
+  struct Expiry {
+    const OrderNode *node{};
+    OrderId_t orderId{};
+    ReplyFormat replyFormat{ReplyFormat::Json};
+    boost::asio::ip::tcp::endpoint endpoint;
+  };
+  using ExpiryWheel_t = common::TimingWheel<Expiry>;
+  /// @brief a tick of the expiry wheel
+  using ExpiryTick_t = std::chrono::milliseconds;
+
+  [[nodiscard]] static inline auto ToExpiryTick(const OrderTime_t time) noexcept -> ExpiryWheel_t::Tick_t
+  {
+    return static_cast<ExpiryWheel_t::Tick_t>(std::chrono::duration_cast<ExpiryTick_t>(time.time_since_epoch()).count());
+  }
+
+  ExpiryWheel_t m_ExpiryWheel;
+  std::vector<Expiry> m_ExpiredOrders;              // expired orders of the current turn of the wheel, the capacity is reused
+  std::vector<const OrderNode *> m_ExpiredNodes;    // expired orders of one price level
+
+  MarketDataPublisher m_MarketDataPublisher;
+  /// @brief price levels changed by the current event, side and price, the capacity is reused
+  std::vector<std::pair<bool, PriceType_t>> m_ChangedLevels;
+
+  /// @brief levels of the last captured snapshot per side, the levels that did not change are shared with the next snapshot
+  std::map<PriceType_t, snapshot::SnapshotLevel_t> m_SnapshotBidLevels;
+  std::map<PriceType_t, snapshot::SnapshotLevel_t> m_SnapshotAskLevels;
+  bool m_IsSnapshotTracking{};   // the changed levels are tracked after the first capture
+  /// @brief price levels changed since the last capture, side and price, compacted when the capacity is reached
+  std::vector<std::pair<bool, PriceType_t>> m_SnapshotChangedLevels;
 };
+
+/// @brief matching engine with the std::map order books
+using MatchingEngine = BasicMatchingEngine<OrderBidBook_t, OrderAskBook_t>;
+/// @brief matching engine with the flat tick indexed price ladder order books
+using LadderMatchingEngine = BasicMatchingEngine<OrderBidLadderBook_t, OrderAskLadderBook_t>;
 }   // namespace moboware::modules
\ No newline at end of file
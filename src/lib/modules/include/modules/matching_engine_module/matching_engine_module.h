@@ -3,10 +3,16 @@
 #include "common/imodule.h"
 #include "common/imodule_factory.h"
 #include "common/service.h"
+#include "common/timer.h"
 #include "modules/matching_engine_module/matching_engine.h"
+#include "modules/matching_engine_module/matching_engine_thread.h"
+#include "modules/matching_engine_module/order_event_processor.h"
+#include <mutex>
 
 namespace moboware::modules {
 
+class OrderEntryTcpServer;
+
 class MatchingEngineModule
     : public common::IModule
     , public std::enable_shared_from_this<MatchingEngineModule>
@@ -24,6 +30,7 @@ public:
   bool Start() final;
   void OnWebSocketDataReceived(const boost::beast::flat_buffer &readBuffer,
                                const boost::asio::ip::tcp::endpoint &endpoint) final;
+  void OnWebSocketSessionClosed(const boost::asio::ip::tcp::endpoint &endpoint) final;
 
 private:
   void HandleOrderInsert(OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint) final;
@@ -32,10 +39,92 @@ private:
 
   void HandleOrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint) final;
 
-  void GetOrderBook(const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint) final;
+  void HandleOrderMassCancel(const OrderMassCancelData &orderMassCancel, const boost::asio::ip::tcp::endpoint &endpoint) final;
+
+  void GetOrderBook(const std::string &instrument, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) final;
+
+  void SubscribeMarketData(const std::string &instrument, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint) final;
+
+  void UnsubscribeMarketData(const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint) final;
+
+  /// @brief Execute the command data on the matching engine of the instrument, queued to the engine thread of the instrument or,
+  /// when the instrument has no engine thread, directly under the instrument lock
+  template <typename TCommandData>
+  void Dispatch(const std::string &instrument, TCommandData &&commandData, const boost::asio::ip::tcp::endpoint &endpoint);
+
+  /// @brief Get the engine thread of the cpu, the engine thread is started when it does not exist yet
+  [[nodiscard]] auto GetEngineThread(const int cpu) -> MatchingEngineThread *;
+
+  /// @brief Get the order event processor of the session of the endpoint, created on the first message of the session. The caller
+  /// shares the ownership, the processor outlives its removal from the map when the session is closed in the mean time.
+  [[nodiscard]] auto GetOrderEventProcessor(const boost::asio::ip::tcp::endpoint &endpoint) -> std::shared_ptr<OrderEventProcessor>;
+
+  /// @brief channel of the replies and the market data of the matching engines, the order entry tcp server when it is configured
+  [[nodiscard]] auto GetReplyChannel() const -> std::shared_ptr<common::ChannelInterface>;
+
+  /// @brief Log the load statistics of the engine threads of the last interval
+  void PublishLoadStats();
+
+  /// @brief Queue the expiry of the good till date orders to all matching engines
+  void ExpireOrders();
+
+  /// @brief Queue a snapshot of the order books to all matching engines
+  void WriteSnapshots();
+
+  /// @brief Load the optional journal config, recover the order books and open the journal of the matching engines
+  [[nodiscard]] bool LoadJournalConfig(const boost::json::value &journalValue);
+
+  /// @brief Rebuild the order books from the latest snapshot of every instrument and a replay of the journal records after it.
+  /// The replies of the replay are not sent, a fresh snapshot is written when records are replayed.
+  /// @return sequence of the last journal record, no value when the journal or a snapshot can not be read
+  [[nodiscard]] auto RecoverOrderBooks(const std::string &journalDirectory, const std::string &snapshotDirectory)
+    -> std::optional<std::uint64_t>;
+
+  struct InstrumentEngine {
+    std::shared_ptr<IMatchingEngine> matchingEngine;
+    /// @brief single writer thread of the matching engine, nullptr when the handlers execute on the calling thread
+    MatchingEngineThread *engineThread{};
+    /// @brief serializes the handlers of the io threads when there is no engine thread
+    std::mutex mutex;
+  };
+
+  /// @brief journal of the inputs of the matching engines, nullptr when journaling is disabled. Declared before the matching
+  /// engines, the journal writer is stopped after the matching engines are destroyed.
+  std::unique_ptr<Journal> m_Journal;
+  /// @brief writer of the periodic snapshots, nullptr when there are no periodic snapshots. Declared before the matching engines,
+  /// the queued snapshots are written after the engine threads are stopped.
+  std::unique_ptr<snapshot::SnapshotWriter> m_SnapshotWriter;
 
   /// @brief map of matching engines per instrument
-  std::map<std::string, std::shared_ptr<MatchingEngine>> m_MatchingEngines;
+  std::map<std::string, InstrumentEngine> m_MatchingEngines;
+  /// @brief engine threads per cpu, the instruments that are configured on the same cpu share the engine thread.
+  /// Declared after the matching engines, the engine threads are stopped before the matching engines are destroyed.
+  std::map<int, std::unique_ptr<MatchingEngineThread>> m_MatchingEngineThreads;
+
+  /// @brief order event processor per web socket session, a processor is only used on the strand of its session, the lock
+  /// protects the map against the io threads of the other sessions
+  std::mutex m_OrderEventProcessorsMutex;
+  std::map<boost::asio::ip::tcp::endpoint, std::shared_ptr<OrderEventProcessor>> m_OrderEventProcessors;
+
+  common::Timer m_LoadStatsTimer;
+  std::chrono::seconds m_LoadStatsInterval{};   // 0 disables the load statistics
+  std::map<int, MatchingEngineThread::LoadStats> m_LastLoadStats;
+
+  /// @brief turns the expiry wheels of the matching engines
+  common::Timer m_ExpiryTimer;
+  std::chrono::milliseconds m_ExpiryInterval{10};
+
+  /// @brief captures the periodic snapshots of the matching engines
+  common::Timer m_SnapshotTimer;
+  std::chrono::seconds m_SnapshotInterval{};   // 0 disables the periodic snapshots
+
+  /// @brief cancel the resting orders of a session when the session is closed
+  bool m_CancelOnDisconnect{true};
+
+  /// @brief optional raw tcp transport of the binary order entry protocol, nullptr when it is not configured
+  std::shared_ptr<OrderEntryTcpServer> m_OrderEntryTcpServer;
+  std::string m_OrderEntryTcpAddress;
+  std::uint16_t m_OrderEntryTcpPort{};
 };
 
 class MatchingEngineModuleFactory : public common::IModuleFactory {
@@ -0,0 +1,149 @@
+#pragma once
+#include "common/mpsc_ring_buffer.hpp"
+#include "modules/matching_engine_module/matching_engine.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <variant>
+
+namespace moboware::modules {
+
+/// @brief request for the order book of the instrument of a matching engine
+struct GetOrderBookRequest {
+  ReplyFormat replyFormat{ReplyFormat::Json};
+};
+
+/// @brief subscribe a session to the market data of the instrument of a matching engine
+struct SubscribeRequest {
+  ReplyFormat replyFormat{ReplyFormat::Json};
+};
+
+struct UnsubscribeRequest {};
+
+/// @brief cancel the good till date orders of a matching engine that are expired at the time
+struct ExpireOrdersRequest {
+  OrderTime_t now{};
+};
+
+/// @brief cancel the resting orders of a closed session
+struct CancelSessionOrdersRequest {};
+
+/// @brief capture a snapshot of the order books of a matching engine, the snapshot file is written by the snapshot writer
+struct WriteSnapshotRequest {
+  snapshot::SnapshotWriter *snapshotWriter{};
+};
+
+/// @brief command for a matching engine, queued from the module handlers to the engine thread that owns the matching engine
+struct MatchingEngineCommand {
+  using Data_t = std::variant<OrderInsertData,
+                              OrderAmendData,
+                              OrderCancelData,
+                              OrderMassCancelData,
+                              GetOrderBookRequest,
+                              SubscribeRequest,
+                              UnsubscribeRequest,
+                              ExpireOrdersRequest,
+                              CancelSessionOrdersRequest,
+                              WriteSnapshotRequest>;
+
+  IMatchingEngine *matchingEngine{};
+  Data_t data;
+  boost::asio::ip::tcp::endpoint endpoint;
+};
+
+/// @brief Thread pinned to one cpu core that is the single writer of the matching engines that are assigned to it.
+/// The module handlers push the commands into a MPSC command ring buffer, the engine thread executes the commands in the order
+/// of the ring buffer, so the matching engines need no locks.
+/// When the command queue stays empty the thread spins for a while before it goes to sleep on an atomic wait, the producers
+/// only wake up the thread when it is sleeping.
+class MatchingEngineThread {
+public:
+  static constexpr std::size_t CommandQueueLength{4 * 1024};
+  using CommandQueue_t = common::MpscRingBuffer<MatchingEngineCommand, CommandQueueLength>;
+
+  /// @brief load statistics of the engine thread, the counters are totals since the start of the thread
+  struct LoadStats {
+    std::uint64_t executedCommands{};
+    std::chrono::nanoseconds busyTime{};   // time spend on executing commands
+    std::uint64_t queueFullCount{};        // number of times a producer had to wait for space in the command queue
+  };
+
+  /// @brief start the engine thread
+  /// @param cpu, core to pin the thread on
+  explicit MatchingEngineThread(const int cpu);
+  MatchingEngineThread(const MatchingEngineThread &) = delete;
+  MatchingEngineThread(MatchingEngineThread &&) = delete;
+  MatchingEngineThread &operator=(const MatchingEngineThread &) = delete;
+  MatchingEngineThread &operator=(MatchingEngineThread &&) = delete;
+  /// @brief stops and joins the engine thread, commands that are still in the queue are not executed
+  ~MatchingEngineThread();
+
+  /// @brief Queue a command for a matching engine, can be called from multiple threads. When the command queue is full the
+  /// calling thread waits until there is space.
+  template <typename TCommandData>
+  void Post(IMatchingEngine &matchingEngine, TCommandData &&commandData, const boost::asio::ip::tcp::endpoint &endpoint);
+
+  [[nodiscard]] int GetCpu() const noexcept
+  {
+    return m_Cpu;
+  }
+
+  /// @brief Get the load statistics, can be called from any thread
+  [[nodiscard]] LoadStats GetLoadStats() const noexcept;
+
+  /// @brief Execute the command data on the matching engine, is called on the engine thread or on the calling thread when an
+  /// instrument has no engine thread
+  static void Execute(IMatchingEngine &matchingEngine, OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine, const OrderAmendData &orderAmend, const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine, const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine,
+                      const OrderMassCancelData &orderMassCancel,
+                      const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine, const GetOrderBookRequest &getOrderBook, const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine, const SubscribeRequest &subscribe, const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine, const UnsubscribeRequest &, const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine, const ExpireOrdersRequest &expireOrders, const boost::asio::ip::tcp::endpoint &);
+  static void Execute(IMatchingEngine &matchingEngine, const CancelSessionOrdersRequest &, const boost::asio::ip::tcp::endpoint &endpoint);
+  static void Execute(IMatchingEngine &matchingEngine, const WriteSnapshotRequest &writeSnapshot, const boost::asio::ip::tcp::endpoint &);
+
+private:
+  /// @brief number of empty polls of the command queue before the thread goes to sleep
+  static constexpr std::uint32_t MaxIdleSpins{100'000};
+
+  void Run(const std::stop_token &stopToken);
+  void WakeUp();
+
+  const int m_Cpu{};
+  CommandQueue_t m_CommandQueue;
+  std::atomic<bool> m_IsSleeping{false};
+
+  // load statistics, the engine thread is the only writer of the executed commands and the busy time
+  std::atomic<std::uint64_t> m_ExecutedCommands{};
+  std::atomic<std::int64_t> m_BusyTime{};
+  std::atomic<std::uint64_t> m_QueueFullCount{};
+
+  std::jthread m_Thread;   // started last in the constructor, all other members are initialized
+};
+
+template <typename TCommandData>
+void MatchingEngineThread::Post(IMatchingEngine &matchingEngine, TCommandData &&commandData, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  bool isQueueFull{false};
+  while (not m_CommandQueue.Push(&matchingEngine, std::forward<TCommandData>(commandData), endpoint)) {
+    // the engine thread can not keep up, back off this producer until there is space in the queue
+    if (not isQueueFull) {
+      isQueueFull = true;
+      m_QueueFullCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    WakeUp();
+    std::this_thread::yield();
+  }
+
+  // the push has to be visible before the sleeping state is read, the engine thread has the same fence between setting the
+  // sleeping state and the last empty check of the queue
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_IsSleeping.load(std::memory_order_relaxed)) {
+    WakeUp();
+  }
+}
+}   // namespace moboware::modules
@@ -0,0 +1,151 @@
+#pragma once
+#include "modules/matching_engine_module/order_data.h"
+#include "modules/matching_engine_module/symbol_table.h"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+namespace moboware::modules {
+
+/// @brief engine assigned order id, unique within a matching engine
+using OrderId_t = std::uint64_t;
+/// @brief engine assigned handle of the session that entered an order
+using SessionHandle_t = std::uint32_t;
+using OrderDuration_t = std::chrono::duration<std::int32_t, std::milli>;
+
+/**
+ * @brief Compact resting order record, trivially copyable and without heap indirections. Account and instrument are handles
+ * of the symbol table of the matching engine. The string ids of the order entry messages are kept outside of this record.
+ */
+class Order final {
+public:
+  Order() = default;
+  explicit Order(const OrderId_t _id,                       //
+                 const PriceType_t _price,                  //
+                 const VolumeType_t _volume,                //
+                 const OrderTime_t _orderTime,              //
+                 const OrderDuration_t _orderDuration,      //
+                 const SymbolHandle_t _account,             //
+                 const SymbolHandle_t _instrument,          //
+                 const OrderType _type,                     //
+                 const bool _isBuySide                      //
+                 )
+    : id(_id)
+    , price(_price)
+    , volume(_volume)
+    , orderTime(_orderTime)
+    , orderDuration(_orderDuration)
+    , account(_account)
+    , instrument(_instrument)
+    , type(_type)
+    , isBuySide(_isBuySide)
+  {
+  }
+
+  [[nodiscard]] inline auto GetId() const noexcept
+  {
+    return id;
+  }
+
+  [[nodiscard]] inline auto GetPrice() const noexcept
+  {
+    return price;
+  }
+
+  inline void SetPrice(const PriceType_t _price) noexcept
+  {
+    price = _price;
+  }
+
+  [[nodiscard]] inline auto GetPriceAsDouble() const noexcept
+  {
+    return static_cast<double>(GetPrice() / std::mega::num);
+  }
+
+  [[nodiscard]] inline auto GetVolume() const noexcept
+  {
+    return volume;
+  }
+
+  inline void SetVolume(const VolumeType_t _volume) noexcept
+  {
+    volume = _volume;
+  }
+
+  [[nodiscard]] inline auto GetOrderTime() const noexcept
+  {
+    return orderTime;
+  }
+
+  [[nodiscard]] inline auto GetOrderDuration() const noexcept
+  {
+    return orderDuration;
+  }
+
+  [[nodiscard]] inline auto GetAccount() const noexcept
+  {
+    return account;
+  }
+
+  [[nodiscard]] inline auto GetInstrument() const noexcept
+  {
+    return instrument;
+  }
+
+  [[nodiscard]] inline auto GetType() const noexcept
+  {
+    return type;
+  }
+
+  [[nodiscard]] inline auto GetIsBuySide() const noexcept
+  {
+    return isBuySide;
+  }
+
+private:
+  OrderId_t id{};
+  /// @brief prices are in 6 places precision
+  PriceType_t price{};
+  VolumeType_t volume{};
+  OrderTime_t orderTime{};
+  OrderDuration_t orderDuration{};
+  SymbolHandle_t account{};
+  SymbolHandle_t instrument{};
+  OrderType type{OrderType::Unknown};
+  bool isBuySide{true};
+};
+
+static_assert(std::is_trivially_copyable_v<Order>);
+static_assert(sizeof(Order) <= 48);
+
+/// @brief the order duration of the order entry data fits in the order record, a negative duration or a good till date of more
+/// than 24 days can not be stored
+[[nodiscard]] inline bool IsValidOrderDuration(const std::chrono::milliseconds orderDuration) noexcept
+{
+  return orderDuration.count() >= 0 and orderDuration <= std::chrono::duration_cast<std::chrono::milliseconds>(OrderDuration_t::max());
+}
+
+/// @brief Convert the order entry data into a resting order record, the account and instrument are interned in the symbol table
+/// @param orderData
+/// @param id, engine assigned order id
+/// @param symbolTable
+/// @return order or no value when the order type is not supported
+[[nodiscard]] inline auto ToOrder(const OrderDataBase &orderData, const OrderId_t id, SymbolTable &symbolTable) -> std::optional<Order>
+{
+  const auto type{orderData.GetType()};
+  if (type == OrderType::Unknown) {
+    return std::nullopt;
+  }
+
+  return Order{id,
+               orderData.GetPrice(),
+               orderData.GetVolume(),
+               orderData.GetOrderTime(),
+               std::chrono::duration_cast<OrderDuration_t>(orderData.GetOrderDuration()),
+               symbolTable.Intern(orderData.GetAccount()),
+               symbolTable.Intern(orderData.GetInstrument()),
+               type,
+               orderData.GetIsBuySide()};
+}
+}   // namespace moboware::modules
@@ -1,31 +1,106 @@
 #pragma once
 #include "modules/matching_engine_module/order_level.h"
+#include "modules/matching_engine_module/price_ladder.h"
 #include <functional>
 #include <map>
+#include <memory_resource>
 #include <optional>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 namespace moboware::modules {
 
-template <typename TCompare> class OrderBook {
+/// @brief Order book of one side of the market. The resting orders are indexed on order id, amend and cancel go straight to
+/// the level and the node of the order in the time queue of the level, without a level lookup on price or a queue scan.
+/// Order nodes are taken from the pool of the book, the returned order pointers stay valid while the order is in the book.
+/// The order id index and an allocator aware order book map allocate from a pool resource of the book, so when warmed up
+/// inserting, matching and cancelling orders does not allocate on the heap.
+/// The resting orders are also linked in an intrusive order list per account and per session, so the orders of an account or
+/// a session are mass cancelled in one pass over their own orders, without a scan of the levels.
+/// @tparam TCompare, price priority compare function
+/// @tparam TOrderBookMap, container of the price levels, the default std::pmr::map or the flat tick indexed PriceLadder
+template <typename TCompare, typename TOrderBookMap = std::pmr::map<PriceType_t, OrderLevel, TCompare>> class OrderBook {
 public:
-  OrderBook() = default;
+  OrderBook()
+    : OrderBook(PriceLadderConfig{})
+  {
+  }
+
+  /// @brief order book with the price range of a price ladder, the config is ignored by the std::map order book
+  explicit OrderBook(const PriceLadderConfig &priceLadderConfig)
+    : m_OrderBookMap(CreateOrderBookMap(m_MemoryResource, priceLadderConfig))
+    , m_OrderIndex(&m_MemoryResource)
+    , m_AccountOrders(&m_MemoryResource)
+    , m_SessionOrders(&m_MemoryResource)
+  {
+  }
+
   OrderBook(const OrderBook &) = delete;
   OrderBook(OrderBook &&) = delete;
   OrderBook &operator=(const OrderBook &) = delete;
   OrderBook &operator=(OrderBook &&) = delete;
   ~OrderBook() = default;
 
-  auto Insert(OrderInsertData &&orderInsert) -> const OrderInsertData*;
+  /// @brief Insert an order, order ids must be unique within the book
+  /// @param order
+  /// @param id, order id of the order entry messages
+  /// @param clientId
+  /// @param session, session that entered the order
+  /// @return the inserted order or a nullptr when the insert failed
+  auto Insert(const Order &order, const Id_t &id, const ClientId_t &clientId, const SessionHandle_t session = {}) -> const OrderNode *;
 
   auto Amend(const OrderAmendData &orderAmend) -> bool;
 
   auto Cancel(const OrderCancelData &orderCancel) -> bool;
 
+  /// @brief Remove a batch of resting orders of one price level, the level is looked up and removed at most once for the batch
+  /// @param price, price of the level
+  /// @param nodes, order nodes of the level, a node that is not in the book is skipped
+  /// @return number of removed orders
+  auto RemoveOrders(const PriceType_t price, const std::vector<const OrderNode *> &nodes) -> std::size_t;
+
+  /// @brief Cancel the orders of an account
+  /// @param account
+  /// @param session, when set only the orders of the account that are entered by the session
+  /// @param cancelledFn, called with every cancelled order before it is removed
+  /// @return number of cancelled orders
+  template <typename TCancelledFn>
+  auto CancelAccountOrders(const SymbolHandle_t account, const std::optional<SessionHandle_t> &session, TCancelledFn &&cancelledFn)
+    -> std::size_t
+  {
+    return CancelOwnerOrders(m_AccountOrders, account, &OrderNode::accountLinks, cancelledFn, [&](const OrderNode &node) {
+      return not session or node.session == *session;
+    });
+  }
+
+  /// @brief Cancel the orders that are entered by a session
+  template <typename TCancelledFn> auto CancelSessionOrders(const SessionHandle_t session, TCancelledFn &&cancelledFn) -> std::size_t
+  {
+    return CancelOwnerOrders(m_SessionOrders, session, &OrderNode::sessionLinks, cancelledFn, [](const OrderNode &) { return true; });
+  }
+
+  /// @brief the session has resting orders in the book
+  [[nodiscard]] bool HasSessionOrders(const SessionHandle_t session) const
+  {
+    const auto iter{m_SessionOrders.find(session)};
+    return iter != std::end(m_SessionOrders) and iter->second != nullptr;
+  }
+
+  /// @brief Cancel all orders of the book
+  template <typename TCancelledFn> auto CancelAllOrders(TCancelledFn &&cancelledFn) -> std::size_t;
+
   /// @brief
   /// @param
   void GetBook(const std::function<bool(const OrderLevel &)> &);
 
+  /// @brief Depth of the top of the book, the best price levels in priority order. The levels keep their aggregates, the depth
+  /// is read without a walk over the orders of the levels.
+  /// @param numberOfLevels, maximum number of levels
+  /// @param depthFn, called with the price and the order level of every level
+  template <typename TDepthFn> void GetDepth(const std::size_t numberOfLevels, TDepthFn &&depthFn) const;
+
   /// @brief get the order level at price
   /// @param price
   /// @return order level
@@ -33,7 +108,19 @@ public:
 
   void RemoveLevelAtPrice(const PriceType_t &price);
 
-  using OrderBookMap_t = std::map<PriceType_t, OrderLevel, TCompare>;
+  /// @brief Trade the top order of the best price level, a fully traded order is removed from the book and an empty level
+  /// is removed
+  /// @param volume
+  /// @param tradedFn, called with the traded order node and the traded volume
+  /// @return traded volume
+  template <typename TTradedFn> auto TradeTopLevel(const VolumeType_t volume, TTradedFn &&tradedFn) -> VolumeType_t;
+
+  /// @brief find a resting order on id
+  /// @param orderId
+  /// @return order or a nullptr when the order is not in the book
+  [[nodiscard]] auto FindOrder(const Id_t &orderId) const -> const OrderNode *;
+
+  using OrderBookMap_t = TOrderBookMap;
 
   inline OrderBookMap_t &GetOrderBookMap()
   {
@@ -46,8 +133,144 @@ public:
   }
 
 private:
+  /// @brief location of a resting order, the level address is stable in both the std::map and the price ladder
+  struct OrderLocation {
+    PriceType_t price{};
+    OrderLevel *level{};
+    OrderNode *node{};
+  };
+  /// @brief the key is a view on the id string of the order node, the node outlives its index entry
+  using OrderIndex_t = std::pmr::unordered_map<std::string_view, OrderLocation>;
+
+  [[nodiscard]] static auto CreateOrderBookMap(std::pmr::memory_resource &memoryResource,
+                                                [[maybe_unused]] const PriceLadderConfig &priceLadderConfig) -> OrderBookMap_t
+  {
+    if constexpr (std::is_constructible_v<OrderBookMap_t, const PriceLadderConfig &>) {
+      return OrderBookMap_t(priceLadderConfig);
+    } else if constexpr (std::uses_allocator_v<OrderBookMap_t, std::pmr::polymorphic_allocator<std::byte>>) {
+      return OrderBookMap_t(&memoryResource);
+    } else {
+      return OrderBookMap_t();
+    }
+  }
+
+  /// @brief a level can be created for the price, every price is valid in the std::map order book
+  [[nodiscard]] inline bool IsValidPrice(const PriceType_t price) const noexcept
+  {
+    if constexpr (requires { m_OrderBookMap.IsValidPrice(price); }) {
+      return m_OrderBookMap.IsValidPrice(price);
+    } else {
+      return true;
+    }
+  }
+
+  /// @brief link the node in the level of its price and add it to the index
+  /// @return false when no level could be created for the price, the node is not released
+  [[nodiscard]] auto InsertNode(OrderNode *node) -> bool;
+  void RemoveOrder(const typename OrderIndex_t::iterator &indexIter);
+
+  /// @brief head of the order list per owner, the list of an owner is kept when it is empty
+  using OwnerOrders_t = std::pmr::unordered_map<std::uint32_t, OrderNode *>;
+
+  static void LinkOwner(OwnerOrders_t &ownerOrders, const std::uint32_t owner, OrderNode *node, OrderLinks OrderNode::*links);
+  static void UnlinkOwner(OwnerOrders_t &ownerOrders, const std::uint32_t owner, OrderNode *node, OrderLinks OrderNode::*links);
+
+  /// @brief unlink the node from the owner lists and return it to the pool, the node is not in the levels and the index
+  void ReleaseNode(OrderNode *node);
+
+  /// @brief cancel the matching orders of the order list of an owner, in one pass over the list
+  template <typename TCancelledFn, typename TMatchFn>
+  auto CancelOwnerOrders(OwnerOrders_t &ownerOrders,
+                         const std::uint32_t owner,
+                         OrderLinks OrderNode::*links,
+                         TCancelledFn &cancelledFn,
+                         TMatchFn &&matchFn) -> std::size_t;
+
+  std::pmr::unsynchronized_pool_resource m_MemoryResource;
+  OrderNodePool m_OrderNodePool;
   OrderBookMap_t m_OrderBookMap;
+  OrderIndex_t m_OrderIndex;         // order id -> location of the order in the book
+  OwnerOrders_t m_AccountOrders;     // account -> orders of the account
+  OwnerOrders_t m_SessionOrders;     // session -> orders of the session
 };
+
+template <typename TCompare, typename TOrderBookMap>
+template <typename TCancelledFn, typename TMatchFn>
+auto OrderBook<TCompare, TOrderBookMap>::CancelOwnerOrders(OwnerOrders_t &ownerOrders,
+                                                           const std::uint32_t owner,
+                                                           OrderLinks OrderNode::*links,
+                                                           TCancelledFn &cancelledFn,
+                                                           TMatchFn &&matchFn) -> std::size_t
+{
+  const auto ownerIter{ownerOrders.find(owner)};
+  if (ownerIter == std::end(ownerOrders)) {
+    return 0;
+  }
+
+  std::size_t cancelledOrders{};
+  for (auto *node{ownerIter->second}; node != nullptr;) {
+    // the node is unlinked from the list when it is removed
+    auto *const next{(node->*links).next};
+    if (matchFn(*node)) {
+      cancelledFn(static_cast<const OrderNode &>(*node));
+      RemoveOrder(m_OrderIndex.find(node->id));
+      cancelledOrders++;
+    }
+    node = next;
+  }
+  return cancelledOrders;
+}
+
+template <typename TCompare, typename TOrderBookMap>
+template <typename TCancelledFn>
+auto OrderBook<TCompare, TOrderBookMap>::CancelAllOrders(TCancelledFn &&cancelledFn) -> std::size_t
+{
+  const auto releaseFn{[&](OrderNode *node) {
+    cancelledFn(static_cast<const OrderNode &>(*node));
+    m_OrderIndex.erase(node->id);
+    ReleaseNode(node);
+  }};
+
+  std::size_t cancelledOrders{m_OrderIndex.size()};
+  while (not m_OrderBookMap.empty()) {
+    const auto iter{std::begin(m_OrderBookMap)};
+    iter->second.Clear(releaseFn);
+    m_OrderBookMap.erase(iter);
+  }
+  return cancelledOrders;
+}
+
+template <typename TCompare, typename TOrderBookMap>
+template <typename TDepthFn>
+void OrderBook<TCompare, TOrderBookMap>::GetDepth(const std::size_t numberOfLevels, TDepthFn &&depthFn) const
+{
+  std::size_t level{};
+  for (auto iter{std::begin(m_OrderBookMap)}; iter != std::end(m_OrderBookMap) and level < numberOfLevels; ++iter, level++) {
+    depthFn(iter->first, iter->second);
+  }
+}
+
+template <typename TCompare, typename TOrderBookMap>
+template <typename TTradedFn>
+auto OrderBook<TCompare, TOrderBookMap>::TradeTopLevel(const VolumeType_t volume, TTradedFn &&tradedFn) -> VolumeType_t
+{
+  const auto iter{std::begin(m_OrderBookMap)};
+  if (iter == std::end(m_OrderBookMap)) {
+    return {};
+  }
+
+  auto &orderPriceLevel{iter->second};
+  const auto filledFn{[this](OrderNode *node) {
+    m_OrderIndex.erase(node->id);
+    ReleaseNode(node);
+  }};
+
+  const auto tradedVolume{orderPriceLevel.TradeTopLevel(volume, std::forward<TTradedFn>(tradedFn), filledFn)};
+  if (orderPriceLevel.IsEmpty()) {
+    m_OrderBookMap.erase(iter);
+  }
+  return tradedVolume;
+}
 }   // namespace moboware::modules
 
 using OrderBidBook_t = moboware::modules::OrderBook<std::greater<uint64_t /*price*/>>;
@@ -55,3 +278,13 @@ template class moboware::modules::OrderBook<std::greater<uint64_t /*price*/>>;
 
 using OrderAskBook_t = moboware::modules::OrderBook<std::less<uint64_t /*price*/>>;
 template class moboware::modules::OrderBook<std::less<uint64_t /*price*/>>;
+
+// order books with a flat tick indexed price ladder instead of the std::map
+using OrderBidLadderBook_t =
+  moboware::modules::OrderBook<std::greater<uint64_t /*price*/>, moboware::modules::PriceLadder<std::greater<uint64_t /*price*/>>>;
+template class moboware::modules::OrderBook<std::greater<uint64_t /*price*/>,
+                                            moboware::modules::PriceLadder<std::greater<uint64_t /*price*/>>>;
+
+using OrderAskLadderBook_t =
+  moboware::modules::OrderBook<std::less<uint64_t /*price*/>, moboware::modules::PriceLadder<std::less<uint64_t /*price*/>>>;
+template class moboware::modules::OrderBook<std::less<uint64_t /*price*/>, moboware::modules::PriceLadder<std::less<uint64_t /*price*/>>>;
@@ -1,20 +1,83 @@
 #pragma once
 #include <boost/json.hpp>
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <fmt/ostream.h>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 namespace moboware::modules {
 
 using PriceType_t = std::uint64_t;
 using VolumeType_t = std::uint64_t;
 using OrderTime_t = std::chrono::time_point<std::chrono::high_resolution_clock>;
+
+/// @brief encoding of the replies to an order entry message, the replies use the protocol of the order entry message
+enum class ReplyFormat : std::uint8_t {
+  Json,
+  Binary
+};
 using Id_t = std::string;
 using ClientId_t = std::string;
 
+/// @brief order type, parsed once from the order entry message. The types after Stop are evaluated before the order is inserted
+/// in the order book, only the left volume of a limit order rests in the book.
+enum class OrderType : std::uint8_t {
+  Unknown = 0,
+  Limit,
+  Market,              // trades at any price, the left volume is cancelled
+  Stop,
+  ImmediateOrCancel,   // trades up to the limit price, the left volume is cancelled
+  FillOrKill,          // trades the full volume up to the limit price or is rejected
+  PostOnly             // rests in the book without trading or is rejected
+};
+
+/// @brief Convert the order type of the order entry message into the enum
+/// @param type
+/// @return order type, Unknown when the type is not supported
+[[nodiscard]] inline auto ToOrderType(const std::string_view type) noexcept -> OrderType
+{
+  if (type == "Limit") {
+    return OrderType::Limit;
+  } else if (type == "Market") {
+    return OrderType::Market;
+  } else if (type == "Stop") {
+    return OrderType::Stop;
+  } else if (type == "IOC") {
+    return OrderType::ImmediateOrCancel;
+  } else if (type == "FOK") {
+    return OrderType::FillOrKill;
+  } else if (type == "PostOnly") {
+    return OrderType::PostOnly;
+  }
+  return OrderType::Unknown;
+}
+
+[[nodiscard]] inline auto ToString(const OrderType type) noexcept -> std::string_view
+{
+  switch (type) {
+  case OrderType::Limit:
+    return "Limit";
+  case OrderType::Market:
+    return "Market";
+  case OrderType::Stop:
+    return "Stop";
+  case OrderType::ImmediateOrCancel:
+    return "IOC";
+  case OrderType::FillOrKill:
+    return "FOK";
+  case OrderType::PostOnly:
+    return "PostOnly";
+  case OrderType::Unknown:
+    break;
+  }
+  return "Unknown";
+}
+
+
 namespace Fields {
 static const std::string Action{"Action"};
 static const std::string Data{"Data"};
@@ -40,6 +103,14 @@ static const std::string Time{"Time"};
 static const std::string Side{"Side"};
 static const std::string OrderReply{"OrderReply"};
 static const std::string ErrorReply{"ErrorReply"};
+static const std::string Subscribe{"Subscribe"};
+static const std::string Unsubscribe{"Unsubscribe"};
+static const std::string LevelUpdate{"LevelUpdate"};
+static const std::string PublicTrade{"PublicTrade"};
+static const std::string OrderCount{"OrderCount"};
+static const std::string MassCancel{"MassCancel"};
+static const std::string Session{"Session"};
+static const std::string Scope{"Scope"};
 
 }   // namespace Fields
 
@@ -54,7 +125,7 @@ public:
                          const std::string &_instrument,                    //
                          const PriceType_t &_price,                         //
                          const VolumeType_t &_volume,                       //
-                         const std::string &_type,                          //
+                         const OrderType _type,                             //
                          const bool _isBuySide,                             //
                          const OrderTime_t &_orderTime,                     //
                          const std::chrono::milliseconds &_orderDuration,   //
@@ -111,16 +182,22 @@ public:
     volume = _volume;
   }
 
-  [[nodiscard]] inline const auto &GetType() const noexcept
+  [[nodiscard]] inline auto GetType() const noexcept
   {
     return type;
   }
 
-  inline void SetType(const std::string &_type) noexcept
+  inline void SetType(const OrderType _type) noexcept
   {
     type = _type;
   }
 
+  /// @brief parse the order type of the order entry message
+  inline void SetType(const std::string_view _type) noexcept
+  {
+    type = ToOrderType(_type);
+  }
+
   [[nodiscard]] inline auto GetIsBuySide() const noexcept
   {
     return isBuySide;
@@ -171,6 +248,16 @@ public:
     clientId = _clientId;
   }
 
+  [[nodiscard]] inline auto GetReplyFormat() const noexcept
+  {
+    return replyFormat;
+  }
+
+  inline void SetReplyFormat(const ReplyFormat _replyFormat) noexcept
+  {
+    replyFormat = _replyFormat;
+  }
+
 private:
   /// @brief user account the order is traded on
   std::string account{};
@@ -181,7 +268,7 @@ private:
   /// @brief volume of the order
   VolumeType_t volume{};
   /// @brief order type, like: Limit, Stop, Market, etc...
-  std::string type{};
+  OrderType type{OrderType::Unknown};
   /// @brief buy or sell order
   bool isBuySide{true};
   /// @brief creation time of the order
@@ -192,6 +279,8 @@ private:
   Id_t id{};
   /// @brief order id assigned by the client
   ClientId_t clientId{};
+  /// @brief encoding of the replies to the order
+  ReplyFormat replyFormat{ReplyFormat::Json};
 };
 
 /**
@@ -204,7 +293,7 @@ public:
                            const std::string &_instrument,                    //
                            const PriceType_t &_price,                         //
                            const VolumeType_t &_volume,                       //
-                           const std::string &_type,                          //
+                           const OrderType _type,                             //
                            const bool _isBuySide,                             //
                            const OrderTime_t &_orderTime,                     //
                            const std::chrono::milliseconds &_orderDuration,   //
@@ -222,7 +311,7 @@ public:
                           const PriceType_t &_newPrice,                      //
                           const VolumeType_t &_volume,                       //
                           const VolumeType_t &_newVolume,                    //
-                          const std::string &_type,                          //
+                          const OrderType _type,                             //
                           const bool _isBuySide,                             //
                           const OrderTime_t &_orderTime,                     //
                           const std::chrono::milliseconds &_orderDuration,   //
@@ -262,13 +351,14 @@ private:
 };
 
 /**
- * @brief Order reply struct
+ * @brief Order reply struct. The ids are views on the order data, a reply is encoded while the order data is alive so creating
+ * a reply never copies or allocates.
  */
 class OrderReply final {
 public:
   OrderReply() = default;
-  explicit OrderReply(const Id_t &_id,              //
-                      const ClientId_t &_clientId   //
+  explicit OrderReply(const std::string_view _id,        //
+                      const std::string_view _clientId   //
   );
 
   [[nodiscard]] const auto &GetId() const noexcept
@@ -288,9 +378,9 @@ public:
 
 private:
   /// @brief generated order id
-  Id_t id{};
+  std::string_view id{};
   /// @brief order id assigned by the client
-  ClientId_t clientId{};
+  std::string_view clientId{};
 };
 
 /**
@@ -381,6 +471,16 @@ public:
            (isBuySide == true or isBuySide == false);
   }
 
+  [[nodiscard]] inline auto GetReplyFormat() const noexcept
+  {
+    return replyFormat;
+  }
+
+  inline void SetReplyFormat(const ReplyFormat _replyFormat) noexcept
+  {
+    replyFormat = _replyFormat;
+  }
+
 private:
   /// @brief instrument
   std::string instrument;
@@ -392,19 +492,112 @@ private:
   Id_t id;
   /// @brief order id assigned by the client
   ClientId_t clientId;
+  /// @brief encoding of the replies to the cancel
+  ReplyFormat replyFormat{ReplyFormat::Json};
+};
+
+/// @brief scope of a mass cancel, the flags can be combined, an order is cancelled when it is in all scopes of the flags
+enum MassCancelScope : std::uint8_t {
+  MassCancelAccount = 0x01,      // all orders of the account
+  MassCancelInstrument = 0x02,   // all orders of the instrument
+  MassCancelSession = 0x04       // all orders of the session that sends the mass cancel
+};
+
+/**
+ * @brief order mass cancel data struct. In json the scope follows from the fields, an account and an instrument field set their
+ * scope and the session scope is set by "Session":true.
+ */
+class OrderMassCancelData final {
+public:
+  OrderMassCancelData() = default;
+  explicit OrderMassCancelData(const std::uint8_t _scope,        //
+                               const std::string &_account,      //
+                               const std::string &_instrument,   //
+                               const ClientId_t &_clientId       //
+  );
+
+  [[nodiscard]] auto SetData(const boost::json::value &data) -> bool;
+
+  [[nodiscard]] auto Validate() const -> bool;
+
+  [[nodiscard]] inline auto GetScope() const noexcept
+  {
+    return scope;
+  }
+
+  inline void SetScope(const std::uint8_t _scope) noexcept
+  {
+    scope = _scope;
+  }
+
+  [[nodiscard]] inline auto HasScope(const MassCancelScope _scope) const noexcept -> bool
+  {
+    return (scope & _scope) != 0;
+  }
+
+  [[nodiscard]] inline auto GetAccount() const -> const std::string &
+  {
+    return account;
+  }
+
+  inline void SetAccount(const std::string &_account)
+  {
+    account = _account;
+  }
+
+  [[nodiscard]] inline auto GetInstrument() const -> const std::string &
+  {
+    return instrument;
+  }
+
+  inline void SetInstrument(const std::string &_instrument)
+  {
+    instrument = _instrument;
+  }
+
+  [[nodiscard]] inline const auto &GetClientId() const
+  {
+    return clientId;
+  }
+
+  inline void SetClientId(const ClientId_t &_clientId)
+  {
+    clientId = _clientId;
+  }
+
+  [[nodiscard]] inline auto GetReplyFormat() const noexcept
+  {
+    return replyFormat;
+  }
+
+  inline void SetReplyFormat(const ReplyFormat _replyFormat) noexcept
+  {
+    replyFormat = _replyFormat;
+  }
+
+private:
+  /// @brief MassCancelScope flags
+  std::uint8_t scope{};
+  std::string account;
+  std::string instrument;
+  /// @brief id of the mass cancel assigned by the client
+  ClientId_t clientId;
+  /// @brief encoding of the replies to the mass cancel
+  ReplyFormat replyFormat{ReplyFormat::Json};
 };
 
 /**
- * @brief Trade object
+ * @brief Trade object. Account and ids are views on the resting order, like the order reply a trade is encoded while the
+ * order is alive.
  */
 class Trade final {
 public:
   Trade() = default;
-  explicit Trade(const std::string &_account,         //
+  explicit Trade(const std::string_view _account,     //
                  const PriceType_t &_tradedPrice,     //
                  const VolumeType_t &_tradedVolume,   //
-                 const Id_t &_id,                     //
-                 const ClientId_t &_clientId);
+                 const std::string_view _id,          //
+                 const std::string_view _clientId);
 
   //[[nodiscard]] auto Validate() const -> bool;
 
@@ -413,7 +606,7 @@ public:
     return account;
   }
 
-  inline void SetAccount(const std::string &_account)
+  inline void SetAccount(const std::string_view _account)
   {
     account = _account;
   }
@@ -449,7 +642,7 @@ public:
     return id;
   }
 
-  inline void SetId(const Id_t &_id)
+  inline void SetId(const std::string_view _id)
   {
     id = _id;
   }
@@ -459,7 +652,7 @@ public:
     return clientId;
   }
 
-  inline void SetClientId(const ClientId_t &_clientId)
+  inline void SetClientId(const std::string_view _clientId)
   {
     clientId = _clientId;
   }
@@ -474,11 +667,11 @@ public:
   }
 
 private:
-  std::string account{};
+  std::string_view account{};
   PriceType_t tradedPrice{};
   VolumeType_t tradedVolume{};
-  Id_t id{};
-  ClientId_t clientId{};
+  std::string_view id{};
+  std::string_view clientId{};
 };
 
 /**
@@ -521,6 +714,28 @@ private:
   std::string errorMessage;
 };
 
+/// @brief public market data of a price level, the aggregate of the resting orders at the price. The instrument is a view on the
+/// instrument of the matching engine.
+struct LevelUpdate {
+  std::string_view instrument;
+  PriceType_t price{};
+  VolumeType_t volume{};   // 0 when the level is removed
+  std::size_t orderCount{};
+  bool isBuySide{};
+
+  inline auto operator==(const LevelUpdate &rhs) const -> bool = default;
+};
+
+/// @brief public market data of a trade, without the account and order ids of the private trade
+struct PublicTrade {
+  std::string_view instrument;
+  PriceType_t price{};
+  VolumeType_t volume{};
+  bool isBuySide{};   // side of the aggressor
+
+  inline auto operator==(const PublicTrade &rhs) const -> bool = default;
+};
+
 // ostream operators
 std::ostream &operator<<(std::ostream &os, const OrderTime_t &rhs);
 std::ostream &operator<<(std::ostream &os, const OrderInsertData &rhs);
@@ -528,6 +743,7 @@ std::ostream &operator<<(std::ostream &os, const OrderReply &rhs);
 std::ostream &operator<<(std::ostream &os, const Trade &rhs);
 std::ostream &operator<<(std::ostream &os, const OrderCancelData &rhs);
 std::ostream &operator<<(std::ostream &os, const OrderAmendData &rhs);
+std::ostream &operator<<(std::ostream &os, const OrderMassCancelData &rhs);
 
 // message construction operators
 std::ostringstream &operator<<(std::ostringstream &os, const OrderReply &orderReply);
@@ -545,6 +761,9 @@ template <> struct fmt::formatter<moboware::modules::OrderAmendData> : fmt::ostr
 template <> struct fmt::formatter<moboware::modules::OrderCancelData> : fmt::ostream_formatter {
 };
 
+template <> struct fmt::formatter<moboware::modules::OrderMassCancelData> : fmt::ostream_formatter {
+};
+
 template <> struct fmt::formatter<moboware::modules::OrderReply> : fmt::ostream_formatter {
 };
 
@@ -0,0 +1,297 @@
+#pragma once
+#include "modules/matching_engine_module/order.h"
+#include "modules/matching_engine_module/order_data.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace moboware::modules {
+
+/// @brief Binary order entry protocol, a compact fixed layout alternative for the json order entry messages.
+/// Layout rules:
+///   - every message starts with a MessageHeader, the length in the header is the length of the whole message
+///   - integers are little endian, the structs are packed so a message can be decoded in place from any buffer position
+///   - strings are fixed length character arrays, padded with zeros when the string is shorter than the array
+///   - the first byte of a message is the BinaryMagic byte, which is never the first byte of a json message, so the two
+///     protocols can be received on the same session
+/// On a stream transport, like a raw tcp session, the messages are sent back to back and the header length is used to find the
+/// message boundaries.
+namespace binary {
+
+static_assert(std::endian::native == std::endian::little, "the binary protocol is decoded in place and is little endian");
+
+static constexpr std::uint8_t BinaryMagic{0xB1};
+static constexpr std::uint8_t BinaryVersion{1};
+
+enum class MessageType : std::uint8_t {
+  Unknown = 0,
+  Insert,
+  Amend,
+  Cancel,
+  MassCancel,
+  GetBook,
+  // replies of the matching engine
+  OrderReply,
+  Trade,
+  ErrorReply,
+  // market data
+  Subscribe,
+  Unsubscribe,
+  LevelUpdate,
+  PublicTrade
+};
+
+#pragma pack(push, 1)
+
+/// @brief fixed length zero padded string
+template <std::size_t Length> struct FixedString {
+  char data[Length];
+
+  [[nodiscard]] inline std::string_view View() const noexcept
+  {
+    const auto *const end{std::find(data, data + Length, '\0')};
+    return {data, static_cast<std::size_t>(end - data)};
+  }
+
+  /// @brief assign a string, false when the string does not fit
+  inline bool Assign(const std::string_view str) noexcept
+  {
+    if (str.size() > Length) {
+      return false;
+    }
+    std::memcpy(data, str.data(), str.size());
+    std::memset(data + str.size(), 0, Length - str.size());
+    return true;
+  }
+};
+
+using Account_t = FixedString<16>;
+using Instrument_t = FixedString<16>;
+using OrderIdString_t = FixedString<32>;
+using ClientIdString_t = FixedString<32>;
+using ErrorString_t = FixedString<64>;
+
+struct MessageHeader {
+  std::uint8_t magic;
+  std::uint8_t version;
+  std::uint16_t length;
+  MessageType messageType;
+  std::uint8_t reserved[3];
+};
+
+struct OrderInsertMessage {
+  static constexpr MessageType Type{MessageType::Insert};
+
+  MessageHeader header;
+  std::uint64_t price;
+  std::uint64_t volume;
+  std::int64_t orderDuration;   // milli seconds
+  OrderType orderType;
+  std::uint8_t isBuySide;
+  std::uint8_t reserved[6];
+  Account_t account;
+  Instrument_t instrument;
+  ClientIdString_t clientId;
+};
+
+struct OrderAmendMessage {
+  static constexpr MessageType Type{MessageType::Amend};
+
+  MessageHeader header;
+  std::uint64_t price;
+  std::uint64_t newPrice;
+  std::uint64_t volume;
+  std::uint64_t newVolume;
+  OrderType orderType;
+  std::uint8_t isBuySide;
+  std::uint8_t reserved[6];
+  Account_t account;
+  Instrument_t instrument;
+  OrderIdString_t id;
+  ClientIdString_t clientId;
+};
+
+struct OrderCancelMessage {
+  static constexpr MessageType Type{MessageType::Cancel};
+
+  MessageHeader header;
+  std::uint64_t price;
+  std::uint8_t isBuySide;
+  std::uint8_t reserved[7];
+  Instrument_t instrument;
+  OrderIdString_t id;
+  ClientIdString_t clientId;
+};
+
+struct MassCancelMessage {
+  static constexpr MessageType Type{MessageType::MassCancel};
+
+  MessageHeader header;
+  std::uint8_t scope;   // MassCancelScope flags
+  std::uint8_t reserved[7];
+  Account_t account;
+  Instrument_t instrument;
+  ClientIdString_t clientId;
+};
+
+struct GetBookMessage {
+  static constexpr MessageType Type{MessageType::GetBook};
+
+  MessageHeader header;
+  Instrument_t instrument;
+};
+
+struct OrderReplyMessage {
+  static constexpr MessageType Type{MessageType::OrderReply};
+
+  MessageHeader header;
+  OrderIdString_t id;
+  ClientIdString_t clientId;
+};
+
+struct TradeMessage {
+  static constexpr MessageType Type{MessageType::Trade};
+
+  MessageHeader header;
+  std::uint64_t tradedPrice;
+  std::uint64_t tradedVolume;
+  Account_t account;
+  OrderIdString_t id;
+  ClientIdString_t clientId;
+};
+
+struct ErrorReplyMessage {
+  static constexpr MessageType Type{MessageType::ErrorReply};
+
+  MessageHeader header;
+  ClientIdString_t clientId;
+  ErrorString_t error;   // truncated when the error message is longer
+};
+
+struct SubscribeMessage {
+  static constexpr MessageType Type{MessageType::Subscribe};
+
+  MessageHeader header;
+  Instrument_t instrument;
+};
+
+struct UnsubscribeMessage {
+  static constexpr MessageType Type{MessageType::Unsubscribe};
+
+  MessageHeader header;
+  Instrument_t instrument;
+};
+
+struct LevelUpdateMessage {
+  static constexpr MessageType Type{MessageType::LevelUpdate};
+
+  MessageHeader header;
+  std::uint64_t price;
+  std::uint64_t volume;   // aggregate volume of the level, 0 when the level is removed
+  std::uint32_t orderCount;
+  std::uint8_t isBuySide;
+  std::uint8_t reserved[3];
+  Instrument_t instrument;
+};
+
+struct PublicTradeMessage {
+  static constexpr MessageType Type{MessageType::PublicTrade};
+
+  MessageHeader header;
+  std::uint64_t price;
+  std::uint64_t volume;
+  std::uint8_t isBuySide;   // side of the aggressor
+  std::uint8_t reserved[7];
+  Instrument_t instrument;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(MessageHeader) == 8);
+static_assert(sizeof(OrderInsertMessage) == 104);
+static_assert(sizeof(OrderAmendMessage) == 144);
+static_assert(sizeof(OrderCancelMessage) == 104);
+static_assert(sizeof(MassCancelMessage) == 80);
+static_assert(sizeof(GetBookMessage) == 24);
+static_assert(sizeof(OrderReplyMessage) == 72);
+static_assert(sizeof(TradeMessage) == 104);
+static_assert(sizeof(ErrorReplyMessage) == 104);
+static_assert(sizeof(SubscribeMessage) == 24);
+static_assert(sizeof(UnsubscribeMessage) == 24);
+static_assert(sizeof(LevelUpdateMessage) == 48);
+static_assert(sizeof(PublicTradeMessage) == 48);
+
+/// @brief Decode the message header in place
+/// @param data, start of the message
+/// @param size, bytes available
+/// @return header or nullptr when the data does not start with a complete and valid binary message
+[[nodiscard]] inline auto DecodeHeader(const char *data, const std::size_t size) noexcept -> const MessageHeader *
+{
+  if (size < sizeof(MessageHeader)) {
+    return nullptr;
+  }
+
+  const auto *const header{reinterpret_cast<const MessageHeader *>(data)};
+  if (header->magic != BinaryMagic or   //
+      header->version != BinaryVersion or
+      header->length < sizeof(MessageHeader) or
+      header->length > size) {
+    return nullptr;
+  }
+  return header;
+}
+
+/// @brief Get the message of a decoded header in place
+/// @return message or nullptr when the header is not of the message type, the message is too short or the order type is not a
+/// known order type
+template <typename TMessage> [[nodiscard]] inline auto DecodeMessage(const MessageHeader &header) noexcept -> const TMessage *
+{
+  if (header.messageType != TMessage::Type or header.length < sizeof(TMessage)) {
+    return nullptr;
+  }
+
+  const auto *const message{reinterpret_cast<const TMessage *>(&header)};
+  // the order type byte is copied from the wire, a value outside of the enum is rejected before it reaches the matching engine
+  if constexpr (requires { message->orderType; }) {
+    if (message->orderType > OrderType::PostOnly) {
+      return nullptr;
+    }
+  }
+  return message;
+}
+
+/// @brief Is the data the start of a binary message, a check on the magic byte only
+[[nodiscard]] inline bool IsBinaryMessage(const char *data, const std::size_t size) noexcept
+{
+  return size > 0 and static_cast<std::uint8_t>(data[0]) == BinaryMagic;
+}
+
+/// @brief Convert the binary messages into the order data of the order handler
+[[nodiscard]] auto ToOrderInsertData(const OrderInsertMessage &message) -> OrderInsertData;
+[[nodiscard]] auto ToOrderAmendData(const OrderAmendMessage &message) -> OrderAmendData;
+[[nodiscard]] auto ToOrderCancelData(const OrderCancelMessage &message) -> OrderCancelData;
+[[nodiscard]] auto ToOrderMassCancelData(const MassCancelMessage &message) -> OrderMassCancelData;
+
+/// @brief Encode the order data into a binary message, used by clients and tests
+/// @return false when a string does not fit into the fixed length field
+[[nodiscard]] bool Encode(const OrderInsertData &orderInsert, OrderInsertMessage &message);
+[[nodiscard]] bool Encode(const OrderAmendData &orderAmend, OrderAmendMessage &message);
+[[nodiscard]] bool Encode(const OrderCancelData &orderCancel, OrderCancelMessage &message);
+[[nodiscard]] bool Encode(const OrderMassCancelData &orderMassCancel, MassCancelMessage &message);
+[[nodiscard]] bool Encode(const std::string_view instrument, GetBookMessage &message);
+[[nodiscard]] bool Encode(const std::string_view instrument, SubscribeMessage &message);
+[[nodiscard]] bool Encode(const std::string_view instrument, UnsubscribeMessage &message);
+
+/// @brief Encode the replies of the matching engine
+/// @return false when a string does not fit, the error reply is always encoded with the strings truncated
+[[nodiscard]] bool Encode(const OrderReply &orderReply, OrderReplyMessage &message);
+[[nodiscard]] bool Encode(const Trade &trade, TradeMessage &message);
+[[nodiscard]] bool Encode(const ErrorReply &errorReply, ErrorReplyMessage &message);
+
+/// @brief Encode the market data of the matching engine
+[[nodiscard]] bool Encode(const LevelUpdate &levelUpdate, LevelUpdateMessage &message);
+[[nodiscard]] bool Encode(const PublicTrade &publicTrade, PublicTradeMessage &message);
+}   // namespace binary
+}   // namespace moboware::modules
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common/channel_interface.h"
+#include "common/service.h"
+#include "common/types.hpp"
+#include "modules/matching_engine_module/order_event_processor.h"
+#include "socket/tcp_socket_server.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace moboware::modules {
+
+/**
+ * @brief Raw tcp transport of the binary order entry protocol. The read loop of a tcp session feeds the binary messages of the stream
+ * to the order event processor of the session, a partial message stays in the receive buffer until the rest is received.
+ * The server is the channel of the matching engines, the replies and the market data for a tcp session are queued in the write queue
+ * of the tcp session, the engine thread never waits for a socket. The messages for the other sessions are forwarded to the channel of
+ * the module, e.g. the web socket channel.
+ */
+class OrderEntryTcpServer final : public common::ChannelInterface {
+public:
+  using GetOrderEventProcessorFn_t = std::function<std::shared_ptr<OrderEventProcessor>(const boost::asio::ip::tcp::endpoint &)>;
+  using SessionClosedFn_t = std::function<void(const boost::asio::ip::tcp::endpoint &)>;
+
+  explicit OrderEntryTcpServer(const std::shared_ptr<common::Service> &service,
+                               const std::shared_ptr<common::ChannelInterface> &channelInterface,
+                               const GetOrderEventProcessorFn_t &getOrderEventProcessorFn,
+                               const SessionClosedFn_t &sessionClosedFn);
+  OrderEntryTcpServer(const OrderEntryTcpServer &) = delete;
+  OrderEntryTcpServer(OrderEntryTcpServer &&) = delete;
+  OrderEntryTcpServer &operator=(const OrderEntryTcpServer &) = delete;
+  OrderEntryTcpServer &operator=(OrderEntryTcpServer &&) = delete;
+  ~OrderEntryTcpServer() final = default;
+
+  [[nodiscard]] bool Start(const std::string &address, const std::uint16_t port);
+
+  void SendWebSocketData(const boost::asio::const_buffer &sendBuffer, const boost::asio::ip::tcp::endpoint &endpoint) final;
+  void PublishWebSocketData(const common::SharedBuffer_t &sharedBuffer,
+                            const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+                            const common::ConflationKey_t conflationKey) final;
+
+  /// @brief session callbacks of the tcp server, called on the strand of the server
+  void OnDataRead(const socket::RingBuffer_t &readBuffer,
+                  const boost::asio::ip::tcp::endpoint &endpoint,
+                  const common::SessionTimePoint_t &sessionTimePoint);
+  void OnSessionConnected(const boost::asio::ip::tcp::endpoint &endpoint);
+  void OnSessionClosed(const boost::asio::ip::tcp::endpoint &endpoint);
+
+private:
+  const std::shared_ptr<common::ChannelInterface> m_ChannelInterface;
+  const GetOrderEventProcessorFn_t m_GetOrderEventProcessorFn;
+  const SessionClosedFn_t m_SessionClosedFn;
+
+  tcp_socket::TcpSocketServer<OrderEntryTcpServer> m_TcpSocketServer;
+};
+}   // namespace moboware::modules
@@ -2,14 +2,20 @@
 
 #include "modules/matching_engine_module/i_order_handler.h"
 #include "modules/matching_engine_module/order_data.h"
+#include "modules/matching_engine_module/order_entry_protocol.h"
+#include <array>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/json.hpp>
 #include <boost/beast/core/flat_buffer.hpp>
+#include <string_view>
 
 namespace moboware::modules {
 
 /**
- * @brief Event processor class. Converts json message in to events/calls to the matching engine.
+ * @brief Event processor class. Converts json and binary order entry messages in to events/calls to the matching engine.
+ * The protocol is detected per message on the first byte, so a session can switch to the binary protocol at any moment.
+ * One processor is kept alive per session, the json parser and the arena of the parsed values are reused for every message so
+ * a json message is parsed without heap allocations as long as it fits in the arena.
  */
 class OrderEventProcessor
 {
@@ -21,16 +27,43 @@ public:
   OrderEventProcessor& operator=(OrderEventProcessor&&) = delete;
   ~OrderEventProcessor() = default;
 
+  /// @brief Process one web socket message, a json text message or one or more binary messages
   void Process(const boost::beast::flat_buffer& readBuffer);
 
+  /// @brief Process the binary messages of a stream transport, like the receive buffer of a raw tcp session. Only complete
+  /// messages are processed, a partial message at the end stays in the stream buffer until the rest is received.
+  /// @return number of bytes processed, that can be flushed from the stream buffer
+  [[nodiscard]] auto ProcessStream(const char* data, const std::size_t size) -> std::size_t;
+
 private:
-  const std::weak_ptr<IOrderHandler> m_OrderHandler;
+  /// @brief size of the arena of the parsed json values, a larger message takes the extra memory from the heap
+  static constexpr std::size_t ParseArenaSize{16 * 1024};
+  /// @brief size of the temporary buffer of the parser for the values that are not complete yet
+  static constexpr std::size_t ParserBufferSize{4 * 1024};
+
+  using ActionHandler_t = void (OrderEventProcessor::*)(const boost::json::value&);
+  /// @brief dispatch table of the json Action field
+  static const std::array<std::pair<std::string_view, ActionHandler_t>, 7> ActionHandlers;
+
+  [[nodiscard]] static auto FindActionHandler(const std::string_view action) -> ActionHandler_t;
+
+  void ProcessJson(const char* data, const std::size_t size);
   void HandleOrderInsert(const boost::json::value& data);
   void HandleOrderCancel(const boost::json::value& data);
   void HandleOrderAmend(const boost::json::value& data);
+  void HandleOrderMassCancel(const boost::json::value& data);
   void GetOrderBook(const boost::json::value& data);
+  void SubscribeMarketData(const boost::json::value& data);
+  void UnsubscribeMarketData(const boost::json::value& data);
+  void HandleBinaryMessage(const binary::MessageHeader& header);
 
+  const std::weak_ptr<IOrderHandler> m_OrderHandler;
   const boost::asio::ip::tcp::endpoint m_Endpoint;
+
+  std::array<unsigned char, ParseArenaSize> m_ParseArena;
+  boost::json::monotonic_resource m_ParseResource{m_ParseArena.data(), m_ParseArena.size()};
+  std::array<unsigned char, ParserBufferSize> m_ParserBuffer;
+  boost::json::stream_parser m_Parser{boost::json::storage_ptr(&m_ParseResource), {}, m_ParserBuffer.data(), m_ParserBuffer.size()};
 };
 
 }
\ No newline at end of file
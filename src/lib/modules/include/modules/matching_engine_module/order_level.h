@@ -1,63 +1,115 @@
 #pragma once
 #include "modules/matching_engine_module/i_order_handler.h"
+#include "modules/matching_engine_module/order_node_pool.h"
 #include <chrono>
-#include <deque>
+#include <functional>
 #include <map>
 #include <optional>
 #include <ostream>
 
 namespace moboware::modules {
 
-/// @brief OrderLevel class to hold orders on a price level sorted on time priority
+/// @brief OrderLevel class to hold orders on a price level sorted on time priority. The orders are pooled order nodes linked
+/// in an intrusive doubly linked list, the level does not own the nodes, the order book acquires and releases them.
+/// The total volume and the number of orders of the level are kept up to date by every change of the level, so the depth of a
+/// level is read without a walk over its orders. The volume of a linked order is only changed through the level.
 class OrderLevel {
 public:
-  explicit OrderLevel(OrderInsertData &&orderData);
-  OrderLevel(const OrderLevel &) = default;
-  OrderLevel(OrderLevel &&) = default;
-  OrderLevel &operator=(const OrderLevel &) = default;
-  OrderLevel &operator=(OrderLevel &&) = default;
+  explicit OrderLevel(OrderNode *node);
+  OrderLevel(const OrderLevel &) = delete;
+  OrderLevel(OrderLevel &&) = delete;
+  OrderLevel &operator=(const OrderLevel &) = delete;
+  OrderLevel &operator=(OrderLevel &&) = delete;
   ~OrderLevel() = default;
 
   /**
-   * @brief Insert an order at the end of the queue
-   * @param orderData
-   * @return std::optional<const OrderInsertData *>, the inserted order on success
+   * @brief Insert an order node at the end of the queue
+   * @param node
    */
-  [[nodiscard]] const OrderInsertData *Insert(OrderInsertData &&orderData) noexcept;
-  [[nodiscard]] bool CancelOrder(const Id_t &orderId) noexcept;
-  [[nodiscard]] bool ChangeOrderVolume(const Id_t &orderId, const VolumeType_t newVolume) noexcept;
+  void Insert(OrderNode *node) noexcept;
+
+  /**
+   * @brief Unlink an order node from the queue, the node is not released
+   * @param node
+   */
+  void CancelOrder(OrderNode *node) noexcept;
+  void ChangeOrderVolume(OrderNode *node, const VolumeType_t newVolume) noexcept;
 
   /**
    * @brief Get the Last Order object, returns the last order in the time queue when not emtpy
-   * @return const OrderInsertData*, pointer to the last order in the queue or a nullptr
+   * @return const OrderNode*, pointer to the last order in the queue or a nullptr
    */
-  [[nodiscard]] const OrderInsertData *GetLastOrder() noexcept;
+  [[nodiscard]] const OrderNode *GetLastOrder() const noexcept;
   [[nodiscard]] auto GetSize() const -> std::size_t;
   [[nodiscard]] auto IsEmpty() const -> bool;
 
-  /// @brief Get the top level OrderInsertData
+  /// @brief aggregate volume of the orders of the level
+  [[nodiscard]] inline auto GetTotalVolume() const noexcept -> VolumeType_t
+  {
+    return m_TotalVolume;
+  }
+
+  /// @brief Get the top level order
   /// @return
-  [[nodiscard]] auto GetTopLevel() const -> std::optional<OrderInsertData>;
+  [[nodiscard]] auto GetTopLevel() const -> std::optional<Order>;
 
-  [[nodiscard]] auto GetLevels(const std::function<bool(const OrderInsertData &)> &orderLevelFunction) const -> bool;
+  /// @brief Get the top level order node without a copy, for the matching loop
+  /// @return first order in the time queue or a nullptr when the level is empty
+  [[nodiscard]] inline auto GetTopOrder() const noexcept -> const OrderNode *
+  {
+    return m_Head;
+  }
 
-  /// @brief Trade the top level, reduce the volume of the top level
+  [[nodiscard]] auto GetLevels(const std::function<bool(const OrderNode &)> &orderLevelFunction) const -> bool;
+
+  /// @brief Trade the top level, reduce the volume of the top level. The callbacks are template parameters so they are inlined
+  /// in the matching loop.
   /// @param volume
-  /// @return left volume at top level
-  [[nodiscard]] auto TradeTopLevel(const VolumeType_t volume, const std::function<void(const Trade &)> &tradedFn) const
-      -> VolumeType_t;
+  /// @param tradedFn, called with the top level order node and the traded volume
+  /// @param filledFn, called with the node of the top level order when it is fully traded and unlinked from the level
+  /// @return traded volume of the top level order, at most the volume
+  template <typename TTradedFn, typename TFilledFn>
+  [[nodiscard]] auto TradeTopLevel(const VolumeType_t volume, TTradedFn &&tradedFn, TFilledFn &&filledFn) -> VolumeType_t;
 
-  [[nodiscard]] auto Find(const Id_t &id, const std::function<void(OrderInsertData &)> &) -> bool;
-  [[nodiscard]] auto MoveOrder(const Id_t &orderId, const std::function<void(OrderInsertData &&orderData)> &moveOrderFn)
-      -> bool;
+  /// @brief Unlink all order nodes from the level
+  /// @param releaseFn, called with every unlinked node
+  void Clear(const std::function<void(OrderNode *)> &releaseFn);
 
   friend std::ostream &operator<<(std::ostream &os, const OrderLevel &level);
 
 private:
-  using OrderLevel_t = std::deque<OrderInsertData>;
-  mutable OrderLevel_t m_TimeQueue;   // order data on this level sorted on time priority
+  OrderNode *m_Head{};   // oldest order, first in time priority
+  OrderNode *m_Tail{};
+  std::size_t m_Size{};
+  VolumeType_t m_TotalVolume{};
 };
 
+template <typename TTradedFn, typename TFilledFn>
+auto OrderLevel::TradeTopLevel(const VolumeType_t volume, TTradedFn &&tradedFn, TFilledFn &&filledFn) -> VolumeType_t
+{
+  VolumeType_t tradedVolume{};
+  if (m_Head) {
+    auto &topLevel = m_Head->order;
+    if (topLevel.GetVolume() >= volume) {
+      topLevel.SetVolume(topLevel.GetVolume() - volume);   // partial trade
+      tradedVolume = volume;
+    } else if (volume > topLevel.GetVolume()) {
+      tradedVolume = topLevel.GetVolume();
+      topLevel.SetVolume(0);   // full trade!!!
+    }
+    m_TotalVolume -= tradedVolume;
+    // Send the Trade
+    tradedFn(*m_Head, tradedVolume);
+    if (topLevel.GetVolume() == 0) {
+      //  remove level
+      auto *const node{m_Head};
+      CancelOrder(node);
+      filledFn(node);
+    }
+  }
+  return tradedVolume;
+}
+
 /// @brief
 /// @param os
 /// @param level
@@ -65,11 +117,11 @@ private:
 inline std::ostream &operator<<(std::ostream &os, const OrderLevel &level)
 {
   os << "{";
-  for (const auto &v : level.m_TimeQueue) {
-    os << "{" << v.GetVolume() << "@" << v.GetPriceAsDouble() << "};";
+  for (const auto *node{level.m_Head}; node != nullptr; node = node->next) {
+    os << "{" << node->order.GetVolume() << "@" << node->order.GetPriceAsDouble() << "};";
   }
   os << "}";
   return os;
 }
 
-}   // namespace moboware::modules
\ No newline at end of file
+}   // namespace moboware::modules
@@ -0,0 +1,83 @@
+#pragma once
+#include "modules/matching_engine_module/order.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace moboware::modules {
+
+struct OrderNode;
+
+/// @brief links of an intrusive doubly linked list of order nodes
+struct OrderLinks {
+  OrderNode *prev{};
+  OrderNode *next{};
+};
+
+/// @brief Node of an intrusive doubly linked time priority queue of an order level. The node address stays the same for the
+/// lifetime of the order in the book. The node is cache line aligned, the links and the compact order record fill the first
+/// cache line, the string ids of the order entry messages are only used for the replies.
+/// The node is also linked in the order lists of its account and of its session, for the mass cancels.
+struct alignas(64) OrderNode {
+  OrderNode *prev{};
+  OrderNode *next{};
+  Order order{};
+  /// @brief order id of the order entry messages
+  Id_t id{};
+  /// @brief order id assigned by the client
+  ClientId_t clientId{};
+  OrderLinks accountLinks{};
+  OrderLinks sessionLinks{};
+  SessionHandle_t session{};
+};
+
+// the queue links are the first members of the node, followed by the order record
+static_assert(alignof(Order) <= sizeof(OrderNode *), "The order record follows the links without padding");
+static_assert(2 * sizeof(OrderNode *) + sizeof(Order) <= alignof(OrderNode), "The links and the order record fit in the first cache line");
+
+/// @brief Slab pool of order nodes. Nodes are allocated in slabs and released nodes are kept in a free list, so when the
+/// pool is warmed up, acquiring and releasing a node does not allocate.
+class OrderNodePool {
+public:
+  static constexpr std::size_t DefaultSlabSize{4096};
+
+  explicit OrderNodePool(const std::size_t slabSize = DefaultSlabSize);
+  OrderNodePool(const OrderNodePool &) = delete;
+  OrderNodePool(OrderNodePool &&) = delete;
+  OrderNodePool &operator=(const OrderNodePool &) = delete;
+  OrderNodePool &operator=(OrderNodePool &&) = delete;
+  ~OrderNodePool() = default;
+
+  /// @brief Get a node from the free list, a new slab is allocated when the free list is empty
+  /// @param order
+  /// @param id
+  /// @param clientId
+  /// @return unlinked node, the strings of a reused node keep their capacity
+  [[nodiscard]] auto Acquire(const Order &order, const Id_t &id, const ClientId_t &clientId) -> OrderNode *;
+
+  /// @brief Return an unlinked node to the free list, the order of the node is reset. The node memory stays valid for the
+  /// lifetime of the pool.
+  /// @param node
+  void Release(OrderNode *node) noexcept;
+
+  /// @brief number of nodes in use
+  [[nodiscard]] inline auto GetSize() const noexcept -> std::size_t
+  {
+    return m_Size;
+  }
+
+  /// @brief number of nodes allocated in the slabs
+  [[nodiscard]] inline auto GetCapacity() const noexcept -> std::size_t
+  {
+    return m_Slabs.size() * m_SlabSize;
+  }
+
+private:
+  void AddSlab();
+
+  const std::size_t m_SlabSize;
+  std::vector<std::unique_ptr<OrderNode[]>> m_Slabs;
+  OrderNode *m_FreeList{};   // single linked on the next pointer of the node
+  std::size_t m_Size{};
+};
+}   // namespace moboware::modules
@@ -0,0 +1,386 @@
+#pragma once
+#include "modules/matching_engine_module/order_level.h"
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace moboware::modules {
+
+/// @brief Price range of a price ladder, configured per instrument
+struct PriceLadderConfig {
+  /// @brief default tick size of 0.01 in the 6 places precision of the prices
+  static constexpr PriceType_t DefaultTickSize{10'000};
+  static constexpr PriceType_t DefaultMinPrice{0};
+  static constexpr std::size_t DefaultNumberOfLevels{1 << 16};
+
+  PriceType_t minPrice{DefaultMinPrice};
+  PriceType_t tickSize{DefaultTickSize};
+  std::size_t numberOfLevels{DefaultNumberOfLevels};
+};
+
+/// @brief Price ladder, a flat tick indexed container of order levels with a (mostly) std::map compatible interface so it can
+/// be used as order book map in the OrderBook.
+/// Behaviour:
+///   - Every tick aligned price in the range [minPrice, minPrice + tickSize * numberOfLevels) has a fixed slot in a contiguous
+///     vector, so a price lookup is an index calculation instead of a tree walk.
+///   - Occupied slots are marked in a bitmap, with a second summary bitmap of non empty bitmap words. The next best level is
+///     found with bit scans on the summary and the bitmap words.
+///   - The index of the best level is cached, begin() is O(1).
+///   - Iteration is in priority order of TCompare, std::greater iterates from the highest to the lowest price (bids) and
+///     std::less from the lowest to the highest price (asks).
+///   - Prices out of range or not aligned on the tick size can not be inserted, emplace will fail.
+/// @tparam TCompare, price priority compare function like the std::map compare
+template <typename TCompare> class PriceLadder {
+public:
+  using key_type = PriceType_t;
+  using mapped_type = OrderLevel;
+  using value_type = std::pair<const PriceType_t, OrderLevel>;
+  using size_type = std::size_t;
+
+  static constexpr PriceType_t DefaultTickSize{PriceLadderConfig::DefaultTickSize};
+  static constexpr PriceType_t DefaultMinPrice{PriceLadderConfig::DefaultMinPrice};
+  static constexpr size_type DefaultNumberOfLevels{PriceLadderConfig::DefaultNumberOfLevels};
+
+  template <bool IsConst> class Iterator {
+  public:
+    using Ladder_t = std::conditional_t<IsConst, const PriceLadder, PriceLadder>;
+    using value_type = std::conditional_t<IsConst, const PriceLadder::value_type, PriceLadder::value_type>;
+    using reference = value_type &;
+    using pointer = value_type *;
+
+    Iterator(Ladder_t *ladder, const size_type index)
+      : m_Ladder(ladder)
+      , m_Index(index)
+    {
+    }
+
+    // a non const iterator can be converted into a const iterator
+    operator Iterator<true>() const
+    {
+      return Iterator<true>(m_Ladder, m_Index);
+    }
+
+    inline reference operator*() const
+    {
+      return *m_Ladder->m_Levels[m_Index];
+    }
+
+    inline pointer operator->() const
+    {
+      return &(*m_Ladder->m_Levels[m_Index]);
+    }
+
+    // pre increment, moves to the next level in priority order
+    inline Iterator &operator++()
+    {
+      m_Index = m_Ladder->FindNextLevel(m_Index);
+      return *this;
+    }
+
+    // post increment
+    inline Iterator operator++(int)
+    {
+      const auto iter{*this};
+      ++(*this);
+      return iter;
+    }
+
+    inline bool operator==(const Iterator &rhs) const
+    {
+      return m_Index == rhs.m_Index;
+    }
+
+    [[nodiscard]] inline size_type GetIndex() const
+    {
+      return m_Index;
+    }
+
+  private:
+    Ladder_t *m_Ladder{};
+    size_type m_Index{};
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  explicit PriceLadder(const PriceType_t minPrice = DefaultMinPrice,   //
+                       const PriceType_t tickSize = DefaultTickSize,   //
+                       const size_type numberOfLevels = DefaultNumberOfLevels)
+    : m_MinPrice(minPrice)
+    , m_TickSize(tickSize)
+    , m_Levels(numberOfLevels)
+    , m_Bitmap((numberOfLevels + BitsPerWord - 1) / BitsPerWord)
+    , m_SummaryBitmap((m_Bitmap.size() + BitsPerWord - 1) / BitsPerWord)
+  {
+  }
+
+  explicit PriceLadder(const PriceLadderConfig &config)
+    : PriceLadder(config.minPrice, config.tickSize, config.numberOfLevels)
+  {
+  }
+
+  PriceLadder(const PriceLadder &) = delete;
+  PriceLadder(PriceLadder &&) = default;
+  PriceLadder &operator=(const PriceLadder &) = delete;
+  PriceLadder &operator=(PriceLadder &&) = default;
+  ~PriceLadder() = default;
+
+  template <typename... TArgs> std::pair<iterator, bool> emplace(const PriceType_t price, TArgs &&...args)
+  {
+    const auto index{GetIndex(price)};
+    if (index == NoIndex) {
+      return {end(), false};
+    }
+
+    if (IsSet(index)) {
+      return {iterator(this, index), false};
+    }
+
+    m_Levels[index].emplace(price, std::forward<TArgs>(args)...);
+    Set(index);
+    m_Size++;
+
+    if (m_BestIndex == NoIndex or IsBetter(index, m_BestIndex)) {
+      m_BestIndex = index;
+    }
+
+    return {iterator(this, index), true};
+  }
+
+  [[nodiscard]] inline iterator find(const PriceType_t price)
+  {
+    const auto index{GetIndex(price)};
+    return (index != NoIndex and IsSet(index)) ? iterator(this, index) : end();
+  }
+
+  [[nodiscard]] inline const_iterator find(const PriceType_t price) const
+  {
+    const auto index{GetIndex(price)};
+    return (index != NoIndex and IsSet(index)) ? const_iterator(this, index) : end();
+  }
+
+  iterator erase(const const_iterator &iter)
+  {
+    const auto index{iter.GetIndex()};
+    const auto nextIndex{FindNextLevel(index)};
+
+    m_Levels[index].reset();
+    Reset(index);
+    m_Size--;
+
+    if (index == m_BestIndex) {
+      m_BestIndex = nextIndex;
+    }
+
+    return iterator(this, nextIndex);
+  }
+
+  size_type erase(const PriceType_t price)
+  {
+    const auto iter{find(price)};
+    if (iter == end()) {
+      return 0;
+    }
+    erase(iter);
+    return 1;
+  }
+
+  [[nodiscard]] inline iterator begin() noexcept
+  {
+    return iterator(this, m_BestIndex);
+  }
+
+  [[nodiscard]] inline const_iterator begin() const noexcept
+  {
+    return const_iterator(this, m_BestIndex);
+  }
+
+  [[nodiscard]] inline iterator end() noexcept
+  {
+    return iterator(this, NoIndex);
+  }
+
+  [[nodiscard]] inline const_iterator end() const noexcept
+  {
+    return const_iterator(this, NoIndex);
+  }
+
+  [[nodiscard]] inline size_type size() const noexcept
+  {
+    return m_Size;
+  }
+
+  [[nodiscard]] inline bool empty() const noexcept
+  {
+    return m_Size == 0;
+  }
+
+  void clear() noexcept
+  {
+    while (not empty()) {
+      erase(begin());
+    }
+  }
+
+  [[nodiscard]] inline PriceType_t GetMinPrice() const noexcept
+  {
+    return m_MinPrice;
+  }
+
+  [[nodiscard]] inline PriceType_t GetMaxPrice() const noexcept
+  {
+    return m_MinPrice + (m_TickSize * (m_Levels.size() - 1));
+  }
+
+  [[nodiscard]] inline PriceType_t GetTickSize() const noexcept
+  {
+    return m_TickSize;
+  }
+
+  /// @brief the price has a slot in the ladder, it is in range and aligned on the tick size
+  [[nodiscard]] inline bool IsValidPrice(const PriceType_t price) const noexcept
+  {
+    return GetIndex(price) != NoIndex;
+  }
+
+private:
+  using Word_t = std::uint64_t;
+  static constexpr size_type BitsPerWord{64};
+  static constexpr size_type NoIndex{static_cast<size_type>(-1)};
+  /// @brief true when the best price is the highest price, like for the bid side
+  static constexpr bool IsDescending{TCompare{}(1, 0)};
+
+  [[nodiscard]] inline size_type GetIndex(const PriceType_t price) const noexcept
+  {
+    if (price < m_MinPrice) {
+      return NoIndex;
+    }
+
+    const auto offset{price - m_MinPrice};
+    if (offset % m_TickSize != 0) {
+      return NoIndex;
+    }
+
+    const auto index{static_cast<size_type>(offset / m_TickSize)};
+    return index < m_Levels.size() ? index : NoIndex;
+  }
+
+  [[nodiscard]] inline bool IsBetter(const size_type index, const size_type otherIndex) const noexcept
+  {
+    if constexpr (IsDescending) {
+      return index > otherIndex;
+    } else {
+      return index < otherIndex;
+    }
+  }
+
+  [[nodiscard]] inline bool IsSet(const size_type index) const noexcept
+  {
+    return (m_Bitmap[index / BitsPerWord] & (Word_t{1} << (index % BitsPerWord))) != 0;
+  }
+
+  inline void Set(const size_type index) noexcept
+  {
+    const auto word{index / BitsPerWord};
+    m_Bitmap[word] |= (Word_t{1} << (index % BitsPerWord));
+    m_SummaryBitmap[word / BitsPerWord] |= (Word_t{1} << (word % BitsPerWord));
+  }
+
+  inline void Reset(const size_type index) noexcept
+  {
+    const auto word{index / BitsPerWord};
+    m_Bitmap[word] &= ~(Word_t{1} << (index % BitsPerWord));
+    if (m_Bitmap[word] == 0) {
+      m_SummaryBitmap[word / BitsPerWord] &= ~(Word_t{1} << (word % BitsPerWord));
+    }
+  }
+
+  /// @brief Find the first set bit in the bitmap after 'index' in priority order
+  /// @param bitmap
+  /// @param index, start position, this position is excluded from the search
+  /// @return index of the set bit or NoIndex
+  [[nodiscard]] static size_type FindNextBit(const std::vector<Word_t> &bitmap, const size_type index) noexcept
+  {
+    if constexpr (IsDescending) {
+      if (index == 0) {
+        return NoIndex;
+      }
+
+      auto word{(index - 1) / BitsPerWord};
+      const auto bit{(index - 1) % BitsPerWord};
+      // mask out all bits above the start position
+      auto bits{bitmap[word] & (bit == BitsPerWord - 1 ? ~Word_t{0} : ((Word_t{1} << (bit + 1)) - 1))};
+      while (bits == 0) {
+        if (word == 0) {
+          return NoIndex;
+        }
+        bits = bitmap[--word];
+      }
+      return (word * BitsPerWord) + (BitsPerWord - 1 - std::countl_zero(bits));
+    } else {
+      const auto start{index + 1};
+      auto word{start / BitsPerWord};
+      if (word >= bitmap.size()) {
+        return NoIndex;
+      }
+
+      // mask out all bits below the start position
+      auto bits{bitmap[word] & (~Word_t{0} << (start % BitsPerWord))};
+      while (bits == 0) {
+        if (++word == bitmap.size()) {
+          return NoIndex;
+        }
+        bits = bitmap[word];
+      }
+      return (word * BitsPerWord) + std::countr_zero(bits);
+    }
+  }
+
+  /// @brief Find the next occupied level after index in priority order, first in the bitmap word of the index and
+  /// when that word has no more levels, via the summary bitmap.
+  [[nodiscard]] size_type FindNextLevel(const size_type index) const noexcept
+  {
+    const auto word{index / BitsPerWord};
+    const auto bits{m_Bitmap[word]};
+
+    if constexpr (IsDescending) {
+      const auto bit{index % BitsPerWord};
+      const auto lowerBits{bits & ((Word_t{1} << bit) - 1)};
+      if (lowerBits != 0) {
+        return (word * BitsPerWord) + (BitsPerWord - 1 - std::countl_zero(lowerBits));
+      }
+    } else {
+      const auto bit{index % BitsPerWord};
+      const auto higherBits{bit == BitsPerWord - 1 ? Word_t{0} : bits & (~Word_t{0} << (bit + 1))};
+      if (higherBits != 0) {
+        return (word * BitsPerWord) + std::countr_zero(higherBits);
+      }
+    }
+
+    const auto nextWord{FindNextBit(m_SummaryBitmap, word)};
+    if (nextWord == NoIndex) {
+      return NoIndex;
+    }
+
+    const auto nextBits{m_Bitmap[nextWord]};
+    if constexpr (IsDescending) {
+      return (nextWord * BitsPerWord) + (BitsPerWord - 1 - std::countl_zero(nextBits));
+    } else {
+      return (nextWord * BitsPerWord) + std::countr_zero(nextBits);
+    }
+  }
+
+  PriceType_t m_MinPrice{};
+  PriceType_t m_TickSize{};
+
+  std::vector<std::optional<value_type>> m_Levels;
+  std::vector<Word_t> m_Bitmap;
+  std::vector<Word_t> m_SummaryBitmap;
+
+  size_type m_BestIndex{NoIndex};
+  size_type m_Size{};
+};
+
+}   // namespace moboware::modules
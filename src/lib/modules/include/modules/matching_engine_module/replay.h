@@ -0,0 +1,88 @@
+#pragma once
+#include "common/channel_interface.h"
+#include "modules/matching_engine_module/journal.h"
+#include "modules/matching_engine_module/matching_engine.h"
+#include <functional>
+#include <string_view>
+
+namespace moboware::modules {
+
+/// @brief Channel that receives the replies of a replay instead of the sessions. The replies are counted and folded into a
+/// checksum, two replays of the same inputs into the same engine give the same checksum, so a replay verifies that a change of
+/// the engine does not change its output.
+class ReplayChannel : public common::ChannelInterface {
+public:
+  ReplayChannel() = default;
+  ReplayChannel(const ReplayChannel &) = delete;
+  ReplayChannel(ReplayChannel &&) = delete;
+  ReplayChannel &operator=(const ReplayChannel &) = delete;
+  ReplayChannel &operator=(ReplayChannel &&) = delete;
+  ~ReplayChannel() override = default;
+
+  void SendWebSocketData(const boost::asio::const_buffer &sendBuffer, const boost::asio::ip::tcp::endpoint &endpoint) override;
+
+  [[nodiscard]] inline auto GetReplyCount() const noexcept -> std::uint64_t
+  {
+    return m_ReplyCount;
+  }
+
+  /// @brief FNV-1a hash of the bytes of all replies, in the order they are sent
+  [[nodiscard]] inline auto GetChecksum() const noexcept -> std::uint64_t
+  {
+    return m_Checksum;
+  }
+
+private:
+  static constexpr std::uint64_t FnvOffsetBasis{14695981039346656037ull};
+  static constexpr std::uint64_t FnvPrime{1099511628211ull};
+
+  std::uint64_t m_ReplyCount{};
+  std::uint64_t m_Checksum{FnvOffsetBasis};
+};
+
+/// @brief Deterministic replay of the journal records into the matching engines, without sessions and at the speed of the
+/// matching engines.
+/// The order entry records are executed with the order id, the order time and the session of the journaled input, the expiries
+/// at the time they were journaled, so the engine makes the same decisions as when the inputs were executed live. A record that
+/// is already in the order books of an engine, because the engine is loaded from a snapshot, is skipped on its input sequence.
+class JournalReplay {
+public:
+  /// @brief Get the matching engine of the instrument, nullptr when the instrument is not replayed
+  using GetMatchingEngineFn_t = std::function<IMatchingEngine *(const std::string_view instrument)>;
+
+  struct Stats {
+    std::uint64_t records{};
+    std::uint64_t appliedRecords{};
+    std::uint64_t skippedRecords{};             // records that are already in the snapshot of the engine
+    std::uint64_t unknownInstrumentRecords{};   // records of instruments that are not replayed
+    /// @brief records after which the input sequence of the engine is not the journaled input sequence, the engine did not take
+    /// the same decision as live or records are missing
+    std::uint64_t divergedRecords{};
+  };
+
+  explicit JournalReplay(const GetMatchingEngineFn_t &getMatchingEngineFn);
+  JournalReplay(const JournalReplay &) = delete;
+  JournalReplay(JournalReplay &&) = delete;
+  JournalReplay &operator=(const JournalReplay &) = delete;
+  JournalReplay &operator=(JournalReplay &&) = delete;
+  ~JournalReplay() = default;
+
+  /// @brief Execute one journal record on the matching engine of its instrument
+  void Apply(const journal::RecordHeader &recordHeader);
+
+  /// @brief Execute all records of the journal
+  /// @return number of read records
+  auto Replay(JournalReader &journalReader) -> std::uint64_t;
+
+  [[nodiscard]] inline auto GetStats() const noexcept -> const Stats &
+  {
+    return m_Stats;
+  }
+
+private:
+  void Execute(IMatchingEngine &matchingEngine, const journal::RecordHeader &recordHeader);
+
+  const GetMatchingEngineFn_t m_GetMatchingEngineFn;
+  Stats m_Stats;
+};
+}   // namespace moboware::modules
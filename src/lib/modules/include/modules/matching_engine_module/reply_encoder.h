@@ -0,0 +1,51 @@
+#pragma once
+#include "modules/matching_engine_module/order_data.h"
+#include <boost/asio/buffer.hpp>
+#include <fmt/format.h>
+
+namespace moboware::modules {
+
+/// @brief Encodes the replies and the market data of the matching engine into a reused output buffer, json with compile time format strings or the
+/// binary reply messages of the order entry protocol.
+/// The buffer is overwritten by the next reply, the encoded reply is valid until then. The buffer only allocates when a reply
+/// does not fit in the inline storage, so in steady state encoding a reply does not allocate.
+class ReplyEncoder {
+public:
+  static constexpr std::size_t InlineBufferSize{512};
+
+  ReplyEncoder() = default;
+  ReplyEncoder(const ReplyEncoder &) = delete;
+  ReplyEncoder(ReplyEncoder &&) = delete;
+  ReplyEncoder &operator=(const ReplyEncoder &) = delete;
+  ReplyEncoder &operator=(ReplyEncoder &&) = delete;
+  ~ReplyEncoder() = default;
+
+  [[nodiscard]] inline auto GetFormat() const noexcept
+  {
+    return m_Format;
+  }
+
+  /// @brief set the format of the next replies, the format of the order entry message that is replied to
+  inline void SetFormat(const ReplyFormat format) noexcept
+  {
+    m_Format = format;
+  }
+
+  [[nodiscard]] auto Encode(const OrderReply &orderReply) -> boost::asio::const_buffer;
+  [[nodiscard]] auto Encode(const Trade &trade) -> boost::asio::const_buffer;
+  [[nodiscard]] auto Encode(const ErrorReply &errorReply) -> boost::asio::const_buffer;
+  [[nodiscard]] auto Encode(const LevelUpdate &levelUpdate) -> boost::asio::const_buffer;
+  [[nodiscard]] auto Encode(const PublicTrade &publicTrade) -> boost::asio::const_buffer;
+
+private:
+  template <typename TMessage, typename TReply> void EncodeBinary(const TReply &reply);
+
+  [[nodiscard]] inline auto GetBuffer() const noexcept -> boost::asio::const_buffer
+  {
+    return {m_Buffer.data(), m_Buffer.size()};
+  }
+
+  ReplyFormat m_Format{ReplyFormat::Json};
+  fmt::basic_memory_buffer<char, InlineBufferSize> m_Buffer;
+};
+}   // namespace moboware::modules
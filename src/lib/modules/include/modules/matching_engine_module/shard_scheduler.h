@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace moboware::modules {
+
+/// @brief Shard scheduler, spreads the instruments over the cpus of the engine threads with a consistent hash ring.
+/// Behaviour:
+///   - Every cpu gets a number of virtual nodes on the hash ring, an instrument is scheduled on the cpu of the first virtual node
+///     at or after the hash of the instrument name.
+///   - The hash of the instrument name is stable across runs and platforms, an instrument runs on the same cpu after a restart
+///     with the same configuration.
+///   - Adding a cpu only moves the instruments that hash onto the virtual nodes of the new cpu, the other instruments stay
+///     on their cpu.
+class ShardScheduler {
+public:
+  static constexpr std::size_t DefaultVirtualNodesPerCpu{128};
+
+  explicit ShardScheduler(const std::vector<int> &cpus, const std::size_t virtualNodesPerCpu = DefaultVirtualNodesPerCpu);
+  ShardScheduler(const ShardScheduler &) = delete;
+  ShardScheduler(ShardScheduler &&) = default;
+  ShardScheduler &operator=(const ShardScheduler &) = delete;
+  ShardScheduler &operator=(ShardScheduler &&) = default;
+  ~ShardScheduler() = default;
+
+  /// @brief Get the cpu the instrument is scheduled on
+  /// @param instrument
+  /// @return cpu or no value when the scheduler has no cpus
+  [[nodiscard]] auto GetCpu(const std::string_view instrument) const -> std::optional<int>;
+
+  [[nodiscard]] inline auto GetCpus() const -> const std::vector<int> &
+  {
+    return m_Cpus;
+  }
+
+  /// @brief 64 bits FNV-1a hash with a final avalanche mix, stable across runs unlike std::hash
+  [[nodiscard]] static auto Hash(const std::string_view key) noexcept -> std::uint64_t;
+
+private:
+  std::vector<int> m_Cpus;
+  std::vector<std::pair<std::uint64_t, int>> m_HashRing;   // virtual node hash -> cpu, sorted on the hash
+};
+}   // namespace moboware::modules
@@ -0,0 +1,159 @@
+#pragma once
+#include "modules/matching_engine_module/journal.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace moboware::modules {
+
+/// @brief Binary layout of a snapshot of the order books of one matching engine.
+/// A snapshot file starts with a SnapshotHeader, followed by the sessions of the resting orders in handle order and the resting
+/// orders of both sides, level by level. The levels are in no particular order, the orders of a level are in time priority so
+/// inserting them in file order rebuilds the time queues of the levels. The input sequence of the header is the sequence of the last input in the snapshot, a replay of the
+/// journal continues with the records after it.
+namespace snapshot {
+
+static constexpr std::array<char, 8> SnapshotMagic{'M', 'B', 'S', 'N', 'A', 'P', '\0', '\0'};
+static constexpr std::uint32_t SnapshotVersion{1};
+
+#pragma pack(push, 1)
+
+struct SnapshotHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t headerLength;
+  binary::Instrument_t instrument;
+  std::uint64_t inputSequence;   // sequence of the last input of the matching engine in the snapshot
+  std::uint64_t lastOrderId;     // last engine assigned order id
+  std::uint64_t expiryTick;      // current tick of the expiry wheel, milli seconds
+  std::int64_t createTime;       // system clock nano seconds
+  std::uint32_t sessionCount;
+  std::uint32_t orderCount;
+};
+
+/// @brief session of the resting orders, the handle of a session is its position in the file starting at 1. A released handle is
+/// written as an empty session.
+struct SnapshotSession {
+  journal::Session session;
+  ReplyFormat replyFormat;
+  std::uint8_t reserved[5];
+};
+
+struct SnapshotOrder {
+  std::uint64_t orderId;   // engine assigned order id
+  std::uint64_t price;
+  std::uint64_t volume;
+  std::int64_t orderTime;       // high resolution clock nano seconds
+  std::int32_t orderDuration;   // milli seconds, 0 when the order is not good till date
+  std::uint32_t session;
+  OrderType type;
+  std::uint8_t isBuySide;
+  std::uint8_t reserved[6];
+  binary::Account_t account;
+  binary::Instrument_t instrument;
+  binary::OrderIdString_t id;
+  binary::ClientIdString_t clientId;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(SnapshotHeader) == 72);
+static_assert(sizeof(SnapshotSession) == 24);
+static_assert(sizeof(SnapshotOrder) == 144);
+
+/// @brief orders of one price level in time priority. A level is immutable once it is captured, the images of consecutive
+/// snapshots share the levels that did not change in between.
+using SnapshotLevel_t = std::shared_ptr<const std::vector<SnapshotOrder>>;
+
+/// @brief Copy of the order books of a matching engine at an input sequence, captured by the single writer of the engine and
+/// written to a file by an other thread
+struct SnapshotImage {
+  std::string instrument;
+  std::uint64_t inputSequence{};
+  std::uint64_t lastOrderId{};
+  std::uint64_t expiryTick{};
+  std::vector<SnapshotSession> sessions;   // handle order, starting at handle 1
+  std::vector<SnapshotLevel_t> levels;
+  bool isTruncated{};   // a symbol or id did not fit in its fixed length field
+};
+
+/// @brief file name of the snapshot of the instrument at the input sequence, the names of an instrument sort on the sequence
+[[nodiscard]] auto GetSnapshotFileName(const std::string_view instrument, const std::uint64_t inputSequence) -> std::string;
+
+/// @brief Find the snapshot of the instrument with the highest input sequence in the directory
+/// @return path of the snapshot or no value when the directory has no snapshot of the instrument
+[[nodiscard]] auto FindLatestSnapshot(const std::string &directory, const std::string_view instrument) -> std::optional<std::string>;
+
+/// @brief paths of the snapshots of the instrument in the directory, from the lowest to the highest input sequence
+[[nodiscard]] auto ListSnapshots(const std::string &directory, const std::string_view instrument) -> std::vector<std::string>;
+
+/// @brief Write the image into a snapshot file in the directory. The snapshot is written into a temporary file that is renamed
+/// when it is complete, a crash never leaves a partial snapshot.
+/// @return false when the snapshot can not be written, the error is logged
+[[nodiscard]] bool WriteSnapshotFile(const SnapshotImage &image, const std::string &directory);
+
+/// @brief Writer thread of the periodic snapshots of the matching engines.
+/// The engines only capture the levels that changed since their previous snapshot and queue the image, the file is written and
+/// synced on the writer thread so matching is not stalled by the size of the order books or the disk. An image that is still
+/// queued when the next image of the same instrument arrives is replaced, a slow disk skips snapshots instead of queueing them.
+/// After a snapshot is written the oldest snapshots of the instrument are removed, the latest snapshots are kept.
+class SnapshotWriter {
+public:
+  /// @brief statistics of the writer, the counters are totals since the writer is started
+  struct Stats {
+    std::uint64_t writtenSnapshots{};
+    std::uint64_t failedSnapshots{};
+    std::uint64_t replacedSnapshots{};   // images that are replaced by a newer image before they were written
+  };
+
+  /// @brief start the writer thread
+  /// @param directory, directory of the snapshot files
+  /// @param keepSnapshots, number of snapshots that are kept per instrument, at least 1
+  explicit SnapshotWriter(const std::string &directory, const std::size_t keepSnapshots = 2);
+  SnapshotWriter(const SnapshotWriter &) = delete;
+  SnapshotWriter(SnapshotWriter &&) = delete;
+  SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+  SnapshotWriter &operator=(SnapshotWriter &&) = delete;
+  /// @brief stops the writer thread after the queued images are written
+  ~SnapshotWriter() = default;
+
+  /// @brief Queue the image of a matching engine, can be called from multiple threads
+  void Write(SnapshotImage &&image);
+
+  /// @brief Get the statistics, can be called from any thread
+  [[nodiscard]] auto GetStats() const noexcept -> Stats;
+
+  [[nodiscard]] inline auto GetDirectory() const noexcept -> const std::string &
+  {
+    return m_Directory;
+  }
+
+private:
+  void Run(const std::stop_token &stopToken);
+  /// @brief remove the snapshots of the instrument that are older than the kept snapshots
+  void RemoveOldSnapshots(const std::string_view instrument);
+
+  const std::string m_Directory;
+  const std::size_t m_KeepSnapshots{};
+
+  std::mutex m_Mutex;
+  std::condition_variable_any m_ImageAvailable;
+  std::deque<SnapshotImage> m_Images;
+
+  std::atomic<std::uint64_t> m_WrittenSnapshots{};
+  std::atomic<std::uint64_t> m_FailedSnapshots{};
+  std::atomic<std::uint64_t> m_ReplacedSnapshots{};
+
+  std::jthread m_Thread;   // started last, joined first
+};
+}   // namespace snapshot
+}   // namespace moboware::modules
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace moboware::modules {
+
+using SymbolHandle_t = std::uint32_t;
+
+/// @brief Interning table of symbols like accounts and instruments. Every distinct symbol gets a small integer handle, so the
+/// resting orders keep a handle instead of a string and comparing symbols is an integer compare.
+/// Behaviour:
+///   - Handle 0 is the empty symbol
+///   - Handles are never released, the symbol references returned by GetSymbol stay valid for the lifetime of the table
+class SymbolTable {
+public:
+  static constexpr SymbolHandle_t EmptySymbolHandle{0};
+
+  SymbolTable();
+  SymbolTable(const SymbolTable &) = delete;
+  SymbolTable(SymbolTable &&) = delete;
+  SymbolTable &operator=(const SymbolTable &) = delete;
+  SymbolTable &operator=(SymbolTable &&) = delete;
+  ~SymbolTable() = default;
+
+  /// @brief Get the handle of the symbol, the symbol is added to the table when it is not known yet
+  /// @param symbol
+  /// @return handle
+  [[nodiscard]] auto Intern(const std::string_view symbol) -> SymbolHandle_t;
+
+  /// @brief Find the handle of a symbol without adding it
+  /// @param symbol
+  /// @return handle or no value when the symbol is not in the table
+  [[nodiscard]] auto Find(const std::string_view symbol) const -> std::optional<SymbolHandle_t>;
+
+  /// @brief Get the symbol of a handle
+  /// @param handle
+  /// @return symbol, the empty symbol for an unknown handle
+  [[nodiscard]] auto GetSymbol(const SymbolHandle_t handle) const -> const std::string &;
+
+  [[nodiscard]] inline auto GetSize() const -> std::size_t
+  {
+    return m_Symbols.size();
+  }
+
+private:
+  struct StringHash {
+    using is_transparent = void;
+
+    [[nodiscard]] inline std::size_t operator()(const std::string_view symbol) const noexcept
+    {
+      return std::hash<std::string_view>{}(symbol);
+    }
+  };
+
+  std::unordered_map<std::string, SymbolHandle_t, StringHash, std::equal_to<>> m_Handles;
+  std::deque<std::string> m_Symbols;   // handle -> symbol, the deque keeps the references stable when growing
+};
+}   // namespace moboware::modules
@@ -0,0 +1,314 @@
+#include "modules/matching_engine_module/journal.h"
+#include "common/logger.hpp"
+#include "common/thread_affinity.h"
+#include <algorithm>
+#include <filesystem>
+
+using namespace moboware::modules;
+using namespace moboware::modules::journal;
+
+auto moboware::modules::journal::ToSession(const boost::asio::ip::tcp::endpoint &endpoint) -> Session
+{
+  const auto address{endpoint.address().is_v4()
+                       ? boost::asio::ip::make_address_v6(boost::asio::ip::v4_mapped, endpoint.address().to_v4())
+                       : endpoint.address().to_v6()};
+  const auto addressBytes{address.to_bytes()};
+
+  Session session{};
+  std::copy(std::begin(addressBytes), std::end(addressBytes), session.address);
+  session.port = endpoint.port();
+  return session;
+}
+
+auto moboware::modules::journal::ToEndpoint(const Session &session) -> boost::asio::ip::tcp::endpoint
+{
+  boost::asio::ip::address_v6::bytes_type addressBytes;
+  std::copy(std::begin(session.address), std::end(session.address), std::begin(addressBytes));
+  const boost::asio::ip::address_v6 address(addressBytes);
+
+  if (address.is_v4_mapped()) {
+    return {boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, address), session.port};
+  }
+  return {address, session.port};
+}
+
+auto moboware::modules::journal::GetSegmentFileName(const std::uint64_t firstSequence) -> std::string
+{
+  return fmt::format("journal_{:020}.bin", firstSequence);
+}
+
+auto moboware::modules::ToFsyncPolicy(const std::string_view policy) -> std::optional<FsyncPolicy>
+{
+  if (policy == "None") {
+    return FsyncPolicy::None;
+  } else if (policy == "Interval") {
+    return FsyncPolicy::Interval;
+  } else if (policy == "Batch") {
+    return FsyncPolicy::Batch;
+  }
+  return std::nullopt;
+}
+
+Journal::Journal(const JournalConfig &config)
+  : m_Config(config)
+  , m_NextSequence(config.firstSequence)
+{
+}
+
+bool Journal::Open()
+{
+  std::error_code ec;
+  std::filesystem::create_directories(m_Config.directory, ec);
+  if (ec) {
+    LOG_ERROR("Failed to create journal directory {}, {}", m_Config.directory, ec.message());
+    return false;
+  }
+
+  if (not CreateSegment()) {
+    return false;
+  }
+
+  m_Thread = std::jthread([this](const std::stop_token &stopToken) { Run(stopToken); });
+  return true;
+}
+
+template <typename TRecord>
+auto Journal::InitRecord(const std::uint64_t inputSequence, const std::string_view instrument, const std::int64_t time) -> TRecord
+{
+  TRecord record;
+  std::memset(&record, 0, sizeof(TRecord));
+  record.header.length = sizeof(TRecord);
+  record.header.type = TRecord::Type;
+  record.header.inputSequence = inputSequence;
+  record.header.time = time;
+  if (not record.header.instrument.Assign(instrument)) {
+    LOG_WARN("Journal record instrument truncated, instrument:{}", instrument);
+  }
+  return record;
+}
+
+void Journal::Append(const std::uint64_t inputSequence, const OrderInsertData &orderInsert, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  auto record{InitRecord<InsertRecord>(inputSequence, orderInsert.GetInstrument(), ToJournalTime(orderInsert.GetOrderTime()))};
+  record.header.replyFormat = orderInsert.GetReplyFormat();
+  record.header.session = ToSession(endpoint);
+  if (not binary::Encode(orderInsert, record.message) or not record.id.Assign(orderInsert.GetId())) {
+    LOG_WARN("Journal insert record field truncated, id:{}", orderInsert.GetId());
+  }
+  Push(record);
+}
+
+void Journal::Append(const std::uint64_t inputSequence, const OrderAmendData &orderAmend, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  auto record{InitRecord<AmendRecord>(inputSequence, orderAmend.GetInstrument(), ToJournalTime(orderAmend.GetOrderTime()))};
+  record.header.replyFormat = orderAmend.GetReplyFormat();
+  record.header.session = ToSession(endpoint);
+  if (not binary::Encode(orderAmend, record.message)) {
+    LOG_WARN("Journal amend record field truncated, id:{}", orderAmend.GetId());
+  }
+  Push(record);
+}
+
+void Journal::Append(const std::uint64_t inputSequence, const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  auto record{InitRecord<CancelRecord>(inputSequence, orderCancel.GetInstrument(), ToJournalTime(std::chrono::high_resolution_clock::now()))};
+  record.header.replyFormat = orderCancel.GetReplyFormat();
+  record.header.session = ToSession(endpoint);
+  if (not binary::Encode(orderCancel, record.message)) {
+    LOG_WARN("Journal cancel record field truncated, id:{}", orderCancel.GetId());
+  }
+  Push(record);
+}
+
+void Journal::Append(const std::uint64_t inputSequence,
+                     const std::string_view instrument,
+                     const OrderMassCancelData &orderMassCancel,
+                     const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  auto record{InitRecord<MassCancelRecord>(inputSequence, instrument, ToJournalTime(std::chrono::high_resolution_clock::now()))};
+  record.header.replyFormat = orderMassCancel.GetReplyFormat();
+  record.header.session = ToSession(endpoint);
+  if (not binary::Encode(orderMassCancel, record.message)) {
+    LOG_WARN("Journal mass cancel record field truncated, client id:{}", orderMassCancel.GetClientId());
+  }
+  Push(record);
+}
+
+void Journal::AppendCancelSessionOrders(const std::uint64_t inputSequence,
+                                        const std::string_view instrument,
+                                        const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  auto record{InitRecord<CancelSessionOrdersRecord>(inputSequence, instrument, ToJournalTime(std::chrono::high_resolution_clock::now()))};
+  record.header.session = ToSession(endpoint);
+  Push(record);
+}
+
+void Journal::AppendExpireOrders(const std::uint64_t inputSequence, const std::string_view instrument, const OrderTime_t now)
+{
+  Push(InitRecord<ExpireOrdersRecord>(inputSequence, instrument, ToJournalTime(now)));
+}
+
+auto Journal::GetStats() const noexcept -> Stats
+{
+  return Stats{m_WrittenRecords.load(std::memory_order_relaxed),
+               m_RingFullCount.load(std::memory_order_relaxed),
+               m_SyncCount.load(std::memory_order_relaxed),
+               m_SegmentCount.load(std::memory_order_relaxed)};
+}
+
+void Journal::Run(const std::stop_token &stopToken)
+{
+  common::SetThreadName("journal");
+
+  bool isWriteFailed{false};
+  const auto writeFn{[&](const Entry &entry) {
+    if (not isWriteFailed and not Write(entry)) {
+      isWriteFailed = true;
+      LOG_ERROR("Journal writer failed, the next records are not journaled");
+    }
+  }};
+
+  // the ring is drained after the stop request, the producers are stopped before the journal
+  bool isStopped{false};
+  while (not isStopped) {
+    isStopped = stopToken.stop_requested();
+
+    std::uint64_t writtenRecords{};
+    while (m_Ring.Pop(writeFn)) {
+      writtenRecords++;
+    }
+
+    if (writtenRecords > 0) {
+      m_WrittenRecords.fetch_add(writtenRecords, std::memory_order_relaxed);
+      m_LastSequence.store(m_NextSequence - 1, std::memory_order_release);
+    }
+
+    if (m_Config.fsyncPolicy == FsyncPolicy::Batch or
+        (m_Config.fsyncPolicy == FsyncPolicy::Interval and std::chrono::steady_clock::now() - m_LastSyncTime >= m_Config.fsyncInterval)) {
+      Sync();
+    }
+
+    if (writtenRecords == 0 and not isStopped) {
+      std::this_thread::sleep_for(WriterIdleSleep);
+    }
+  }
+
+  CloseSegment();
+  LOG_INFO("Journal writer stopped, last sequence:{}", m_NextSequence - 1);
+}
+
+bool Journal::CreateSegment()
+{
+  const auto path{(std::filesystem::path(m_Config.directory) / GetSegmentFileName(m_NextSequence)).string()};
+  if (not m_Segment.Create(path, m_Config.segmentSize)) {
+    return false;
+  }
+
+  auto &segmentHeader{*reinterpret_cast<SegmentHeader *>(m_Segment.GetData())};
+  std::copy(std::begin(SegmentMagic), std::end(SegmentMagic), segmentHeader.magic);
+  segmentHeader.version = JournalVersion;
+  segmentHeader.headerLength = sizeof(SegmentHeader);
+  segmentHeader.firstSequence = m_NextSequence;
+  segmentHeader.createTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+  m_WriteOffset = sizeof(SegmentHeader);
+  m_SyncOffset = 0;
+  m_Segment.SetUsedSize(m_WriteOffset);
+  m_SegmentCount.fetch_add(1, std::memory_order_relaxed);
+
+  LOG_INFO("Journal segment {} created", path);
+  return true;
+}
+
+void Journal::CloseSegment()
+{
+  if (not m_Segment.IsOpen()) {
+    return;
+  }
+
+  if (m_Config.fsyncPolicy != FsyncPolicy::None) {
+    Sync();
+  }
+  m_Segment.Close();
+}
+
+bool Journal::Write(const Entry &entry)
+{
+  const auto &recordHeader{*reinterpret_cast<const RecordHeader *>(entry.data.data())};
+
+  // the record does not fit, the rest of the segment stays zero and marks the end of the records
+  if (m_WriteOffset + recordHeader.length > m_Segment.GetSize()) {
+    CloseSegment();
+    if (not CreateSegment()) {
+      return false;
+    }
+  }
+
+  auto *const record{m_Segment.GetData() + m_WriteOffset};
+  std::memcpy(record, entry.data.data(), recordHeader.length);
+  reinterpret_cast<RecordHeader *>(record)->sequence = m_NextSequence++;
+
+  m_WriteOffset += recordHeader.length;
+  m_Segment.SetUsedSize(m_WriteOffset);
+  return true;
+}
+
+void Journal::Sync()
+{
+  m_LastSyncTime = std::chrono::steady_clock::now();
+  if (m_WriteOffset == m_SyncOffset) {
+    return;
+  }
+
+  m_Segment.Sync(m_SyncOffset, m_WriteOffset - m_SyncOffset);
+  m_SyncOffset = m_WriteOffset;
+  m_SyncCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool JournalReader::Open(const std::string &directory)
+{
+  m_SegmentPaths.clear();
+  m_LastSequence = 0;
+
+  std::error_code ec;
+  if (not std::filesystem::exists(directory, ec)) {
+    return true;   // nothing journaled yet
+  }
+
+  for (const auto &entry : std::filesystem::directory_iterator(directory, ec)) {
+    const auto fileName{entry.path().filename().string()};
+    if (entry.is_regular_file() and fileName.starts_with("journal_") and fileName.ends_with(".bin")) {
+      m_SegmentPaths.push_back(entry.path().string());
+    }
+  }
+
+  if (ec) {
+    LOG_ERROR("Failed to list journal directory {}, {}", directory, ec.message());
+    return false;
+  }
+
+  // the first sequence in the file name is zero padded, the names sort on the sequence
+  std::sort(std::begin(m_SegmentPaths), std::end(m_SegmentPaths));
+  return true;
+}
+
+bool JournalReader::OpenSegment(const std::string &path, common::MappedFile &segment) const
+{
+  if (not segment.Open(path)) {
+    return false;
+  }
+
+  const auto &segmentHeader{*reinterpret_cast<const SegmentHeader *>(segment.GetData())};
+  if (segment.GetSize() < sizeof(SegmentHeader) or not std::equal(std::begin(SegmentMagic), std::end(SegmentMagic), segmentHeader.magic) or
+      segmentHeader.version != JournalVersion or segmentHeader.headerLength < sizeof(SegmentHeader)) {
+    LOG_ERROR("File {} is not a journal segment of version {}", path, JournalVersion);
+    return false;
+  }
+
+  // the first segment of the directory can start at any sequence, older segments can be removed
+  if (m_LastSequence != 0 and segmentHeader.firstSequence != m_LastSequence + 1) {
+    LOG_ERROR("Journal segment {} starts at sequence {}, the last read sequence is {}", path, segmentHeader.firstSequence, m_LastSequence);
+    return false;
+  }
+  return true;
+}
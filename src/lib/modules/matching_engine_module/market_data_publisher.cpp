@@ -0,0 +1,72 @@
+#include "modules/matching_engine_module/market_data_publisher.h"
+#include "common/logger.hpp"
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+using namespace moboware::modules;
+
+MarketDataPublisher::MarketDataPublisher(const std::shared_ptr<common::ChannelInterface> &channelInterface)
+  : m_ChannelInterface(channelInterface)
+{
+}
+
+void MarketDataPublisher::Subscribe(const boost::asio::ip::tcp::endpoint &endpoint, const ReplyFormat format)
+{
+  Unsubscribe(endpoint);
+  m_Subscribers[static_cast<std::size_t>(format)].push_back(endpoint);
+  LOG_INFO("Market data subscribed {}:{}, subscribers:{}", endpoint.address().to_string(), endpoint.port(), GetNumberOfSubscribers());
+}
+
+bool MarketDataPublisher::Unsubscribe(const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  for (auto &endpoints : m_Subscribers) {
+    const auto iter{std::find(std::begin(endpoints), std::end(endpoints), endpoint)};
+    if (iter != std::end(endpoints)) {
+      endpoints.erase(iter);
+      return true;
+    }
+  }
+  return false;
+}
+
+auto MarketDataPublisher::GetNumberOfSubscribers() const noexcept -> std::size_t
+{
+  std::size_t numberOfSubscribers{};
+  for (const auto &endpoints : m_Subscribers) {
+    numberOfSubscribers += endpoints.size();
+  }
+  return numberOfSubscribers;
+}
+
+template <typename TUpdate> void MarketDataPublisher::PublishUpdate(const TUpdate &update, const common::ConflationKey_t conflationKey)
+{
+  for (std::size_t format{}; format < m_Subscribers.size(); format++) {
+    const auto &endpoints{m_Subscribers[format]};
+    if (endpoints.empty()) {
+      continue;
+    }
+
+    // encoded once, the same buffer is queued on all sessions of the format
+    m_Encoder.SetFormat(static_cast<ReplyFormat>(format));
+    const auto buffer{m_Encoder.Encode(update)};
+    m_ChannelInterface->PublishWebSocketData(common::MakeSharedBuffer(static_cast<const char *>(buffer.data()), buffer.size()), endpoints, conflationKey);
+  }
+}
+
+void MarketDataPublisher::Publish(const LevelUpdate &levelUpdate)
+{
+  // a level update is the latest state of its price level, a slow consumer may skip the older updates of the level
+  auto conflationKey{std::hash<std::string_view>{}(levelUpdate.instrument) ^
+                     ((static_cast<common::ConflationKey_t>(levelUpdate.price) << 1 | (levelUpdate.isBuySide ? 1 : 0)) * 0x9e3779b97f4a7c15)};
+  if (conflationKey == common::NoConflationKey) {
+    conflationKey = 1;
+  }
+  PublishUpdate(levelUpdate, conflationKey);
+}
+
+void MarketDataPublisher::Publish(const PublicTrade &publicTrade)
+{
+  // every trade is sent
+  PublishUpdate(publicTrade, common::NoConflationKey);
+}
@@ -1,108 +1,403 @@
 #include "modules/matching_engine_module/matching_engine.h"
 #include "common/logger.hpp"
+#include "common/mapped_file.h"
+#include <algorithm>
+#include <tuple>
 
 using namespace moboware::modules;
 
-MatchingEngine::MatchingEngine(const std::shared_ptr<common::ChannelInterface> &channelInterface)
+auto moboware::modules::ToSelfTradePrevention(const std::string_view selfTradePrevention) -> std::optional<SelfTradePrevention>
+{
+  if (selfTradePrevention == "None") {
+    return SelfTradePrevention::None;
+  } else if (selfTradePrevention == "CancelNewest") {
+    return SelfTradePrevention::CancelNewest;
+  } else if (selfTradePrevention == "CancelOldest") {
+    return SelfTradePrevention::CancelOldest;
+  } else if (selfTradePrevention == "DecrementBoth") {
+    return SelfTradePrevention::DecrementBoth;
+  }
+  return std::nullopt;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::BasicMatchingEngine(const std::shared_ptr<common::ChannelInterface> &channelInterface,
+                                                                       const std::string &instrument,
+                                                                       const PriceLadderConfig &priceLadderConfig)
   : m_ChannelInterface(channelInterface)
+  , m_Instrument(instrument)
+  , m_Sessions(1)
+  , m_Bids(priceLadderConfig)
+  , m_Asks(priceLadderConfig)
+  , m_ExpiryWheel(ToExpiryTick(std::chrono::high_resolution_clock::now()))
+  , m_MarketDataPublisher(channelInterface)
 {
 }
 
-void MatchingEngine::CreateAndSendMessage(const OrderReply &orderInsertReply, const boost::asio::ip::tcp::endpoint &endpoint)
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::CreateAndSendMessage(const OrderReply &orderInsertReply,
+                                                                             const boost::asio::ip::tcp::endpoint &endpoint)
 {
-  // sendBuffer
-  std::ostringstream strm;
-  strm << orderInsertReply;
+  m_ChannelInterface->SendWebSocketData(m_ReplyEncoder.Encode(orderInsertReply), endpoint);
+}
 
-  const auto s{strm.view()};
-  const boost::asio::const_buffer sendBuffer(s.data(), s.size());
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::CreateAndSendMessage(const Trade &trade, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  m_ChannelInterface->SendWebSocketData(m_ReplyEncoder.Encode(trade), endpoint);
+}
 
-  m_ChannelInterface->SendWebSocketData(sendBuffer, endpoint);
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::CreateAndSendMessage(const ErrorReply &errorReply,
+                                                                             const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  m_ChannelInterface->SendWebSocketData(m_ReplyEncoder.Encode(errorReply), endpoint);
 }
 
-void MatchingEngine::CreateAndSendMessage(const Trade &trade, const boost::asio::ip::tcp::endpoint &endpoint)
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::OrderInsert(OrderInsertData &&orderInsert,
+                                                                    const boost::asio::ip::tcp::endpoint &endpoint)
 {
-  // sendBuffer
-  std::ostringstream strm;
-  strm << trade;
+  // the scalar fields are encoded by value, the order is not formatted on the engine thread
+  LOG_INFO("OrderInsert id:{}, clientId:{}, account:{}, price:{}, volume:{}, side:{}, type:{}",
+           orderInsert.GetId(),
+           orderInsert.GetClientId(),
+           orderInsert.GetAccount(),
+           orderInsert.GetPrice(),
+           orderInsert.GetVolume(),
+           orderInsert.GetIsBuySide() ? 'B' : 'S',
+           ToString(orderInsert.GetType()));
+  m_InputSequence++;
+  if (m_Journal) {
+    m_Journal->Append(m_InputSequence, orderInsert, endpoint);
+  }
+  m_ReplyEncoder.SetFormat(orderInsert.GetReplyFormat());
+
+  if (not IsValidOrderDuration(orderInsert.GetOrderDuration())) {
+    const ErrorReply errorReply{orderInsert.GetClientId(), "Order duration out of range"};
+    CreateAndSendMessage(errorReply, endpoint);
+    return;
+  }
 
-  const auto s{strm.view()};
-  const boost::asio::const_buffer sendBuffer(s.data(), s.size());
+  // convert the order entry data into the compact resting order record, the order gets the next order id that is only taken
+  // when the order is accepted
+  const auto order{ToOrder(orderInsert, m_LastOrderId + 1, m_SymbolTable)};
+  if (not order) {
+    const ErrorReply errorReply{orderInsert.GetClientId(), "Invalid order type"};
+    CreateAndSendMessage(errorReply, endpoint);
+    return;
+  }
 
-  m_ChannelInterface->SendWebSocketData(sendBuffer, endpoint);
+  // the order is matched against the other side before it is inserted, only the left volume of a resting order type touches the
+  // order book of its own side
+  order->GetIsBuySide() ? InsertOrder(m_Asks, m_Bids, *order, orderInsert, endpoint)
+                        : InsertOrder(m_Bids, m_Asks, *order, orderInsert, endpoint);
+  PublishChangedLevels();
 }
 
-void MatchingEngine::CreateAndSendMessage(const ErrorReply &errorReply, const boost::asio::ip::tcp::endpoint &endpoint)
+template <typename TOrderBidBook, typename TOrderAskBook>
+template <typename TOppositeOrderBook, typename TOrderBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::InsertOrder(TOppositeOrderBook &oppositeSideOrderBook,
+                                                                    TOrderBook &mySideOrderBook,
+                                                                    const Order &order,
+                                                                    const OrderInsertData &orderInsert,
+                                                                    const boost::asio::ip::tcp::endpoint &endpoint)
 {
-  // sendBuffer
-  std::ostringstream strm;
-  strm << errorReply;
+  const auto type{order.GetType()};
+  // a stop order has no trigger in the engine, it would rest as a limit order
+  if (type == OrderType::Stop) {
+    const ErrorReply errorReply{orderInsert.GetClientId(), "Stop order is not supported"};
+    CreateAndSendMessage(errorReply, endpoint);
+    return;
+  }
+
+  // the order ids are unique per matching engine, an amend or cancel finds the order on either side
+  if (IsRestingOrderId(orderInsert.GetId())) {
+    const ErrorReply errorReply{orderInsert.GetClientId(), "Order id already in use"};
+    CreateAndSendMessage(errorReply, endpoint);
+    return;
+  }
+
+  if (type == OrderType::PostOnly and GetMatchVolume(oppositeSideOrderBook, order) > 0) {
+    const ErrorReply errorReply{orderInsert.GetClientId(), "Post only order would trade"};
+    CreateAndSendMessage(errorReply, endpoint);
+    return;
+  }
+
+  // with self trade prevention an own resting order stops the fill, a fill or kill order that meets one is not filled
+  if (type == OrderType::FillOrKill and
+      (m_SelfTradePrevention == SelfTradePrevention::None ? GetMatchVolume(oppositeSideOrderBook, order)
+                                                          : GetMatchVolumeBeforeSelfTrade(oppositeSideOrderBook, order)) < order.GetVolume()) {
+    const ErrorReply errorReply{orderInsert.GetClientId(), "Fill or kill order can not be filled"};
+    CreateAndSendMessage(errorReply, endpoint);
+    return;
+  }
+
+  // send order insert reply, the order is accepted and takes its order id
+  m_LastOrderId = order.GetId();
+  const OrderReply orderInsertReply{orderInsert.GetId(), orderInsert.GetClientId()};
+  CreateAndSendMessage(orderInsertReply, endpoint);
+  LOG_INFO("OrderReply id:{}, clientId:{}", orderInsertReply.GetId(), orderInsertReply.GetClientId());
+
+  const auto leftVolume{MatchOrder(oppositeSideOrderBook, order, orderInsert, endpoint)};
+  if (leftVolume == 0 or type == OrderType::FillOrKill) {
+    return;   // filled
+  }
+
+  if (type == OrderType::Market or type == OrderType::ImmediateOrCancel) {
+    // the left volume is cancelled, the cancel reply follows the trades
+    const OrderReply orderCancelReply{orderInsert.GetId(), orderInsert.GetClientId()};
+    CreateAndSendMessage(orderCancelReply, endpoint);
+    LOG_INFO("Left volume:{} of order {} cancelled", leftVolume, orderInsert.GetId());
+    return;
+  }
 
-  const auto s{strm.view()};
-  const boost::asio::const_buffer sendBuffer(s.data(), s.size());
+  auto restingOrder{order};
+  restingOrder.SetVolume(leftVolume);
+  const auto session{GetSessionHandle(endpoint, orderInsert.GetReplyFormat())};
+  const auto *const node{mySideOrderBook.Insert(restingOrder, orderInsert.GetId(), orderInsert.GetClientId(), session)};
+  if (not node) {
+    // send error back
+    const ErrorReply errorReply{orderInsert.GetClientId(), "Failed to insert order"};
+    CreateAndSendMessage(errorReply, endpoint);
+    return;
+  }
 
-  m_ChannelInterface->SendWebSocketData(sendBuffer, endpoint);
+  if (order.GetOrderDuration().count() > 0) {
+    AddExpiry(*node, orderInsert.GetReplyFormat(), endpoint);
+  }
+  SetLevelChanged(order.GetIsBuySide(), order.GetPrice());
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::AddExpiry(const OrderNode &node,
+                                                                  const ReplyFormat format,
+                                                                  const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  const auto expiryTime{node.order.GetOrderTime() + node.order.GetOrderDuration()};
+  m_ExpiryWheel.Add(ToExpiryTick(expiryTime), Expiry{&node, node.order.GetId(), format, endpoint});
 }
 
-void MatchingEngine::OrderInsert(OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint)
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ExpireOrders(const OrderTime_t now)
 {
-  std::scoped_lock lock(m_Mutex);
+  m_ExpiryWheel.Advance(ToExpiryTick(now), [this](const Expiry &expiry) {
+    // the order is traded or cancelled before it expired when the node has an other or no order
+    if (expiry.node->order.GetId() == expiry.orderId) {
+      m_ExpiredOrders.push_back(expiry);
+    }
+  });
+
+  if (m_ExpiredOrders.empty()) {
+    return;
+  }
 
-  LOG_INFO("OrderInsert:{}", orderInsert);
+  // only a turn of the wheel that expires orders changes the order book
+  m_InputSequence++;
+  if (m_Journal) {
+    m_Journal->AppendExpireOrders(m_InputSequence, m_Instrument, now);
+  }
 
-  const auto InsertOrderFn{[&](OrderInsertData &&orderInsert) {
-    return (orderInsert.GetIsBuySide() ? m_Bids.Insert(std::forward<OrderInsertData>(orderInsert))
-                                       : m_Asks.Insert(std::forward<OrderInsertData>(orderInsert)));
+  // batch the expired orders per price level, an amended order can be on an other level than it was inserted on
+  const auto levelOf{[](const Expiry &expiry) {
+    return std::tuple{expiry.node->order.GetIsBuySide(), expiry.node->order.GetPrice(), expiry.orderId};
   }};
+  std::sort(std::begin(m_ExpiredOrders), std::end(m_ExpiredOrders), [&](const Expiry &lhs, const Expiry &rhs) {
+    return levelOf(lhs) < levelOf(rhs);
+  });
+
+  for (auto first{std::begin(m_ExpiredOrders)}; first != std::end(m_ExpiredOrders);) {
+    const auto isBuySide{first->node->order.GetIsBuySide()};
+    const auto price{first->node->order.GetPrice()};
+
+    m_ExpiredNodes.clear();
+    auto last{first};
+    for (; last != std::end(m_ExpiredOrders) and last->node->order.GetIsBuySide() == isBuySide and
+           last->node->order.GetPrice() == price;
+         ++last) {
+      const auto &node{*last->node};
+      LOG_INFO("Order expired, id:{}, price:{}", node.id, price);
+
+      // the expiry is a cancel of the order, sent as a cancel reply to the session of the order
+      m_ReplyEncoder.SetFormat(last->replyFormat);
+      const OrderReply orderCancelReply{node.id, node.clientId};
+      CreateAndSendMessage(orderCancelReply, last->endpoint);
+      m_ExpiredNodes.push_back(&node);
+    }
 
-  const auto insertedOrder{InsertOrderFn(std::forward<OrderInsertData>(orderInsert))};   // order is moved and after this not valid anymore, you
-                                                                                         // should use the returned inserted order pointer
-  if (insertedOrder) {
-    // send order insert reply
-    const OrderReply orderInsertReply{insertedOrder->GetId(), insertedOrder->GetClientId()};
-    CreateAndSendMessage(orderInsertReply, endpoint);
-    LOG_INFO("OrderReply:{}", orderInsertReply);
+    // removed after the replies, the nodes are released by the order book
+    isBuySide ? m_Bids.RemoveOrders(price, m_ExpiredNodes) : m_Asks.RemoveOrders(price, m_ExpiredNodes);
+    SetLevelChanged(isBuySide, price);
+    first = last;
+  }
 
-    // check if this order has matches
-    const auto CheckMatch{[&](const OrderDataBase &newOrder, const boost::asio::ip::tcp::endpoint &endpoint) {
-      newOrder.GetIsBuySide() ?   // matches to the ask side
-        ExecuteOrder(m_Asks, m_Bids, endpoint)
-                              :   // matches to the bid side
-        ExecuteOrder(m_Bids, m_Asks, endpoint);
-    }};
+  m_ExpiredOrders.clear();
+  PublishChangedLevels();
+}
 
-    CheckMatch(orderInsert, endpoint);
-  } else {
-    // send error back
-    const ErrorReply errorReply{orderInsert.GetClientId(), "Failed to insert order"};
-    CreateAndSendMessage(errorReply, endpoint);
+template <typename TOrderBidBook, typename TOrderAskBook>
+template <typename TOppositeOrderBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::GetMatchVolume(const TOppositeOrderBook &oppositeSideOrderBook, const Order &order) const
+  -> VolumeType_t
+{
+  // the levels keep their total volume, no walk over the orders
+  VolumeType_t matchVolume{};
+  const auto &oppositeSideOrderBookMap{oppositeSideOrderBook.GetOrderBookMap()};
+  for (auto iter{std::begin(oppositeSideOrderBookMap)};
+       iter != std::end(oppositeSideOrderBookMap) and matchVolume < order.GetVolume() and IsMatchPrice(order, iter->first);
+       ++iter) {
+    matchVolume += iter->second.GetTotalVolume();
   }
+  return matchVolume;
 }
 
-void MatchingEngine::OrderAmend(const OrderAmendData &orderAmend, const boost::asio::ip::tcp::endpoint &endpoint)
+template <typename TOrderBidBook, typename TOrderAskBook>
+template <typename TOppositeOrderBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::GetMatchVolumeBeforeSelfTrade(const TOppositeOrderBook &oppositeSideOrderBook,
+                                                                                      const Order &order) const -> VolumeType_t
 {
-  std::scoped_lock lock(m_Mutex);
+  VolumeType_t matchVolume{};
+  const auto &oppositeSideOrderBookMap{oppositeSideOrderBook.GetOrderBookMap()};
+  for (auto iter{std::begin(oppositeSideOrderBookMap)};
+       iter != std::end(oppositeSideOrderBookMap) and matchVolume < order.GetVolume() and IsMatchPrice(order, iter->first);
+       ++iter) {
+    for (const auto *node{iter->second.GetTopOrder()}; node != nullptr and matchVolume < order.GetVolume(); node = node->next) {
+      if (node->order.GetAccount() == order.GetAccount()) {
+        return matchVolume;
+      }
+      matchVolume += node->order.GetVolume();
+    }
+  }
+  return matchVolume;
+}
 
-  LOG_INFO("OrderAmend: {}", orderAmend);
+template <typename TOrderBidBook, typename TOrderAskBook>
+template <typename TOppositeOrderBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::MatchOrder(TOppositeOrderBook &oppositeSideOrderBook,
+                                                                   const Order &order,
+                                                                   const OrderInsertData &orderInsert,
+                                                                   const boost::asio::ip::tcp::endpoint &endpoint) -> VolumeType_t
+{
+  const auto sendTradeFn{[this](const OrderNode &node, const VolumeType_t tradedVolume) { SendTrade(node, tradedVolume); }};
+
+  auto volume{order.GetVolume()};
+  const auto &oppositeSideOrderBookMap{oppositeSideOrderBook.GetOrderBookMap()};
+  while (volume > 0 and not oppositeSideOrderBookMap.empty()) {
+    const auto tradedPrice{std::begin(oppositeSideOrderBookMap)->first};
+    if (not IsMatchPrice(order, tradedPrice)) {
+      break;
+    }
 
+    // self trade prevention, the interned account handles are compared before the top order trades
+    if (m_SelfTradePrevention != SelfTradePrevention::None and
+        std::begin(oppositeSideOrderBookMap)->second.GetTopOrder()->order.GetAccount() == order.GetAccount()) {
+      const auto &topOrder{std::begin(oppositeSideOrderBookMap)->second.GetTopOrder()->order};
+      SetLevelChanged(not order.GetIsBuySide(), tradedPrice);
+      if (m_SelfTradePrevention == SelfTradePrevention::CancelNewest) {
+        volume = 0;
+      } else if (m_SelfTradePrevention == SelfTradePrevention::CancelOldest) {
+        ReduceTopOrder(oppositeSideOrderBook, topOrder.GetVolume());
+        continue;
+      } else {
+        const auto decrementedVolume{std::min(volume, topOrder.GetVolume())};
+        ReduceTopOrder(oppositeSideOrderBook, decrementedVolume);
+        volume -= decrementedVolume;
+      }
+
+      if (volume == 0) {
+        // the new order is cancelled before it rests, the cancel reply follows the insert reply
+        const OrderReply orderCancelReply{orderInsert.GetId(), orderInsert.GetClientId()};
+        CreateAndSendMessage(orderCancelReply, endpoint);
+        LOG_INFO("Self trade prevented, order {} cancelled", orderInsert.GetId());
+        return 0;
+      }
+      continue;
+    }
+
+    // the resting order trades first, a fully traded order and an empty level are removed from the order book
+    const auto tradedVolume{oppositeSideOrderBook.TradeTopLevel(volume, sendTradeFn)};
+    volume -= tradedVolume;
+
+    const Trade trade{orderInsert.GetAccount(), tradedPrice, tradedVolume, orderInsert.GetId(), orderInsert.GetClientId()};
+    LOG_INFO("Trade id:{}, clientId:{}, account:{}, price:{}, volume:{}",
+             trade.GetId(),
+             trade.GetClientId(),
+             trade.GetAccount(),
+             tradedPrice,
+             tradedVolume);
+    CreateAndSendMessage(trade, endpoint);
+
+    if (m_MarketDataPublisher.HasSubscribers()) {
+      m_MarketDataPublisher.Publish(PublicTrade{m_Instrument, tradedPrice, tradedVolume, order.GetIsBuySide()});
+    }
+    SetLevelChanged(not order.GetIsBuySide(), tradedPrice);
+  }
+  return volume;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::SendTrade(const OrderNode &node, const VolumeType_t tradedVolume)
+{
+  const Trade trade{m_SymbolTable.GetSymbol(node.order.GetAccount()), node.order.GetPrice(), tradedVolume, node.id, node.clientId};
+  LOG_INFO("Trade id:{}, clientId:{}, account:{}, price:{}, volume:{}",
+           trade.GetId(),
+           trade.GetClientId(),
+           trade.GetAccount(),
+           trade.GetTradedPrice(),
+           trade.GetTradedVolume());
+
+  // the replies of the current event continue in their own format
+  const auto format{m_ReplyEncoder.GetFormat()};
+  const auto &orderSession{m_Sessions[node.session]};
+  m_ReplyEncoder.SetFormat(orderSession.replyFormat);
+  CreateAndSendMessage(trade, orderSession.endpoint);
+  m_ReplyEncoder.SetFormat(format);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::OrderAmend(const OrderAmendData &orderAmend,
+                                                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_INFO("OrderAmend id:{}, clientId:{}, price:{}, newPrice:{}, volume:{}, newVolume:{}, side:{}",
+           orderAmend.GetId(),
+           orderAmend.GetClientId(),
+           orderAmend.GetPrice(),
+           orderAmend.GetNewPrice(),
+           orderAmend.GetVolume(),
+           orderAmend.GetNewVolume(),
+           orderAmend.GetIsBuySide() ? 'B' : 'S');
+  m_InputSequence++;
+  if (m_Journal) {
+    m_Journal->Append(m_InputSequence, orderAmend, endpoint);
+  }
+  m_ReplyEncoder.SetFormat(orderAmend.GetReplyFormat());
+
+  // the order ids are unique per matching engine, an amend with the wrong side amends the order on the side it rests on
+  const auto isBuySide{GetOrderSide(orderAmend.GetIsBuySide(), orderAmend.GetId())};
   const auto Amend{[&](const OrderAmendData &orderAmend) {
-    return (orderAmend.GetIsBuySide() ? m_Bids.Amend(orderAmend) : m_Asks.Amend(orderAmend));
+    return (isBuySide ? m_Bids.Amend(orderAmend) : m_Asks.Amend(orderAmend));
   }};
 
+  // the price level the order is moved from, before the order is amended
+  const auto restingPrice{GetRestingPrice(isBuySide, orderAmend.GetId())};
+
   if (Amend(orderAmend)) {
     // send order insert reply
     const OrderReply orderAmendReply{orderAmend.GetId(), orderAmend.GetClientId()};
     CreateAndSendMessage(orderAmendReply, endpoint);
 
     // check if this order has matches
-    const auto CheckMatch{[&](const OrderDataBase &newOrder, const boost::asio::ip::tcp::endpoint &endpoint) {
-      newOrder.GetIsBuySide() ?   // matches to the ask side
-        ExecuteOrder(m_Asks, m_Bids, endpoint)
-                              :   // matches to the bid side
-        ExecuteOrder(m_Bids, m_Asks, endpoint);
+    const auto CheckMatch{[&]() {
+      isBuySide ?   // matches to the ask side
+        ExecuteOrder(m_Asks, m_Bids)
+                :   // matches to the bid side
+        ExecuteOrder(m_Bids, m_Asks);
     }};
 
-    CheckMatch(orderAmend, endpoint);
+    SetLevelChanged(isBuySide, restingPrice);
+    SetLevelChanged(isBuySide, orderAmend.GetNewPrice());
+    CheckMatch();
+    PublishChangedLevels();
   } else {
     // send error back
     const ErrorReply errorReply{orderAmend.GetClientId(), "Failed to amend order"};
@@ -110,20 +405,35 @@ void MatchingEngine::OrderAmend(const OrderAmendData &orderAmend, const boost::a
   }
 }
 
-void MatchingEngine::OrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint)
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::OrderCancel(const OrderCancelData &orderCancel,
+                                                                    const boost::asio::ip::tcp::endpoint &endpoint)
 {
-  std::scoped_lock lock(m_Mutex);
-
-  LOG_INFO("OrderCancel:{}", orderCancel);
+  LOG_INFO("OrderCancel id:{}, clientId:{}, price:{}, side:{}",
+           orderCancel.GetId(),
+           orderCancel.GetClientId(),
+           orderCancel.GetPrice(),
+           orderCancel.GetIsBuySide() ? 'B' : 'S');
+  m_InputSequence++;
+  if (m_Journal) {
+    m_Journal->Append(m_InputSequence, orderCancel, endpoint);
+  }
+  m_ReplyEncoder.SetFormat(orderCancel.GetReplyFormat());
 
+  // the order ids are unique per matching engine, a cancel with the wrong side cancels the order on the side it rests on
+  const auto isBuySide{GetOrderSide(orderCancel.GetIsBuySide(), orderCancel.GetId())};
   const auto Cancel{[&](const OrderCancelData &orderCancel) {
-    return orderCancel.GetIsBuySide() ? m_Bids.Cancel(orderCancel) : m_Asks.Cancel(orderCancel);
+    return isBuySide ? m_Bids.Cancel(orderCancel) : m_Asks.Cancel(orderCancel);
   }};
 
+  const auto restingPrice{GetRestingPrice(isBuySide, orderCancel.GetId())};
+
   if (Cancel(orderCancel)) {
     // send order insert reply
     const OrderReply orderCancelReply{orderCancel.GetId(), orderCancel.GetClientId()};
     CreateAndSendMessage(orderCancelReply, endpoint);
+    SetLevelChanged(isBuySide, restingPrice);
+    PublishChangedLevels();
   } else {
     // send error back
     const ErrorReply errorReply{orderCancel.GetClientId(), "Failed to cancel order"};
@@ -131,96 +441,572 @@ void MatchingEngine::OrderCancel(const OrderCancelData &orderCancel, const boost
   }
 }
 
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::OrderMassCancel(const OrderMassCancelData &orderMassCancel,
+                                                                        const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_INFO("OrderMassCancel clientId:{}, account:{}, instrument:{}, scope:{}",
+           orderMassCancel.GetClientId(),
+           orderMassCancel.GetAccount(),
+           orderMassCancel.GetInstrument(),
+           static_cast<int>(orderMassCancel.GetScope()));
+  m_InputSequence++;
+  if (m_Journal) {
+    m_Journal->Append(m_InputSequence, m_Instrument, orderMassCancel, endpoint);
+  }
+
+  // the mass cancel is acknowledged after the cancel replies, also when it cancels nothing. The account and session scopes are sent
+  // to every matching engine, the id of the reply is the instrument of the engine.
+  const auto sendMassCancelReply{[&](const std::size_t cancelledOrders) {
+    m_ReplyEncoder.SetFormat(orderMassCancel.GetReplyFormat());
+    const OrderReply orderMassCancelReply{m_Instrument, orderMassCancel.GetClientId()};
+    CreateAndSendMessage(orderMassCancelReply, endpoint);
+    LOG_INFO("Mass cancel {} cancelled {} orders", orderMassCancel.GetClientId(), cancelledOrders);
+  }};
+
+  std::optional<SessionHandle_t> session;
+  if (orderMassCancel.HasScope(MassCancelSession)) {
+    session = FindSessionHandle(endpoint);
+    if (not session) {
+      sendMassCancelReply(0);   // the session has no resting orders
+      return;
+    }
+  }
+
+  const auto cancelledFn{[this](const OrderNode &node) {
+    // the cancel reply goes to the session that entered the order, in the format of that session
+    const auto &orderSession{m_Sessions[node.session]};
+    m_ReplyEncoder.SetFormat(orderSession.replyFormat);
+    const OrderReply orderCancelReply{node.id, node.clientId};
+    CreateAndSendMessage(orderCancelReply, orderSession.endpoint);
+    SetLevelChanged(node.order.GetIsBuySide(), node.order.GetPrice());
+  }};
+
+  std::size_t cancelledOrders{};
+  if (orderMassCancel.HasScope(MassCancelAccount)) {
+    const auto account{m_SymbolTable.Find(orderMassCancel.GetAccount())};
+    if (account) {
+      cancelledOrders = m_Bids.CancelAccountOrders(*account, session, cancelledFn) +   //
+                        m_Asks.CancelAccountOrders(*account, session, cancelledFn);
+    }
+  } else if (session) {
+    cancelledOrders = m_Bids.CancelSessionOrders(*session, cancelledFn) + m_Asks.CancelSessionOrders(*session, cancelledFn);
+  } else {
+    // only the instrument scope, all orders of the instrument
+    cancelledOrders = m_Bids.CancelAllOrders(cancelledFn) + m_Asks.CancelAllOrders(cancelledFn);
+  }
+
+  sendMassCancelReply(cancelledOrders);
+  PublishChangedLevels();
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::CancelSessionOrders(const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  const auto session{FindSessionHandle(endpoint)};
+  if (not session) {
+    return;
+  }
+
+  m_InputSequence++;
+  if (m_Journal) {
+    m_Journal->AppendCancelSessionOrders(m_InputSequence, m_Instrument, endpoint);
+  }
+
+  const auto cancelledFn{[this](const OrderNode &node) {
+    SetLevelChanged(node.order.GetIsBuySide(), node.order.GetPrice());
+  }};
+  const auto cancelledOrders{m_Bids.CancelSessionOrders(*session, cancelledFn) + m_Asks.CancelSessionOrders(*session, cancelledFn)};
+  if (cancelledOrders > 0) {
+    LOG_INFO("Session {}:{} closed, cancelled {} orders", endpoint.address().to_string(), endpoint.port(), cancelledOrders);
+  }
+  // the session has no resting orders left, its handle is reused by a new session
+  ReleaseSession(*session);
+  PublishChangedLevels();
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::GetSessionHandle(const boost::asio::ip::tcp::endpoint &endpoint,
+                                                                         const ReplyFormat format) -> SessionHandle_t
+{
+  const auto iter{m_SessionHandles.find(endpoint)};
+  if (iter != std::end(m_SessionHandles)) {
+    m_Sessions[iter->second].replyFormat = format;
+    return iter->second;
+  }
+
+  // the handles of the sessions that have no resting orders left are reused before the session table grows
+  if (m_FreeSessionHandles.empty() and m_Sessions.size() == m_Sessions.capacity()) {
+    ReleaseIdleSessions();
+  }
+
+  auto session{static_cast<SessionHandle_t>(m_Sessions.size())};
+  if (m_FreeSessionHandles.empty()) {
+    m_Sessions.emplace_back();
+  } else {
+    session = m_FreeSessionHandles.back();
+    m_FreeSessionHandles.pop_back();
+  }
+  m_Sessions[session] = Session{endpoint, format, true};
+  m_SessionHandles.emplace(endpoint, session);
+  return session;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::FindSessionHandle(const boost::asio::ip::tcp::endpoint &endpoint) const
+  -> std::optional<SessionHandle_t>
+{
+  const auto iter{m_SessionHandles.find(endpoint)};
+  if (iter == std::end(m_SessionHandles)) {
+    return std::nullopt;
+  }
+  return iter->second;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+bool BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::IsIdleSession(const SessionHandle_t session) const
+{
+  return not m_Bids.HasSessionOrders(session) and not m_Asks.HasSessionOrders(session);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ReleaseSession(const SessionHandle_t session)
+{
+  m_SessionHandles.erase(m_Sessions[session].endpoint);
+  m_Sessions[session] = Session{};
+  m_FreeSessionHandles.push_back(session);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ReleaseIdleSessions()
+{
+  for (SessionHandle_t session{1}; session < m_Sessions.size(); session++) {
+    if (m_Sessions[session].isActive and IsIdleSession(session)) {
+      ReleaseSession(session);
+    }
+  }
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::CaptureSnapshot() -> snapshot::SnapshotImage
+{
+  using namespace snapshot;
+
+  SnapshotImage image{m_Instrument, m_InputSequence, m_LastOrderId, m_ExpiryWheel.GetCurrentTick()};
+
+  if (not m_IsSnapshotTracking) {
+    const auto captureLevels{[&](const auto &orderBook, std::map<PriceType_t, SnapshotLevel_t> &snapshotLevels) {
+      snapshotLevels.clear();
+      for (const auto &[price, orderLevel] : orderBook.GetOrderBookMap()) {
+        snapshotLevels.emplace(price, ToSnapshotLevel(orderLevel, image.isTruncated));
+      }
+    }};
+    captureLevels(m_Bids, m_SnapshotBidLevels);
+    captureLevels(m_Asks, m_SnapshotAskLevels);
+    m_IsSnapshotTracking = true;
+  } else {
+    std::sort(std::begin(m_SnapshotChangedLevels), std::end(m_SnapshotChangedLevels));
+    const auto last{std::unique(std::begin(m_SnapshotChangedLevels), std::end(m_SnapshotChangedLevels))};
+    for (auto iter{std::begin(m_SnapshotChangedLevels)}; iter != last; ++iter) {
+      const auto &[isBuySide, price]{*iter};
+      if (isBuySide) {
+        CaptureSnapshotLevel(m_Bids, m_SnapshotBidLevels, price, image.isTruncated);
+      } else {
+        CaptureSnapshotLevel(m_Asks, m_SnapshotAskLevels, price, image.isTruncated);
+      }
+    }
+  }
+  m_SnapshotChangedLevels.clear();
+
+  // a released handle is written as an empty session, the orders keep their handles
+  image.sessions.reserve(m_Sessions.size() - 1);
+  for (auto iter{std::next(std::begin(m_Sessions))}; iter != std::end(m_Sessions); ++iter) {
+    image.sessions.push_back(SnapshotSession{journal::ToSession(iter->endpoint), iter->replyFormat, {}});
+  }
+
+  // only the references of the levels are copied, the levels are shared with the writer of the snapshot
+  image.levels.reserve(m_SnapshotBidLevels.size() + m_SnapshotAskLevels.size());
+  for (const auto &[price, level] : m_SnapshotBidLevels) {
+    image.levels.push_back(level);
+  }
+  for (const auto &[price, level] : m_SnapshotAskLevels) {
+    image.levels.push_back(level);
+  }
+  return image;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+bool BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::WriteSnapshot(const std::string &directory)
+{
+  return snapshot::WriteSnapshotFile(CaptureSnapshot(), directory);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ToSnapshotLevel(const OrderLevel &orderLevel, bool &isTruncated) const
+  -> snapshot::SnapshotLevel_t
+{
+  auto snapshotOrders{std::make_shared<std::vector<snapshot::SnapshotOrder>>(orderLevel.GetSize())};
+
+  // the orders in time priority, the node links are followed without a copy of the level
+  auto snapshotOrder{std::begin(*snapshotOrders)};
+  for (const auto *node{orderLevel.GetTopOrder()}; node != nullptr and snapshotOrder != std::end(*snapshotOrders);
+       node = node->next, ++snapshotOrder) {
+    const auto &order{node->order};
+    snapshotOrder->orderId = order.GetId();
+    snapshotOrder->price = order.GetPrice();
+    snapshotOrder->volume = order.GetVolume();
+    snapshotOrder->orderTime = journal::ToJournalTime(order.GetOrderTime());
+    snapshotOrder->orderDuration = order.GetOrderDuration().count();
+    snapshotOrder->session = node->session;
+    snapshotOrder->type = order.GetType();
+    snapshotOrder->isBuySide = order.GetIsBuySide() ? 1 : 0;
+    isTruncated |= not snapshotOrder->account.Assign(m_SymbolTable.GetSymbol(order.GetAccount()));
+    isTruncated |= not snapshotOrder->instrument.Assign(m_SymbolTable.GetSymbol(order.GetInstrument()));
+    isTruncated |= not snapshotOrder->id.Assign(node->id);
+    isTruncated |= not snapshotOrder->clientId.Assign(node->clientId);
+  }
+  return snapshotOrders;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+template <typename TOrderBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::CaptureSnapshotLevel(const TOrderBook &orderBook,
+                                                                             std::map<PriceType_t, snapshot::SnapshotLevel_t> &snapshotLevels,
+                                                                             const PriceType_t price,
+                                                                             bool &isTruncated) const
+{
+  // the previous level stays valid for the snapshots that still reference it
+  const auto &orderBookMap{orderBook.GetOrderBookMap()};
+  const auto iter{orderBookMap.find(price)};
+  if (iter == std::end(orderBookMap)) {
+    snapshotLevels.erase(price);
+    return;
+  }
+  snapshotLevels.insert_or_assign(price, ToSnapshotLevel(iter->second, isTruncated));
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ResetSnapshotLevels()
+{
+  m_IsSnapshotTracking = false;
+  m_SnapshotChangedLevels.clear();
+  m_SnapshotBidLevels.clear();
+  m_SnapshotAskLevels.clear();
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+bool BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::LoadSnapshot(const std::string &path)
+{
+  using namespace snapshot;
+
+  if (m_InputSequence != 0 or not m_Bids.GetOrderBookMap().empty() or not m_Asks.GetOrderBookMap().empty()) {
+    LOG_ERROR("Snapshot {} can not be loaded, the matching engine {} has inputs", path, m_Instrument);
+    return false;
+  }
+
+  common::MappedFile file;
+  if (not file.Open(path)) {
+    return false;
+  }
+
+  const auto &header{*reinterpret_cast<const SnapshotHeader *>(file.GetData())};
+  if (file.GetSize() < sizeof(SnapshotHeader) or
+      not std::equal(std::begin(SnapshotMagic), std::end(SnapshotMagic), header.magic) or header.version != SnapshotVersion or
+      header.headerLength != sizeof(SnapshotHeader) or
+      file.GetSize() != sizeof(SnapshotHeader) + header.sessionCount * sizeof(SnapshotSession) + header.orderCount * sizeof(SnapshotOrder)) {
+    LOG_ERROR("File {} is not a snapshot of version {}", path, SnapshotVersion);
+    return false;
+  }
+
+  if (header.instrument.View() != m_Instrument) {
+    LOG_ERROR("Snapshot {} is of instrument {}, not of {}", path, header.instrument.View(), m_Instrument);
+    return false;
+  }
+
+  // the sessions get the handles they had when the snapshot was written
+  const auto *snapshotSession{reinterpret_cast<const SnapshotSession *>(file.GetData() + sizeof(SnapshotHeader))};
+  for (std::uint32_t index{}; index < header.sessionCount; index++, ++snapshotSession) {
+    m_Sessions.push_back(Session{journal::ToEndpoint(snapshotSession->session), snapshotSession->replyFormat, true});
+  }
+
+  // the expiries of the good till date orders are added relative to the time of the snapshot
+  if (not m_ExpiryWheel.Reset(header.expiryTick)) {
+    LOG_WARN("Snapshot {} expiry time not restored, the expiry wheel is not empty", path);
+  }
+
+  const auto *snapshotOrder{reinterpret_cast<const SnapshotOrder *>(snapshotSession)};
+  for (std::uint32_t index{}; index < header.orderCount; index++, ++snapshotOrder) {
+    if (snapshotOrder->session >= m_Sessions.size()) {
+      LOG_ERROR("Snapshot {} order {} has an unknown session", path, snapshotOrder->id.View());
+      return false;
+    }
+
+    const Order order{snapshotOrder->orderId,
+                      snapshotOrder->price,
+                      snapshotOrder->volume,
+                      journal::ToOrderTime(snapshotOrder->orderTime),
+                      OrderDuration_t(snapshotOrder->orderDuration),
+                      m_SymbolTable.Intern(snapshotOrder->account.View()),
+                      m_SymbolTable.Intern(snapshotOrder->instrument.View()),
+                      snapshotOrder->type,
+                      snapshotOrder->isBuySide != 0};
+    const Id_t id{snapshotOrder->id.View()};
+    const ClientId_t clientId{snapshotOrder->clientId.View()};
+    const auto session{static_cast<SessionHandle_t>(snapshotOrder->session)};
+    const auto *const node{order.GetIsBuySide() ? m_Bids.Insert(order, id, clientId, session) : m_Asks.Insert(order, id, clientId, session)};
+    if (not node) {
+      LOG_ERROR("Snapshot {} order {} can not be inserted", path, id);
+      return false;
+    }
+
+    // the expiry replies go to the session in its last reply format
+    if (order.GetOrderDuration().count() > 0) {
+      AddExpiry(*node, m_Sessions[session].replyFormat, m_Sessions[session].endpoint);
+    }
+  }
+
+  // only the sessions with resting orders keep their handle, the handles of the other sessions are reused
+  for (SessionHandle_t session{1}; session < m_Sessions.size(); session++) {
+    if (IsIdleSession(session)) {
+      m_Sessions[session] = Session{};
+      m_FreeSessionHandles.push_back(session);
+    } else {
+      m_SessionHandles.emplace(m_Sessions[session].endpoint, session);
+    }
+  }
+
+  m_LastOrderId = header.lastOrderId;
+  m_InputSequence = header.inputSequence;
+
+  // the loaded orders are not tracked as changed levels, the next capture copies all levels
+  ResetSnapshotLevels();
+
+  LOG_INFO("Snapshot {} loaded, input sequence:{}, orders:{}, sessions:{}", path, m_InputSequence, header.orderCount, header.sessionCount);
+  return true;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
 template <typename TOrderBook1, typename TOrderBook2>
-void MatchingEngine::ExecuteOrder(TOrderBook1 &oppositeSideOrderBook,
-                                  TOrderBook2 &mySideOrderBook,
-                                  const boost::asio::ip::tcp::endpoint &endpoint)
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ExecuteOrder(TOrderBook1 &oppositeSideOrderBook, TOrderBook2 &mySideOrderBook)
 {
+  // the matching loop works on the resting order nodes in the books, without copies of the orders
+  const auto matchPricePredicate{[](const Order &newOrder, const Order &bestOrder) -> bool {
+    return (newOrder.GetIsBuySide() ? (newOrder.GetPrice() >= bestOrder.GetPrice()) : (bestOrder.GetPrice() >= newOrder.GetPrice()));
+  }};
+
+  // trade execution callback function, inlined in the trade of the top level
+  const auto sendTradeFn{[this](const OrderNode &node, const VolumeType_t tradedVolume) { SendTrade(node, tradedVolume); }};
+
   while (true) {
-    auto &mySideOrderBookMap = mySideOrderBook.GetOrderBookMap();
+    const auto &mySideOrderBookMap = mySideOrderBook.GetOrderBookMap();
     if (mySideOrderBookMap.empty()) {
       // should never happen if we just inserted an new order
       LOG_DEBUG("Other sides order book is empty");
       return;
     }
 
-    const auto &mySideBestOrderLevel = std::begin(mySideOrderBookMap)->second;
-    if (mySideBestOrderLevel.IsEmpty()) {
-      LOG_DEBUG("Other side top level is empty");
-      return;
-    }
-
-    const auto mySideBestTopLevel = mySideBestOrderLevel.GetTopLevel();
-    if (not mySideBestTopLevel) {
+    const auto *const mySideBestOrder = std::begin(mySideOrderBookMap)->second.GetTopOrder();
+    if (not mySideBestOrder) {
       LOG_DEBUG("No best price on other side PriceLevel found");
       return;
     }
 
-    const auto &myBestOrderData = mySideBestTopLevel.value();
-
     // get data of the opposite side
-    auto &oppositeSideOrderBookMap = oppositeSideOrderBook.GetOrderBookMap();
+    const auto &oppositeSideOrderBookMap = oppositeSideOrderBook.GetOrderBookMap();
     if (oppositeSideOrderBookMap.empty()) {
       return;
     }
 
-    const auto &oppositeBestOrderLevel = std::begin(oppositeSideOrderBookMap)->second;
-    if (oppositeBestOrderLevel.IsEmpty()) {
-      LOG_DEBUG("Best top level is empty");
-      return;
-    }
-
-    const auto oppositeBestTopLevel = oppositeBestOrderLevel.GetTopLevel();
-    if (not oppositeBestTopLevel) {
+    const auto *const oppositeBestOrder = std::begin(oppositeSideOrderBookMap)->second.GetTopOrder();
+    if (not oppositeBestOrder) {
       LOG_DEBUG("No best price on PriceLevel found");
       return;
     }
 
-    const auto &oppositeBestOrderData = oppositeBestTopLevel.value();
-    const auto matchPricePredicate{[](const OrderInsertData &newOrder, const OrderInsertData &bestOrder) -> bool {
-      return (newOrder.GetIsBuySide() ? (newOrder.GetPrice() >= bestOrder.GetPrice()) : (bestOrder.GetPrice() >= newOrder.GetPrice()));
-    }};
-
+    const auto &myBestOrderData = mySideBestOrder->order;
+    const auto &oppositeBestOrderData = oppositeBestOrder->order;
     if (not matchPricePredicate(myBestOrderData, oppositeBestOrderData)) {
       return;
     }
+
+    // self trade prevention, the order of the amended side is the newest order
+    if (m_SelfTradePrevention != SelfTradePrevention::None and myBestOrderData.GetAccount() == oppositeBestOrderData.GetAccount()) {
+      const auto isBuySide{myBestOrderData.GetIsBuySide()};
+      const auto myPrice{myBestOrderData.GetPrice()};
+      const auto myVolume{myBestOrderData.GetVolume()};
+      const auto oppositePrice{oppositeBestOrderData.GetPrice()};
+      const auto oppositeVolume{oppositeBestOrderData.GetVolume()};
+      if (m_SelfTradePrevention == SelfTradePrevention::CancelNewest) {
+        ReduceTopOrder(mySideOrderBook, myVolume);
+      } else if (m_SelfTradePrevention == SelfTradePrevention::CancelOldest) {
+        ReduceTopOrder(oppositeSideOrderBook, oppositeVolume);
+      } else {
+        ReduceTopOrder(mySideOrderBook, std::min(myVolume, oppositeVolume));
+        ReduceTopOrder(oppositeSideOrderBook, std::min(myVolume, oppositeVolume));
+      }
+      SetLevelChanged(isBuySide, myPrice);
+      SetLevelChanged(not isBuySide, oppositePrice);
+      continue;
+    }
     // we have a match
     LOG_DEBUG("Match {}@{}:{}@{}",
               myBestOrderData.GetVolume(),
               myBestOrderData.GetPrice(),
               oppositeBestOrderData.GetVolume(),
               oppositeBestOrderData.GetPrice());
-    // trade execution callback function
-    const auto sendTradeFn{[this, &endpoint](const Trade &trade) {
-      LOG_INFO("Trade:{}", trade);
-      CreateAndSendMessage(trade, endpoint);
-    }};
 
-    const auto tradedVolume{oppositeBestOrderLevel.TradeTopLevel(myBestOrderData.GetVolume(), sendTradeFn)};
+    // the order books remove fully traded orders and empty top levels, the order references are not valid after the trade
+    const auto isBuySide{myBestOrderData.GetIsBuySide()};
+    const auto myPrice{myBestOrderData.GetPrice()};
+    const auto tradedPrice{oppositeBestOrderData.GetPrice()};
+    const auto tradedVolume{oppositeSideOrderBook.TradeTopLevel(myBestOrderData.GetVolume(), sendTradeFn)};
     //  reduce volume on the other side top level
-    const auto otherSideTradedVolume{mySideBestOrderLevel.TradeTopLevel(tradedVolume, sendTradeFn)};
+    [[maybe_unused]] const auto otherSideTradedVolume{mySideOrderBook.TradeTopLevel(tradedVolume, sendTradeFn)};
 
-    /// check if the bid/ask levels are empty and remove the top level if so
-    if (oppositeBestOrderLevel.IsEmpty()) {
-      oppositeSideOrderBook.RemoveLevelAtPrice(oppositeBestOrderData.GetPrice());
+    if (m_MarketDataPublisher.HasSubscribers()) {
+      m_MarketDataPublisher.Publish(PublicTrade{m_Instrument, tradedPrice, tradedVolume, isBuySide});
     }
-    if (mySideBestOrderLevel.IsEmpty()) {
-      mySideOrderBook.RemoveLevelAtPrice(myBestOrderData.GetPrice());
+    SetLevelChanged(isBuySide, myPrice);
+    SetLevelChanged(not isBuySide, tradedPrice);
+  }
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+template <typename TOrderBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ReduceTopOrder(TOrderBook &orderBook, const VolumeType_t volume)
+{
+  // the reduction is a trade of the top order without the trade reply
+  [[maybe_unused]] const auto reducedVolume{orderBook.TradeTopLevel(volume, [this](const OrderNode &node, const VolumeType_t) {
+    if (node.order.GetVolume() == 0) {
+      LOG_INFO("Self trade prevented, order {} cancelled", node.id);
+      SendCancelReply(node);
     }
+  })};
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::SendCancelReply(const OrderNode &node)
+{
+  // the replies of the current event continue in their own format
+  const auto format{m_ReplyEncoder.GetFormat()};
+  const auto &orderSession{m_Sessions[node.session]};
+  m_ReplyEncoder.SetFormat(orderSession.replyFormat);
+  const OrderReply orderCancelReply{node.id, node.clientId};
+  CreateAndSendMessage(orderCancelReply, orderSession.endpoint);
+  m_ReplyEncoder.SetFormat(format);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::GetOrderBook(const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  m_ReplyEncoder.SetFormat(format);
+
+  const auto sendOrderLevels{[&](const auto &orderBook, const bool isBuySide) {
+    for (const auto &[price, orderLevel] : orderBook.GetOrderBookMap()) {
+      m_ChannelInterface->SendWebSocketData(m_ReplyEncoder.Encode(ToLevelUpdate(isBuySide, price, orderLevel)), endpoint);
+    }
+  }};
+
+  sendOrderLevels(m_Asks, false);
+  sendOrderLevels(m_Bids, true);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::SubscribeMarketData(const ReplyFormat format,
+                                                                            const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  // the snapshot and the updates are sent by the same single writer, no update is missed or sent twice
+  GetOrderBook(format, endpoint);
+  m_MarketDataPublisher.Subscribe(endpoint, format);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::UnsubscribeMarketData(const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  m_MarketDataPublisher.Unsubscribe(endpoint);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::SetLevelChanged(const bool isBuySide, const PriceType_t price)
+{
+  const std::pair changedLevel{isBuySide, price};
+  if (m_IsSnapshotTracking) {
+    // the same levels change over and over between two snapshots, the duplicates are removed before the capacity grows
+    if (m_SnapshotChangedLevels.size() == m_SnapshotChangedLevels.capacity()) {
+      std::sort(std::begin(m_SnapshotChangedLevels), std::end(m_SnapshotChangedLevels));
+      m_SnapshotChangedLevels.erase(std::unique(std::begin(m_SnapshotChangedLevels), std::end(m_SnapshotChangedLevels)),
+                                    std::end(m_SnapshotChangedLevels));
+    }
+    m_SnapshotChangedLevels.push_back(changedLevel);
+  }
+
+  if (not m_MarketDataPublisher.HasSubscribers()) {
+    return;
+  }
+
+  if (std::find(std::begin(m_ChangedLevels), std::end(m_ChangedLevels), changedLevel) == std::end(m_ChangedLevels)) {
+    m_ChangedLevels.push_back(changedLevel);
   }
 }
 
-void MatchingEngine::GetOrderBook(const boost::asio::ip::tcp::endpoint &endpoint)
+template <typename TOrderBidBook, typename TOrderAskBook>
+bool BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::GetOrderSide(const bool isBuySide, const Id_t &id) const
 {
-  const auto printOrderLevel{[](const OrderLevel &orderLevel) {
-    const auto printOrderData{[](const OrderInsertData &orderData) {
-      // LOG_DEBUG("OrderInsertData:" << orderData);
-      return true;
-    }};
+  // the other side is only looked up when the order is not on the side of the message
+  if ((isBuySide ? m_Bids.FindOrder(id) : m_Asks.FindOrder(id)) != nullptr) {
+    return isBuySide;
+  }
+  return (isBuySide ? m_Asks.FindOrder(id) : m_Bids.FindOrder(id)) != nullptr ? not isBuySide : isBuySide;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+bool BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::IsRestingOrderId(const Id_t &id) const
+{
+  return m_Bids.FindOrder(id) != nullptr or m_Asks.FindOrder(id) != nullptr;
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::GetRestingPrice(const bool isBuySide, const Id_t &id) const -> PriceType_t
+{
+  if (not m_IsSnapshotTracking and not m_MarketDataPublisher.HasSubscribers()) {
+    return {};
+  }
+
+  const auto *const restingOrder{isBuySide ? m_Bids.FindOrder(id) : m_Asks.FindOrder(id)};
+  return restingOrder ? restingOrder->order.GetPrice() : PriceType_t{};
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+void BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::PublishChangedLevels()
+{
+  for (const auto &[isBuySide, price] : m_ChangedLevels) {
+    m_MarketDataPublisher.Publish(GetLevelUpdate(isBuySide, price));
+  }
+  m_ChangedLevels.clear();
+}
 
-    return orderLevel.GetLevels(printOrderData);
+template <typename TOrderBidBook, typename TOrderAskBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::GetLevelUpdate(const bool isBuySide, const PriceType_t price) const -> LevelUpdate
+{
+  const auto findLevel{[&](const auto &orderBookMap) -> const OrderLevel * {
+    const auto iter{orderBookMap.find(price)};
+    return iter != std::end(orderBookMap) ? &iter->second : nullptr;
   }};
 
-  m_Asks.GetBook(printOrderLevel);
-  m_Bids.GetBook(printOrderLevel);
-}
\ No newline at end of file
+  const auto *const orderLevel{isBuySide ? findLevel(m_Bids.GetOrderBookMap()) : findLevel(m_Asks.GetOrderBookMap())};
+  if (not orderLevel) {
+    return LevelUpdate{m_Instrument, price, 0, 0, isBuySide};   // the level is removed
+  }
+  return ToLevelUpdate(isBuySide, price, *orderLevel);
+}
+
+template <typename TOrderBidBook, typename TOrderAskBook>
+auto BasicMatchingEngine<TOrderBidBook, TOrderAskBook>::ToLevelUpdate(const bool isBuySide,
+                                                                      const PriceType_t price,
+                                                                      const OrderLevel &orderLevel) const -> LevelUpdate
+{
+  return LevelUpdate{m_Instrument, price, orderLevel.GetTotalVolume(), orderLevel.GetSize(), isBuySide};
+}
+
+template class moboware::modules::BasicMatchingEngine<OrderBidBook_t, OrderAskBook_t>;
+template class moboware::modules::BasicMatchingEngine<OrderBidLadderBook_t, OrderAskLadderBook_t>;
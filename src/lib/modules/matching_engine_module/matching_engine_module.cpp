@@ -1,6 +1,10 @@
 #include "modules/matching_engine_module/matching_engine_module.h"
 #include "common/logger.hpp"
-#include "modules/matching_engine_module/order_event_processor.h"
+#include "modules/matching_engine_module/order_entry_tcp_server.h"
+#include "modules/matching_engine_module/replay.h"
+#include "modules/matching_engine_module/shard_scheduler.h"
+#include "modules/matching_engine_module/snapshot.h"
+#include <algorithm>
 
 using namespace moboware::modules;
 using namespace moboware::common;
@@ -8,19 +12,146 @@ using namespace moboware::common;
 MatchingEngineModule::MatchingEngineModule(const std::shared_ptr<common::Service> &service,                     //
                                            const std::shared_ptr<common::ChannelInterface> &channelInterface)   //
   : common::IModule("MatchingEngineModule", service, channelInterface)
+  , m_LoadStatsTimer(service)
+  , m_ExpiryTimer(service)
+  , m_SnapshotTimer(service)
 {
 }
 
 bool MatchingEngineModule::LoadConfig(const boost::json::value &moduleValue)
 {
   LOG_DEBUG("Load matching engine module Config");
+  // optional raw tcp transport of the binary order entry protocol, created before the matching engines that reply through it
+  if (moduleValue.as_object().contains("OrderEntryTcp")) {
+    const auto &orderEntryTcpValue{moduleValue.at("OrderEntryTcp")};
+    m_OrderEntryTcpAddress = orderEntryTcpValue.at("Address").as_string().c_str();
+    m_OrderEntryTcpPort = static_cast<std::uint16_t>(orderEntryTcpValue.at("Port").as_int64());
+    m_OrderEntryTcpServer = std::make_shared<OrderEntryTcpServer>(
+      GetService(),
+      GetChannelInterface(),
+      [this](const boost::asio::ip::tcp::endpoint &endpoint) { return GetOrderEventProcessor(endpoint); },
+      [this](const boost::asio::ip::tcp::endpoint &endpoint) { OnWebSocketSessionClosed(endpoint); });
+  }
+
+  // optional price ladder per instrument, the order books of the instrument are flat tick indexed price ladders over the price
+  // range of the instrument instead of std::maps
+  std::map<std::string, PriceLadderConfig> priceLadderConfigs;
+  if (moduleValue.as_object().contains("PriceLadders")) {
+    for (const auto &priceLadderValue : moduleValue.at("PriceLadders").as_object()) {
+      const auto &priceLadderObject{priceLadderValue.value().as_object()};
+
+      PriceLadderConfig priceLadderConfig;
+      if (priceLadderObject.contains("MinPrice")) {
+        priceLadderConfig.minPrice = static_cast<PriceType_t>(priceLadderObject.at("MinPrice").as_int64());
+      }
+      if (priceLadderObject.contains("TickSize")) {
+        priceLadderConfig.tickSize = static_cast<PriceType_t>(priceLadderObject.at("TickSize").as_int64());
+      }
+      if (priceLadderObject.contains("Levels")) {
+        priceLadderConfig.numberOfLevels = static_cast<std::size_t>(priceLadderObject.at("Levels").as_int64());
+      }
+      if (priceLadderConfig.tickSize == 0 or priceLadderConfig.numberOfLevels == 0) {
+        LOG_ERROR("Invalid price ladder of instrument {}, tick size and levels must be positive", std::string(priceLadderValue.key()));
+        return false;
+      }
+      priceLadderConfigs[std::string(priceLadderValue.key())] = priceLadderConfig;
+    }
+  }
+
   const auto &instrumentsArrayValues{moduleValue.at("Instruments").as_array()};
 
   for (const auto &instrumentValue : instrumentsArrayValues) {
-    const auto instrument{instrumentValue.as_string().c_str()};
+    const std::string instrument{instrumentValue.as_string().c_str()};
 
     LOG_DEBUG("Loading instrument {}", instrument);
-    m_MatchingEngines[instrument] = std::make_shared<MatchingEngine>(GetChannelInterface());
+    const auto priceLadderIter{priceLadderConfigs.find(instrument)};
+    if (priceLadderIter != std::end(priceLadderConfigs)) {
+      const auto &priceLadderConfig{priceLadderIter->second};
+      LOG_INFO("Instrument {} has a price ladder, min price:{}, tick size:{}, levels:{}",
+               instrument,
+               priceLadderConfig.minPrice,
+               priceLadderConfig.tickSize,
+               priceLadderConfig.numberOfLevels);
+      m_MatchingEngines[instrument].matchingEngine = std::make_shared<LadderMatchingEngine>(GetReplyChannel(), instrument, priceLadderConfig);
+      priceLadderConfigs.erase(priceLadderIter);
+    } else {
+      m_MatchingEngines[instrument].matchingEngine = std::make_shared<MatchingEngine>(GetReplyChannel(), instrument);
+    }
+  }
+
+  if (not priceLadderConfigs.empty()) {
+    LOG_ERROR("Price ladder configured for unknown instrument {}", priceLadderConfigs.begin()->first);
+    return false;
+  }
+
+  // optional self trade prevention of all matching engines, set before the order books are recovered from the journal
+  if (moduleValue.as_object().contains("SelfTradePrevention")) {
+    const auto selfTradePrevention{ToSelfTradePrevention(moduleValue.at("SelfTradePrevention").as_string().c_str())};
+    if (not selfTradePrevention) {
+      LOG_ERROR("Unknown self trade prevention {}", moduleValue.at("SelfTradePrevention").as_string().c_str());
+      return false;
+    }
+    for (auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+      instrumentEngine.matchingEngine->SetSelfTradePrevention(*selfTradePrevention);
+    }
+  }
+
+  // optional journal of the inputs of the matching engines
+  if (moduleValue.as_object().contains("Journal") and not LoadJournalConfig(moduleValue.at("Journal"))) {
+    return false;
+  }
+
+  // optional interval of the expiry of the good till date orders
+  if (moduleValue.as_object().contains("ExpiryInterval")) {
+    m_ExpiryInterval = std::chrono::milliseconds(moduleValue.at("ExpiryInterval").as_int64());
+  }
+
+  // optional cancel of the resting orders of a closed session, enabled by default
+  if (moduleValue.as_object().contains("CancelOnDisconnect")) {
+    m_CancelOnDisconnect = moduleValue.at("CancelOnDisconnect").as_bool();
+  }
+
+  // optional cpu per instrument, the matching engine of the instrument is owned by a engine thread pinned on that cpu
+  if (moduleValue.as_object().contains("EngineThreads")) {
+    for (const auto &engineThreadValue : moduleValue.at("EngineThreads").as_object()) {
+      const std::string instrument{engineThreadValue.key()};
+      const auto iter{m_MatchingEngines.find(instrument)};
+      if (iter == std::end(m_MatchingEngines)) {
+        LOG_ERROR("Engine thread configured for unknown instrument {}", instrument);
+        return false;
+      }
+
+      const auto cpu{static_cast<int>(engineThreadValue.value().as_int64())};
+      LOG_INFO("Instrument {} runs on engine thread of cpu {}", instrument, cpu);
+      iter->second.engineThread = GetEngineThread(cpu);
+    }
+  }
+
+  // optional shards, the other instruments are spread over the shard cpus by the consistent hash of the instrument name
+  if (moduleValue.as_object().contains("Shards")) {
+    const auto &shardsValue{moduleValue.at("Shards")};
+
+    std::vector<int> cpus;
+    for (const auto &cpuValue : shardsValue.at("Cpus").as_array()) {
+      cpus.push_back(static_cast<int>(cpuValue.as_int64()));
+    }
+
+    const ShardScheduler shardScheduler(cpus);
+    for (auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+      if (instrumentEngine.engineThread) {
+        continue;   // explicitly configured engine thread
+      }
+
+      const auto cpu{shardScheduler.GetCpu(instrument)};
+      if (cpu) {
+        LOG_INFO("Instrument {} scheduled on shard of cpu {}", instrument, *cpu);
+        instrumentEngine.engineThread = GetEngineThread(*cpu);
+      }
+    }
+
+    if (shardsValue.as_object().contains("LoadStatsInterval")) {
+      m_LoadStatsInterval = std::chrono::seconds(shardsValue.at("LoadStatsInterval").as_int64());
+    }
   }
 
   return true;
@@ -28,57 +159,325 @@ bool MatchingEngineModule::LoadConfig(const boost::json::value &moduleValue)
 
 bool MatchingEngineModule::Start()
 {
+  if (m_OrderEntryTcpServer and not m_OrderEntryTcpServer->Start(m_OrderEntryTcpAddress, m_OrderEntryTcpPort)) {
+    LOG_ERROR("Failed to start the order entry tcp server on {}:{}", m_OrderEntryTcpAddress, m_OrderEntryTcpPort);
+    return false;
+  }
+
+  if (not m_MatchingEngineThreads.empty() and m_LoadStatsInterval.count() > 0) {
+    const auto publishLoadStatsFunc{[this](Timer &timer) {
+      PublishLoadStats();
+      timer.Restart();
+    }};
+
+    m_LoadStatsTimer.Start(publishLoadStatsFunc, m_LoadStatsInterval);
+  }
+
+  if (m_ExpiryInterval.count() > 0) {
+    const auto expireOrdersFunc{[this](Timer &timer) {
+      ExpireOrders();
+      timer.Restart();
+    }};
+
+    m_ExpiryTimer.Start(expireOrdersFunc, m_ExpiryInterval);
+  }
+
+  if (m_SnapshotWriter and m_SnapshotInterval.count() > 0) {
+    const auto writeSnapshotsFunc{[this](Timer &timer) {
+      WriteSnapshots();
+      timer.Restart();
+    }};
+
+    m_SnapshotTimer.Start(writeSnapshotsFunc, m_SnapshotInterval);
+  }
+
+  return true;
+}
+
+void MatchingEngineModule::ExpireOrders()
+{
+  // the expiry runs on the single writer of every matching engine, like the order entry events
+  const auto now{std::chrono::high_resolution_clock::now()};
+  for (const auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+    Dispatch(instrument, ExpireOrdersRequest{now}, boost::asio::ip::tcp::endpoint{});
+  }
+}
+
+void MatchingEngineModule::WriteSnapshots()
+{
+  // the snapshot is captured by the single writer of every matching engine, between two order entry events
+  for (const auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+    Dispatch(instrument, WriteSnapshotRequest{m_SnapshotWriter.get()}, boost::asio::ip::tcp::endpoint{});
+  }
+}
+
+bool MatchingEngineModule::LoadJournalConfig(const boost::json::value &journalValue)
+{
+  JournalConfig journalConfig;
+  journalConfig.directory = journalValue.at("Directory").as_string().c_str();
+  if (journalValue.as_object().contains("SegmentSize")) {
+    // in mega bytes
+    journalConfig.segmentSize = static_cast<std::size_t>(journalValue.at("SegmentSize").as_int64()) * 1024 * 1024;
+  }
+  if (journalValue.as_object().contains("FsyncPolicy")) {
+    const auto fsyncPolicy{ToFsyncPolicy(journalValue.at("FsyncPolicy").as_string().c_str())};
+    if (not fsyncPolicy) {
+      LOG_ERROR("Unknown journal fsync policy {}", journalValue.at("FsyncPolicy").as_string().c_str());
+      return false;
+    }
+    journalConfig.fsyncPolicy = *fsyncPolicy;
+  }
+  if (journalValue.as_object().contains("FsyncInterval")) {
+    journalConfig.fsyncInterval = std::chrono::milliseconds(journalValue.at("FsyncInterval").as_int64());
+  }
+
+  if (journalConfig.segmentSize < journal::MaxRecordLength + sizeof(journal::SegmentHeader)) {
+    LOG_ERROR("Journal segment size {} is too small", journalConfig.segmentSize);
+    return false;
+  }
+
+  // the snapshots are written next to the journal segments by default
+  std::string snapshotDirectory{journalConfig.directory};
+  if (journalValue.as_object().contains("SnapshotDirectory")) {
+    snapshotDirectory = journalValue.at("SnapshotDirectory").as_string().c_str();
+  }
+  // optional interval of the periodic snapshots in seconds, the replay after a restart is bounded by the interval
+  if (journalValue.as_object().contains("SnapshotInterval")) {
+    m_SnapshotInterval = std::chrono::seconds(journalValue.at("SnapshotInterval").as_int64());
+  }
+
+  // the order books are recovered before the journal is opened, the journal continues after the last journaled record
+  const auto lastSequence{RecoverOrderBooks(journalConfig.directory, snapshotDirectory)};
+  if (not lastSequence) {
+    return false;
+  }
+  journalConfig.firstSequence = *lastSequence + 1;
+
+  m_Journal = std::make_unique<Journal>(journalConfig);
+  if (not m_Journal->Open()) {
+    return false;
+  }
+
+  for (auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+    instrumentEngine.matchingEngine->SetJournal(m_Journal.get());
+  }
+
+  if (m_SnapshotInterval.count() > 0) {
+    m_SnapshotWriter = std::make_unique<snapshot::SnapshotWriter>(snapshotDirectory);
+  }
   return true;
 }
 
+auto MatchingEngineModule::RecoverOrderBooks(const std::string &journalDirectory, const std::string &snapshotDirectory)
+  -> std::optional<std::uint64_t>
+{
+  const auto startTime{std::chrono::steady_clock::now()};
+
+  const auto replayChannel{std::make_shared<ReplayChannel>()};
+  for (auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+    const auto snapshotPath{snapshot::FindLatestSnapshot(snapshotDirectory, instrument)};
+    if (snapshotPath and not instrumentEngine.matchingEngine->LoadSnapshot(*snapshotPath)) {
+      return std::nullopt;
+    }
+    instrumentEngine.matchingEngine->SetChannelInterface(replayChannel);
+  }
+
+  JournalReader journalReader;
+  if (not journalReader.Open(journalDirectory)) {
+    return std::nullopt;
+  }
+
+  JournalReplay journalReplay([this](const std::string_view instrument) -> IMatchingEngine * {
+    const auto iter{m_MatchingEngines.find(std::string(instrument))};
+    return iter != std::end(m_MatchingEngines) ? iter->second.matchingEngine.get() : nullptr;
+  });
+  journalReplay.Replay(journalReader);
+
+  const auto &replayStats{journalReplay.GetStats()};
+  for (auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+    instrumentEngine.matchingEngine->SetChannelInterface(GetReplyChannel());
+
+    // the next startup does not replay the same records again
+    if (replayStats.appliedRecords > 0 and not instrumentEngine.matchingEngine->WriteSnapshot(snapshotDirectory)) {
+      return std::nullopt;
+    }
+  }
+
+  LOG_INFO("Order books recovered in {} ms, journal segments:{}, records:{}, replayed:{}, in snapshot:{}, unknown instrument:{}",
+           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count(),
+           journalReader.GetSegmentCount(),
+           replayStats.records,
+           replayStats.appliedRecords,
+           replayStats.skippedRecords,
+           replayStats.unknownInstrumentRecords);
+  if (replayStats.divergedRecords > 0) {
+    LOG_WARN("Order book recovery diverged from the journal on {} records", replayStats.divergedRecords);
+  }
+  return journalReader.GetLastSequence();
+}
+
+auto MatchingEngineModule::GetEngineThread(const int cpu) -> MatchingEngineThread *
+{
+  auto &engineThread{m_MatchingEngineThreads[cpu]};
+  if (not engineThread) {
+    engineThread = std::make_unique<MatchingEngineThread>(cpu);
+  }
+  return engineThread.get();
+}
+
+void MatchingEngineModule::PublishLoadStats()
+{
+  for (const auto &[cpu, engineThread] : m_MatchingEngineThreads) {
+    const auto loadStats{engineThread->GetLoadStats()};
+    auto &lastLoadStats{m_LastLoadStats[cpu]};
+
+    const auto numberOfInstruments{std::count_if(std::begin(m_MatchingEngines), std::end(m_MatchingEngines), [&](const auto &instrumentEngine) {
+      return instrumentEngine.second.engineThread == engineThread.get();
+    })};
+
+    const auto executedCommands{loadStats.executedCommands - lastLoadStats.executedCommands};
+    const auto busyTime{loadStats.busyTime - lastLoadStats.busyTime};
+    const auto load{100.0 * static_cast<double>(busyTime.count()) /
+                    static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(m_LoadStatsInterval).count())};
+
+    LOG_INFO("Shard cpu:{}, instruments:{}, commands:{}, commands/s:{}, load:{:.2f}%, queue full:{}",
+             cpu,
+             numberOfInstruments,
+             loadStats.executedCommands,
+             executedCommands / static_cast<std::uint64_t>(m_LoadStatsInterval.count()),
+             load,
+             loadStats.queueFullCount);
+
+    lastLoadStats = loadStats;
+  }
+
+  if (m_Journal) {
+    const auto journalStats{m_Journal->GetStats()};
+    LOG_INFO("Journal records:{}, last sequence:{}, syncs:{}, segments:{}, ring full:{}",
+             journalStats.writtenRecords,
+             m_Journal->GetLastSequence(),
+             journalStats.syncCount,
+             journalStats.segmentCount,
+             journalStats.ringFullCount);
+  }
+
+  if (m_SnapshotWriter) {
+    const auto snapshotStats{m_SnapshotWriter->GetStats()};
+    LOG_INFO("Snapshots written:{}, failed:{}, replaced:{}",
+             snapshotStats.writtenSnapshots,
+             snapshotStats.failedSnapshots,
+             snapshotStats.replacedSnapshots);
+  }
+}
+
 void MatchingEngineModule::OnWebSocketDataReceived(const boost::beast::flat_buffer &readBuffer, const boost::asio::ip::tcp::endpoint &endpoint)
 {
-  OrderEventProcessor orderEventProcessor(weak_from_this(), endpoint);
+  GetOrderEventProcessor(endpoint)->Process(readBuffer);
+}
 
-  orderEventProcessor.Process(readBuffer);
+void MatchingEngineModule::OnWebSocketSessionClosed(const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  {
+    const std::lock_guard lock(m_OrderEventProcessorsMutex);
+    m_OrderEventProcessors.erase(endpoint);
+  }
+
+  // the market data subscriptions are owned by the matching engines, removed by their single writer
+  for (const auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+    Dispatch(instrument, UnsubscribeRequest{}, endpoint);
+    if (m_CancelOnDisconnect) {
+      Dispatch(instrument, CancelSessionOrdersRequest{}, endpoint);
+    }
+  }
 }
 
-void MatchingEngineModule::HandleOrderInsert(OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint)
+auto MatchingEngineModule::GetOrderEventProcessor(const boost::asio::ip::tcp::endpoint &endpoint) -> std::shared_ptr<OrderEventProcessor>
 {
-  LOG_DEBUG("Handle order insert...");
-  auto iter = m_MatchingEngines.find(orderInsert.GetInstrument());
+  const std::lock_guard lock(m_OrderEventProcessorsMutex);
+  auto &orderEventProcessor{m_OrderEventProcessors[endpoint]};
+  if (not orderEventProcessor) {
+    orderEventProcessor = std::make_shared<OrderEventProcessor>(weak_from_this(), endpoint);
+  }
+  // a copy, the session closed handler may erase the processor while it processes the data
+  return orderEventProcessor;
+}
+
+auto MatchingEngineModule::GetReplyChannel() const -> std::shared_ptr<common::ChannelInterface>
+{
+  if (m_OrderEntryTcpServer) {
+    return m_OrderEntryTcpServer;
+  }
+  return GetChannelInterface();
+}
+
+template <typename TCommandData>
+void MatchingEngineModule::Dispatch(const std::string &instrument, TCommandData &&commandData, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  auto iter = m_MatchingEngines.find(instrument);
   if (iter == std::end(m_MatchingEngines)) {
-    LOG_ERROR("Unknown instrument {}", orderInsert.GetInstrument());
+    LOG_ERROR("Unknown instrument {}", instrument);
+    return;
+  }
+
+  auto &instrumentEngine{iter->second};
+  if (instrumentEngine.engineThread) {
+    instrumentEngine.engineThread->Post(*instrumentEngine.matchingEngine, std::forward<TCommandData>(commandData), endpoint);
     return;
   }
-  iter->second->OrderInsert(std::forward<OrderInsertData>(orderInsert), endpoint);
+
+  const std::scoped_lock lock(instrumentEngine.mutex);
+  MatchingEngineThread::Execute(*instrumentEngine.matchingEngine, std::forward<TCommandData>(commandData), endpoint);
+}
+
+void MatchingEngineModule::HandleOrderInsert(OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_DEBUG("Handle order insert...");
+  const auto instrument{orderInsert.GetInstrument()};
+  Dispatch(instrument, std::move(orderInsert), endpoint);
 }
 
 void MatchingEngineModule::HandleOrderAmend(const OrderAmendData &orderAmend, const boost::asio::ip::tcp::endpoint &endpoint)
 {
   LOG_DEBUG("Handle order amend...");
-  auto iter = m_MatchingEngines.find(orderAmend.GetInstrument());
-  if (iter == std::end(m_MatchingEngines)) {
-    LOG_ERROR("Unknown instrument {}", orderAmend.GetInstrument());
-    return;
-  }
-  iter->second->OrderAmend(orderAmend, endpoint);
+  Dispatch(orderAmend.GetInstrument(), orderAmend, endpoint);
 }
 
 void MatchingEngineModule::HandleOrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint)
 {
   LOG_DEBUG("Handle order cancel...");
-  auto iter = m_MatchingEngines.find(orderCancel.GetInstrument());
-  if (iter == std::end(m_MatchingEngines)) {
-    LOG_ERROR("Unknown instrument {}", orderCancel.GetInstrument());
+  Dispatch(orderCancel.GetInstrument(), orderCancel, endpoint);
+}
+
+void MatchingEngineModule::HandleOrderMassCancel(const OrderMassCancelData &orderMassCancel, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_DEBUG("Handle order mass cancel...");
+  if (orderMassCancel.HasScope(MassCancelInstrument)) {
+    Dispatch(orderMassCancel.GetInstrument(), orderMassCancel, endpoint);
     return;
   }
-  iter->second->OrderCancel(orderCancel, endpoint);
+
+  // the orders of an account or session can rest in every matching engine
+  for (const auto &[instrument, instrumentEngine] : m_MatchingEngines) {
+    Dispatch(instrument, orderMassCancel, endpoint);
+  }
 }
 
-void MatchingEngineModule::GetOrderBook(const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint)
+void MatchingEngineModule::GetOrderBook(const std::string &instrument, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint)
 {
   LOG_DEBUG("GetOrderBook:{}", instrument);
-  auto iter = m_MatchingEngines.find(instrument);
-  if (iter == std::end(m_MatchingEngines)) {
-    LOG_WARN("GetOrderBook, unknown instrument {}", instrument);
-    return;
-  }
+  Dispatch(instrument, GetOrderBookRequest{format}, endpoint);
+}
 
-  iter->second->GetOrderBook(endpoint);
+void MatchingEngineModule::SubscribeMarketData(const std::string &instrument,
+                                               const ReplyFormat format,
+                                               const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_DEBUG("SubscribeMarketData:{}", instrument);
+  Dispatch(instrument, SubscribeRequest{format}, endpoint);
+}
+
+void MatchingEngineModule::UnsubscribeMarketData(const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_DEBUG("UnsubscribeMarketData:{}", instrument);
+  Dispatch(instrument, UnsubscribeRequest{}, endpoint);
 }
@@ -0,0 +1,145 @@
+#include "modules/matching_engine_module/matching_engine_thread.h"
+#include "common/logger.hpp"
+#include "common/thread_affinity.h"
+
+using namespace moboware::modules;
+
+MatchingEngineThread::MatchingEngineThread(const int cpu)
+  : m_Cpu(cpu)
+  , m_Thread([this](const std::stop_token &stopToken) { Run(stopToken); })
+{
+}
+
+MatchingEngineThread::~MatchingEngineThread()
+{
+  m_Thread.request_stop();
+  WakeUp();
+}
+
+void MatchingEngineThread::WakeUp()
+{
+  m_IsSleeping.store(false, std::memory_order_seq_cst);
+  m_IsSleeping.notify_one();
+}
+
+void MatchingEngineThread::Run(const std::stop_token &stopToken)
+{
+  common::SetThreadName(fmt::format("engine_cpu{}", m_Cpu));
+  if (not common::SetThreadAffinity(m_Cpu)) {
+    LOG_WARN("Matching engine thread runs without cpu affinity");
+  }
+
+  const auto executeFn{[](MatchingEngineCommand &command) {
+    std::visit(
+      [&](auto &commandData) {   //
+        Execute(*command.matchingEngine, std::move(commandData), command.endpoint);
+      },
+      command.data);
+  }};
+
+  std::uint32_t idleSpins{};
+  while (not stopToken.stop_requested()) {
+    if (not m_CommandQueue.Empty()) {
+      // execute the burst of commands until the queue is empty, the clock is only read at the start and the end of the burst
+      const auto burstStartTime{std::chrono::steady_clock::now()};
+      std::uint64_t executedCommands{};
+      while (m_CommandQueue.Pop(executeFn)) {
+        executedCommands++;
+      }
+      const auto burstTime{std::chrono::steady_clock::now() - burstStartTime};
+
+      m_ExecutedCommands.store(m_ExecutedCommands.load(std::memory_order_relaxed) + executedCommands, std::memory_order_relaxed);
+      m_BusyTime.store(m_BusyTime.load(std::memory_order_relaxed) + std::chrono::duration_cast<std::chrono::nanoseconds>(burstTime).count(),
+                       std::memory_order_relaxed);
+      idleSpins = 0;
+      continue;
+    }
+
+    if (++idleSpins < MaxIdleSpins) {
+      continue;
+    }
+
+    // go to sleep until a producer wakes up the thread
+    m_IsSleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_CommandQueue.Empty() and not stopToken.stop_requested()) {
+      m_IsSleeping.wait(true, std::memory_order_acquire);
+    }
+    m_IsSleeping.store(false, std::memory_order_relaxed);
+    idleSpins = 0;
+  }
+
+  LOG_INFO("Matching engine thread on cpu {} stopped", m_Cpu);
+}
+
+auto MatchingEngineThread::GetLoadStats() const noexcept -> LoadStats
+{
+  return LoadStats{m_ExecutedCommands.load(std::memory_order_relaxed),
+                   std::chrono::nanoseconds(m_BusyTime.load(std::memory_order_relaxed)),
+                   m_QueueFullCount.load(std::memory_order_relaxed)};
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine,
+                                   OrderInsertData &&orderInsert,
+                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.OrderInsert(std::move(orderInsert), endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine,
+                                   const OrderAmendData &orderAmend,
+                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.OrderAmend(orderAmend, endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine,
+                                   const OrderCancelData &orderCancel,
+                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.OrderCancel(orderCancel, endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine,
+                                   const OrderMassCancelData &orderMassCancel,
+                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.OrderMassCancel(orderMassCancel, endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine,
+                                   const GetOrderBookRequest &getOrderBook,
+                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.GetOrderBook(getOrderBook.replyFormat, endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine,
+                                   const SubscribeRequest &subscribe,
+                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.SubscribeMarketData(subscribe.replyFormat, endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine, const UnsubscribeRequest &, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.UnsubscribeMarketData(endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine, const ExpireOrdersRequest &expireOrders, const boost::asio::ip::tcp::endpoint &)
+{
+  matchingEngine.ExpireOrders(expireOrders.now);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine,
+                                   const CancelSessionOrdersRequest &,
+                                   const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  matchingEngine.CancelSessionOrders(endpoint);
+}
+
+void MatchingEngineThread::Execute(IMatchingEngine &matchingEngine, const WriteSnapshotRequest &writeSnapshot, const boost::asio::ip::tcp::endpoint &)
+{
+  // only the changed levels are copied on the engine thread, the file is written by the snapshot writer thread
+  writeSnapshot.snapshotWriter->Write(matchingEngine.CaptureSnapshot());
+}
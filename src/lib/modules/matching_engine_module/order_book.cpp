@@ -3,108 +3,210 @@
 
 using namespace moboware::modules;
 
-template <typename TCompare> const OrderInsertData *OrderBook<TCompare>::Insert(OrderInsertData &&orderInsert)
+template <typename TCompare, typename TOrderBookMap>
+auto OrderBook<TCompare, TOrderBookMap>::Insert(const Order &order, const Id_t &id, const ClientId_t &clientId, const SessionHandle_t session)
+  -> const OrderNode *
 {
-  auto iter{m_OrderBookMap.find(orderInsert.GetPrice())};
-  if (iter != std::end(m_OrderBookMap)) {
-    /// already more orders on this price level, add this one to it.
-    auto &orderPriceLevel{iter->second};
+  if (m_OrderIndex.contains(id)) {
+    LOG_ERROR("Order id {} already in the order book", id);
+    return {};
+  }
+
+  auto *const node{m_OrderNodePool.Acquire(order, id, clientId)};
+  if (not InsertNode(node)) {
+    m_OrderNodePool.Release(node);
+    return {};   // false
+  }
+
+  node->session = session;
+  LinkOwner(m_AccountOrders, node->order.GetAccount(), node, &OrderNode::accountLinks);
+  LinkOwner(m_SessionOrders, session, node, &OrderNode::sessionLinks);
 
-    const auto insertedOrder{orderPriceLevel.Insert(std::forward<OrderInsertData>(orderInsert))};
+  LOG_DEBUG("Order added at price level:{}@{}, id:{}", node->order.GetVolume(), node->order.GetPriceAsDouble(), node->id);
+  return node;
+}
 
-    LOG_DEBUG("Order added at price level:{}, id:{}", insertedOrder->GetPriceAsDouble(), insertedOrder->GetId());
+template <typename TCompare, typename TOrderBookMap>
+auto OrderBook<TCompare, TOrderBookMap>::InsertNode(OrderNode *node) -> bool
+{
+  const auto price{node->order.GetPrice()};
 
-    return insertedOrder;
+  OrderLevel *orderPriceLevel{};
+  auto iter{m_OrderBookMap.find(price)};
+  if (iter != std::end(m_OrderBookMap)) {
+    /// already more orders on this price level, add this one to it.
+    orderPriceLevel = &iter->second;
+    orderPriceLevel->Insert(node);
   } else {
-    /// add new order to the price level
-    const auto pair{m_OrderBookMap.emplace(orderInsert.GetPrice(), std::forward<OrderInsertData>(orderInsert))};
-    if (pair.second) {
-      auto &orderPriceLevel{pair.first->second};
-
-      const auto insertedOrder{orderPriceLevel.GetLastOrder()};
-      if (insertedOrder) {
-        LOG_DEBUG("Order added at price level:{}@{}, id:{}",
-                  insertedOrder->GetVolume(),
-                  insertedOrder->GetPriceAsDouble(),
-                  insertedOrder->GetId());
-
-        return insertedOrder;
-      }
+    /// add new price level with the order
+    const auto pair{m_OrderBookMap.emplace(price, node)};
+    if (not pair.second) {
+      LOG_ERROR("Failed to add price level {}", node->order.GetPriceAsDouble());
+      return false;
     }
+    orderPriceLevel = &pair.first->second;
   }
-  return {};   // false
+
+  m_OrderIndex.emplace(node->id, OrderLocation{price, orderPriceLevel, node});
+  return true;
 }
 
-template <typename TCompare> bool OrderBook<TCompare>::Amend(const OrderAmendData &orderAmend)
+template <typename TCompare, typename TOrderBookMap>
+bool OrderBook<TCompare, TOrderBookMap>::Amend(const OrderAmendData &orderAmend)
 {
-  auto iter{m_OrderBookMap.find(orderAmend.GetPrice())};
-  if (iter == std::end(m_OrderBookMap)) {
-    LOG_ERROR("Price level not found at price {}", orderAmend.GetPrice());
+  const auto indexIter{m_OrderIndex.find(orderAmend.GetId())};
+  if (indexIter == std::end(m_OrderIndex)) {
+    LOG_ERROR("Order id {} not found", orderAmend.GetId());
     return false;
   }
 
-  auto &orderPriceLevel{iter->second};
+  const auto [price, orderPriceLevel, node]{indexIter->second};
 
   if (orderAmend.GetNewVolume() == 0) {   // cancel order when  volume is zero
-    if (orderPriceLevel.CancelOrder(orderAmend.GetId())) {
-      // cancel the order when new volume is zero
-      LOG_DEBUG("Order amend volume is zero, order is cancelled at price level:{}, id:{}", orderAmend.GetPriceAsDouble(), orderAmend.GetId());
-      if (orderPriceLevel.IsEmpty()) {
-        RemoveLevelAtPrice(orderAmend.GetPrice());
-      }
-      return true;
-    }
-  } else if (orderAmend.GetPrice() == orderAmend.GetNewPrice()) {
+    // cancel the order when new volume is zero
+    LOG_DEBUG("Order amend volume is zero, order is cancelled at price level:{}, id:{}", orderAmend.GetPriceAsDouble(), orderAmend.GetId());
+    RemoveOrder(indexIter);
+    return true;
+  } else if (price == orderAmend.GetNewPrice()) {
     /// price is not changed on the price level, so can only change volume or time duration
     /// change the order volume of the order at price level
+    orderPriceLevel->ChangeOrderVolume(node, orderAmend.GetNewVolume());
+    LOG_DEBUG("Order volume changed to {}", orderAmend.GetNewVolume());
+    return true;
+  }
 
-    if (orderPriceLevel.ChangeOrderVolume(orderAmend.GetId(), orderAmend.GetNewVolume())) {
-      LOG_DEBUG("Order volume changed to {}", orderAmend.GetNewVolume());
-      return true;
-    }
-  } else {
-    //// The change is on a other price level. Means we need to move the order from the original price level and insert a new
-    /// order in the new price level with an original order id move the order from one price level to the new price level
-
-    const auto moveOrderFn{[&](OrderInsertData &&orderData) {
-      // set new price and volume
-      orderData.SetPrice(orderAmend.GetNewPrice());
-      orderData.SetVolume(orderAmend.GetNewVolume());
-
-      const auto pair{m_OrderBookMap.emplace(orderAmend.GetNewPrice(), std::forward<OrderInsertData>(orderData))};
-      if (pair.second) {
-        LOG_DEBUG("Order moved to new price level:{}", orderData);
-      }
-    }};
+  // the order stays on its level when the new price has no level, e.g. out of the range of the price ladder
+  if (not IsValidPrice(orderAmend.GetNewPrice())) {
+    LOG_ERROR("Order id {} can not be moved to price {}", orderAmend.GetId(), orderAmend.GetNewPrice());
+    return false;
+  }
+
+  //// The change is on a other price level. The node is unlinked from the original price level and linked with the original
+  /// order id at the end of the time queue of the new price level.
+  m_OrderIndex.erase(indexIter);
+  orderPriceLevel->CancelOrder(node);
+  // check if the order level is empty and needs to be removed
+  if (orderPriceLevel->IsEmpty()) {
+    m_OrderBookMap.erase(price);
+  }
+
+  // set new price and volume
+  node->order.SetPrice(orderAmend.GetNewPrice());
+  node->order.SetVolume(orderAmend.GetNewVolume());
+  if (not InsertNode(node)) {
+    ReleaseNode(node);
+    return false;
+  }
+
+  LOG_DEBUG("Order moved to new price level:{}, id:{}", node->order.GetPriceAsDouble(), node->id);
+  return true;
+}
+
+template <typename TCompare, typename TOrderBookMap>
+bool OrderBook<TCompare, TOrderBookMap>::Cancel(const OrderCancelData &orderCancel)
+{
+  const auto indexIter{m_OrderIndex.find(orderCancel.GetId())};
+  if (indexIter == std::end(m_OrderIndex)) {
+    return false;
+  }
 
-    if (orderPriceLevel.MoveOrder(orderAmend.GetId(), moveOrderFn)) {
-      // check if the order level is empty and needs to be removed
-      if (orderPriceLevel.IsEmpty()) {
-        // remove the price level
-        m_OrderBookMap.erase(iter);
-      }
-      return true;
+  /// cancel the order at price level
+  LOG_DEBUG("Order cancelled at price level:{}, id:{}", indexIter->second.node->order.GetPriceAsDouble(), orderCancel.GetId());
+  RemoveOrder(indexIter);
+  return true;
+}
+
+template <typename TCompare, typename TOrderBookMap>
+void OrderBook<TCompare, TOrderBookMap>::RemoveOrder(const typename OrderIndex_t::iterator &indexIter)
+{
+  const auto [price, orderPriceLevel, node]{indexIter->second};
+  m_OrderIndex.erase(indexIter);
+
+  orderPriceLevel->CancelOrder(node);
+  ReleaseNode(node);
+  if (orderPriceLevel->IsEmpty()) {
+    m_OrderBookMap.erase(price);
+  }
+}
+
+template <typename TCompare, typename TOrderBookMap>
+auto OrderBook<TCompare, TOrderBookMap>::RemoveOrders(const PriceType_t price, const std::vector<const OrderNode *> &nodes) -> std::size_t
+{
+  const auto levelIter{m_OrderBookMap.find(price)};
+  if (levelIter == std::end(m_OrderBookMap)) {
+    return 0;
+  }
+
+  auto &orderPriceLevel{levelIter->second};
+  std::size_t removedOrders{};
+  for (const auto *const node : nodes) {
+    const auto indexIter{m_OrderIndex.find(node->id)};
+    if (indexIter == std::end(m_OrderIndex) or indexIter->second.node != node or indexIter->second.level != &orderPriceLevel) {
+      LOG_ERROR("Order id {} not found at price level:{}", node->id, price);
+      continue;
     }
+
+    auto *const orderNode{indexIter->second.node};
+    m_OrderIndex.erase(indexIter);
+    orderPriceLevel.CancelOrder(orderNode);
+    ReleaseNode(orderNode);
+    removedOrders++;
   }
-  return false;
+
+  if (orderPriceLevel.IsEmpty()) {
+    m_OrderBookMap.erase(levelIter);
+  }
+  return removedOrders;
 }
 
-template <typename TCompare> bool OrderBook<TCompare>::Cancel(const OrderCancelData &orderCancel)
+template <typename TCompare, typename TOrderBookMap>
+void OrderBook<TCompare, TOrderBookMap>::LinkOwner(OwnerOrders_t &ownerOrders,
+                                                   const std::uint32_t owner,
+                                                   OrderNode *node,
+                                                   OrderLinks OrderNode::*links)
 {
-  auto iter{m_OrderBookMap.find(orderCancel.GetPrice())};
-  if (iter != std::end(m_OrderBookMap)) {
-    /// cancel the order at price level
-    auto &orderPriceLevel{iter->second};
-    if (orderPriceLevel.CancelOrder(orderCancel.GetId())) {
-      LOG_DEBUG("Order cancelled at price level:{}, id:{}", orderCancel.GetPriceAsDouble(), orderCancel.GetId());
+  // the new order is the head of the list, the order of an owner list has no meaning
+  auto &head{ownerOrders[owner]};
+  node->*links = OrderLinks{nullptr, head};
+  if (head) {
+    (head->*links).prev = node;
+  }
+  head = node;
+}
 
-      return true;
+template <typename TCompare, typename TOrderBookMap>
+void OrderBook<TCompare, TOrderBookMap>::UnlinkOwner(OwnerOrders_t &ownerOrders,
+                                                     const std::uint32_t owner,
+                                                     OrderNode *node,
+                                                     OrderLinks OrderNode::*links)
+{
+  auto &[prev, next]{node->*links};
+  if (prev) {
+    (prev->*links).next = next;
+  } else {
+    // only the head of the list needs the owner lookup
+    const auto ownerIter{ownerOrders.find(owner)};
+    if (ownerIter != std::end(ownerOrders) and ownerIter->second == node) {
+      ownerIter->second = next;
     }
   }
-  return false;
+
+  if (next) {
+    (next->*links).prev = prev;
+  }
+  node->*links = OrderLinks{};
+}
+
+template <typename TCompare, typename TOrderBookMap>
+void OrderBook<TCompare, TOrderBookMap>::ReleaseNode(OrderNode *node)
+{
+  UnlinkOwner(m_AccountOrders, node->order.GetAccount(), node, &OrderNode::accountLinks);
+  UnlinkOwner(m_SessionOrders, node->session, node, &OrderNode::sessionLinks);
+  m_OrderNodePool.Release(node);
 }
 
-template <typename TCompare> void OrderBook<TCompare>::GetBook(const std::function<bool(const OrderLevel &)> &orderBookFunction)
+template <typename TCompare, typename TOrderBookMap>
+void OrderBook<TCompare, TOrderBookMap>::GetBook(const std::function<bool(const OrderLevel &)> &orderBookFunction)
 {
   for (const auto &[k, v] : m_OrderBookMap) {
     if (not orderBookFunction(v)) {
@@ -113,7 +215,8 @@ template <typename TCompare> void OrderBook<TCompare>::GetBook(const std::functi
   }
 }
 
-template <typename TCompare> std::optional<const OrderLevel *> OrderBook<TCompare>::GetLevelAtPrice(const PriceType_t &price)
+template <typename TCompare, typename TOrderBookMap>
+std::optional<const OrderLevel *> OrderBook<TCompare, TOrderBookMap>::GetLevelAtPrice(const PriceType_t &price)
 {
   const auto iter{m_OrderBookMap.find(price)};
   if (iter != std::end(m_OrderBookMap)) {
@@ -123,10 +226,24 @@ template <typename TCompare> std::optional<const OrderLevel *> OrderBook<TCompar
   return nullptr;
 }
 
-template <typename TCompare> void OrderBook<TCompare>::RemoveLevelAtPrice(const PriceType_t &price)
+template <typename TCompare, typename TOrderBookMap>
+void OrderBook<TCompare, TOrderBookMap>::RemoveLevelAtPrice(const PriceType_t &price)
 {
   const auto iter{m_OrderBookMap.find(price)};
   if (iter != std::end(m_OrderBookMap)) {
+    const auto releaseFn{[this](OrderNode *node) {
+      m_OrderIndex.erase(node->id);
+      ReleaseNode(node);
+    }};
+    iter->second.Clear(releaseFn);
+
     m_OrderBookMap.erase(iter);
   }
 }
+
+template <typename TCompare, typename TOrderBookMap>
+auto OrderBook<TCompare, TOrderBookMap>::FindOrder(const Id_t &orderId) const -> const OrderNode *
+{
+  const auto indexIter{m_OrderIndex.find(orderId)};
+  return (indexIter != std::end(m_OrderIndex)) ? indexIter->second.node : nullptr;
+}
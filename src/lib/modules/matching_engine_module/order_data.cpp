@@ -51,7 +51,7 @@ std::ostream &operator<<(std::ostream &os, const OrderInsertData &rhs)
             << "," << Fields::Id << ":" << rhs.GetId()                              //
             << "," << Fields::ClientId << ":" << rhs.GetClientId()                  //
             << "," << Fields::Account << ":" << rhs.GetAccount()                    //
-            << "," << Fields::Type << ":" << rhs.GetType()                          //
+            << "," << Fields::Type << ":" << ToString(rhs.GetType())                //
             << "," << Fields::Time << ":" << rhs.GetOrderTime()                     //
       ;
 }
@@ -67,7 +67,7 @@ std::ostream &operator<<(std::ostream &os, const OrderAmendData &rhs)
             << "," << Fields::Id << ":" << rhs.GetId()                              //
             << "," << Fields::ClientId << ":" << rhs.GetClientId()                  //
             << "," << Fields::Account << ":" << rhs.GetAccount()                    //
-            << "," << Fields::Type << ":" << rhs.GetType()                          //
+            << "," << Fields::Type << ":" << ToString(rhs.GetType())                //
             << "," << Fields::Time << ":" << rhs.GetOrderTime()                     //
       ;
 }
@@ -83,6 +83,15 @@ std::ostream &operator<<(std::ostream &os, const OrderCancelData &rhs)
       ;
 }
 
+std::ostream &operator<<(std::ostream &os, const OrderMassCancelData &rhs)
+{
+  return os << Fields::Scope << ":" << static_cast<int>(rhs.GetScope())   //
+            << "," << Fields::Account << ":" << rhs.GetAccount()          //
+            << "," << Fields::Instrument << ":" << rhs.GetInstrument()    //
+            << "," << Fields::ClientId << ":" << rhs.GetClientId()        //
+      ;
+}
+
 std::ostringstream &operator<<(std::ostringstream &os, const OrderReply &orderReply)
 {
   os << "{\"" << Fields::OrderReply                                        //
@@ -95,8 +104,8 @@ std::ostringstream &operator<<(std::ostringstream &os, const OrderReply &orderRe
 std::ostringstream &operator<<(std::ostringstream &os, const Trade &trade)
 {
   os << "{\"" << Fields::Trade << "\":"                                       //
-     << ",\"" << Fields::Id << "\":\"" << trade.GetId() << "\""               //
-     << "{\"" << Fields::ClientId << "\":\"" << trade.GetClientId() << "\""   //
+     << "{\"" << Fields::Id << "\":\"" << trade.GetId() << "\""               //
+     << ",\"" << Fields::ClientId << "\":\"" << trade.GetClientId() << "\""   //
      << ",\"" << Fields::Account << "\":\"" << trade.GetAccount() << "\""     //
      << ",\"" << Fields::TradedPrice << "\":" << trade.GetTradedPrice()       //
      << ",\"" << Fields::TradedVolume << "\":" << trade.GetTradedVolume()     //
@@ -110,19 +119,19 @@ std::ostringstream &operator<<(std::ostringstream &os, const ErrorReply &errorRe
 {
   os << "{\"" << Fields::ErrorReply                                           //
      << "\":{\"" << Fields::ClientId << "\":\"" << errorReply.GetClientId()   //
-     << "\",\"" << Fields::Error << "\":" << errorReply.GetErrorMessage()     //
-     << "}}";
+     << "\",\"" << Fields::Error << "\":\"" << errorReply.GetErrorMessage()   //
+     << "\"}}";
   return os;
 }
 }   // namespace moboware::modules
 
 using namespace moboware::modules;
 
-Trade::Trade(const std::string &_account,         //
+Trade::Trade(const std::string_view _account,     //
              const PriceType_t &_tradedPrice,     //
              const VolumeType_t &_tradedVolume,   //
-             const Id_t &_id,                     //
-             const ClientId_t &_clientId)
+             const std::string_view _id,          //
+             const std::string_view _clientId)
     : account(_account)
     , tradedPrice(_tradedPrice)
     , tradedVolume(_tradedVolume)
@@ -149,7 +158,7 @@ auto OrderDataBase::SetData(const boost::json::value &data) -> bool
 
 auto OrderDataBase::Validate() const -> bool
 {
-  return price > 0 &&                                  //
+  return (price > 0 || type == OrderType::Market) &&   // a market order has no limit price
          volume > 0 &&                                 //
          orderTime.time_since_epoch().count() > 0 &&   //
          not id.empty() &&                             //
@@ -197,13 +206,56 @@ OrderCancelData::OrderCancelData(const std::string &_instrument,   //
 {
 }
 
+OrderMassCancelData::OrderMassCancelData(const std::uint8_t _scope,        //
+                                         const std::string &_account,      //
+                                         const std::string &_instrument,   //
+                                         const ClientId_t &_clientId       //
+                                         )
+    : scope(_scope)
+    , account(_account)
+    , instrument(_instrument)
+    , clientId(_clientId)
+{
+}
+
+auto OrderMassCancelData::SetData(const boost::json::value &data) -> bool
+{
+  const auto &object{data.as_object()};
+
+  scope = 0;
+  if (object.contains(Fields::Account)) {
+    SetAccount(data.at(Fields::Account).as_string().c_str());
+    scope |= MassCancelAccount;
+  }
+  if (object.contains(Fields::Instrument)) {
+    SetInstrument(data.at(Fields::Instrument).as_string().c_str());
+    scope |= MassCancelInstrument;
+  }
+  if (object.contains(Fields::Session) and data.at(Fields::Session).as_bool()) {
+    scope |= MassCancelSession;
+  }
+  SetClientId(data.at(Fields::ClientId).as_string().c_str());
+
+  return Validate();
+}
+
+auto OrderMassCancelData::Validate() const -> bool
+{
+  constexpr std::uint8_t allScopes{MassCancelAccount | MassCancelInstrument | MassCancelSession};
+  return scope != 0 &&                                                  //
+         (scope & ~allScopes) == 0 &&                                   //
+         (not HasScope(MassCancelAccount) || not account.empty()) &&         //
+         (not HasScope(MassCancelInstrument) || not instrument.empty()) &&   //
+         not clientId.empty();
+}
+
 OrderAmendData::OrderAmendData(const std::string &_account,                       //
                                const std::string &_instrument,                    //
                                const PriceType_t &_price,                         //
                                const PriceType_t &_newPrice,                      //
                                const VolumeType_t &_volume,                       //
                                const VolumeType_t &_newVolume,                    //
-                               const std::string &_type,                          //
+                               const OrderType _type,                             //
                                const bool _isBuySide,                             //
                                const OrderTime_t &_orderTime,                     //
                                const std::chrono::milliseconds &_orderDuration,   //
@@ -220,7 +272,7 @@ OrderInsertData::OrderInsertData(const std::string &_account,
                                  const std::string &_instrument,                    //
                                  const PriceType_t &_price,                         //
                                  const VolumeType_t &_volume,                       //
-                                 const std::string &_type,                          //
+                                 const OrderType _type,                             //
                                  const bool _isBuySide,                             //
                                  const OrderTime_t &_orderTime,                     //
                                  const std::chrono::milliseconds &_orderDuration,   //
@@ -235,7 +287,7 @@ OrderDataBase::OrderDataBase(const std::string &_account,
                              const std::string &_instrument,                    //
                              const PriceType_t &_price,                         //
                              const VolumeType_t &_volume,                       //
-                             const std::string &_type,                          //
+                             const OrderType _type,                             //
                              const bool _isBuySide,                             //
                              const OrderTime_t &_orderTime,                     //
                              const std::chrono::milliseconds &_orderDuration,   //
@@ -255,8 +307,8 @@ OrderDataBase::OrderDataBase(const std::string &_account,
 {
 }
 
-OrderReply::OrderReply(const Id_t &_id,   //
-                       const ClientId_t &_clientId)
+OrderReply::OrderReply(const std::string_view _id,   //
+                       const std::string_view _clientId)
     : id(_id)
     , clientId(_clientId)
 {
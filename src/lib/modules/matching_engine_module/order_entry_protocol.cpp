@@ -0,0 +1,184 @@
+#include "modules/matching_engine_module/order_entry_protocol.h"
+
+using namespace moboware::modules;
+using namespace moboware::modules::binary;
+
+namespace {
+template <typename TMessage> void InitHeader(TMessage &message)
+{
+  std::memset(&message, 0, sizeof(TMessage));
+  message.header.magic = BinaryMagic;
+  message.header.version = BinaryVersion;
+  message.header.length = sizeof(TMessage);
+  message.header.messageType = TMessage::Type;
+}
+}   // namespace
+
+auto moboware::modules::binary::ToOrderInsertData(const OrderInsertMessage &message) -> OrderInsertData
+{
+  OrderInsertData orderInsert;
+  orderInsert.SetAccount(std::string(message.account.View()));
+  orderInsert.SetInstrument(std::string(message.instrument.View()));
+  orderInsert.SetPrice(message.price);
+  orderInsert.SetVolume(message.volume);
+  orderInsert.SetType(message.orderType);
+  orderInsert.SetIsBuySide(message.isBuySide != 0);
+  orderInsert.SetOrderTime(std::chrono::high_resolution_clock::now());
+  orderInsert.SetOrderDuration(std::chrono::milliseconds(message.orderDuration));
+  orderInsert.SetClientId(std::string(message.clientId.View()));
+  // the order id is generated like for the json order insert
+  orderInsert.SetId(std::to_string(orderInsert.GetOrderTime().time_since_epoch().count()));
+  orderInsert.SetReplyFormat(ReplyFormat::Binary);
+  return orderInsert;
+}
+
+auto moboware::modules::binary::ToOrderAmendData(const OrderAmendMessage &message) -> OrderAmendData
+{
+  OrderAmendData orderAmend;
+  orderAmend.SetAccount(std::string(message.account.View()));
+  orderAmend.SetInstrument(std::string(message.instrument.View()));
+  orderAmend.SetPrice(message.price);
+  orderAmend.SetNewPrice(message.newPrice);
+  orderAmend.SetVolume(message.volume);
+  orderAmend.SetNewVolume(message.newVolume);
+  orderAmend.SetType(message.orderType);
+  orderAmend.SetIsBuySide(message.isBuySide != 0);
+  orderAmend.SetOrderTime(std::chrono::high_resolution_clock::now());
+  orderAmend.SetId(std::string(message.id.View()));
+  orderAmend.SetClientId(std::string(message.clientId.View()));
+  orderAmend.SetReplyFormat(ReplyFormat::Binary);
+  return orderAmend;
+}
+
+auto moboware::modules::binary::ToOrderCancelData(const OrderCancelMessage &message) -> OrderCancelData
+{
+  OrderCancelData orderCancel{std::string(message.instrument.View()),   //
+                              message.price,
+                              message.isBuySide != 0,
+                              std::string(message.id.View()),
+                              std::string(message.clientId.View())};
+  orderCancel.SetReplyFormat(ReplyFormat::Binary);
+  return orderCancel;
+}
+
+auto moboware::modules::binary::ToOrderMassCancelData(const MassCancelMessage &message) -> OrderMassCancelData
+{
+  OrderMassCancelData orderMassCancel{message.scope,   //
+                                      std::string(message.account.View()),
+                                      std::string(message.instrument.View()),
+                                      std::string(message.clientId.View())};
+  orderMassCancel.SetReplyFormat(ReplyFormat::Binary);
+  return orderMassCancel;
+}
+
+bool moboware::modules::binary::Encode(const OrderInsertData &orderInsert, OrderInsertMessage &message)
+{
+  InitHeader(message);
+  message.price = orderInsert.GetPrice();
+  message.volume = orderInsert.GetVolume();
+  message.orderDuration = orderInsert.GetOrderDuration().count();
+  message.orderType = orderInsert.GetType();
+  message.isBuySide = orderInsert.GetIsBuySide() ? 1 : 0;
+  return message.account.Assign(orderInsert.GetAccount()) and        //
+         message.instrument.Assign(orderInsert.GetInstrument()) and   //
+         message.clientId.Assign(orderInsert.GetClientId());
+}
+
+bool moboware::modules::binary::Encode(const OrderAmendData &orderAmend, OrderAmendMessage &message)
+{
+  InitHeader(message);
+  message.price = orderAmend.GetPrice();
+  message.newPrice = orderAmend.GetNewPrice();
+  message.volume = orderAmend.GetVolume();
+  message.newVolume = orderAmend.GetNewVolume();
+  message.orderType = orderAmend.GetType();
+  message.isBuySide = orderAmend.GetIsBuySide() ? 1 : 0;
+  return message.account.Assign(orderAmend.GetAccount()) and        //
+         message.instrument.Assign(orderAmend.GetInstrument()) and   //
+         message.id.Assign(orderAmend.GetId()) and                   //
+         message.clientId.Assign(orderAmend.GetClientId());
+}
+
+bool moboware::modules::binary::Encode(const OrderCancelData &orderCancel, OrderCancelMessage &message)
+{
+  InitHeader(message);
+  message.price = orderCancel.GetPrice();
+  message.isBuySide = orderCancel.GetIsBuySide() ? 1 : 0;
+  return message.instrument.Assign(orderCancel.GetInstrument()) and   //
+         message.id.Assign(orderCancel.GetId()) and                   //
+         message.clientId.Assign(orderCancel.GetClientId());
+}
+
+bool moboware::modules::binary::Encode(const OrderMassCancelData &orderMassCancel, MassCancelMessage &message)
+{
+  InitHeader(message);
+  message.scope = orderMassCancel.GetScope();
+  return message.account.Assign(orderMassCancel.GetAccount()) and         //
+         message.instrument.Assign(orderMassCancel.GetInstrument()) and   //
+         message.clientId.Assign(orderMassCancel.GetClientId());
+}
+
+bool moboware::modules::binary::Encode(const std::string_view instrument, GetBookMessage &message)
+{
+  InitHeader(message);
+  return message.instrument.Assign(instrument);
+}
+
+bool moboware::modules::binary::Encode(const std::string_view instrument, SubscribeMessage &message)
+{
+  InitHeader(message);
+  return message.instrument.Assign(instrument);
+}
+
+bool moboware::modules::binary::Encode(const std::string_view instrument, UnsubscribeMessage &message)
+{
+  InitHeader(message);
+  return message.instrument.Assign(instrument);
+}
+
+bool moboware::modules::binary::Encode(const OrderReply &orderReply, OrderReplyMessage &message)
+{
+  InitHeader(message);
+  return message.id.Assign(orderReply.GetId()) and   //
+         message.clientId.Assign(orderReply.GetClientId());
+}
+
+bool moboware::modules::binary::Encode(const Trade &trade, TradeMessage &message)
+{
+  InitHeader(message);
+  message.tradedPrice = trade.GetTradedPrice();
+  message.tradedVolume = trade.GetTradedVolume();
+  return message.account.Assign(trade.GetAccount()) and   //
+         message.id.Assign(trade.GetId()) and             //
+         message.clientId.Assign(trade.GetClientId());
+}
+
+bool moboware::modules::binary::Encode(const ErrorReply &errorReply, ErrorReplyMessage &message)
+{
+  InitHeader(message);
+  // an error reply is always sent, the strings are truncated when they do not fit
+  const std::string_view clientId{errorReply.GetClientId()};
+  const std::string_view errorMessage{errorReply.GetErrorMessage()};
+  message.clientId.Assign(clientId.substr(0, sizeof(message.clientId.data)));
+  message.error.Assign(errorMessage.substr(0, sizeof(message.error.data)));
+  return clientId.size() <= sizeof(message.clientId.data) and errorMessage.size() <= sizeof(message.error.data);
+}
+
+bool moboware::modules::binary::Encode(const LevelUpdate &levelUpdate, LevelUpdateMessage &message)
+{
+  InitHeader(message);
+  message.price = levelUpdate.price;
+  message.volume = levelUpdate.volume;
+  message.orderCount = static_cast<std::uint32_t>(levelUpdate.orderCount);
+  message.isBuySide = levelUpdate.isBuySide ? 1 : 0;
+  return message.instrument.Assign(levelUpdate.instrument);
+}
+
+bool moboware::modules::binary::Encode(const PublicTrade &publicTrade, PublicTradeMessage &message)
+{
+  InitHeader(message);
+  message.price = publicTrade.price;
+  message.volume = publicTrade.volume;
+  message.isBuySide = publicTrade.isBuySide ? 1 : 0;
+  return message.instrument.Assign(publicTrade.instrument);
+}
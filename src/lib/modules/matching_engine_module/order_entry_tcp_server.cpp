@@ -0,0 +1,79 @@
+#include "modules/matching_engine_module/order_entry_tcp_server.h"
+#include "common/logger.hpp"
+
+using namespace moboware::modules;
+using namespace moboware::common;
+
+OrderEntryTcpServer::OrderEntryTcpServer(const std::shared_ptr<common::Service> &service,
+                                         const std::shared_ptr<common::ChannelInterface> &channelInterface,
+                                         const GetOrderEventProcessorFn_t &getOrderEventProcessorFn,
+                                         const SessionClosedFn_t &sessionClosedFn)
+  : m_ChannelInterface(channelInterface)
+  , m_GetOrderEventProcessorFn(getOrderEventProcessorFn)
+  , m_SessionClosedFn(sessionClosedFn)
+  , m_TcpSocketServer(service, *this)
+{
+}
+
+bool OrderEntryTcpServer::Start(const std::string &address, const std::uint16_t port)
+{
+  LOG_INFO("Start order entry tcp server on {}:{}", address, port);
+  return m_TcpSocketServer.Start(address, port);
+}
+
+void OrderEntryTcpServer::SendWebSocketData(const boost::asio::const_buffer &sendBuffer, const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  if (m_TcpSocketServer.HasSession(endpoint)) {
+    // the binary messages are length delimited, they are queued for the writer of the session as they are, the engine thread does
+    // not wait for the socket
+    (void)m_TcpSocketServer.QueueSocketData(sendBuffer, endpoint);
+    return;
+  }
+  m_ChannelInterface->SendWebSocketData(sendBuffer, endpoint);
+}
+
+void OrderEntryTcpServer::PublishWebSocketData(const common::SharedBuffer_t &sharedBuffer,
+                                               const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+                                               const common::ConflationKey_t conflationKey)
+{
+  if (not m_TcpSocketServer.HasConnectedClients()) {
+    m_ChannelInterface->PublishWebSocketData(sharedBuffer, endpoints, conflationKey);
+    return;
+  }
+
+  // the tcp sessions queue a reference to the shared buffer, like the web socket sessions
+  std::vector<boost::asio::ip::tcp::endpoint> otherEndpoints;
+  for (const auto &endpoint : endpoints) {
+    if (m_TcpSocketServer.HasSession(endpoint)) {
+      (void)m_TcpSocketServer.QueueSocketData(sharedBuffer, conflationKey, endpoint);
+    } else {
+      otherEndpoints.push_back(endpoint);
+    }
+  }
+
+  if (not otherEndpoints.empty()) {
+    m_ChannelInterface->PublishWebSocketData(sharedBuffer, otherEndpoints, conflationKey);
+  }
+}
+
+void OrderEntryTcpServer::OnDataRead(const socket::RingBuffer_t &readBuffer,
+                                     const boost::asio::ip::tcp::endpoint &endpoint,
+                                     [[maybe_unused]] const common::SessionTimePoint_t &sessionTimePoint)
+{
+  const auto orderEventProcessor{m_GetOrderEventProcessorFn(endpoint)};
+
+  // only the complete messages are flushed from the receive buffer
+  readBuffer.ReadBuffer(
+    [&](const char *data, const std::size_t bytesAvailable) { return orderEventProcessor->ProcessStream(data, bytesAvailable); });
+}
+
+void OrderEntryTcpServer::OnSessionConnected(const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_INFO("Order entry tcp session connected {}:{}", endpoint.address().to_string(), endpoint.port());
+}
+
+void OrderEntryTcpServer::OnSessionClosed(const boost::asio::ip::tcp::endpoint &endpoint)
+{
+  LOG_INFO("Order entry tcp session closed {}:{}", endpoint.address().to_string(), endpoint.port());
+  m_SessionClosedFn(endpoint);
+}
@@ -16,29 +16,70 @@ OrderEventProcessor::OrderEventProcessor(const std::weak_ptr<IOrderHandler> &ord
 
 void OrderEventProcessor::Process(const boost::beast::flat_buffer &readBuffer)
 {
-  json::stream_parser parser;
+  const auto *const messageData{static_cast<const char *>(readBuffer.data().data())};
+  const auto messageSize{readBuffer.data().size()};
+  if (binary::IsBinaryMessage(messageData, messageSize)) {
+    if (ProcessStream(messageData, messageSize) != messageSize) {
+      LOG_ERROR("Incomplete binary message of {} bytes", messageSize);
+    }
+    return;
+  }
+
+  ProcessJson(messageData, messageSize);
+}
+
+const std::array<std::pair<std::string_view, OrderEventProcessor::ActionHandler_t>, 7> OrderEventProcessor::ActionHandlers{
+  {{Fields::Insert, &OrderEventProcessor::HandleOrderInsert},
+   {Fields::Cancel, &OrderEventProcessor::HandleOrderCancel},
+   {Fields::Amend, &OrderEventProcessor::HandleOrderAmend},
+   {Fields::MassCancel, &OrderEventProcessor::HandleOrderMassCancel},
+   {Fields::GetBook, &OrderEventProcessor::GetOrderBook},
+   {Fields::Subscribe, &OrderEventProcessor::SubscribeMarketData},
+   {Fields::Unsubscribe, &OrderEventProcessor::UnsubscribeMarketData}}
+};
+
+auto OrderEventProcessor::FindActionHandler(const std::string_view action) -> ActionHandler_t
+{
+  for (const auto &[actionName, actionHandler] : ActionHandlers) {
+    if (actionName == action) {
+      return actionHandler;
+    }
+  }
+  return nullptr;
+}
+
+void OrderEventProcessor::ProcessJson(const char *data, const std::size_t size)
+{
+  // destroy what is left of the previous message before the arena is rewound, the parser then allocates from the start of the
+  // arena again
+  m_Parser.reset();
+  m_ParseResource.release();
+  m_Parser.reset(json::storage_ptr(&m_ParseResource));
+
   system::error_code ec;
-  if (0 == parser.write((const char *)readBuffer.data().data(),   //
-                        readBuffer.data().size(),                 //
-                        ec)) {
+  m_Parser.write(data,   //
+                 size,   //
+                 ec);
+  if (not ec) {
+    m_Parser.finish(ec);   // a web socket message is one complete json text
+  }
+  if (ec) {
     LOG_ERROR("Failed to parse message {}", ec.to_string());
     return;
   }
 
-  const json::value &rootDocument{parser.release()};
+  const json::value rootDocument{m_Parser.release()};
   LOG_DEBUG("Root doc:", rootDocument);
 
   const auto &action{rootDocument.at(Fields::Action)};
-  const auto &data{rootDocument.at(Fields::Data)};
-  LOG_DEBUG("{}:{}:{}", Fields::Action, action, data);
-  if (action.as_string() == Fields::Insert) {
-    HandleOrderInsert(data);
-  } else if (action.as_string() == Fields::Cancel) {
-    HandleOrderCancel(data);
-  } else if (action.as_string() == Fields::Amend) {
-    HandleOrderAmend(data);
-  } else if (action.as_string() == Fields::GetBook) {
-    GetOrderBook(data);
+  const auto &messageData{rootDocument.at(Fields::Data)};
+  LOG_DEBUG("{}:{}:{}", Fields::Action, action, messageData);
+
+  const auto actionHandler{FindActionHandler(action.as_string())};
+  if (actionHandler) {
+    (this->*actionHandler)(messageData);
+  } else {
+    LOG_ERROR("Unknown action {}", action);
   }
 }
 
@@ -75,9 +116,127 @@ void OrderEventProcessor::HandleOrderAmend(const boost::json::value &data)
   }
 }
 
+void OrderEventProcessor::HandleOrderMassCancel(const boost::json::value &data)
+{
+  OrderMassCancelData orderMassCancel;
+
+  if (orderMassCancel.SetData(data)) {
+    m_OrderHandler.lock()->HandleOrderMassCancel(orderMassCancel, m_Endpoint);
+  } else {
+    LOG_ERROR("Order mass cancel validation failed");
+  }
+}
+
 void OrderEventProcessor::GetOrderBook(const boost::json::value &data)
 {
   const auto instrument{data.at(Fields::Instrument).as_string().c_str()};
 
-  m_OrderHandler.lock()->GetOrderBook(instrument, m_Endpoint);
-}
\ No newline at end of file
+  m_OrderHandler.lock()->GetOrderBook(instrument, ReplyFormat::Json, m_Endpoint);
+}
+
+void OrderEventProcessor::SubscribeMarketData(const boost::json::value &data)
+{
+  const auto instrument{data.at(Fields::Instrument).as_string().c_str()};
+
+  m_OrderHandler.lock()->SubscribeMarketData(instrument, ReplyFormat::Json, m_Endpoint);
+}
+
+void OrderEventProcessor::UnsubscribeMarketData(const boost::json::value &data)
+{
+  const auto instrument{data.at(Fields::Instrument).as_string().c_str()};
+
+  m_OrderHandler.lock()->UnsubscribeMarketData(instrument, m_Endpoint);
+}
+
+auto OrderEventProcessor::ProcessStream(const char *data, const std::size_t size) -> std::size_t
+{
+  std::size_t processedBytes{};
+  while (processedBytes < size) {
+    const auto *const messageData{data + processedBytes};
+    const auto bytesAvailable{size - processedBytes};
+
+    const auto *const header{binary::DecodeHeader(messageData, bytesAvailable)};
+    if (not header) {
+      if (not binary::IsBinaryMessage(messageData, bytesAvailable)) {
+        // the stream is out of sync, there is no way to find the next message boundary
+        LOG_ERROR("Invalid binary message, drop {} bytes", bytesAvailable);
+        return size;
+      }
+      break;   // partial message, wait for more data
+    }
+
+    HandleBinaryMessage(*header);
+    processedBytes += header->length;
+  }
+
+  return processedBytes;
+}
+
+void OrderEventProcessor::HandleBinaryMessage(const binary::MessageHeader &header)
+{
+  switch (header.messageType) {
+  case binary::MessageType::Insert:
+    if (const auto *const message{binary::DecodeMessage<binary::OrderInsertMessage>(header)}; message) {
+      auto orderInsert{binary::ToOrderInsertData(*message)};
+      if (orderInsert.Validate()) {
+        m_OrderHandler.lock()->HandleOrderInsert(std::move(orderInsert), m_Endpoint);
+        return;
+      }
+    }
+    break;
+  case binary::MessageType::Amend:
+    if (const auto *const message{binary::DecodeMessage<binary::OrderAmendMessage>(header)}; message) {
+      const auto orderAmend{binary::ToOrderAmendData(*message)};
+      if (orderAmend.Validate()) {
+        m_OrderHandler.lock()->HandleOrderAmend(orderAmend, m_Endpoint);
+        return;
+      }
+    }
+    break;
+  case binary::MessageType::Cancel:
+    if (const auto *const message{binary::DecodeMessage<binary::OrderCancelMessage>(header)}; message) {
+      const auto orderCancel{binary::ToOrderCancelData(*message)};
+      if (orderCancel.Validate()) {
+        m_OrderHandler.lock()->HandleOrderCancel(orderCancel, m_Endpoint);
+        return;
+      }
+    }
+    break;
+  case binary::MessageType::GetBook:
+    if (const auto *const message{binary::DecodeMessage<binary::GetBookMessage>(header)}; message) {
+      m_OrderHandler.lock()->GetOrderBook(std::string(message->instrument.View()), ReplyFormat::Binary, m_Endpoint);
+      return;
+    }
+    break;
+  case binary::MessageType::Subscribe:
+    if (const auto *const message{binary::DecodeMessage<binary::SubscribeMessage>(header)}; message) {
+      m_OrderHandler.lock()->SubscribeMarketData(std::string(message->instrument.View()), ReplyFormat::Binary, m_Endpoint);
+      return;
+    }
+    break;
+  case binary::MessageType::Unsubscribe:
+    if (const auto *const message{binary::DecodeMessage<binary::UnsubscribeMessage>(header)}; message) {
+      m_OrderHandler.lock()->UnsubscribeMarketData(std::string(message->instrument.View()), m_Endpoint);
+      return;
+    }
+    break;
+  case binary::MessageType::MassCancel:
+    if (const auto *const message{binary::DecodeMessage<binary::MassCancelMessage>(header)}; message) {
+      const auto orderMassCancel{binary::ToOrderMassCancelData(*message)};
+      if (orderMassCancel.Validate()) {
+        m_OrderHandler.lock()->HandleOrderMassCancel(orderMassCancel, m_Endpoint);
+        return;
+      }
+    }
+    break;
+  case binary::MessageType::Unknown:
+  case binary::MessageType::OrderReply:
+  case binary::MessageType::Trade:
+  case binary::MessageType::ErrorReply:
+  case binary::MessageType::LevelUpdate:
+  case binary::MessageType::PublicTrade:
+    break;   // not an order entry message
+  }
+
+  LOG_ERROR("Binary message validation failed, type:{}, length:{}", static_cast<int>(header.messageType), header.length);
+}
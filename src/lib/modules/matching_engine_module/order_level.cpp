@@ -3,151 +3,84 @@
 
 using namespace moboware::modules;
 
-OrderLevel::OrderLevel(OrderInsertData &&orderData)
+OrderLevel::OrderLevel(OrderNode *node)
 {
-  const auto insertedOrder{Insert(std::forward<OrderInsertData>(orderData))};
+  Insert(node);
 }
 
 auto OrderLevel::GetSize() const -> std::size_t
 {
-  return m_TimeQueue.size();
+  return m_Size;
 }
 
 auto OrderLevel::IsEmpty() const -> bool
 {
-  return m_TimeQueue.empty();
+  return m_Head == nullptr;
 }
 
-auto OrderLevel::GetTopLevel() const -> std::optional<OrderInsertData>
+auto OrderLevel::GetTopLevel() const -> std::optional<Order>
 {
-  std::optional<OrderInsertData> topLevel;
-  if (not m_TimeQueue.empty()) {
-    topLevel = *m_TimeQueue.begin();
+  std::optional<Order> topLevel;
+  if (m_Head) {
+    topLevel = m_Head->order;
   }
   return topLevel;
 }
 
-auto OrderLevel::TradeTopLevel(const VolumeType_t volume, const std::function<void(const Trade &)> &tradedFn) const -> VolumeType_t
+auto OrderLevel::GetLevels(const std::function<bool(const OrderNode &)> &orderLevelFunction) const -> bool
 {
-  VolumeType_t tradedVolume{};
-  if (not m_TimeQueue.empty()) {
-    auto &topLevel = *m_TimeQueue.begin();
-    if (topLevel.GetVolume() >= volume) {
-      topLevel.SetVolume(topLevel.GetVolume() - volume);   // partial trade
-      tradedVolume = volume;
-    } else if (volume > topLevel.GetVolume()) {
-      tradedVolume = topLevel.GetVolume();
-      topLevel.SetVolume(0);   // full trade!!!
-    }
-    // Send the Trade
-    const Trade trade{topLevel.GetAccount(), topLevel.GetPrice(), tradedVolume, topLevel.GetId(), topLevel.GetClientId()};
-    tradedFn(trade);
-    if (topLevel.GetVolume() == 0) {
-      //  remove level
-      m_TimeQueue.erase(m_TimeQueue.begin());
-    }
-  }
-  return tradedVolume;
-}
-
-auto OrderLevel::GetLevels(const std::function<bool(const OrderInsertData &)> &orderLevelFunction) const -> bool
-{
-  for (const auto &orderData : m_TimeQueue) {
-    if (not orderLevelFunction(orderData)) {
+  for (const auto *node{m_Head}; node != nullptr; node = node->next) {
+    if (not orderLevelFunction(*node)) {
       return false;
     }
   }
   return true;
 }
 
-const OrderInsertData *OrderLevel::Insert(OrderInsertData &&orderData) noexcept
+void OrderLevel::Insert(OrderNode *node) noexcept
 {
-  const auto iter{m_TimeQueue.insert(m_TimeQueue.end(), orderData)};
-
-  return (iter != m_TimeQueue.end()) ? &(*iter) : nullptr;
-}
-
-bool OrderLevel::CancelOrder(const Id_t &orderId) noexcept
-{
-  LOG_DEBUG("Cancel order id {}", orderId);
-  for (auto iter{m_TimeQueue.cbegin()}; iter != std::end(m_TimeQueue); ++iter) {
-    const auto &orderData{*iter};
-    if (orderData.GetId() == orderId) {
-      m_TimeQueue.erase(iter);
-      return true;
-    }
+  node->prev = m_Tail;
+  node->next = nullptr;
+  if (m_Tail) {
+    m_Tail->next = node;
+  } else {
+    m_Head = node;
   }
-  return false;
+  m_Tail = node;
+  m_Size++;
+  m_TotalVolume += node->order.GetVolume();
 }
 
-bool OrderLevel::ChangeOrderVolume(const Id_t &orderId, const VolumeType_t newVolume) noexcept
+void OrderLevel::CancelOrder(OrderNode *node) noexcept
 {
-  /*const auto p{ [&orderId](const OrderInsertData& orderData) {
-    return orderId == orderData.GetId();
-  } };
-
-  auto result = std::find_if(std::begin(m_TimeQueue),
-                             std::end(m_TimeQueue), //
-                             p);
-
-  if (result != std::end(m_TimeQueue)) {
-    auto& orderData = *result;
-    orderData.SetVolume(newVolume);
-    return true;
-  }
-
-  return false;
-*/
-  const auto orderFoundFn{[newVolume](OrderInsertData &orderData) {
-    orderData.SetVolume(newVolume);
-  }};
-  return Find(orderId, orderFoundFn);
+  LOG_DEBUG("Cancel order id {}", node->id);
+  (node->prev ? node->prev->next : m_Head) = node->next;
+  (node->next ? node->next->prev : m_Tail) = node->prev;
+  node->prev = nullptr;
+  node->next = nullptr;
+  m_Size--;
+  m_TotalVolume -= node->order.GetVolume();
 }
 
-auto OrderLevel::Find(const Id_t &orderId, const std::function<void(OrderInsertData &)> &orderFoundFn) -> bool
+void OrderLevel::ChangeOrderVolume(OrderNode *node, const VolumeType_t newVolume) noexcept
 {
-  const auto p{[&orderId](const OrderInsertData &orderData) {
-    return orderId == orderData.GetId();
-  }};
-
-  auto result = std::find_if(std::begin(m_TimeQueue),
-                             std::end(m_TimeQueue),   //
-                             p);
-
-  if (result != std::end(m_TimeQueue)) {
-    auto &orderData = *result;
-
-    orderFoundFn(orderData);
-    return true;
-  }
-  return false;
+  m_TotalVolume = m_TotalVolume - node->order.GetVolume() + newVolume;
+  node->order.SetVolume(newVolume);
 }
 
-auto OrderLevel::MoveOrder(const Id_t &orderId, const std::function<void(OrderInsertData &&orderData)> &moveOrderFn) -> bool
+void OrderLevel::Clear(const std::function<void(OrderNode *)> &releaseFn)
 {
-  // find the order in this level and move it to the other level
-  const auto p{[&orderId](const OrderInsertData &orderData) {
-    return orderId == orderData.GetId();
-  }};
-
-  auto result = std::find_if(std::begin(m_TimeQueue),
-                             std::end(m_TimeQueue),   //
-                             p);
-
-  if (result != std::end(m_TimeQueue)) {
-
-    moveOrderFn(std::move(*result));
-    // erase the order from this level. Remember that this level could be empty now.
-    m_TimeQueue.erase(result);
-    return true;
+  while (m_Head) {
+    auto *const node{m_Head};
+    CancelOrder(node);
+    releaseFn(node);
   }
-  return false;
 }
 
-const OrderInsertData *OrderLevel::GetLastOrder() noexcept
+const OrderNode *OrderLevel::GetLastOrder() const noexcept
 {
-  if (not m_TimeQueue.empty()) {
-    return &m_TimeQueue.back();
+  if (m_Tail) {
+    return m_Tail;
   }
 
   return nullptr;
@@ -0,0 +1,52 @@
+#include "modules/matching_engine_module/order_node_pool.h"
+
+using namespace moboware::modules;
+
+OrderNodePool::OrderNodePool(const std::size_t slabSize)
+  : m_SlabSize(slabSize == 0 ? 1 : slabSize)
+{
+}
+
+auto OrderNodePool::Acquire(const Order &order, const Id_t &id, const ClientId_t &clientId) -> OrderNode *
+{
+  if (not m_FreeList) {
+    AddSlab();
+  }
+
+  auto *const node{m_FreeList};
+  m_FreeList = node->next;
+
+  node->order = order;
+  node->id = id;
+  node->clientId = clientId;
+  node->prev = nullptr;
+  node->next = nullptr;
+  node->accountLinks = OrderLinks{};
+  node->sessionLinks = OrderLinks{};
+  node->session = {};
+  m_Size++;
+  return node;
+}
+
+void OrderNodePool::Release(OrderNode *node) noexcept
+{
+  // a released node has no order id, a stale reference to the node does not match the order it had
+  node->order = Order{};
+  node->prev = nullptr;
+  node->next = m_FreeList;
+  m_FreeList = node;
+  m_Size--;
+}
+
+void OrderNodePool::AddSlab()
+{
+  auto slab{std::make_unique<OrderNode[]>(m_SlabSize)};
+
+  // link the new nodes in the free list, in address order
+  for (auto i{m_SlabSize}; i-- > 0;) {
+    slab[i].next = m_FreeList;
+    m_FreeList = &slab[i];
+  }
+
+  m_Slabs.push_back(std::move(slab));
+}
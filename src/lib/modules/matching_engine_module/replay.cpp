@@ -0,0 +1,119 @@
+#include "modules/matching_engine_module/replay.h"
+#include "common/logger.hpp"
+
+using namespace moboware::modules;
+using namespace moboware::modules::journal;
+
+namespace {
+/// @brief the record of the header, nullptr when the record is too short for its type
+template <typename TRecord> auto GetRecord(const RecordHeader &recordHeader) -> const TRecord *
+{
+  if (recordHeader.length < sizeof(TRecord)) {
+    LOG_ERROR("Journal record {} is too short for its type", recordHeader.sequence);
+    return nullptr;
+  }
+  return reinterpret_cast<const TRecord *>(&recordHeader);
+}
+}   // namespace
+
+void ReplayChannel::SendWebSocketData(const boost::asio::const_buffer &sendBuffer, const boost::asio::ip::tcp::endpoint &)
+{
+  m_ReplyCount++;
+
+  const auto *const data{static_cast<const std::uint8_t *>(sendBuffer.data())};
+  for (std::size_t index{}; index < sendBuffer.size(); index++) {
+    m_Checksum = (m_Checksum ^ data[index]) * FnvPrime;
+  }
+}
+
+JournalReplay::JournalReplay(const GetMatchingEngineFn_t &getMatchingEngineFn)
+  : m_GetMatchingEngineFn(getMatchingEngineFn)
+{
+}
+
+auto JournalReplay::Replay(JournalReader &journalReader) -> std::uint64_t
+{
+  return journalReader.ForEach([this](const RecordHeader &recordHeader) { Apply(recordHeader); });
+}
+
+void JournalReplay::Apply(const RecordHeader &recordHeader)
+{
+  m_Stats.records++;
+
+  auto *const matchingEngine{m_GetMatchingEngineFn(recordHeader.instrument.View())};
+  if (not matchingEngine) {
+    m_Stats.unknownInstrumentRecords++;
+    return;
+  }
+
+  // the input is already in the order books that are loaded from a snapshot
+  if (recordHeader.inputSequence <= matchingEngine->GetInputSequence()) {
+    m_Stats.skippedRecords++;
+    return;
+  }
+
+  // the expiry wheel is turned by the journaled times, a wheel without expiries restarts at the time of the record
+  matchingEngine->SetExpiryTime(ToOrderTime(recordHeader.time));
+
+  Execute(*matchingEngine, recordHeader);
+  m_Stats.appliedRecords++;
+
+  if (matchingEngine->GetInputSequence() != recordHeader.inputSequence) {
+    if (m_Stats.divergedRecords == 0) {
+      LOG_WARN("Replay diverged at journal sequence {}, instrument:{}, input sequence:{}, engine input sequence:{}",
+               recordHeader.sequence,
+               recordHeader.instrument.View(),
+               recordHeader.inputSequence,
+               matchingEngine->GetInputSequence());
+    }
+    m_Stats.divergedRecords++;
+  }
+}
+
+void JournalReplay::Execute(IMatchingEngine &matchingEngine, const RecordHeader &recordHeader)
+{
+  const auto endpoint{ToEndpoint(recordHeader.session)};
+  switch (recordHeader.type) {
+  case RecordType::Insert:
+    if (const auto *const record{GetRecord<InsertRecord>(recordHeader)}) {
+      // the order id and the order time are generated when the input is received, the journal has the generated values
+      auto orderInsert{binary::ToOrderInsertData(record->message)};
+      orderInsert.SetId(Id_t(record->id.View()));
+      orderInsert.SetOrderTime(ToOrderTime(recordHeader.time));
+      orderInsert.SetReplyFormat(recordHeader.replyFormat);
+      matchingEngine.OrderInsert(std::move(orderInsert), endpoint);
+    }
+    break;
+  case RecordType::Amend:
+    if (const auto *const record{GetRecord<AmendRecord>(recordHeader)}) {
+      auto orderAmend{binary::ToOrderAmendData(record->message)};
+      orderAmend.SetOrderTime(ToOrderTime(recordHeader.time));
+      orderAmend.SetReplyFormat(recordHeader.replyFormat);
+      matchingEngine.OrderAmend(orderAmend, endpoint);
+    }
+    break;
+  case RecordType::Cancel:
+    if (const auto *const record{GetRecord<CancelRecord>(recordHeader)}) {
+      auto orderCancel{binary::ToOrderCancelData(record->message)};
+      orderCancel.SetReplyFormat(recordHeader.replyFormat);
+      matchingEngine.OrderCancel(orderCancel, endpoint);
+    }
+    break;
+  case RecordType::MassCancel:
+    if (const auto *const record{GetRecord<MassCancelRecord>(recordHeader)}) {
+      auto orderMassCancel{binary::ToOrderMassCancelData(record->message)};
+      orderMassCancel.SetReplyFormat(recordHeader.replyFormat);
+      matchingEngine.OrderMassCancel(orderMassCancel, endpoint);
+    }
+    break;
+  case RecordType::CancelSessionOrders:
+    matchingEngine.CancelSessionOrders(endpoint);
+    break;
+  case RecordType::ExpireOrders:
+    matchingEngine.ExpireOrders(ToOrderTime(recordHeader.time));
+    break;
+  default:
+    LOG_ERROR("Journal record {} has unknown type {}", recordHeader.sequence, static_cast<int>(recordHeader.type));
+    break;
+  }
+}
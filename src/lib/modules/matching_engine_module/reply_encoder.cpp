@@ -0,0 +1,95 @@
+#include "modules/matching_engine_module/reply_encoder.h"
+#include "common/logger.hpp"
+#include "modules/matching_engine_module/order_entry_protocol.h"
+#include <fmt/compile.h>
+
+using namespace moboware::modules;
+
+template <typename TMessage, typename TReply> void ReplyEncoder::EncodeBinary(const TReply &reply)
+{
+  TMessage message;
+  if (not binary::Encode(reply, message)) {
+    LOG_WARN("Binary reply field truncated, type:{}", static_cast<int>(TMessage::Type));
+  }
+
+  const auto *const messageData{reinterpret_cast<const char *>(&message)};
+  m_Buffer.append(messageData, messageData + sizeof(message));
+}
+
+auto ReplyEncoder::Encode(const OrderReply &orderReply) -> boost::asio::const_buffer
+{
+  m_Buffer.clear();
+  if (m_Format == ReplyFormat::Binary) {
+    EncodeBinary<binary::OrderReplyMessage>(orderReply);
+  } else {
+    fmt::format_to(std::back_inserter(m_Buffer),
+                   FMT_COMPILE(R"({{"OrderReply":{{"Id":"{}","ClientId":"{}"}}}})"),
+                   orderReply.GetId(),
+                   orderReply.GetClientId());
+  }
+  return GetBuffer();
+}
+
+auto ReplyEncoder::Encode(const Trade &trade) -> boost::asio::const_buffer
+{
+  m_Buffer.clear();
+  if (m_Format == ReplyFormat::Binary) {
+    EncodeBinary<binary::TradeMessage>(trade);
+  } else {
+    fmt::format_to(std::back_inserter(m_Buffer),
+                   FMT_COMPILE(R"({{"Trade":{{"Id":"{}","ClientId":"{}","Account":"{}","TradedPrice":{},"TradedVolume":{}}}}})"),
+                   trade.GetId(),
+                   trade.GetClientId(),
+                   trade.GetAccount(),
+                   trade.GetTradedPrice(),
+                   trade.GetTradedVolume());
+  }
+  return GetBuffer();
+}
+
+auto ReplyEncoder::Encode(const ErrorReply &errorReply) -> boost::asio::const_buffer
+{
+  m_Buffer.clear();
+  if (m_Format == ReplyFormat::Binary) {
+    EncodeBinary<binary::ErrorReplyMessage>(errorReply);
+  } else {
+    fmt::format_to(std::back_inserter(m_Buffer),
+                   FMT_COMPILE(R"({{"ErrorReply":{{"ClientId":"{}","Error":"{}"}}}})"),
+                   errorReply.GetClientId(),
+                   errorReply.GetErrorMessage());
+  }
+  return GetBuffer();
+}
+
+auto ReplyEncoder::Encode(const LevelUpdate &levelUpdate) -> boost::asio::const_buffer
+{
+  m_Buffer.clear();
+  if (m_Format == ReplyFormat::Binary) {
+    EncodeBinary<binary::LevelUpdateMessage>(levelUpdate);
+  } else {
+    fmt::format_to(std::back_inserter(m_Buffer),
+                   FMT_COMPILE(R"({{"LevelUpdate":{{"Instrument":"{}","IsBuy":{},"Price":{},"Volume":{},"OrderCount":{}}}}})"),
+                   levelUpdate.instrument,
+                   levelUpdate.isBuySide,
+                   levelUpdate.price,
+                   levelUpdate.volume,
+                   levelUpdate.orderCount);
+  }
+  return GetBuffer();
+}
+
+auto ReplyEncoder::Encode(const PublicTrade &publicTrade) -> boost::asio::const_buffer
+{
+  m_Buffer.clear();
+  if (m_Format == ReplyFormat::Binary) {
+    EncodeBinary<binary::PublicTradeMessage>(publicTrade);
+  } else {
+    fmt::format_to(std::back_inserter(m_Buffer),
+                   FMT_COMPILE(R"({{"PublicTrade":{{"Instrument":"{}","IsBuy":{},"Price":{},"Volume":{}}}}})"),
+                   publicTrade.instrument,
+                   publicTrade.isBuySide,
+                   publicTrade.price,
+                   publicTrade.volume);
+  }
+  return GetBuffer();
+}
@@ -0,0 +1,61 @@
+#include "modules/matching_engine_module/shard_scheduler.h"
+#include <algorithm>
+#include <fmt/format.h>
+
+using namespace moboware::modules;
+
+ShardScheduler::ShardScheduler(const std::vector<int> &cpus, const std::size_t virtualNodesPerCpu)
+  : m_Cpus(cpus)
+{
+  // remove duplicate cpus, a cpu with more entries would get more virtual nodes
+  std::sort(std::begin(m_Cpus), std::end(m_Cpus));
+  m_Cpus.erase(std::unique(std::begin(m_Cpus), std::end(m_Cpus)), std::end(m_Cpus));
+
+  m_HashRing.reserve(m_Cpus.size() * virtualNodesPerCpu);
+  for (const auto cpu : m_Cpus) {
+    for (std::size_t virtualNode = 0; virtualNode < virtualNodesPerCpu; virtualNode++) {
+      m_HashRing.emplace_back(Hash(fmt::format("cpu{}#{}", cpu, virtualNode)), cpu);
+    }
+  }
+
+  std::sort(std::begin(m_HashRing), std::end(m_HashRing));
+}
+
+auto ShardScheduler::GetCpu(const std::string_view instrument) const -> std::optional<int>
+{
+  if (m_HashRing.empty()) {
+    return std::nullopt;
+  }
+
+  const auto hash{Hash(instrument)};
+  auto iter{std::lower_bound(std::begin(m_HashRing),
+                             std::end(m_HashRing),
+                             hash,
+                             [](const std::pair<std::uint64_t, int> &virtualNode, const std::uint64_t hash) { return virtualNode.first < hash; })};
+  if (iter == std::end(m_HashRing)) {
+    // wrap around the ring
+    iter = std::begin(m_HashRing);
+  }
+
+  return iter->second;
+}
+
+auto ShardScheduler::Hash(const std::string_view key) noexcept -> std::uint64_t
+{
+  constexpr std::uint64_t FnvOffsetBasis{14695981039346656037ull};
+  constexpr std::uint64_t FnvPrime{1099511628211ull};
+
+  auto hash{FnvOffsetBasis};
+  for (const auto c : key) {
+    hash ^= static_cast<std::uint8_t>(c);
+    hash *= FnvPrime;
+  }
+
+  // avalanche mix, spreads short keys that differ in the last characters over the whole ring
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
@@ -0,0 +1,203 @@
+#include "modules/matching_engine_module/snapshot.h"
+#include "common/logger.hpp"
+#include "common/mapped_file.h"
+#include "common/thread_affinity.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+using namespace moboware::modules;
+using namespace moboware::modules::snapshot;
+
+auto moboware::modules::snapshot::GetSnapshotFileName(const std::string_view instrument, const std::uint64_t inputSequence) -> std::string
+{
+  return fmt::format("snapshot_{}_{:020}.bin", instrument, inputSequence);
+}
+
+auto moboware::modules::snapshot::FindLatestSnapshot(const std::string &directory, const std::string_view instrument)
+  -> std::optional<std::string>
+{
+  const auto snapshots{ListSnapshots(directory, instrument)};
+  if (snapshots.empty()) {
+    return std::nullopt;
+  }
+  return snapshots.back();
+}
+
+auto moboware::modules::snapshot::ListSnapshots(const std::string &directory, const std::string_view instrument) -> std::vector<std::string>
+{
+  std::error_code ec;
+  if (not std::filesystem::is_directory(directory, ec)) {
+    return {};
+  }
+
+  const auto prefix{fmt::format("snapshot_{}_", instrument)};
+  const auto nameLength{GetSnapshotFileName(instrument, 0).size()};
+
+  std::vector<std::string> fileNames;
+  for (const auto &entry : std::filesystem::directory_iterator(directory, ec)) {
+    auto fileName{entry.path().filename().string()};
+    if (not entry.is_regular_file() or fileName.size() != nameLength or not fileName.starts_with(prefix) or
+        not fileName.ends_with(".bin") or
+        not std::all_of(std::begin(fileName) + prefix.size(), std::end(fileName) - 4, [](const char c) { return std::isdigit(c); })) {
+      continue;
+    }
+    fileNames.push_back(std::move(fileName));
+  }
+
+  if (ec) {
+    LOG_ERROR("Failed to list snapshot directory {}, {}", directory, ec.message());
+    return {};
+  }
+
+  // the sequence is zero padded, the file names sort on the input sequence
+  std::sort(std::begin(fileNames), std::end(fileNames));
+
+  std::vector<std::string> paths;
+  paths.reserve(fileNames.size());
+  for (const auto &fileName : fileNames) {
+    paths.push_back((std::filesystem::path(directory) / fileName).string());
+  }
+  return paths;
+}
+
+bool moboware::modules::snapshot::WriteSnapshotFile(const SnapshotImage &image, const std::string &directory)
+{
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  if (ec) {
+    LOG_ERROR("Failed to create snapshot directory {}, {}", directory, ec.message());
+    return false;
+  }
+
+  std::size_t orderCount{};
+  for (const auto &level : image.levels) {
+    orderCount += level->size();
+  }
+  const auto sessionCount{image.sessions.size()};
+  const auto size{sizeof(SnapshotHeader) + sessionCount * sizeof(SnapshotSession) + orderCount * sizeof(SnapshotOrder)};
+
+  const auto path{(std::filesystem::path(directory) / GetSnapshotFileName(image.instrument, image.inputSequence)).string()};
+  const auto tempPath{path + ".tmp"};
+  std::filesystem::remove(tempPath, ec);   // left behind by a crash during a snapshot
+
+  common::MappedFile file;
+  if (not file.Create(tempPath, size)) {
+    return false;
+  }
+
+  // the created file is zero filled, the reserved fields and the padding of the strings stay zero
+  auto &header{*reinterpret_cast<SnapshotHeader *>(file.GetData())};
+  std::copy(std::begin(SnapshotMagic), std::end(SnapshotMagic), header.magic);
+  header.version = SnapshotVersion;
+  header.headerLength = sizeof(SnapshotHeader);
+  const auto isTruncated{not header.instrument.Assign(image.instrument) or image.isTruncated};
+  header.inputSequence = image.inputSequence;
+  header.lastOrderId = image.lastOrderId;
+  header.expiryTick = image.expiryTick;
+  header.createTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  header.sessionCount = static_cast<std::uint32_t>(sessionCount);
+  header.orderCount = static_cast<std::uint32_t>(orderCount);
+
+  auto *data{file.GetData() + sizeof(SnapshotHeader)};
+  if (sessionCount > 0) {
+    std::memcpy(data, image.sessions.data(), sessionCount * sizeof(SnapshotSession));
+    data += sessionCount * sizeof(SnapshotSession);
+  }
+  for (const auto &level : image.levels) {
+    std::memcpy(data, level->data(), level->size() * sizeof(SnapshotOrder));
+    data += level->size() * sizeof(SnapshotOrder);
+  }
+
+  if (isTruncated) {
+    LOG_WARN("Snapshot {} has truncated fields", path);
+  }
+
+  file.SetUsedSize(size);
+  if (not file.Sync(0, size)) {
+    return false;
+  }
+  file.Close();
+
+  // the complete snapshot replaces an older snapshot of the same input sequence
+  std::filesystem::rename(tempPath, path, ec);
+  if (ec) {
+    LOG_ERROR("Failed to rename snapshot {} to {}, {}", tempPath, path, ec.message());
+    return false;
+  }
+
+  LOG_INFO("Snapshot {} written, input sequence:{}, orders:{}, sessions:{}", path, image.inputSequence, orderCount, sessionCount);
+  return true;
+}
+
+SnapshotWriter::SnapshotWriter(const std::string &directory, const std::size_t keepSnapshots)
+  : m_Directory(directory)
+  , m_KeepSnapshots(std::max<std::size_t>(keepSnapshots, 1))
+  , m_Thread([this](const std::stop_token &stopToken) { Run(stopToken); })
+{
+}
+
+void SnapshotWriter::Write(SnapshotImage &&image)
+{
+  const std::scoped_lock lock(m_Mutex);
+
+  // the newer image of the instrument makes the queued image obsolete
+  const auto iter{std::find_if(std::begin(m_Images), std::end(m_Images), [&](const SnapshotImage &queuedImage) {
+    return queuedImage.instrument == image.instrument;
+  })};
+  if (iter != std::end(m_Images)) {
+    *iter = std::move(image);
+    m_ReplacedSnapshots.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    m_Images.push_back(std::move(image));
+  }
+  m_ImageAvailable.notify_one();
+}
+
+auto SnapshotWriter::GetStats() const noexcept -> Stats
+{
+  return Stats{m_WrittenSnapshots.load(std::memory_order_relaxed),
+               m_FailedSnapshots.load(std::memory_order_relaxed),
+               m_ReplacedSnapshots.load(std::memory_order_relaxed)};
+}
+
+void SnapshotWriter::Run(const std::stop_token &stopToken)
+{
+  common::SetThreadName("snapshot");
+
+  while (true) {
+    SnapshotImage image;
+    {
+      std::unique_lock lock(m_Mutex);
+      m_ImageAvailable.wait(lock, stopToken, [this]() { return not m_Images.empty(); });
+      if (m_Images.empty()) {
+        return;   // stopped and all queued images are written
+      }
+      image = std::move(m_Images.front());
+      m_Images.pop_front();
+    }
+
+    // the levels of the image are shared with the matching engine but never changed, the file is written without a lock
+    if (WriteSnapshotFile(image, m_Directory)) {
+      m_WrittenSnapshots.fetch_add(1, std::memory_order_relaxed);
+      RemoveOldSnapshots(image.instrument);
+    } else {
+      m_FailedSnapshots.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void SnapshotWriter::RemoveOldSnapshots(const std::string_view instrument)
+{
+  const auto snapshots{ListSnapshots(m_Directory, instrument)};
+  if (snapshots.size() <= m_KeepSnapshots) {
+    return;
+  }
+
+  for (auto iter{std::begin(snapshots)}; iter != std::end(snapshots) - static_cast<std::ptrdiff_t>(m_KeepSnapshots); ++iter) {
+    std::error_code ec;
+    if (not std::filesystem::remove(*iter, ec) and ec) {
+      LOG_WARN("Failed to remove snapshot {}, {}", *iter, ec.message());
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#include "modules/matching_engine_module/symbol_table.h"
+
+using namespace moboware::modules;
+
+SymbolTable::SymbolTable()
+{
+  [[maybe_unused]] const auto handle{Intern({})};
+}
+
+auto SymbolTable::Intern(const std::string_view symbol) -> SymbolHandle_t
+{
+  const auto iter{m_Handles.find(symbol)};
+  if (iter != std::end(m_Handles)) {
+    return iter->second;
+  }
+
+  const auto handle{static_cast<SymbolHandle_t>(m_Symbols.size())};
+  m_Symbols.emplace_back(symbol);
+  m_Handles.emplace(m_Symbols.back(), handle);
+  return handle;
+}
+
+auto SymbolTable::Find(const std::string_view symbol) const -> std::optional<SymbolHandle_t>
+{
+  const auto iter{m_Handles.find(symbol)};
+  if (iter != std::end(m_Handles)) {
+    return iter->second;
+  }
+  return std::nullopt;
+}
+
+auto SymbolTable::GetSymbol(const SymbolHandle_t handle) const -> const std::string &
+{
+  return handle < m_Symbols.size() ? m_Symbols[handle] : m_Symbols[EmptySymbolHandle];
+}
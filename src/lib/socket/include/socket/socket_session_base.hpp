@@ -5,6 +5,7 @@
 #include "common/service.h"
 #include "common/types.hpp"
 #include <boost/asio/ip/tcp.hpp>
+#include <mutex>
 
 namespace moboware::socket {
 
@@ -53,6 +54,8 @@ protected:
 
 private:
   boost::asio::ip::tcp::endpoint m_RemoteEndpoint{};
+  // the data of a session can be sent from several threads, a write is not interleaved with the write of another thread
+  std::mutex m_WriteMutex;
 
   [[nodiscard]] virtual std::size_t ReadBuffer(socket::RingBuffer_t::BufferType_t *dataBuffer, const std::size_t requestedBufferSize) = 0;
   [[nodiscard]] virtual std::size_t WriteSocket(const std::vector<boost::asio::const_buffer> &sendBuffers, boost::system::error_code &ec) = 0;
@@ -157,7 +160,10 @@ std::size_t SocketSessionBase<TSessionCallback>::SendData(boost::asio::ip::tcp::
   if (IsOpen()) {
 
     boost::system::error_code ec;
-    const auto sendBytes{WriteSocket(sendBuffers, ec)};
+    const auto sendBytes{[&]() {
+      const std::lock_guard lock(m_WriteMutex);
+      return WriteSocket(sendBuffers, ec);
+    }()};
 
     if (ec.failed()) {
       LOG_ERROR("Write failed: {}", ec.what());
@@ -5,6 +5,7 @@
 #include <boost/asio/strand.hpp>
 #include <map>
 #include <memory>
+#include <shared_mutex>
 
 namespace moboware::tcp_socket {
 
@@ -26,24 +27,48 @@ public:
                                            const boost::asio::ip::tcp::endpoint &remoteEndPoint);
   void SendToAllClients(const std::vector<boost::asio::const_buffer> &sendBuffer);
 
+  /// @brief Queue the data in the write queue of the session, the calling thread does not wait for the socket
+  /// @return false when there is no session or the data is dropped
+  [[nodiscard]] bool QueueSocketData(const boost::asio::const_buffer &sendBuffer, const boost::asio::ip::tcp::endpoint &remoteEndPoint);
+  [[nodiscard]] bool QueueSocketData(const common::SharedBuffer_t &sharedBuffer,
+                                     const common::ConflationKey_t conflationKey,
+                                     const boost::asio::ip::tcp::endpoint &remoteEndPoint);
+
+  /// @brief write queue config of the sessions that are accepted after the call
+  void SetWriteQueueConfig(const common::WriteQueueConfig &writeQueueConfig)
+  {
+    m_WriteQueueConfig = writeQueueConfig;
+  }
+
   bool HasConnectedClients() const
   {
+    const std::shared_lock lock(m_SessionsMutex);
     return not m_Sessions.empty();
   }
 
+  /// @brief is the endpoint a session of this server
+  [[nodiscard]] bool HasSession(const boost::asio::ip::tcp::endpoint &remoteEndPoint) const;
+
 private:
   using TcpSocketClientServer_t = TcpSocketClientServer<TSessionCallback>;
 
   void Accept();
   std::size_t CheckClosedSessions(const boost::asio::ip::tcp::endpoint &remoteEndpoint);
 
+  /// @brief the session of the endpoint or nullptr
+  [[nodiscard]] auto FindSession(const boost::asio::ip::tcp::endpoint &remoteEndPoint) const
+    -> std::shared_ptr<tcp_socket::TcpSocketSession<TSessionCallback>>;
+
   boost::asio::ip::tcp::acceptor m_Acceptor;
 
   using endpointPair_t = std::pair<boost::asio::ip::address, boost::asio::ip::port_type>;
   using Sessions_t = std::map<endpointPair_t, std::shared_ptr<tcp_socket::TcpSocketSession<TSessionCallback>>>;
+  // the sessions are added and removed on the strand of the server and are looked up by the threads that send data
+  mutable std::shared_mutex m_SessionsMutex;
   Sessions_t m_Sessions;
 
   TSessionCallback &m_SessionCallback{};
+  common::WriteQueueConfig m_WriteQueueConfig;
 };
 
 template <typename TSessionCallback>   //
@@ -115,6 +140,7 @@ template <typename TSessionCallback>   //
 std::size_t TcpSocketServer<TSessionCallback>::CheckClosedSessions(const boost::asio::ip::tcp::endpoint &remoteEndpoint)
 {
   const auto endpointPair{std::make_pair(remoteEndpoint.address(), remoteEndpoint.port())};
+  const std::unique_lock lock(m_SessionsMutex);
   const auto iter{m_Sessions.find(endpointPair)};
   if (iter != m_Sessions.end()) {
 
@@ -137,19 +163,31 @@ void TcpSocketServer<TSessionCallback>::Accept()
       // create session and store in our session list
       const auto endPointKey = std::make_pair(webSocket.remote_endpoint().address(), webSocket.remote_endpoint().port());
 
+      // a session can be closed by a failed write on any thread, the callback is informed and the session is removed from the list on
+      // the strand of the server after its socket is closed
+      const auto sessionClosedFn{[this](const boost::asio::ip::tcp::endpoint &remoteEndpoint) {
+        boost::asio::post(TcpSocketClientServer_t::m_Strand, [this, remoteEndpoint]() {
+          m_SessionCallback.OnSessionClosed(remoteEndpoint);
+          CheckClosedSessions(remoteEndpoint);
+        });
+      }};
       const auto session = std::make_shared<TcpSocketSession<TSessionCallback>>(TcpSocketClientServer_t::m_Service,
                                                                                 TcpSocketClientServer_t::m_SessionCallback,
                                                                                 std::move(webSocket),
-                                                                                [](const boost::asio::ip::tcp::endpoint &) {
-                                                                                });
+                                                                                sessionClosedFn,
+                                                                                m_WriteQueueConfig);
 
-      const auto pair{m_Sessions.emplace(endPointKey, session)};
+      const auto isInserted{[&]() {
+        const std::unique_lock lock(m_SessionsMutex);
+        return m_Sessions.emplace(endPointKey, session).second;
+      }()};
 
-      if (pair.second and session->Accept()) {
+      if (isInserted and session->Accept()) {
         LOG_INFO("Connection accepted from {}:{}", session->GetRemoteEndpoint().address().to_string(), session->GetRemoteEndpoint().port());
         // store this new session in the sessions list
-      } else {
-        m_Sessions.erase(pair.first);
+      } else if (isInserted) {
+        const std::unique_lock lock(m_SessionsMutex);
+        m_Sessions.erase(endPointKey);
       }
     }
 
@@ -164,11 +202,8 @@ template <typename TSessionCallback>   //
 std::size_t TcpSocketServer<TSessionCallback>::SendSocketData(const std::vector<boost::asio::const_buffer> &sendBuffer,
                                                               const boost::asio::ip::tcp::endpoint &remoteEndPoint)
 {
-  const auto endPointKey = std::make_pair(remoteEndPoint.address(), remoteEndPoint.port());
-  const auto iter = m_Sessions.find(endPointKey);
-  if (iter != std::end(m_Sessions)) {
-
-    const auto &session = iter->second;
+  const auto session{FindSession(remoteEndPoint)};
+  if (session) {
     return session->SendData(sendBuffer);
   }
 
@@ -176,9 +211,27 @@ std::size_t TcpSocketServer<TSessionCallback>::SendSocketData(const std::vector<
   return 0;
 }
 
+template <typename TSessionCallback>   //
+bool TcpSocketServer<TSessionCallback>::QueueSocketData(const boost::asio::const_buffer &sendBuffer,
+                                                        const boost::asio::ip::tcp::endpoint &remoteEndPoint)
+{
+  const auto session{FindSession(remoteEndPoint)};
+  return session and session->QueueData(sendBuffer);
+}
+
+template <typename TSessionCallback>   //
+bool TcpSocketServer<TSessionCallback>::QueueSocketData(const common::SharedBuffer_t &sharedBuffer,
+                                                        const common::ConflationKey_t conflationKey,
+                                                        const boost::asio::ip::tcp::endpoint &remoteEndPoint)
+{
+  const auto session{FindSession(remoteEndPoint)};
+  return session and session->QueueData(sharedBuffer, conflationKey);
+}
+
 template <typename TSessionCallback>   //
 void TcpSocketServer<TSessionCallback>::SendToAllClients(const std::vector<boost::asio::const_buffer> &sendBuffer)
 {
+  const std::shared_lock lock(m_SessionsMutex);
   for (const auto &[k, v] : m_Sessions) {
     const auto &session = v;
     if (0 == session->SendData(sendBuffer)) {
@@ -187,4 +240,23 @@ void TcpSocketServer<TSessionCallback>::SendToAllClients(const std::vector<boost
   }
 }
 
+template <typename TSessionCallback>   //
+bool TcpSocketServer<TSessionCallback>::HasSession(const boost::asio::ip::tcp::endpoint &remoteEndPoint) const
+{
+  const std::shared_lock lock(m_SessionsMutex);
+  return m_Sessions.contains(std::make_pair(remoteEndPoint.address(), remoteEndPoint.port()));
+}
+
+template <typename TSessionCallback>   //
+auto TcpSocketServer<TSessionCallback>::FindSession(const boost::asio::ip::tcp::endpoint &remoteEndPoint) const
+  -> std::shared_ptr<tcp_socket::TcpSocketSession<TSessionCallback>>
+{
+  const std::shared_lock lock(m_SessionsMutex);
+  const auto iter{m_Sessions.find(std::make_pair(remoteEndPoint.address(), remoteEndPoint.port()))};
+  if (iter != std::end(m_Sessions)) {
+    return iter->second;
+  }
+  return {};
+}
+
 }   // namespace moboware::tcp_socket
\ No newline at end of file
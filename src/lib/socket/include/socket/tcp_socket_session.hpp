@@ -1,6 +1,8 @@
 #pragma once
 
+#include "common/shared_buffer.h"
 #include "common/timer.h"
+#include "common/write_queue.h"
 #include "socket/socket_session_base.hpp"
 #include <boost/asio.hpp>
 #include <boost/asio/buffer.hpp>
@@ -15,7 +17,8 @@ namespace moboware::tcp_socket {
  * Handles session connect, data reads, web socket protocol ping and pong messages on the control layer
  */
 template <typename TSessionCallback>   //
-class TcpSocketSession : public moboware::socket::SocketSessionBase<TSessionCallback> {
+class TcpSocketSession : public moboware::socket::SocketSessionBase<TSessionCallback>,
+                         public std::enable_shared_from_this<TcpSocketSession<TSessionCallback>> {
 public:
   using Strand_t = boost::asio::strand<boost::asio::io_context::executor_type>;
   using SessionBase_t = socket::SocketSessionBase<TSessionCallback>;
@@ -23,7 +26,8 @@ public:
   explicit TcpSocketSession(const std::shared_ptr<moboware::common::Service> &service,
                             TSessionCallback &callback,
                             boost::asio::ip::tcp::socket &&tcpSocket,
-                            const SessionBase_t::SessionClosedCleanupHandlerFn &);
+                            const SessionBase_t::SessionClosedCleanupHandlerFn &,
+                            const common::WriteQueueConfig &writeQueueConfig = {});
   /**
    * @brief Performs a server handshake and accept on an incoming client connection and start reading data
    */
@@ -47,15 +51,30 @@ public:
   [[nodiscard]] std::size_t SendData(const boost::asio::const_buffer &sendBuffer);
   [[nodiscard]] std::size_t SendData(const std::vector<boost::asio::const_buffer> &sendBuffers);
 
+  /**
+   * @brief Queue the data in the write queue of the session, the calling thread does not wait for the socket. The queued data is
+   * written by async writes on the executor of the socket, a slow consumer is handled by the policy of the write queue.
+   * @return false when the data is dropped or the session is disconnected
+   */
+  [[nodiscard]] bool QueueData(const boost::asio::const_buffer &sendBuffer);
+  [[nodiscard]] bool QueueData(const common::SharedBuffer_t &sharedBuffer, const common::ConflationKey_t conflationKey);
+
 protected:
 private:
   void SetRemoteEndpoint();
 
+  [[nodiscard]] bool HandlePushResult(const common::WriteQueue::PushResult pushResult);
+  /// @brief write the next batch of the write queue, on the executor of the socket
+  void WriteData();
+  /// @brief close the socket, the pending read completes with an error and closes the session
+  void CloseSocket();
+
   std::size_t ReadBuffer(socket::RingBuffer_t::BufferType_t *dataBuffer, const std::size_t requestedBufferSize) final;
   std::size_t WriteSocket(const std::vector<boost::asio::const_buffer> &sendBuffers, boost::system::error_code &ec) final;
 
   using TcpSocket_t = boost::asio::ip::tcp::socket;
   TcpSocket_t m_TcpSocketStream;
+  common::WriteQueue m_WriteQueue;
   //
   boost::asio::ip::tcp::endpoint m_RemoteEndpoint;
 };
@@ -64,9 +83,11 @@ template <typename TSessionCallback>   //
 TcpSocketSession<TSessionCallback>::TcpSocketSession(const common::ServicePtr &service,
                                                      TSessionCallback &callback,
                                                      boost::asio::ip::tcp::socket &&socket,
-                                                     const SessionBase_t::SessionClosedCleanupHandlerFn &sessionClosedHandlerFn)
+                                                     const SessionBase_t::SessionClosedCleanupHandlerFn &sessionClosedHandlerFn,
+                                                     const common::WriteQueueConfig &writeQueueConfig)
   : moboware::socket::SocketSessionBase<TSessionCallback>(service, callback, sessionClosedHandlerFn)
   , m_TcpSocketStream(std::move(socket))
+  , m_WriteQueue(writeQueueConfig)
 {
 }
 
@@ -151,6 +172,71 @@ std::size_t TcpSocketSession<TSessionCallback>::SendData(const std::vector<boost
   return SessionBase_t::SendData(m_TcpSocketStream, sendBuffers);
 }
 
+template <typename TSessionCallback>   //
+bool TcpSocketSession<TSessionCallback>::QueueData(const boost::asio::const_buffer &sendBuffer)
+{
+  // the stream carries length delimited binary messages, the queued messages are coalesced into one write
+  return HandlePushResult(m_WriteQueue.Push(sendBuffer, true));
+}
+
+template <typename TSessionCallback>   //
+bool TcpSocketSession<TSessionCallback>::QueueData(const common::SharedBuffer_t &sharedBuffer, const common::ConflationKey_t conflationKey)
+{
+  return HandlePushResult(m_WriteQueue.Push(sharedBuffer, true, conflationKey));
+}
+
+template <typename TSessionCallback>   //
+bool TcpSocketSession<TSessionCallback>::HandlePushResult(const common::WriteQueue::PushResult pushResult)
+{
+  switch (pushResult) {
+  case common::WriteQueue::PushResult::Queued:
+    return true;
+  case common::WriteQueue::PushResult::StartWrite:
+    boost::asio::post(m_TcpSocketStream.get_executor(), [this, self = this->shared_from_this()]() { WriteData(); });
+    return true;
+  case common::WriteQueue::PushResult::Dropped:
+    return false;
+  case common::WriteQueue::PushResult::Disconnect:
+    boost::asio::post(m_TcpSocketStream.get_executor(), [this, self = this->shared_from_this()]() {
+      const auto stats{m_WriteQueue.GetStats()};
+      LOG_WARN("Disconnect slow consumer, queued:{}, dropped:{}", stats.queuedMessages, stats.droppedMessages);
+      CloseSocket();
+    });
+    return false;
+  }
+  return false;
+}
+
+template <typename TSessionCallback>   //
+void TcpSocketSession<TSessionCallback>::WriteData()
+{
+  const auto write{m_WriteQueue.GetNextWrite()};
+  if (not write) {
+    return;
+  }
+
+  const auto writeDataFunc{[this, self = this->shared_from_this()](const boost::system::error_code &ec, const std::size_t) {
+    if (ec.failed()) {
+      // the queued data can not be written anymore, the writer stops and the failing read closes the session
+      LOG_ERROR("Write failed: {}", ec.what());
+      m_WriteQueue.Close();
+      CloseSocket();
+      return;
+    }
+
+    WriteData();
+  }};
+
+  boost::asio::async_write(m_TcpSocketStream, write->buffer, writeDataFunc);
+}
+
+template <typename TSessionCallback>   //
+void TcpSocketSession<TSessionCallback>::CloseSocket()
+{
+  boost::system::error_code ec;
+  m_TcpSocketStream.close(ec);
+}
+
 template <typename TSessionCallback>   //
 std::size_t TcpSocketSession<TSessionCallback>::WriteSocket(const std::vector<boost::asio::const_buffer> &sendBuffers,
                                                             boost::system::error_code &ec)
@@ -5,6 +5,8 @@
 #include "web_socket/web_socket_session.h"
 #include "web_socket/web_socket_session_callback.h"
 #include <map>
+#include <shared_mutex>
+#include <vector>
 
 namespace moboware::web_socket {
 
@@ -26,19 +28,33 @@ public:
   [[nodiscard]] auto Start(const std::string& address, const short port) -> bool;
   [[nodiscard]] auto SendWebSocketData(const boost::asio::const_buffer& sendBuffer, const boost::asio::ip::tcp::endpoint& remoteEndPoint) -> bool;
 
+  /// @brief Queue the same shared message on the sessions of the endpoints
+  /// @return number of sessions the message is queued on
+  auto PublishWebSocketData(const common::SharedBuffer_t& sharedBuffer,
+                            const std::vector<boost::asio::ip::tcp::endpoint>& remoteEndPoints,
+                            const common::ConflationKey_t conflationKey) -> std::size_t;
+
+  /// @brief write queue settings of the sessions that are accepted after this call
+  void SetWriteQueueConfig(const common::WriteQueueConfig& writeQueueConfig) { m_WriteQueueConfig = writeQueueConfig; }
+
 private:
   void OnDataRead(const boost::beast::flat_buffer& readBuffer, const boost::asio::ip::tcp::endpoint& remoteEndPoint) final;
   void OnSessionClosed() final;
 
   void Accept();
   auto CheckClosedSessions() -> std::size_t;
+  /// @brief the session of the endpoint or nullptr, the session is kept alive by the caller after it is removed
+  [[nodiscard]] auto FindSession(const boost::asio::ip::tcp::endpoint& remoteEndPoint) const -> std::shared_ptr<WebSocketSession>;
 
   const std::shared_ptr<moboware::common::Service> m_Service;
 
   boost::asio::ip::tcp::acceptor m_Acceptor;
+  common::WriteQueueConfig m_WriteQueueConfig;
 
   using endpointPair_t = std::pair<boost::asio::ip::address, boost::asio::ip::port_type>;
   using Sessions_t = std::map<endpointPair_t, std::shared_ptr<moboware::web_socket::WebSocketSession>>;
+  // the sessions are added and removed on the io threads and are looked up by the threads that send data, e.g. the engine threads
+  mutable std::shared_mutex m_SessionsMutex;
   Sessions_t m_Sessions;
 };
 } // namespace moboware
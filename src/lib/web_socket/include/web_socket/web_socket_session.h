@@ -1,18 +1,23 @@
 #pragma once
 #include "common/service.h"
+#include "common/write_queue.h"
 #include "web_socket/web_socket_session_callback.h"
 #include <boost/asio/buffer.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/beast/websocket.hpp>
+#include <atomic>
+#include <memory>
 
 namespace moboware::web_socket {
 
-class WebSocketSession
+/// @brief A web socket session is owned by a shared_ptr, the asynchronous operations of the session keep it alive until they complete
+class WebSocketSession : public std::enable_shared_from_this<WebSocketSession>
 {
 public:
   explicit WebSocketSession(const std::shared_ptr<moboware::common::Service>& service,
                             const std::shared_ptr<WebSocketSessionCallback>& callback,
-                            boost::asio::ip::tcp::socket&& webSocket);
+                            boost::asio::ip::tcp::socket&& webSocket,
+                            const common::WriteQueueConfig& writeQueueConfig = {});
   /**
    * @brief Accept incoming client connection and start reading data
    */
@@ -34,14 +39,39 @@ public:
    */
   inline auto IsOpen() const -> bool { return m_WebSocket.is_open(); }
 
+  /**
+   * @brief Queue a copy of the data for an asynchronous write on the strand of the session, can be called from any thread and
+   * never blocks on the socket. The data is sent with the frame type of the last received message.
+   * @return false when the data is dropped by the slow consumer policy of the write queue
+   */
   [[nodiscard]] auto SendWebSocketData(const boost::asio::const_buffer& sendBuffer) -> bool;
 
+  /**
+   * @brief Queue a reference to a shared message, the message is not copied
+   * @param conflationKey, the state the message updates, see the conflate policy of the write queue
+   * @return false when the message is dropped by the slow consumer policy of the write queue
+   */
+  [[nodiscard]] auto SendWebSocketData(const common::SharedBuffer_t& sharedBuffer,
+                                       const common::ConflationKey_t conflationKey = common::NoConflationKey) -> bool;
+
+  [[nodiscard]] auto GetWriteQueueStats() const -> common::WriteQueue::Stats { return m_WriteQueue.GetStats(); }
+
 private:
   void ReadData();
+  /// @brief start the writer or disconnect a slow consumer
+  [[nodiscard]] auto HandlePushResult(const common::WriteQueue::PushResult pushResult) -> bool;
+  /// @brief write the queued data until the write queue is empty, runs on the strand of the session
+  void WriteData();
+  /// @brief close the socket of a slow consumer, runs on the strand of the session
+  void Disconnect();
+  /// @brief close the socket, the pending operations complete with an error, runs on the strand of the session
+  void CloseSocket();
   const std::shared_ptr<common::Service> m_Service;
   const std::shared_ptr<WebSocketSessionCallback> m_DataHandlerCallback;
 
   boost::beast::websocket::stream<boost::beast::tcp_stream> m_WebSocket;
   boost::beast::flat_buffer m_ReadBuffer;
+  std::atomic<bool> m_IsBinary{false};   // frame type of the last received message
+  common::WriteQueue m_WriteQueue;
 };
 } // namespace moboware
\ No newline at end of file
@@ -16,6 +16,7 @@ public:
   WebSocketSessionCallback& operator=(WebSocketSessionCallback&&) = default;
 
   using WebSocketDataReceivedFn = std::function<void(const boost::beast::flat_buffer& sendBuffer, const boost::asio::ip::tcp::endpoint& endpoint)>;
+  using WebSocketSessionClosedFn = std::function<void(const boost::asio::ip::tcp::endpoint& endpoint)>;
 
   // called when data is received from the web socket.
   virtual void OnDataRead(const boost::beast::flat_buffer& readBuffer, const boost::asio::ip::tcp::endpoint& remoteEndPoint) = 0;
@@ -24,8 +25,10 @@ public:
   virtual void OnSessionClosed() = 0;
 
   void SetWebSocketDataReceived(const WebSocketDataReceivedFn& fn) { m_WebSocketDataReceivedFn = fn; }
+  void SetWebSocketSessionClosed(const WebSocketSessionClosedFn& fn) { m_WebSocketSessionClosedFn = fn; }
 
 protected:
   WebSocketDataReceivedFn m_WebSocketDataReceivedFn;
+  WebSocketSessionClosedFn m_WebSocketSessionClosedFn;
 };
 } // namespace moboware
\ No newline at end of file
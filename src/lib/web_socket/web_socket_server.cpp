@@ -65,19 +65,28 @@ auto WebSocketServer::Start(const std::string &address, const short port) -> boo
 
 auto WebSocketServer::CheckClosedSessions() -> std::size_t
 {
-  int numberOfSessions{};
+  std::vector<tcp::endpoint> closedEndPoints;
+  {
+    const std::unique_lock lock(m_SessionsMutex);
+    auto iter = std::begin(m_Sessions);
+    while (iter != std::end(m_Sessions)) {
+      const auto session = iter->second;
+      if (not session->IsOpen()) {
+        closedEndPoints.emplace_back(iter->first.first, iter->first.second);
+        iter = m_Sessions.erase(iter);
+      } else {
+        iter++;
+      }
+    }
+  }
 
-  auto iter = std::begin(m_Sessions);
-  while (iter != std::end(m_Sessions)) {
-    const auto session = iter->second;
-    if (not session->IsOpen()) {
-      iter = m_Sessions.erase(iter);
-      numberOfSessions++;
-    } else {
-      iter++;
+  // the callback may send data to other sessions, it is called without the lock
+  if (m_WebSocketSessionClosedFn) {
+    for (const auto &closedEndPoint : closedEndPoints) {
+      m_WebSocketSessionClosedFn(closedEndPoint);
     }
   }
-  return numberOfSessions;
+  return closedEndPoints.size();
 }
 
 void WebSocketServer::Accept()
@@ -91,8 +100,9 @@ void WebSocketServer::Accept()
       // create session and store in our session list
       const auto endPointKey = std::make_pair(webSocket.remote_endpoint().address(), webSocket.remote_endpoint().port());
 
-      const auto session = std::make_shared<WebSocketSession>(m_Service, shared_from_this(), std::move(webSocket));
+      const auto session = std::make_shared<WebSocketSession>(m_Service, shared_from_this(), std::move(webSocket), m_WriteQueueConfig);
       session->Accept();
+      const std::unique_lock lock(m_SessionsMutex);
       m_Sessions[endPointKey] = session;
     }
     Accept();
@@ -105,11 +115,8 @@ void WebSocketServer::Accept()
 auto WebSocketServer::SendWebSocketData(const boost::asio::const_buffer &sendBuffer, const boost::asio::ip::tcp::endpoint &remoteEndPoint)
   -> bool
 {
-  const auto endPointKey = std::make_pair(remoteEndPoint.address(), remoteEndPoint.port());
-  const auto iter = m_Sessions.find(endPointKey);
-  if (iter != std::end(m_Sessions)) {
-
-    const auto &session = iter->second;
+  const auto session{FindSession(remoteEndPoint)};
+  if (session) {
     return session->SendWebSocketData(sendBuffer);
   }
 
@@ -117,6 +124,31 @@ auto WebSocketServer::SendWebSocketData(const boost::asio::const_buffer &sendBuf
   return false;
 }
 
+auto WebSocketServer::PublishWebSocketData(const common::SharedBuffer_t &sharedBuffer,
+                                           const std::vector<boost::asio::ip::tcp::endpoint> &remoteEndPoints,
+                                           const common::ConflationKey_t conflationKey) -> std::size_t
+{
+  std::size_t numberOfSessions{};
+  const std::shared_lock lock(m_SessionsMutex);
+  for (const auto &remoteEndPoint : remoteEndPoints) {
+    const auto iter = m_Sessions.find(std::make_pair(remoteEndPoint.address(), remoteEndPoint.port()));
+    if (iter != std::end(m_Sessions) and iter->second->SendWebSocketData(sharedBuffer, conflationKey)) {
+      numberOfSessions++;
+    }
+  }
+  return numberOfSessions;
+}
+
+auto WebSocketServer::FindSession(const boost::asio::ip::tcp::endpoint &remoteEndPoint) const -> std::shared_ptr<WebSocketSession>
+{
+  const std::shared_lock lock(m_SessionsMutex);
+  const auto iter = m_Sessions.find(std::make_pair(remoteEndPoint.address(), remoteEndPoint.port()));
+  if (iter != std::end(m_Sessions)) {
+    return iter->second;
+  }
+  return {};
+}
+
 void WebSocketServer::OnDataRead(const boost::beast::flat_buffer &readBuffer, const boost::asio::ip::tcp::endpoint &remoteEndPoint)
 {
   if (m_WebSocketDataReceivedFn) {
@@ -12,10 +12,12 @@ using namespace moboware::web_socket;
 
 WebSocketSession::WebSocketSession(const std::shared_ptr<moboware::common::Service> &service,
                                    const std::shared_ptr<WebSocketSessionCallback> &callback,
-                                   tcp::socket &&webSocket)
+                                   tcp::socket &&webSocket,
+                                   const common::WriteQueueConfig &writeQueueConfig)
   : m_Service(service)
   , m_DataHandlerCallback(callback)
   , m_WebSocket(std::move(webSocket))
+  , m_WriteQueue(writeQueueConfig)
 {
 }
 
@@ -27,7 +29,8 @@ void WebSocketSession::Accept()
   // for single-threaded contexts, this example code is written to be
   // thread-safe by default.
 
-  const auto runFunc{[this]() {
+  // the handlers keep the session alive, the server may erase the session while an operation is pending
+  const auto runFunc{[this, self = shared_from_this()]() {
     // Set suggested timeout settings for the websocket
     m_WebSocket.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
 
@@ -38,7 +41,7 @@ void WebSocketSession::Accept()
 
     {
       // Accept the websocket handshake
-      const auto acceptHandshakeFn{[this](const beast::error_code &ec) {
+      const auto acceptHandshakeFn{[this, self](const beast::error_code &ec) {
         if (ec) {
           LOG_DEBUG("Failed to accept web socket handshake ", ec.to_string());
           return;
@@ -59,7 +62,7 @@ void WebSocketSession::ReadData()
   // clear read buffer before every read
   m_ReadBuffer.clear();
 
-  const auto readDataFunc{[this](const beast::error_code &ec, const std::size_t bytesTransferred) {
+  const auto readDataFunc{[this, self = shared_from_this()](const beast::error_code &ec, const std::size_t bytesTransferred) {
     boost::ignore_unused(bytesTransferred);
 
     // This indicates that the session was closed
@@ -71,11 +74,17 @@ void WebSocketSession::ReadData()
 
     if (ec) {
       LOG_ERROR("Read error: {}, open:{}", ec.to_string(), m_WebSocket.is_open());
+      if (not m_WebSocket.is_open()) {
+        m_DataHandlerCallback->OnSessionClosed();
+      }
       return;
     }
 
-    // forward read data to channel
+    // the session replies with the frame type of the last received message, a client that switches to the binary order
+    // entry protocol receives binary frames
+    m_IsBinary.store(m_WebSocket.got_binary(), std::memory_order_relaxed);
 
+    // forward read data to channel
     m_DataHandlerCallback->OnDataRead(m_ReadBuffer, m_WebSocket.next_layer().socket().remote_endpoint());
 
     // initialize new read operation
@@ -88,11 +97,67 @@ void WebSocketSession::ReadData()
 
 auto WebSocketSession::SendWebSocketData(const boost::asio::const_buffer &sendBuffer) -> bool
 {
-  beast::error_code ec;
+  return HandlePushResult(m_WriteQueue.Push(sendBuffer, m_IsBinary.load(std::memory_order_relaxed)));
+}
 
-  const auto n = m_WebSocket.write(sendBuffer, ec);
+auto WebSocketSession::SendWebSocketData(const common::SharedBuffer_t &sharedBuffer, const common::ConflationKey_t conflationKey) -> bool
+{
+  return HandlePushResult(m_WriteQueue.Push(sharedBuffer, m_IsBinary.load(std::memory_order_relaxed), conflationKey));
+}
+
+auto WebSocketSession::HandlePushResult(const common::WriteQueue::PushResult pushResult) -> bool
+{
+  switch (pushResult) {
+  case common::WriteQueue::PushResult::Queued:
+    return true;
+  case common::WriteQueue::PushResult::StartWrite:
+    asio::post(m_WebSocket.get_executor(), [this, self = shared_from_this()]() { WriteData(); });
+    return true;
+  case common::WriteQueue::PushResult::Dropped:
+    return false;
+  case common::WriteQueue::PushResult::Disconnect:
+    asio::post(m_WebSocket.get_executor(), [this, self = shared_from_this()]() { Disconnect(); });
+    return false;
+  }
+  return false;
+}
+
+void WebSocketSession::WriteData()
+{
+  const auto write{m_WriteQueue.GetNextWrite()};
+  if (not write) {
+    return;
+  }
 
-  return n != 0 && !ec;
+  const auto writeDataFunc{[this, self = shared_from_this()](const beast::error_code &ec, const std::size_t bytesTransferred) {
+    boost::ignore_unused(bytesTransferred);
+    if (ec) {
+      // the queued data can not be written anymore, the writer stops and the session is closed, the failing read removes it
+      LOG_ERROR("Write error: {}, open:{}", ec.to_string(), m_WebSocket.is_open());
+      m_WriteQueue.Close();
+      CloseSocket();
+      return;
+    }
+
+    WriteData();
+  }};
+
+  m_WebSocket.binary(write->isBinary);
+  m_WebSocket.async_write(write->buffer, beast::bind_front_handler(writeDataFunc));
+}
+
+void WebSocketSession::Disconnect()
+{
+  const auto stats{m_WriteQueue.GetStats()};
+  LOG_WARN("Disconnect slow consumer, queued:{}, dropped:{}", stats.queuedMessages, stats.droppedMessages);
+  CloseSocket();
+}
+
+void WebSocketSession::CloseSocket()
+{
+  // a graceful close would wait behind the queued data, close the socket so the pending operations complete with an error
+  beast::error_code ec;
+  beast::get_lowest_layer(m_WebSocket).socket().close(ec);
 }
 
 auto WebSocketSession::Connect(const std::string &address, const short port) -> bool
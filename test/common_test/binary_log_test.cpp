@@ -0,0 +1,140 @@
+#include "common/binary_log.h"
+#include "common/log_codec.hpp"
+#include "common/logger.hpp"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace moboware::common;
+using namespace moboware::common::binary_log;
+
+namespace {
+constexpr std::int64_t StartTime{1'700'000'000'000'000'000};   // 20231114 22:13:20
+
+void WriteFile(const std::string &path, const fmt::memory_buffer &buffer)
+{
+  std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+  file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+void WriteSite(fmt::memory_buffer &buffer, const std::uint32_t id, const std::uint32_t line, const std::string_view format)
+{
+  WriteByte(buffer, static_cast<std::uint8_t>(RecordType::Site));
+  WriteVarint(buffer, id);
+  WriteByte(buffer, static_cast<std::uint8_t>(Logger::LogLevel::Info));
+  WriteVarint(buffer, line);
+  WriteString(buffer, "order_book.cpp");
+  WriteString(buffer, format);
+}
+
+void WriteThread(fmt::memory_buffer &buffer)
+{
+  WriteByte(buffer, static_cast<std::uint8_t>(RecordType::Thread));
+  WriteVarint(buffer, 0);
+  WriteVarint(buffer, 0x1234);
+}
+
+/// @brief a line with the arguments that are encoded as the logging thread does
+template <typename... TArgs>
+void WriteLine(fmt::memory_buffer &buffer, const std::uint32_t siteId, const std::int64_t elapsed, const TArgs &...args)
+{
+  std::array<std::byte, 256> data{};
+  log::ArgumentEncoder encoder(data.data(), data.size());
+  (encoder.Encode(args), ...);
+  ASSERT_FALSE(encoder.IsOverflow());
+
+  WriteByte(buffer, static_cast<std::uint8_t>(RecordType::Line));
+  WriteVarint(buffer, siteId);
+  WriteZigzag(buffer, elapsed);
+  WriteVarint(buffer, 0);
+  log::ArgumentsCodecOf<TArgs...>.transcodeFn(buffer, data.data());
+}
+
+auto ReadLines(const std::string &path, BinaryLogReader &reader) -> std::vector<std::string>
+{
+  std::vector<std::string> lines;
+  EXPECT_TRUE(reader.Read(path, [&](const std::string_view line) { lines.emplace_back(line); }));
+  return lines;
+}
+}   // namespace
+
+TEST(BinaryLogTest, readTest)
+{
+  const auto path{(std::filesystem::temp_directory_path() / "moboware_binary_log_test.bin").string()};
+
+  fmt::memory_buffer buffer;
+  WriteHeader(buffer, StartTime);
+  WriteThread(buffer);
+  WriteSite(buffer, 0, 10, "order {} {} {:.2f} {} {}");
+  WriteLine(buffer, 0, 1'000'000'000, -5, std::string("buy"), 1.125, true, Logger::LogLevel::Warning);
+  WriteSite(buffer, 1, 20, "id {:#x} {}");
+  WriteLine(buffer, 1, 0, 255u, 'c');
+  WriteByte(buffer, static_cast<std::uint8_t>(RecordType::Text));
+  WriteVarint(buffer, 0);
+  WriteString(buffer, "formatted line\n");
+  WriteFile(path, buffer);
+
+  BinaryLogReader reader;
+  const auto lines{ReadLines(path, reader)};
+  ASSERT_EQ(lines.size(), 3);
+  EXPECT_EQ(lines[0], "[20231114 22:13:21][INFO][0x1234][order_book.cpp:10]order -5 buy 1.12 true WARN\n");
+  EXPECT_EQ(lines[1], "[20231114 22:13:21][INFO][0x1234][order_book.cpp:20]id 0xff c\n");
+  EXPECT_EQ(lines[2], "formatted line\n");
+  EXPECT_EQ(reader.GetLineCount(), 3);
+
+  std::filesystem::remove(path);
+}
+
+TEST(BinaryLogTest, appendedSessionTest)
+{
+  const auto path{(std::filesystem::temp_directory_path() / "moboware_binary_log_test.bin").string()};
+
+  // a restarted application appends a new session with its own sites and threads
+  fmt::memory_buffer buffer;
+  for (const auto format : {"first {}", "second {}"}) {
+    WriteHeader(buffer, StartTime);
+    WriteThread(buffer);
+    WriteSite(buffer, 0, 10, format);
+    WriteLine(buffer, 0, 0, 1);
+  }
+  WriteFile(path, buffer);
+
+  BinaryLogReader reader;
+  const auto lines{ReadLines(path, reader)};
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_THAT(lines[0], testing::EndsWith("]first 1\n"));
+  EXPECT_THAT(lines[1], testing::EndsWith("]second 1\n"));
+
+  std::filesystem::remove(path);
+}
+
+TEST(BinaryLogTest, corruptTest)
+{
+  const auto path{(std::filesystem::temp_directory_path() / "moboware_binary_log_test.bin").string()};
+
+  fmt::memory_buffer buffer;
+  WriteString(buffer, "text log");
+  WriteFile(path, buffer);
+  {
+    BinaryLogReader reader;
+    EXPECT_FALSE(reader.Read(path, [](const std::string_view) {}));
+  }
+
+  // a line of an unknown site
+  buffer.clear();
+  WriteHeader(buffer, StartTime);
+  WriteThread(buffer);
+  WriteLine(buffer, 3, 0, 1);
+  WriteFile(path, buffer);
+  {
+    BinaryLogReader reader;
+    EXPECT_FALSE(reader.Read(path, [](const std::string_view) {}));
+    EXPECT_EQ(reader.GetLineCount(), 0);
+  }
+
+  std::filesystem::remove(path);
+}
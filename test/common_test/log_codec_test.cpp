@@ -0,0 +1,87 @@
+#include "common/log_codec.hpp"
+#include <array>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace moboware::common::log;
+
+namespace {
+enum class Side : std::uint8_t { Buy, Sell };
+
+struct Price {
+  std::int64_t value{};
+};
+
+/// @brief encode the arguments and format them as the log consumer does
+template <typename... TArgs> auto EncodeAndFormat(const fmt::string_view format, const TArgs &...args) -> std::string
+{
+  std::array<std::byte, 256> data{};
+  ArgumentEncoder encoder(data.data(), data.size());
+  (encoder.Encode(args), ...);
+  EXPECT_FALSE(encoder.IsOverflow());
+
+  fmt::memory_buffer buffer;
+  FormatArguments<TArgs...>(buffer, format, data.data());
+  return fmt::to_string(buffer);
+}
+}   // namespace
+
+template <> struct fmt::formatter<Side> : formatter<string_view> {
+  auto format(const Side side, format_context &ctx) const
+  {
+    return formatter<string_view>::format(side == Side::Buy ? "Buy" : "Sell", ctx);
+  }
+};
+
+template <> struct fmt::formatter<Price> : formatter<std::int64_t> {
+  auto format(const Price &price, format_context &ctx) const
+  {
+    return formatter<std::int64_t>::format(price.value, ctx);
+  }
+};
+
+TEST(LogCodecTest, valueArgumentsTest)
+{
+  EXPECT_EQ(EncodeAndFormat("no arguments"), "no arguments");
+  EXPECT_EQ(EncodeAndFormat("{} {} {} {}", 42, -7ll, true, 'c'), "42 -7 true c");
+  EXPECT_EQ(EncodeAndFormat("{:.2f} {:#x} {:>4}", 3.14159, 255u, 9), "3.14 0xff    9");
+  EXPECT_EQ(EncodeAndFormat("{}", Side::Sell), "Sell");
+}
+
+TEST(LogCodecTest, stringArgumentsTest)
+{
+  const std::string text{"text"};
+  const std::string_view view{"view"};
+  const char *const pointer{"pointer"};
+  EXPECT_EQ(EncodeAndFormat("{} {} {} {}", text, view, pointer, "literal"), "text view pointer literal");
+  EXPECT_EQ(EncodeAndFormat("[{}]", std::string{}), "[]");
+}
+
+TEST(LogCodecTest, formattedArgumentsTest)
+{
+  // other types are formatted when they are encoded, the format specification applies to the formatted string
+  EXPECT_EQ(EncodeAndFormat("{} {}", Price{100}, 1), "100 1");
+  EXPECT_EQ(EncodeAndFormat("{:>5}", Price{100}), "  100");
+}
+
+TEST(LogCodecTest, overflowTest)
+{
+  std::array<std::byte, 16> data{};
+
+  ArgumentEncoder valueEncoder(data.data(), data.size());
+  valueEncoder.Encode(1ll);
+  valueEncoder.Encode(2ll);
+  EXPECT_FALSE(valueEncoder.IsOverflow());
+  EXPECT_EQ(valueEncoder.GetSize(), 16);
+  valueEncoder.Encode('c');
+  EXPECT_TRUE(valueEncoder.IsOverflow());
+
+  ArgumentEncoder stringEncoder(data.data(), data.size());
+  stringEncoder.Encode(std::string(13, 'x'));
+  EXPECT_TRUE(stringEncoder.IsOverflow());
+
+  ArgumentEncoder formattedEncoder(data.data(), data.size());
+  formattedEncoder.Encode(Price{1'000'000'000'000});
+  EXPECT_TRUE(formattedEncoder.IsOverflow());
+}
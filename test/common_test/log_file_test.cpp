@@ -0,0 +1,69 @@
+#include "common/log_file.h"
+#include <filesystem>
+#include <fmt/chrono.h>
+#include <fstream>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+using namespace moboware::common;
+
+namespace {
+auto ReadFile(const std::filesystem::path &path) -> std::string
+{
+  std::ifstream file(path);
+  std::stringstream stream;
+  stream << file.rdbuf();
+  return stream.str();
+}
+}   // namespace
+
+TEST(LogFileTest, appendAndRotateTest)
+{
+  const auto directory{std::filesystem::temp_directory_path() / "moboware_log_file_test"};
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  const auto today{fmt::format("{:%Y%m%d}", std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now()))};
+  const auto firstPath{directory / (today + "_test.log")};
+  const auto secondPath{directory / (today + "_test.1.log")};
+
+  {
+    LogFile logFile;
+    logFile.SetMaxFileSize(100);
+    ASSERT_TRUE(logFile.Open(directory / "test.log"));
+    EXPECT_TRUE(logFile.IsOpen());
+    EXPECT_EQ(logFile.GetPath(), firstPath.string());
+    EXPECT_EQ(logFile.GetFileSequence(), 1);
+
+    // a line that is larger than a block continues in the next block
+    const std::string longLine(100 * 1024, 'x');
+    logFile.Append(longLine.data(), longLine.size());
+    logFile.Append("\n", 1);
+    EXPECT_FALSE(std::filesystem::exists(secondPath));
+
+    // the appended data is written to the full file before the next file is opened
+    EXPECT_TRUE(logFile.RotateIfDue());
+    EXPECT_EQ(logFile.GetPath(), secondPath.string());
+    EXPECT_EQ(logFile.GetFileSequence(), 2);
+    EXPECT_EQ(ReadFile(firstPath), longLine + "\n");
+
+    logFile.Append("line\n", 5);
+    EXPECT_FALSE(logFile.RotateIfDue());
+  }
+  EXPECT_EQ(ReadFile(secondPath), "line\n");
+
+  // a reopened log file appends to the latest file of today
+  {
+    LogFile logFile;
+    ASSERT_TRUE(logFile.Open(directory / "test.log"));
+    EXPECT_EQ(logFile.GetPath(), secondPath.string());
+    logFile.Append("next\n", 5);
+    logFile.Close();
+    EXPECT_FALSE(logFile.IsOpen());
+  }
+  EXPECT_EQ(ReadFile(secondPath), "line\nnext\n");
+
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,54 @@
+#include "common/logger.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+TEST(LoggerTest, moduleLevelTest)
+{
+  auto &logger{Logger::GetInstance()};
+  logger.SetLevel(Logger::LogLevel::Info);
+
+  const auto &engineLevel{logger.GetFileLevel("src/lib/modules/matching_engine_module/order_book.cpp")};
+  const auto &socketLevel{logger.GetFileLevel("src/lib/socket/include/socket/socket_session_base.hpp")};
+  const auto &otherLevel{logger.GetFileLevel("src/lib/common/timer.cpp")};
+  EXPECT_EQ(&engineLevel, &logger.GetFileLevel("src/lib/modules/matching_engine_module/order_book.cpp"));
+  EXPECT_EQ(engineLevel.load(), Logger::LogLevel::Info);
+
+  // the levels of the files that are already looked up are updated
+  logger.SetModuleLevel("matching_engine_module", Logger::LogLevel::Warning);
+  logger.SetModuleLevel("socket", Logger::LogLevel::Debug);
+  EXPECT_FALSE(Logger::TestLevel(engineLevel, Logger::LogLevel::Info));
+  EXPECT_TRUE(Logger::TestLevel(engineLevel, Logger::LogLevel::Warning));
+  EXPECT_TRUE(Logger::TestLevel(socketLevel, Logger::LogLevel::Debug));
+  EXPECT_TRUE(Logger::TestLevel(otherLevel, Logger::LogLevel::Info));
+  EXPECT_FALSE(Logger::TestLevel(otherLevel, Logger::LogLevel::Debug));
+
+  // the most specific module in the path wins, a file is a module as well
+  logger.SetModuleLevel("order_book.cpp", Logger::LogLevel::Error);
+  EXPECT_EQ(engineLevel.load(), Logger::LogLevel::Error);
+  EXPECT_EQ(logger.GetFileLevel("src/lib/modules/matching_engine_module/order_level.cpp").load(), Logger::LogLevel::Warning);
+
+  // the global level applies to the files without a module only
+  logger.SetLevel(Logger::LogLevel::None);
+  EXPECT_FALSE(Logger::TestLevel(otherLevel, Logger::LogLevel::Fatal));
+  EXPECT_TRUE(Logger::TestLevel(socketLevel, Logger::LogLevel::Debug));
+
+  logger.SetModuleLevel("matching_engine_module", Logger::LogLevel::Debug);
+  logger.SetModuleLevel("socket", Logger::LogLevel::Debug);
+  logger.SetModuleLevel("order_book.cpp", Logger::LogLevel::Debug);
+  logger.SetLevel(Logger::LogLevel::Debug);
+}
+
+TEST(LoggerTest, compiledLevelTest)
+{
+  EXPECT_EQ(Logger::MinLogLevel, static_cast<Logger::LogLevel>(MOBOWARE_LOG_MIN_LEVEL));
+  EXPECT_TRUE(Logger::IsCompiledLevel(Logger::LogLevel::Fatal));
+  EXPECT_EQ(Logger::IsCompiledLevel(Logger::LogLevel::Trace), MOBOWARE_LOG_MIN_LEVEL == MOBOWARE_LOG_LEVEL_TRACE);
+
+  // a discarded log statement does not evaluate its arguments
+  int evaluated{};
+  const auto argument{[&]() { return ++evaluated; }};
+  Logger::GetInstance().SetLevel(Logger::LogLevel::Fatal);
+  LOG_DEBUG("argument {}", argument());
+  EXPECT_EQ(evaluated, 0);
+  Logger::GetInstance().SetLevel(Logger::LogLevel::Debug);
+}
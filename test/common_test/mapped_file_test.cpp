@@ -0,0 +1,41 @@
+#include "common/mapped_file.h"
+#include <cstring>
+#include <filesystem>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace moboware::common;
+
+TEST(MappedFileTest, createAndOpenTest)
+{
+  const auto path{(std::filesystem::temp_directory_path() / "moboware_mapped_file_test.bin").string()};
+  std::filesystem::remove(path);
+
+  {
+    MappedFile mappedFile;
+    ASSERT_TRUE(mappedFile.Create(path, 64 * 1024));
+    EXPECT_TRUE(mappedFile.IsOpen());
+    EXPECT_EQ(mappedFile.GetSize(), 64 * 1024);
+    EXPECT_EQ(std::filesystem::file_size(path), 64 * 1024);
+
+    // an existing file is not overwritten
+    MappedFile existingFile;
+    EXPECT_FALSE(existingFile.Create(path, 1024));
+
+    std::memcpy(mappedFile.GetData(), "journal", 7);
+    mappedFile.SetUsedSize(7);
+    EXPECT_TRUE(mappedFile.Sync(0, 7));
+  }
+
+  // the pre-allocated tail is truncated on close
+  EXPECT_EQ(std::filesystem::file_size(path), 7);
+
+  MappedFile mappedFile;
+  ASSERT_TRUE(mappedFile.Open(path));
+  EXPECT_EQ(std::string(mappedFile.GetData(), mappedFile.GetSize()), "journal");
+  mappedFile.Close();
+  EXPECT_FALSE(mappedFile.IsOpen());
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(mappedFile.Open(path));
+}
@@ -0,0 +1,90 @@
+#include "common/mpsc_ring_buffer.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace moboware::common;
+
+TEST(MpscRingBufferTest, pushPopTest)
+{
+  constexpr std::size_t capacity{4};
+  using MpscRingBuffer_t = MpscRingBuffer<std::string, capacity>;
+
+  MpscRingBuffer_t rb;
+
+  EXPECT_TRUE(rb.Empty());
+  EXPECT_EQ(rb.GetCapacity(), capacity);
+
+  std::string poppedElement;
+  const auto popFn{[&](std::string &element) { poppedElement = std::move(element); }};
+  // pop on empty queue should return false
+  EXPECT_FALSE(rb.Pop(popFn));
+
+  // fill the buffer, no space left after the capacity
+  for (std::size_t i = 0; i < capacity; i++) {
+    EXPECT_TRUE(rb.Push(std::to_string(i)));
+    EXPECT_FALSE(rb.Empty());
+  }
+  EXPECT_FALSE(rb.Push("full"));
+
+  // pop in fifo order
+  EXPECT_TRUE(rb.Pop(popFn));
+  EXPECT_EQ(poppedElement, "0");
+
+  // the popped slot is free for the next round
+  EXPECT_TRUE(rb.Push("4"));
+  EXPECT_FALSE(rb.Push("full"));
+
+  for (std::size_t i = 1; i <= capacity; i++) {
+    EXPECT_TRUE(rb.Pop(popFn));
+    EXPECT_EQ(poppedElement, std::to_string(i));
+  }
+
+  EXPECT_TRUE(rb.Empty());
+  EXPECT_FALSE(rb.Pop(popFn));
+}
+
+TEST(MpscRingBufferTest, multipleProducersTest)
+{
+  using Element_t = std::pair<std::size_t, std::size_t>;   // producer, sequence number
+  using MpscRingBuffer_t = MpscRingBuffer<Element_t, 64>;
+
+  constexpr std::size_t numberOfProducers{4};
+  constexpr std::size_t elementsPerProducer{100'000};
+
+  MpscRingBuffer_t rb;
+
+  std::vector<std::jthread> producers;
+  for (std::size_t producer = 0; producer < numberOfProducers; producer++) {
+    producers.emplace_back([&rb, producer]() {
+      for (std::size_t sequence = 0; sequence < elementsPerProducer; sequence++) {
+        while (not rb.Push(producer, sequence)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // every producer's elements are popped in the order of that producer
+  std::vector<std::size_t> nextSequence(numberOfProducers);
+  std::size_t poppedElements{};
+  bool isOrdered{true};
+  const auto popFn{[&](const Element_t &element) {
+    isOrdered = isOrdered and (element.second == nextSequence[element.first]);
+    nextSequence[element.first] = element.second + 1;
+    poppedElements++;
+  }};
+
+  while (poppedElements < numberOfProducers * elementsPerProducer) {
+    if (not rb.Pop(popFn)) {
+      std::this_thread::yield();
+    }
+  }
+
+  EXPECT_TRUE(isOrdered);
+  EXPECT_TRUE(rb.Empty());
+  for (const auto sequence : nextSequence) {
+    EXPECT_EQ(sequence, elementsPerProducer);
+  }
+}
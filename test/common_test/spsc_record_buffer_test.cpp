@@ -0,0 +1,135 @@
+#include "common/spsc_record_buffer.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <string_view>
+#include <thread>
+
+using namespace moboware::common;
+
+namespace {
+template <std::size_t Capacity> bool PushRecord(SpscRecordBuffer<Capacity> &rb, const std::string_view text)
+{
+  auto *const data{rb.Reserve(text.size())};
+  if (data == nullptr) {
+    return false;
+  }
+  std::memcpy(data, text.data(), text.size());
+  rb.Commit(text.size());
+  return true;
+}
+
+template <std::size_t Capacity> auto FrontRecord(SpscRecordBuffer<Capacity> &rb) -> std::string_view
+{
+  const auto record{rb.Front()};
+  return {reinterpret_cast<const char *>(record.data()), record.size()};
+}
+}   // namespace
+
+TEST(SpscRecordBufferTest, pushPopTest)
+{
+  constexpr std::size_t capacity{64};
+  SpscRecordBuffer<capacity> rb;
+
+  EXPECT_TRUE(rb.Empty());
+  EXPECT_EQ(rb.GetCapacity(), capacity);
+  EXPECT_TRUE(rb.Front().empty());
+
+  // a record takes its length, the header and the alignment: 16 bytes for "a" and "bcdefgh", 24 bytes for "ijklmnopq"
+  EXPECT_TRUE(PushRecord(rb, "a"));
+  EXPECT_TRUE(PushRecord(rb, "bcdefgh"));
+  EXPECT_TRUE(PushRecord(rb, "ijklmnopq"));
+  EXPECT_FALSE(PushRecord(rb, "full1234"));   // 8 bytes left
+
+  EXPECT_EQ(FrontRecord(rb), "a");
+  // the front is the same record until it is popped
+  EXPECT_EQ(FrontRecord(rb), "a");
+  rb.Pop();
+  EXPECT_EQ(FrontRecord(rb), "bcdefgh");
+  rb.Pop();
+  EXPECT_EQ(FrontRecord(rb), "ijklmnopq");
+  rb.Pop();
+
+  EXPECT_TRUE(rb.Empty());
+  EXPECT_TRUE(rb.Front().empty());
+}
+
+TEST(SpscRecordBufferTest, wrapTest)
+{
+  constexpr std::size_t capacity{64};
+  SpscRecordBuffer<capacity> rb;
+
+  // 48 bytes used, the next record of 24 bytes does not fit before the end
+  EXPECT_TRUE(PushRecord(rb, "0123456789abcdefghij"));
+  EXPECT_TRUE(PushRecord(rb, "klmnopq"));
+  EXPECT_FALSE(PushRecord(rb, "rstuvwxyzABC"));   // the end and the begin are in use
+
+  EXPECT_EQ(FrontRecord(rb), "0123456789abcdefghij");
+  rb.Pop();
+
+  // the end of the buffer is skipped, the record is at the begin
+  EXPECT_TRUE(PushRecord(rb, "rstuvwxyzABC"));
+  EXPECT_EQ(FrontRecord(rb), "klmnopq");
+  rb.Pop();
+  EXPECT_EQ(FrontRecord(rb), "rstuvwxyzABC");
+  rb.Pop();
+  EXPECT_TRUE(rb.Empty());
+
+  // a reservation that is not committed is not visible
+  EXPECT_NE(rb.Reserve(8), nullptr);
+  EXPECT_TRUE(rb.Empty());
+  EXPECT_TRUE(PushRecord(rb, "D"));
+  EXPECT_EQ(FrontRecord(rb), "D");
+}
+
+TEST(SpscRecordBufferTest, keepFreeTest)
+{
+  constexpr std::size_t capacity{64};
+  SpscRecordBuffer<capacity> rb;
+
+  EXPECT_TRUE(PushRecord(rb, "0123456789abcdefghij"));
+  // 32 bytes are free, a record of 16 bytes does not keep 24 bytes free
+  EXPECT_EQ(rb.Reserve(8, 24), nullptr);
+  EXPECT_NE(rb.Reserve(8, 16), nullptr);
+  EXPECT_TRUE(PushRecord(rb, "klmnopq"));
+}
+
+TEST(SpscRecordBufferTest, producerConsumerTest)
+{
+  constexpr std::size_t numberOfRecords{1'000'000};
+  SpscRecordBuffer<4 * 1024> rb;
+
+  // records of a random length, every record has its sequence number in all bytes
+  std::jthread producer([&rb]() {
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<std::size_t> lengthDistribution{1, 200};
+    for (std::size_t sequence = 0; sequence < numberOfRecords; sequence++) {
+      const auto length{lengthDistribution(generator)};
+      std::byte *data{};
+      while ((data = rb.Reserve(length)) == nullptr) {
+        std::this_thread::yield();
+      }
+      std::memset(data, static_cast<int>(sequence & 0xff), length);
+      rb.Commit(length);
+    }
+  });
+
+  std::mt19937 generator{42};
+  std::uniform_int_distribution<std::size_t> lengthDistribution{1, 200};
+  bool isValid{true};
+  for (std::size_t sequence = 0; sequence < numberOfRecords;) {
+    const auto record{rb.Front()};
+    if (record.empty()) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    isValid = isValid and record.size() == lengthDistribution(generator) and
+              std::all_of(std::begin(record), std::end(record), [&](const std::byte b) { return b == static_cast<std::byte>(sequence & 0xff); });
+    rb.Pop();
+    sequence++;
+  }
+
+  EXPECT_TRUE(isValid);
+  EXPECT_TRUE(rb.Empty());
+}
@@ -0,0 +1,118 @@
+#include "common/timing_wheel.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace moboware::common;
+
+namespace {
+using TimingWheel_t = TimingWheel<int, 4, 3>;   // 16 slots per level, range of 4096 ticks
+
+struct Expired {
+  TimingWheel_t::Tick_t tick{};
+  int entry{};
+
+  bool operator==(const Expired &) const = default;
+};
+}   // namespace
+
+TEST(TimingWheelTest, expireTest)
+{
+  TimingWheel_t timingWheel(1000);
+  std::vector<Expired> expired;
+  const auto expireFn{[&](const int entry) { expired.push_back(Expired{timingWheel.GetCurrentTick(), entry}); }};
+
+  // expiries on each level, in the past and out of the range of the wheel
+  timingWheel.Add(1005, 1);
+  timingWheel.Add(1100, 2);
+  timingWheel.Add(3000, 3);
+  timingWheel.Add(500, 4);
+  timingWheel.Add(1000 + 10000, 5);
+  timingWheel.Add(1005, 6);
+  EXPECT_EQ(timingWheel.GetSize(), 6);
+
+  timingWheel.Advance(1004, expireFn);
+  EXPECT_EQ(expired, (std::vector{Expired{1001, 4}}));
+
+  expired.clear();
+  timingWheel.Advance(1005, expireFn);
+  EXPECT_EQ(expired, (std::vector{Expired{1005, 1}, Expired{1005, 6}}));
+
+  expired.clear();
+  timingWheel.Advance(2999, expireFn);
+  EXPECT_EQ(expired, (std::vector{Expired{1100, 2}}));
+
+  expired.clear();
+  timingWheel.Advance(5000, expireFn);
+  EXPECT_EQ(expired, (std::vector{Expired{3000, 3}}));
+  EXPECT_EQ(timingWheel.GetSize(), 1);
+
+  expired.clear();
+  timingWheel.Advance(20000, expireFn);
+  EXPECT_EQ(expired, (std::vector{Expired{11000, 5}}));
+  EXPECT_TRUE(timingWheel.IsEmpty());
+  EXPECT_EQ(timingWheel.GetCurrentTick(), 20000);
+}
+
+TEST(TimingWheelTest, addWhileExpireTest)
+{
+  TimingWheel_t timingWheel;
+  std::vector<Expired> expired;
+
+  // every expired entry adds the next entry, until the 10th entry
+  const auto expireFn{[&](const int entry) {
+    expired.push_back(Expired{timingWheel.GetCurrentTick(), entry});
+    if (entry < 10) {
+      timingWheel.Add(timingWheel.GetCurrentTick() + 100, entry + 1);
+    }
+  }};
+
+  timingWheel.Add(100, 1);
+  timingWheel.Advance(10000, expireFn);
+
+  ASSERT_EQ(expired.size(), 10);
+  for (int i{}; i < 10; i++) {
+    EXPECT_EQ(expired[i], (Expired{100U * (i + 1), i + 1}));
+  }
+  EXPECT_TRUE(timingWheel.IsEmpty());
+}
+
+TEST(TimingWheelTest, expireOrderTest)
+{
+  TimingWheel<int> timingWheel;
+
+  // every tick of the first 100000 ticks, added in reverse order, expires in tick order
+  for (int tick{100000}; tick > 0; tick--) {
+    timingWheel.Add(tick, tick);
+  }
+
+  std::vector<int> expired;
+  TimingWheel<int>::Tick_t tick{};
+  while (not timingWheel.IsEmpty()) {
+    tick += 777;
+    timingWheel.Advance(tick, [&](const int entry) {
+      EXPECT_EQ(timingWheel.GetCurrentTick(), entry);
+      expired.push_back(entry);
+    });
+  }
+
+  ASSERT_EQ(expired.size(), 100000);
+  EXPECT_TRUE(std::is_sorted(std::begin(expired), std::end(expired)));
+}
+
+TEST(TimingWheelTest, resetTest)
+{
+  TimingWheel_t timingWheel(5000);
+  timingWheel.Add(5010, 1);
+  EXPECT_FALSE(timingWheel.Reset(100));
+
+  std::vector<Expired> expired;
+  timingWheel.Advance(6000, [&](const int entry) { expired.push_back(Expired{timingWheel.GetCurrentTick(), entry}); });
+  EXPECT_EQ(expired, (std::vector{Expired{5010, 1}}));
+
+  // an empty wheel is moved back in time and expires from there
+  EXPECT_TRUE(timingWheel.Reset(100));
+  EXPECT_EQ(timingWheel.GetCurrentTick(), 100);
+  timingWheel.Add(110, 2);
+  timingWheel.Advance(120, [&](const int entry) { expired.push_back(Expired{timingWheel.GetCurrentTick(), entry}); });
+  EXPECT_EQ(expired, (std::vector{Expired{5010, 1}, Expired{110, 2}}));
+}
@@ -0,0 +1,195 @@
+#include "common/write_queue.h"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace moboware::common;
+
+namespace {
+auto ToBuffer(const std::string &message) -> boost::asio::const_buffer
+{
+  return {message.data(), message.size()};
+}
+
+auto ToString(const WriteQueue::Write &write) -> std::string
+{
+  return {static_cast<const char *>(write.buffer.data()), write.buffer.size()};
+}
+}   // namespace
+
+TEST(WriteQueueTest, coalesceWritesTest)
+{
+  WriteQueue writeQueue(WriteQueueConfig{});
+
+  // nothing to write
+  EXPECT_FALSE(writeQueue.GetNextWrite());
+
+  // the first message starts the writer, the next messages are queued behind it
+  EXPECT_EQ(writeQueue.Push(ToBuffer("text1"), false), WriteQueue::PushResult::StartWrite);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("text2"), false), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("bin1"), true), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("bin2"), true), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 18);
+
+  // text messages are written one by one, the binary messages are coalesced into one write
+  auto write{writeQueue.GetNextWrite()};
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "text1");
+  EXPECT_FALSE(write->isBinary);
+
+  // queued while the batch is written, goes into the next batch
+  EXPECT_EQ(writeQueue.Push(ToBuffer("bin3"), true), WriteQueue::PushResult::Queued);
+
+  write = writeQueue.GetNextWrite();
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "text2");
+
+  write = writeQueue.GetNextWrite();
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "bin1bin2");
+  EXPECT_TRUE(write->isBinary);
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 12);
+
+  write = writeQueue.GetNextWrite();
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "bin3");
+
+  // all written, the writer is idle and the next message starts it again
+  EXPECT_FALSE(writeQueue.GetNextWrite());
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 0);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("text3"), false), WriteQueue::PushResult::StartWrite);
+  EXPECT_EQ(writeQueue.GetStats().queuedMessages, 6);
+}
+
+TEST(WriteQueueTest, slowConsumerDropTest)
+{
+  WriteQueue writeQueue(WriteQueueConfig{10, 2, SlowConsumerPolicy::Drop});
+
+  EXPECT_EQ(writeQueue.Push(ToBuffer("1234"), false, 1), WriteQueue::PushResult::StartWrite);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("5678"), false, 2), WriteQueue::PushResult::Queued);
+  // above the high water mark, the market data is dropped and a message without a conflation key is queued
+  EXPECT_EQ(writeQueue.Push(ToBuffer("abcd"), false, 1), WriteQueue::PushResult::Dropped);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("priv"), false), WriteQueue::PushResult::Queued);
+
+  // below the high water mark, the slow consumer stays slow until the queue is below the low water mark
+  ASSERT_TRUE(writeQueue.GetNextWrite());
+  ASSERT_TRUE(writeQueue.GetNextWrite());
+  const auto write{writeQueue.GetNextWrite()};
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "priv");
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 4);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("ab"), false, 1), WriteQueue::PushResult::Dropped);
+
+  EXPECT_FALSE(writeQueue.GetNextWrite());
+  EXPECT_EQ(writeQueue.Push(ToBuffer("ab"), false, 1), WriteQueue::PushResult::StartWrite);
+
+  const auto stats{writeQueue.GetStats()};
+  EXPECT_EQ(stats.droppedMessages, 2);
+  EXPECT_EQ(stats.slowConsumerCount, 1);
+}
+
+TEST(WriteQueueTest, slowConsumerConflateTest)
+{
+  WriteQueue writeQueue(WriteQueueConfig{10, 5, SlowConsumerPolicy::Conflate});
+
+  EXPECT_EQ(writeQueue.Push(ToBuffer("1234"), true, 1), WriteQueue::PushResult::StartWrite);
+  auto write{writeQueue.GetNextWrite()};   // in flight
+  ASSERT_TRUE(write);
+
+  EXPECT_EQ(writeQueue.Push(ToBuffer("5678"), true, 2), WriteQueue::PushResult::Queued);
+  // a message without a conflation key is queued by a slow consumer
+  EXPECT_EQ(writeQueue.Push(ToBuffer("priv"), true), WriteQueue::PushResult::Queued);
+  // the pending message of the key is replaced by the latest one, the write in flight is not touched
+  EXPECT_EQ(writeQueue.Push(ToBuffer("abcd"), true, 2), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("efgh"), true, 1), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(ToString(*write), "1234");
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 16);
+
+  write = writeQueue.GetNextWrite();
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "privabcdefgh");
+  EXPECT_FALSE(writeQueue.GetNextWrite());
+  EXPECT_EQ(writeQueue.GetStats().conflatedMessages, 1);
+}
+
+TEST(WriteQueueTest, slowConsumerConflateSharedTest)
+{
+  WriteQueue writeQueue(WriteQueueConfig{10, 5, SlowConsumerPolicy::Conflate});
+
+  const auto level1{MakeSharedBuffer("level1", 6)};
+  const auto level2{MakeSharedBuffer("level2", 6)};
+  EXPECT_EQ(writeQueue.Push(ToBuffer("reply"), false), WriteQueue::PushResult::StartWrite);
+  EXPECT_EQ(writeQueue.Push(level1, false, 1), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("trade"), false), WriteQueue::PushResult::Queued);
+  // the session became slow with level1 queued, it is superseded and released
+  EXPECT_EQ(writeQueue.Push(level2, false, 1), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(level1.use_count(), 1);
+
+  std::vector<std::string> writes;
+  while (const auto write{writeQueue.GetNextWrite()}) {
+    writes.push_back(ToString(*write));
+  }
+  EXPECT_EQ(writes, (std::vector<std::string>{"reply", "trade", "level2"}));
+  EXPECT_EQ(writeQueue.GetStats().conflatedMessages, 1);
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 0);
+}
+
+TEST(WriteQueueTest, slowConsumerDisconnectTest)
+{
+  WriteQueue writeQueue(WriteQueueConfig{10, 5, SlowConsumerPolicy::Disconnect});
+
+  EXPECT_EQ(writeQueue.Push(ToBuffer("1234"), false), WriteQueue::PushResult::StartWrite);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("5678"), false), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("abcd"), false), WriteQueue::PushResult::Disconnect);
+
+  // everything after the disconnect is dropped
+  EXPECT_EQ(writeQueue.Push(ToBuffer("a"), false), WriteQueue::PushResult::Dropped);
+  EXPECT_EQ(writeQueue.GetStats().droppedMessages, 2);
+}
+
+TEST(WriteQueueTest, sharedMessageTest)
+{
+  WriteQueue writeQueue(WriteQueueConfig{});
+
+  const auto sharedMessage{MakeSharedBuffer("shared", 6)};
+  EXPECT_EQ(writeQueue.Push(ToBuffer("bin1"), true), WriteQueue::PushResult::StartWrite);
+  EXPECT_EQ(writeQueue.Push(sharedMessage, true), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("bin2"), true), WriteQueue::PushResult::Queued);
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 14);
+  EXPECT_EQ(sharedMessage.use_count(), 2);
+
+  // the shared message is written from the shared buffer, not copied, and is not coalesced with the copied messages
+  auto write{writeQueue.GetNextWrite()};
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "bin1");
+
+  write = writeQueue.GetNextWrite();
+  ASSERT_TRUE(write);
+  EXPECT_EQ(write->buffer.data(), sharedMessage->data());
+  EXPECT_TRUE(write->isBinary);
+
+  write = writeQueue.GetNextWrite();
+  ASSERT_TRUE(write);
+  EXPECT_EQ(ToString(*write), "bin2");
+
+  // the reference is released when the batch is written
+  EXPECT_FALSE(writeQueue.GetNextWrite());
+  EXPECT_EQ(sharedMessage.use_count(), 1);
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 0);
+}
+
+TEST(WriteQueueTest, closeTest)
+{
+  WriteQueue writeQueue(WriteQueueConfig{});
+
+  EXPECT_EQ(writeQueue.Push(ToBuffer("text1"), false), WriteQueue::PushResult::StartWrite);
+  EXPECT_EQ(writeQueue.Push(ToBuffer("text2"), false), WriteQueue::PushResult::Queued);
+  ASSERT_TRUE(writeQueue.GetNextWrite());
+  EXPECT_EQ(writeQueue.Push(ToBuffer("text3"), false), WriteQueue::PushResult::Queued);
+
+  // a failed write stops the writer, the queued messages are dropped and nothing is written anymore
+  writeQueue.Close();
+  EXPECT_EQ(writeQueue.GetQueuedBytes(), 0);
+  EXPECT_EQ(writeQueue.GetStats().droppedMessages, 2);
+  EXPECT_FALSE(writeQueue.GetNextWrite());
+  EXPECT_EQ(writeQueue.Push(ToBuffer("text4"), false), WriteQueue::PushResult::Dropped);
+}
@@ -0,0 +1,96 @@
+#include "benchmark/benchmark.h"
+#include "common/logger.hpp"
+#include "modules/matching_engine_module/order_data.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+/// @brief Cost of a log line on the logging thread, in the formatted mode the line is formatted on the calling thread, in the deferred
+/// mode only the arguments are encoded. The arguments are those of an order insert.
+/// Every iteration is a batch of log lines that fits the ring of the thread, the consumer thread writes the batch before the next batch so the calls
+/// are measured without waiting for a full queue.
+static void LogInfo(benchmark::State &state)
+{
+  constexpr auto BatchSize{256};
+
+  const auto logMode{static_cast<Logger::LogMode>(state.range(0))};
+  Logger::GetInstance().SetMode(logMode);
+  Logger::GetInstance().SetLevel(Logger::LogLevel::Info);
+
+  const std::string account{"account-1"};
+  const std::string clientId{"client-order-12345"};
+  std::int64_t price{10'000};
+  for (auto _ : state) {
+    const auto startTime{std::chrono::steady_clock::now()};
+    for (auto line{0}; line < BatchSize; line++) {
+      LOG_INFO("OrderInsert account:{}, clientId:{}, price:{}, volume:{}, side:{}", account, clientId, price++, 100, 'B');
+    }
+    state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  state.SetItemsProcessed(state.iterations() * BatchSize);
+
+  Logger::GetInstance().SetLevel(Logger::LogLevel::Error);
+  Logger::GetInstance().SetMode(Logger::LogMode::Formatted);
+}
+BENCHMARK(LogInfo)
+  ->Arg(static_cast<int>(Logger::LogMode::Formatted))
+  ->Arg(static_cast<int>(Logger::LogMode::Deferred))
+  ->UseManualTime()
+  ->Iterations(500);
+
+/// @brief Cost of the order insert log line of the matching engine on the engine thread. Argument 1 selects the statement:
+///   0, the order is formatted with its stream operator, the formatting is done on the logging thread in both modes
+///   1, the scalar fields of the order are logged as the matching engine does, they are encoded by value in the deferred mode
+static void LogOrderInsert(benchmark::State &state)
+{
+  constexpr auto BatchSize{256};
+
+  const auto logMode{static_cast<Logger::LogMode>(state.range(0))};
+  const bool isScalarFields{state.range(1) == 1};
+  Logger::GetInstance().SetMode(logMode);
+  Logger::GetInstance().SetLevel(Logger::LogLevel::Info);
+
+  moboware::modules::OrderInsertData orderInsert{"account-1",
+                                                 "ABCD",
+                                                 75'000'000U,
+                                                 100U,
+                                                 moboware::modules::OrderType::Limit,
+                                                 true,
+                                                 std::chrono::high_resolution_clock::now(),
+                                                 std::chrono::milliseconds::duration::zero(),
+                                                 "order-12345",
+                                                 "client-order-12345"};
+  for (auto _ : state) {
+    const auto startTime{std::chrono::steady_clock::now()};
+    for (auto line{0}; line < BatchSize; line++) {
+      if (isScalarFields) {
+        LOG_INFO("OrderInsert id:{}, clientId:{}, account:{}, price:{}, volume:{}, side:{}, type:{}",
+                 orderInsert.GetId(),
+                 orderInsert.GetClientId(),
+                 orderInsert.GetAccount(),
+                 orderInsert.GetPrice(),
+                 orderInsert.GetVolume(),
+                 orderInsert.GetIsBuySide() ? 'B' : 'S',
+                 ToString(orderInsert.GetType()));
+      } else {
+        LOG_INFO("OrderInsert:{}", orderInsert);
+      }
+    }
+    state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  state.SetItemsProcessed(state.iterations() * BatchSize);
+
+  Logger::GetInstance().SetLevel(Logger::LogLevel::Error);
+  Logger::GetInstance().SetMode(Logger::LogMode::Formatted);
+}
+BENCHMARK(LogOrderInsert)
+  ->Args({static_cast<int>(Logger::LogMode::Formatted), 0})
+  ->Args({static_cast<int>(Logger::LogMode::Formatted), 1})
+  ->Args({static_cast<int>(Logger::LogMode::Deferred), 0})
+  ->Args({static_cast<int>(Logger::LogMode::Deferred), 1})
+  ->UseManualTime()
+  ->Iterations(500);
@@ -1,11 +1,41 @@
 #include "benchmark/benchmark.h"
 #include "common/logger.hpp"
 #include "modules/matching_engine_module/matching_engine.h"
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <new>
 #include <random>
+#include <vector>
 
 using namespace moboware;
 using namespace moboware::modules;
 
+namespace {
+/// @brief number of heap allocations of the benchmark thread, counted by the replaced global operator new
+thread_local std::uint64_t allocationCount{};
+}   // namespace
+
+void *operator new(std::size_t size)
+{
+  allocationCount++;
+  if (auto *const ptr{std::malloc(size == 0 ? 1 : size)}) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
 class ChannelInterfaceMock : public common::ChannelInterface {
 public:
   void SendWebSocketData(const boost::asio::const_buffer &readBuffer,
@@ -13,9 +43,30 @@ public:
 };
 
 /**
- * @brief benchmark fixture
+ * @brief matching engine without the encoding and sending of the replies, to measure the match path only
  */
-class MatchingEngineBenchmark : public benchmark::Fixture {
+template <typename TMatchingEngine> class NoReplyMatchingEngine : public TMatchingEngine {
+public:
+  using TMatchingEngine::TMatchingEngine;
+
+protected:
+  void CreateAndSendMessage(const OrderReply &, const boost::asio::ip::tcp::endpoint &) final
+  {
+  }
+
+  void CreateAndSendMessage(const ErrorReply &, const boost::asio::ip::tcp::endpoint &) final
+  {
+  }
+
+  void CreateAndSendMessage(const Trade &, const boost::asio::ip::tcp::endpoint &) final
+  {
+  }
+};
+
+/**
+ * @brief benchmark fixture, templated on the matching engine type to compare the std::map and the price ladder order books
+ */
+template <typename TMatchingEngine> class MatchingEngineBenchmark : public benchmark::Fixture {
 public:
   MatchingEngineBenchmark()
       : matchingEngine(std::make_shared<ChannelInterfaceMock>())
@@ -31,79 +82,400 @@ public:
   {
   }
 
-  MatchingEngine matchingEngine;
-  const boost::asio::ip::tcp::endpoint endpoint;
-};
+  void InsertOrder(benchmark::State &state)
+  {
+    std::random_device rd;    // Will be used to obtain a seed for the random number engine
+    std::mt19937 gen(rd());   // Standard mersenne_twister_engine seeded with rd()
+    std::uniform_int_distribution<PriceType_t> priceDistribution(50, 100);   // price range from 50..100
 
-BENCHMARK_F(MatchingEngineBenchmark, InsertOrder)(benchmark::State &state)
-{
-  std::random_device rd;    // Will be used to obtain a seed for the random number engine
-  std::mt19937 gen(rd());   // Standard mersenne_twister_engine seeded with rd()
-  std::uniform_int_distribution<PriceType_t> priceDistribution(50, 100);   // price range from 50..100
+    for (const auto _ : state) {
 
-  for (const auto _ : state) {
+      state.PauseTiming();
+      OrderInsertData orderInsertData{"mobo",
+                                      "ABCD",
+                                      {priceDistribution(gen) * std::mega::num},
+                                      1'000U,
+                                      OrderType::Limit,
+                                      true,
+                                      std::chrono::system_clock::now(),
+                                      std::chrono::milliseconds::duration::zero(),
+                                      std::to_string(std::chrono::system_clock::now().time_since_epoch().count()),
+                                      std::to_string(std::chrono::system_clock::now().time_since_epoch().count())};
+      if (not orderInsertData.Validate()) {
+        state.SkipWithError("Order data validation failed");
+        return;
+      }
+      state.ResumeTiming();
 
-    state.PauseTiming();
-    OrderInsertData orderInsertData{"mobo",
-                                    "ABCD",
-                                    {priceDistribution(gen) * std::mega::num},
-                                    1'000U,
-                                    "Limit",
-                                    true,
-                                    std::chrono::system_clock::now(),
-                                    std::chrono::milliseconds::duration::zero(),
-                                    std::to_string(std::chrono::system_clock::now().time_since_epoch().count()),
-                                    std::to_string(std::chrono::system_clock::now().time_since_epoch().count())};
-    if (not orderInsertData.Validate()) {
-      state.SkipWithError("Order data validation failed");
-      return;
+      matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
     }
-    state.ResumeTiming();
+  }
+
+  void CancelOrder(benchmark::State &state)
+  {
+    for (const auto _ : state) {
+      state.PauseTiming();
+
+      std::random_device rd;    // Will be used to obtain a seed for the random number engine
+      std::mt19937 gen(rd());   // Standard mersenne_twister_engine seeded with rd()
+      std::uniform_int_distribution<PriceType_t> priceDistribution(50, 100);   // price range from 50..100
+
+      OrderInsertData orderInsertData{"mobo",
+                                      "ABCD",
+                                      {priceDistribution(gen) * std::mega::num},
+                                      1'000U,
+                                      OrderType::Limit,
+                                      true,
+                                      std::chrono::high_resolution_clock::now(),
+                                      std::chrono::milliseconds::duration::zero(),
+                                      std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count()),
+                                      std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count())};
+      if (not orderInsertData.Validate()) {
+        state.SkipWithError("Order data validation failed");
+        return;
+      }
+
+      matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+
+      OrderCancelData orderCancel{orderInsertData.GetInstrument(),
+                                  orderInsertData.GetPrice(),
+                                  orderInsertData.GetIsBuySide(),
+                                  orderInsertData.GetId(),
+                                  orderInsertData.GetClientId()};
 
-    matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+      state.ResumeTiming();
+
+      // start timing measurement here
+      matchingEngine.OrderCancel(orderCancel, endpoint);
+    }
   }
-}
 
-BENCHMARK_REGISTER_F(MatchingEngineBenchmark, InsertOrder);   //->DenseThreadRange(1, 8, 1);
+  /// @brief cancel the last order of a price level with a queue depth of state.range(0) orders
+  void CancelOrderAtQueueDepth(benchmark::State &state)
+  {
+    constexpr PriceType_t price{75U * std::mega::num};
+    const auto createOrderFn{[&](const std::string &id) {
+      return OrderInsertData{"mobo",
+                             "ABCD",
+                             price,
+                             1'000U,
+                             OrderType::Limit,
+                             true,
+                             std::chrono::high_resolution_clock::now(),
+                             std::chrono::milliseconds::duration::zero(),
+                             id,
+                             id};
+    }};
 
-BENCHMARK_F(MatchingEngineBenchmark, CancelOrder)(benchmark::State &state)
-{
+    // the fixture is reused between the runs, only add the missing orders to get to the queue depth
+    for (; queueDepth < state.range(0); queueDepth++) {
+      matchingEngine.OrderInsert(createOrderFn("depth" + std::to_string(queueDepth)), endpoint);
+    }
 
-  for (const auto _ : state) {
-    state.PauseTiming();
+    for (const auto _ : state) {
+      state.PauseTiming();
 
-    std::random_device rd;    // Will be used to obtain a seed for the random number engine
-    std::mt19937 gen(rd());   // Standard mersenne_twister_engine seeded with rd()
-    std::uniform_int_distribution<PriceType_t> priceDistribution(50, 100);   // price range from 50..100
+      auto orderInsertData{createOrderFn(std::to_string(orderCount++))};
+      const OrderCancelData orderCancel{orderInsertData.GetInstrument(),
+                                        orderInsertData.GetPrice(),
+                                        orderInsertData.GetIsBuySide(),
+                                        orderInsertData.GetId(),
+                                        orderInsertData.GetClientId()};
+      matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+
+      state.ResumeTiming();
+
+      // start timing measurement here
+      matchingEngine.OrderCancel(orderCancel, endpoint);
+    }
+  }
+
+  /// @brief insert and cancel churn on a price level with a queue depth of state.range(0) orders, every iteration inserts an
+  /// order at the end of the queue and cancels the oldest order of the queue
+  void InsertCancelChurnAtQueueDepth(benchmark::State &state)
+  {
+    constexpr PriceType_t price{25U * std::mega::num};
+    const auto createOrderFn{[&]() {
+      const auto id{"churn" + std::to_string(orderCount++)};
+      return OrderInsertData{"mobo",
+                             "ABCD",
+                             price,
+                             1'000U,
+                             OrderType::Limit,
+                             false,
+                             std::chrono::high_resolution_clock::now(),
+                             std::chrono::milliseconds::duration::zero(),
+                             id,
+                             id};
+    }};
+    const auto createCancelFn{[](const OrderInsertData &orderInsertData) {
+      return OrderCancelData{orderInsertData.GetInstrument(),
+                             orderInsertData.GetPrice(),
+                             orderInsertData.GetIsBuySide(),
+                             orderInsertData.GetId(),
+                             orderInsertData.GetClientId()};
+    }};
+
+    // the fixture is reused between the runs, only add the missing orders to get to the queue depth
+    while (restingOrders.size() < state.range(0)) {
+      auto orderInsertData{createOrderFn()};
+      restingOrders.push_back(createCancelFn(orderInsertData));
+      matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+    }
+
+    for (const auto _ : state) {
+      state.PauseTiming();
 
-    OrderInsertData orderInsertData{"mobo",
-                                    "ABCD",
-                                    {priceDistribution(gen) * std::mega::num},
-                                    1'000U,
-                                    "Limit",
-                                    true,
-                                    std::chrono::high_resolution_clock::now(),
-                                    std::chrono::milliseconds::duration::zero(),
-                                    std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count()),
-                                    std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count())};
-    if (not orderInsertData.Validate()) {
-      state.SkipWithError("Order data validation failed");
+      auto orderInsertData{createOrderFn()};
+      restingOrders.push_back(createCancelFn(orderInsertData));
+      const auto orderCancel{restingOrders.front()};
+      restingOrders.pop_front();
+
+      state.ResumeTiming();
+
+      // start timing measurement here
+      matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+      matchingEngine.OrderCancel(orderCancel, endpoint);
+    }
+  }
+
+  /// @brief Insert and cancel churn over a bid book of 1'000 levels with periodic snapshots, a snapshot is captured every
+  /// state.range(0) iterations and 0 is no snapshots. The latency of an iteration includes the capture of a snapshot that is due
+  /// before it, as the engine thread captures between two orders. The latency percentiles are reported as counters.
+  void InsertCancelChurnWithSnapshots(benchmark::State &state)
+  {
+    constexpr PriceType_t Levels{1'000};
+    constexpr PriceType_t OrdersPerLevel{10};
+    const auto snapshotInterval{state.range(0)};
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<PriceType_t> levelDistribution(1, Levels);
+    const auto createOrderFn{[&](const PriceType_t level) {
+      const auto id{"snapshot" + std::to_string(orderCount++)};
+      return OrderInsertData{"mobo",
+                             "ABCD",
+                             level * std::mega::num,
+                             1'000U,
+                             OrderType::Limit,
+                             true,
+                             std::chrono::high_resolution_clock::now(),
+                             std::chrono::milliseconds::duration::zero(),
+                             id,
+                             id};
+    }};
+    const auto createCancelFn{[](const OrderInsertData &orderInsertData) {
+      return OrderCancelData{orderInsertData.GetInstrument(),
+                             orderInsertData.GetPrice(),
+                             orderInsertData.GetIsBuySide(),
+                             orderInsertData.GetId(),
+                             orderInsertData.GetClientId()};
+    }};
+
+    // the fixture is reused between the runs, only add the missing orders to get to the book size
+    while (restingOrders.size() < Levels * OrdersPerLevel) {
+      auto orderInsertData{createOrderFn(restingOrders.size() % Levels + 1)};
+      restingOrders.push_back(createCancelFn(orderInsertData));
+      matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+    }
+
+    const auto directory{std::filesystem::temp_directory_path() / "moboware_snapshot_benchmark"};
+    std::vector<std::chrono::nanoseconds::rep> latencies;
+    latencies.reserve(static_cast<std::size_t>(state.max_iterations));
+    {
+      snapshot::SnapshotWriter snapshotWriter(directory.string());
+      std::int64_t iterations{};
+      for (const auto _ : state) {
+        state.PauseTiming();
+        auto orderInsertData{createOrderFn(levelDistribution(gen))};
+        restingOrders.push_back(createCancelFn(orderInsertData));
+        const auto orderCancel{restingOrders.front()};
+        restingOrders.pop_front();
+        state.ResumeTiming();
+
+        const auto startTime{std::chrono::steady_clock::now()};
+        if (snapshotInterval > 0 and ++iterations % snapshotInterval == 0) {
+          snapshotWriter.Write(matchingEngine.CaptureSnapshot());
+        }
+        matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+        matchingEngine.OrderCancel(orderCancel, endpoint);
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+      }
+
+      const auto snapshotStats{snapshotWriter.GetStats()};
+      state.counters["Snapshots"] = static_cast<double>(snapshotStats.writtenSnapshots + snapshotStats.replacedSnapshots);
+    }
+    std::filesystem::remove_all(directory);
+
+    if (latencies.empty()) {
       return;
     }
+    std::sort(std::begin(latencies), std::end(latencies));
+    const auto percentile{[&](const double fraction) {
+      return static_cast<double>(latencies[static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1))]);
+    }};
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p99.9_ns"] = percentile(0.999);
+    state.counters["max_ns"] = static_cast<double>(latencies.back());
+  }
+
+  /// @brief insert a resting ask order and a bid order that fully matches it. The heap allocations of the inserts and the match
+  /// are counted once the engine is warmed up, the benchmark fails when there are any.
+  void MatchOrder(benchmark::State &state)
+  {
+    constexpr auto WarmUpOrders{1'000};
+    constexpr PriceType_t price{60U * std::mega::num};
+    const auto createOrderFn{[&](const bool isBuySide) {
+      // ids with the length of the generated order ids, longer than the small string buffer of a std::string
+      const auto id{std::to_string(1'700'000'000'000'000'000U + orderCount++)};
+      return OrderInsertData{"mobo",
+                             "ABCD",
+                             price,
+                             1'000U,
+                             OrderType::Limit,
+                             isBuySide,
+                             std::chrono::high_resolution_clock::now(),
+                             std::chrono::milliseconds::duration::zero(),
+                             id,
+                             id};
+    }};
 
-    matchingEngine.OrderInsert(std::move(orderInsertData), endpoint);
+    // warm up the order node pools, the memory resources of the order books and the strings of the reused order nodes
+    for (auto i{0}; i < WarmUpOrders; i++) {
+      matchingEngine.OrderInsert(createOrderFn(false), endpoint);
+      matchingEngine.OrderInsert(createOrderFn(true), endpoint);
+    }
 
-    OrderCancelData orderCancel{orderInsertData.GetInstrument(),
-                                orderInsertData.GetPrice(),
-                                orderInsertData.GetIsBuySide(),
-                                orderInsertData.GetId(),
-                                orderInsertData.GetClientId()};
+    std::uint64_t allocations{};
+    for (const auto _ : state) {
+      state.PauseTiming();
+      auto askOrder{createOrderFn(false)};
+      auto bidOrder{createOrderFn(true)};
+      state.ResumeTiming();
 
-    state.ResumeTiming();
+      const auto allocationsBefore{allocationCount};
+      matchingEngine.OrderInsert(std::move(askOrder), endpoint);
+      matchingEngine.OrderInsert(std::move(bidOrder), endpoint);
+      allocations += allocationCount - allocationsBefore;
+    }
 
-    // start timing measurement here
-    matchingEngine.OrderCancel(orderCancel, endpoint);
+    state.counters["AllocationsPerMatch"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    if (allocations != 0) {
+      state.SkipWithError("Heap allocations in the match path");
+    }
   }
+
+  TMatchingEngine matchingEngine;
+  const boost::asio::ip::tcp::endpoint endpoint;
+  std::deque<OrderCancelData> restingOrders;
+  std::int64_t queueDepth{};
+  std::uint64_t orderCount{};
+};
+
+// std::map order books
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, InsertOrder, MatchingEngine)(benchmark::State &state)
+{
+  InsertOrder(state);
 }
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, InsertOrder);   //->DenseThreadRange(1, 8, 1);
 
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, CancelOrder, MatchingEngine)(benchmark::State &state)
+{
+  CancelOrder(state);
+}
 BENCHMARK_REGISTER_F(MatchingEngineBenchmark, CancelOrder);   //->DenseThreadRange(1, 8, 1);
+
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, CancelOrderAtQueueDepth, MatchingEngine)(benchmark::State &state)
+{
+  CancelOrderAtQueueDepth(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, CancelOrderAtQueueDepth)->RangeMultiplier(10)->Range(1, 10'000);
+
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, InsertCancelChurnAtQueueDepth, MatchingEngine)(benchmark::State &state)
+{
+  InsertCancelChurnAtQueueDepth(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, InsertCancelChurnAtQueueDepth)->RangeMultiplier(10)->Range(10, 10'000);
+
+// matching latency while the snapshots are captured, the first run has no snapshots
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, InsertCancelChurnWithSnapshots, MatchingEngine)(benchmark::State &state)
+{
+  InsertCancelChurnWithSnapshots(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, InsertCancelChurnWithSnapshots)->Arg(0)->Arg(10'000)->Arg(1'000);
+
+// price ladder order books
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, LadderInsertOrder, LadderMatchingEngine)(benchmark::State &state)
+{
+  InsertOrder(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, LadderInsertOrder);   //->DenseThreadRange(1, 8, 1);
+
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, LadderCancelOrder, LadderMatchingEngine)(benchmark::State &state)
+{
+  CancelOrder(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, LadderCancelOrder);   //->DenseThreadRange(1, 8, 1);
+
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, LadderInsertCancelChurnAtQueueDepth, LadderMatchingEngine)(benchmark::State &state)
+{
+  InsertCancelChurnAtQueueDepth(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, LadderInsertCancelChurnAtQueueDepth)->RangeMultiplier(10)->Range(10, 10'000);
+
+// match path without the replies, asserts zero heap allocations per matched order
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, MatchOrder, NoReplyMatchingEngine<MatchingEngine>)(benchmark::State &state)
+{
+  MatchOrder(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, MatchOrder);
+
+BENCHMARK_TEMPLATE_DEFINE_F(MatchingEngineBenchmark, LadderMatchOrder, NoReplyMatchingEngine<LadderMatchingEngine>)(benchmark::State &state)
+{
+  MatchOrder(state);
+}
+BENCHMARK_REGISTER_F(MatchingEngineBenchmark, LadderMatchOrder);
+
+// reply encoding, the ostringstream per reply against the reused buffer of the reply encoder
+namespace {
+const std::string tradeAccount{"mobo"};
+const std::string tradeId{"1700000000000000001"};
+const std::string tradeClientId{"1298749274982713"};
+}   // namespace
+
+static void StreamEncodeTrade(benchmark::State &state)
+{
+  const Trade trade{tradeAccount, 100500000, 55, tradeId, tradeClientId};
+
+  const auto allocationsBefore{allocationCount};
+  for (const auto _ : state) {
+    std::ostringstream strm;
+    strm << trade;
+
+    const auto s{strm.view()};
+    const boost::asio::const_buffer sendBuffer(s.data(), s.size());
+    benchmark::DoNotOptimize(sendBuffer);
+  }
+
+  state.counters["AllocationsPerReply"] =
+    benchmark::Counter(static_cast<double>(allocationCount - allocationsBefore), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(StreamEncodeTrade);
+
+template <ReplyFormat Format> static void EncoderEncodeTrade(benchmark::State &state)
+{
+  const Trade trade{tradeAccount, 100500000, 55, tradeId, tradeClientId};
+  ReplyEncoder replyEncoder;
+  replyEncoder.SetFormat(Format);
+
+  const auto allocationsBefore{allocationCount};
+  for (const auto _ : state) {
+    const auto sendBuffer{replyEncoder.Encode(trade)};
+    benchmark::DoNotOptimize(sendBuffer);
+  }
+
+  state.counters["AllocationsPerReply"] =
+    benchmark::Counter(static_cast<double>(allocationCount - allocationsBefore), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(EncoderEncodeTrade, ReplyFormat::Json);
+BENCHMARK_TEMPLATE(EncoderEncodeTrade, ReplyFormat::Binary);
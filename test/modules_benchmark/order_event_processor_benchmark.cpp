@@ -14,7 +14,19 @@ public:
 
   void HandleOrderCancel(const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint) final{};
 
-  void GetOrderBook(const std::string &, const boost::asio::ip::tcp::endpoint &) final
+  void HandleOrderMassCancel(const OrderMassCancelData &, const boost::asio::ip::tcp::endpoint &) final
+  {
+  }
+
+  void GetOrderBook(const std::string &, const ReplyFormat, const boost::asio::ip::tcp::endpoint &) final
+  {
+  }
+
+  void SubscribeMarketData(const std::string &, const ReplyFormat, const boost::asio::ip::tcp::endpoint &) final
+  {
+  }
+
+  void UnsubscribeMarketData(const std::string &, const boost::asio::ip::tcp::endpoint &) final
   {
   }
 };
@@ -37,6 +49,34 @@ public:
   {
   }
 
+  /// @brief copy a binary message into the read buffer
+  template <typename TMessage> void CommitMessage(const TMessage &message)
+  {
+    memcpy(buffer.prepare(sizeof(message)).data(), &message, sizeof(message));
+    buffer.commit(sizeof(message));
+  }
+
+  /// @brief report the messages per second and the decode time per message
+  static void SetMessageCounters(benchmark::State &state)
+  {
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    state.counters["DecodePerMsg"] = benchmark::Counter(static_cast<double>(state.iterations()),   //
+                                                        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  }
+
+  static auto CreateOrderInsert() -> OrderInsertData
+  {
+    OrderInsertData orderInsert;
+    orderInsert.SetAccount("mobo");
+    orderInsert.SetInstrument("ABCN");
+    orderInsert.SetPrice(100500000);
+    orderInsert.SetVolume(55);
+    orderInsert.SetType("Limit");
+    orderInsert.SetIsBuySide(false);
+    orderInsert.SetClientId("1298749274982713");
+    return orderInsert;
+  }
+
   OrderEventProcessor orderEventProcessor;
   boost::beast::flat_buffer buffer{10 * 1'024U};
 };
@@ -51,11 +91,30 @@ BENCHMARK_F(OrderEventProcessorBenchmark, InsertOrder)(benchmark::State &state)
   for (const auto _ : state) {
     orderEventProcessor.Process(buffer);
   }
+  SetMessageCounters(state);
   buffer.clear();
 }
 
 BENCHMARK_REGISTER_F(OrderEventProcessorBenchmark, InsertOrder);   //->DenseThreadRange(1, 8, 1);
 
+BENCHMARK_F(OrderEventProcessorBenchmark, InsertOrderProcessorPerMessage)(benchmark::State &state)
+{
+  // a new processor, and so a new parser and arena, for every message, the module did this before the processor was kept per session
+  const std::string orderRequest{
+      "{\"Action\":\"Insert\",\"Data\":{\"Account\":\"mobo\",\"Instrument\":"
+      "\"ABCN\",\"Price\":100500000,\"Volume\":55,\"IsBuy\":false,\"Type\":\"Limit\",\"ClientId\":\"1298749274982713\"}}"};
+  memcpy(buffer.prepare(orderRequest.size()).data(), orderRequest.c_str(), orderRequest.size());
+  buffer.commit(orderRequest.size());
+  for (const auto _ : state) {
+    OrderEventProcessor messageEventProcessor(orderHandlerMock, boost::asio::ip::tcp::endpoint());
+    messageEventProcessor.Process(buffer);
+  }
+  SetMessageCounters(state);
+  buffer.clear();
+}
+
+BENCHMARK_REGISTER_F(OrderEventProcessorBenchmark, InsertOrderProcessorPerMessage);
+
 BENCHMARK_F(OrderEventProcessorBenchmark, CancelOrder)(benchmark::State &state)
 {
   const std::string orderRequest{"{\"Action\":\"Cancel\",\"Data\":{\"Instrument\":\"ABCN\",\"Price\":100500000,\"IsBuy\":"
@@ -65,6 +124,7 @@ BENCHMARK_F(OrderEventProcessorBenchmark, CancelOrder)(benchmark::State &state)
   for (const auto _ : state) {
     orderEventProcessor.Process(buffer);
   }
+  SetMessageCounters(state);
   buffer.clear();
 }
 
@@ -81,6 +141,7 @@ BENCHMARK_F(OrderEventProcessorBenchmark, AmendOrder)(benchmark::State &state)
   for (const auto _ : state) {
     orderEventProcessor.Process(buffer);
   }
+  SetMessageCounters(state);
   buffer.clear();
 }
 
@@ -95,7 +156,75 @@ BENCHMARK_F(OrderEventProcessorBenchmark, GetBook)(benchmark::State &state)
   for (const auto _ : state) {
     orderEventProcessor.Process(buffer);
   }
+  SetMessageCounters(state);
   buffer.clear();
 }
 
 BENCHMARK_REGISTER_F(OrderEventProcessorBenchmark, GetBook);   //->DenseThreadRange(1, 8, 1);
+
+BENCHMARK_F(OrderEventProcessorBenchmark, JsonDecodeInsertOrder)(benchmark::State &state)
+{
+  // json parse and conversion into the order insert data, without the order handler call
+  const std::string orderRequest{
+      "{\"Action\":\"Insert\",\"Data\":{\"Account\":\"mobo\",\"Instrument\":"
+      "\"ABCN\",\"Price\":100500000,\"Volume\":55,\"IsBuy\":false,\"Type\":\"Limit\",\"ClientId\":\"1298749274982713\"}}"};
+  for (const auto _ : state) {
+    boost::json::stream_parser parser;
+    boost::system::error_code ec;
+    parser.write(orderRequest.data(), orderRequest.size(), ec);
+    const auto rootDocument{parser.release()};
+
+    OrderInsertData orderInsert;
+    benchmark::DoNotOptimize(orderInsert.SetData(rootDocument.at(Fields::Data)));
+  }
+  SetMessageCounters(state);
+}
+
+BENCHMARK_REGISTER_F(OrderEventProcessorBenchmark, JsonDecodeInsertOrder);
+
+BENCHMARK_F(OrderEventProcessorBenchmark, BinaryDecodeInsertOrder)(benchmark::State &state)
+{
+  // in place decode and conversion into the order insert data, without the order handler call
+  binary::OrderInsertMessage message;
+  [[maybe_unused]] const auto isEncoded{binary::Encode(CreateOrderInsert(), message)};
+  const auto *const data{reinterpret_cast<const char *>(&message)};
+
+  for (const auto _ : state) {
+    const auto *const header{binary::DecodeHeader(data, sizeof(message))};
+    const auto *const insertMessage{binary::DecodeMessage<binary::OrderInsertMessage>(*header)};
+    auto orderInsert{binary::ToOrderInsertData(*insertMessage)};
+    benchmark::DoNotOptimize(orderInsert);
+  }
+  SetMessageCounters(state);
+}
+
+BENCHMARK_REGISTER_F(OrderEventProcessorBenchmark, BinaryDecodeInsertOrder);
+
+BENCHMARK_F(OrderEventProcessorBenchmark, BinaryInsertOrder)(benchmark::State &state)
+{
+  binary::OrderInsertMessage message;
+  [[maybe_unused]] const auto isEncoded{binary::Encode(CreateOrderInsert(), message)};
+  CommitMessage(message);
+  for (const auto _ : state) {
+    orderEventProcessor.Process(buffer);
+  }
+  SetMessageCounters(state);
+  buffer.clear();
+}
+
+BENCHMARK_REGISTER_F(OrderEventProcessorBenchmark, BinaryInsertOrder);
+
+BENCHMARK_F(OrderEventProcessorBenchmark, BinaryCancelOrder)(benchmark::State &state)
+{
+  const OrderCancelData orderCancel{"ABCN", 100500000, false, "309458290485", "1298749274982713"};
+  binary::OrderCancelMessage message;
+  [[maybe_unused]] const auto isEncoded{binary::Encode(orderCancel, message)};
+  CommitMessage(message);
+  for (const auto _ : state) {
+    orderEventProcessor.Process(buffer);
+  }
+  SetMessageCounters(state);
+  buffer.clear();
+}
+
+BENCHMARK_REGISTER_F(OrderEventProcessorBenchmark, BinaryCancelOrder);
@@ -1,6 +1,15 @@
 #include "common/logger.hpp"
+#include "common/mapped_file.h"
+#include "modules/matching_engine_module/journal.h"
 #include "modules/matching_engine_module/matching_engine.h"
+#include "modules/matching_engine_module/matching_engine_thread.h"
 #include "modules/matching_engine_module/order_book.h"
+#include "modules/matching_engine_module/order_entry_protocol.h"
+#include "modules/matching_engine_module/replay.h"
+#include "modules/matching_engine_module/reply_encoder.h"
+#include "modules/matching_engine_module/shard_scheduler.h"
+#include "modules/matching_engine_module/snapshot.h"
+#include <filesystem>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -8,6 +17,23 @@ using namespace moboware::modules;
 
 class OrderBookTest : public testing::Test {
 public:
+  /// @brief insert the order entry data into the order book, converted into a resting order like the matching engine does
+  template <typename TOrderBook> auto Insert(TOrderBook &orderBook, const OrderInsertData &orderData) -> const OrderNode *
+  {
+    const Order order{++orderId,
+                      orderData.GetPrice(),
+                      orderData.GetVolume(),
+                      orderData.GetOrderTime(),
+                      std::chrono::duration_cast<OrderDuration_t>(orderData.GetOrderDuration()),
+                      symbolTable.Intern(orderData.GetAccount()),
+                      symbolTable.Intern(orderData.GetInstrument()),
+                      orderData.GetType(),
+                      orderData.GetIsBuySide()};
+    return orderBook.Insert(order, orderData.GetId(), orderData.GetClientId());
+  }
+
+  SymbolTable symbolTable;
+  OrderId_t orderId{};
 };
 
 class ChannelInterfaceMock : public moboware::common::ChannelInterface {
@@ -15,12 +41,18 @@ public:
   MOCK_METHOD(void,
               SendWebSocketData,
               (const boost::asio::const_buffer &readBuffer, const boost::asio::ip::tcp::endpoint &endpoint));
+  MOCK_METHOD(void,
+              PublishWebSocketData,
+              (const moboware::common::SharedBuffer_t &sharedBuffer,
+               const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+               const moboware::common::ConflationKey_t conflationKey));
 };
 
-class MatchingEngineMock : public MatchingEngine {
+template <typename TMatchingEngine> class BasicMatchingEngineMock : public TMatchingEngine {
 public:
-  explicit MatchingEngineMock(const std::shared_ptr<moboware::common::ChannelInterface> &channelInterface)
-      : MatchingEngine(channelInterface)
+  explicit BasicMatchingEngineMock(const std::shared_ptr<moboware::common::ChannelInterface> &channelInterface,
+                                   const std::string &instrument = {})
+      : TMatchingEngine(channelInterface, instrument)
   {
   }
 
@@ -33,6 +65,9 @@ public:
               (const moboware::modules::ErrorReply &, const boost::asio::ip::tcp::endpoint &endpoint));
 };
 
+using MatchingEngineMock = BasicMatchingEngineMock<MatchingEngine>;
+using LadderMatchingEngineMock = BasicMatchingEngineMock<LadderMatchingEngine>;
+
 TEST_F(OrderBookTest, InsertBidOrdersTest)
 {
   OrderBidBook_t orderBook;
@@ -53,7 +88,7 @@ TEST_F(OrderBookTest, InsertBidOrdersTest)
     strm << i;
     orderData.SetId(strm.str());
 
-    orderBook.Insert(std::move(orderData));
+    Insert(orderBook, orderData);
   }
 
   const auto levelOptional{orderBook.GetLevelAtPrice(price)};
@@ -82,7 +117,7 @@ TEST_F(OrderBookTest, InsertAskOrdersTest)
     strm << i;
     orderData.SetId(strm.str());
 
-    orderBook.Insert(std::move(orderData));
+    Insert(orderBook, orderData);
   }
 
   const auto levelOptional{orderBook.GetLevelAtPrice(price)};
@@ -105,7 +140,7 @@ TEST_F(OrderBookTest, MatchOrdersFullTradeAskSideTest)
                                "ABCD",
                                price,
                                100,
-                               "Limit",
+                               OrderType::Limit,
                                true,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -117,7 +152,7 @@ TEST_F(OrderBookTest, MatchOrdersFullTradeAskSideTest)
                                "ABCD",
                                price,
                                10,
-                               "Limit",
+                               OrderType::Limit,
                                false,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -146,11 +181,11 @@ TEST_F(OrderBookTest, MatchOrdersFullTradeAskSideTest)
 
   // insert bid order
   ASSERT_TRUE(orderDataBid.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataBid), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid}, endpoint);
 
   // insert ask order
   ASSERT_TRUE(orderDataAsk.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataAsk), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk}, endpoint);
 
   const auto &bidOrderBook{matchingEngine.GetBidOrderBook()};
   EXPECT_FALSE(bidOrderBook.GetOrderBookMap().empty());
@@ -171,7 +206,7 @@ TEST_F(OrderBookTest, MatchOrdersFullTradeBidSideTest)
                                "ABCD",
                                price,
                                10,
-                               "Limit",
+                               OrderType::Limit,
                                true,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -182,7 +217,7 @@ TEST_F(OrderBookTest, MatchOrdersFullTradeBidSideTest)
                                "ABCD",
                                price,
                                100,
-                               "Limit",
+                               OrderType::Limit,
                                false,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -213,11 +248,11 @@ TEST_F(OrderBookTest, MatchOrdersFullTradeBidSideTest)
 
   // insert bid order
   ASSERT_TRUE(orderDataBid.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataBid), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid}, endpoint);
 
   // insert ask order
   ASSERT_TRUE(orderDataAsk.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataAsk), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk}, endpoint);
 
   const auto &bidOrderBook{matchingEngine.GetBidOrderBook()};
   EXPECT_TRUE(bidOrderBook.GetOrderBookMap().empty());
@@ -239,7 +274,7 @@ TEST_F(OrderBookTest, MatchOrderFullTradeBidAndAskSideTest)
                                "ABCD",
                                price,
                                100,
-                               "Limit",
+                               OrderType::Limit,
                                true,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -250,7 +285,7 @@ TEST_F(OrderBookTest, MatchOrderFullTradeBidAndAskSideTest)
                                "ABCD",
                                price,
                                100,
-                               "Limit",
+                               OrderType::Limit,
                                false,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -281,11 +316,11 @@ TEST_F(OrderBookTest, MatchOrderFullTradeBidAndAskSideTest)
 
   // insert bid side
   ASSERT_TRUE(orderDataBid.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataBid), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid}, endpoint);
 
   // insert ask side
   ASSERT_TRUE(orderDataAsk.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataAsk), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk}, endpoint);
 
   const auto &bidOrderBook{matchingEngine.GetBidOrderBook()};
   EXPECT_TRUE(bidOrderBook.GetOrderBookMap().empty());
@@ -307,7 +342,7 @@ TEST_F(OrderBookTest, MatchOrderFullTradeAskAndBidSideTest)
                                "ABCD",
                                price,
                                100,
-                               "Limit",
+                               OrderType::Limit,
                                true,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -318,7 +353,7 @@ TEST_F(OrderBookTest, MatchOrderFullTradeAskAndBidSideTest)
                                "ABCD",
                                price,
                                100,
-                               "Limit",
+                               OrderType::Limit,
                                false,
                                std::chrono::high_resolution_clock::now(),
                                std::chrono::milliseconds::duration::zero(),
@@ -349,11 +384,11 @@ TEST_F(OrderBookTest, MatchOrderFullTradeAskAndBidSideTest)
 
   // insert ask side first
   ASSERT_TRUE(orderDataAsk.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataAsk), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk}, endpoint);
 
   // insert bid side secondly
   ASSERT_TRUE(orderDataBid.Validate());
-  matchingEngine.OrderInsert(std::move(orderDataBid), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid}, endpoint);
 
   const auto &bidOrderBook{matchingEngine.GetBidOrderBook()};
   EXPECT_TRUE(bidOrderBook.GetOrderBookMap().empty());
@@ -391,7 +426,7 @@ TEST_F(OrderBookTest, MultiLevelMatchOrderBidAndAskSideTest)
                                 "ABCD",
                                 {50U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -403,7 +438,7 @@ TEST_F(OrderBookTest, MultiLevelMatchOrderBidAndAskSideTest)
                                 "ABCD",
                                 {52U * std::mega::num},
                                 150,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -415,7 +450,7 @@ TEST_F(OrderBookTest, MultiLevelMatchOrderBidAndAskSideTest)
                                 "ABCD",
                                 {51U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -427,7 +462,7 @@ TEST_F(OrderBookTest, MultiLevelMatchOrderBidAndAskSideTest)
                                 "ABCD",
                                 orderDataBid2.GetPrice(),
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -448,20 +483,20 @@ TEST_F(OrderBookTest, MultiLevelMatchOrderBidAndAskSideTest)
   const OrderReply askReply2{orderDataAsk2.GetId(), orderDataAsk2.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(askReply2, endpoint));
 
-  matchingEngine.OrderInsert(std::move(orderDataBid1), endpoint);
-  matchingEngine.OrderInsert(std::move(orderDataAsk1), endpoint);
-  matchingEngine.OrderInsert(std::move(orderDataAsk2), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid1}, endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk2}, endpoint);
 
-  // 2 trades on bid order2
+  // 2 trades on bid order2, at the price of the resting orders
   const Trade tradeBid2_1{orderDataBid2.GetAccount(),
-                          orderDataBid2.GetPrice(),
+                          orderDataAsk1.GetPrice(),
                           orderDataAsk1.GetVolume(),
                           orderDataBid2.GetId(),
                           orderDataBid2.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(tradeBid2_1, endpoint));
 
   const Trade tradeBid2_2{orderDataBid2.GetAccount(),
-                          orderDataBid2.GetPrice(),
+                          orderDataAsk2.GetPrice(),
                           orderDataAsk2.GetVolume() / 2,
                           orderDataBid2.GetId(),
                           orderDataBid2.GetClientId()};
@@ -482,7 +517,7 @@ TEST_F(OrderBookTest, MultiLevelMatchOrderBidAndAskSideTest)
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(tradeAsk2, endpoint));
 
   // insert bid order 2 to fully match the ask order 1 and partially match ask order 2
-  matchingEngine.OrderInsert(std::move(orderDataBid2), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid2}, endpoint);
   // check the state of the orderbook
   const auto &bidOrderBook{matchingEngine.GetBidOrderBook()};
   EXPECT_EQ(bidOrderBook.GetOrderBookMap().size(), 1);
@@ -503,7 +538,7 @@ TEST_F(OrderBookTest, MultiLevelCancelOrderBidAndAskSideTest)
                                 "ABCD",
                                 {50U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -515,7 +550,7 @@ TEST_F(OrderBookTest, MultiLevelCancelOrderBidAndAskSideTest)
                                 "ABCD",
                                 {52U * std::mega::num},
                                 150,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -527,7 +562,7 @@ TEST_F(OrderBookTest, MultiLevelCancelOrderBidAndAskSideTest)
                                 "ABCD",
                                 {51U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -539,7 +574,7 @@ TEST_F(OrderBookTest, MultiLevelCancelOrderBidAndAskSideTest)
                                 "ABCD",
                                 orderDataBid2.GetPrice(),
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -556,9 +591,9 @@ TEST_F(OrderBookTest, MultiLevelCancelOrderBidAndAskSideTest)
   const OrderReply askReply2{orderDataAsk2.GetId(), orderDataAsk2.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(askReply2, endpoint)).Times(2);
 
-  matchingEngine.OrderInsert(std::move(orderDataBid1), endpoint);
-  matchingEngine.OrderInsert(std::move(orderDataAsk1), endpoint);
-  matchingEngine.OrderInsert(std::move(orderDataAsk2), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid1}, endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk2}, endpoint);
 
   const OrderCancelData cancelBidOrder1{orderDataBid1.GetInstrument(),
                                         orderDataBid1.GetPrice(),
@@ -592,7 +627,7 @@ TEST_F(OrderBookTest, AmendOrderVolumeTest)
                                 "ABCD",
                                 {50U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -604,7 +639,7 @@ TEST_F(OrderBookTest, AmendOrderVolumeTest)
                                 "ABCD",
                                 {51U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -615,11 +650,11 @@ TEST_F(OrderBookTest, AmendOrderVolumeTest)
   //
   const OrderReply bidReply1{orderDataBid1.GetId(), orderDataBid1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(bidReply1, endpoint)).Times(1);
-  matchingEngine.OrderInsert(std::move(orderDataBid1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid1}, endpoint);
 
   const OrderReply askReply1{orderDataAsk1.GetId(), orderDataAsk1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(askReply1, endpoint)).Times(1);
-  matchingEngine.OrderInsert(std::move(orderDataAsk1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
 
   // amend bid order volume
   const OrderAmendData amendBidOrder1{orderDataBid1.GetAccount(),
@@ -694,7 +729,7 @@ TEST_F(OrderBookTest, AmendAskOrderPriceVolumeTest)
                                 "ABCD",
                                 {51U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -704,7 +739,7 @@ TEST_F(OrderBookTest, AmendAskOrderPriceVolumeTest)
 
   const OrderReply askReply1{orderDataAsk1.GetId(), orderDataAsk1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(askReply1, endpoint)).Times(1);
-  matchingEngine.OrderInsert(std::move(orderDataAsk1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
 
   // amend ask order volume and price
   const auto newAskVolume1{orderDataAsk1.GetVolume() / 2};
@@ -741,7 +776,7 @@ TEST_F(OrderBookTest, AmendAskOrderPriceZeroVolumeTest)
                                 "ABCD",
                                 {51U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -751,7 +786,7 @@ TEST_F(OrderBookTest, AmendAskOrderPriceZeroVolumeTest)
 
   const OrderReply askReply1{orderDataAsk1.GetId(), orderDataAsk1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(askReply1, endpoint)).Times(1);
-  matchingEngine.OrderInsert(std::move(orderDataAsk1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
 
   // amend ask order volume to zero and price
   const auto zeroVolume{0};
@@ -786,7 +821,7 @@ TEST_F(OrderBookTest, AmendBidOrderPriceVolumeTest)
                                 "ABCD",
                                 {50U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -796,7 +831,7 @@ TEST_F(OrderBookTest, AmendBidOrderPriceVolumeTest)
   //
   const OrderReply bidReply1{orderDataBid1.GetId(), orderDataBid1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(bidReply1, endpoint)).Times(1);
-  matchingEngine.OrderInsert(std::move(orderDataBid1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid1}, endpoint);
 
   {   // amend bid order volume
     const auto newBidVolume1{orderDataBid1.GetVolume() + 100};
@@ -835,7 +870,7 @@ TEST_F(OrderBookTest, AmendAskOrderMatchBidPriceTest)
                                 "ABCD",
                                 {50U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -845,14 +880,14 @@ TEST_F(OrderBookTest, AmendAskOrderMatchBidPriceTest)
   //
   const OrderReply bidReply1{orderDataBid1.GetId(), orderDataBid1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(bidReply1, endpoint)).Times(1);
-  matchingEngine.OrderInsert(std::move(orderDataBid1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid1}, endpoint);
 
   // insert ask order
   OrderInsertData orderDataAsk1{"mobo",
                                 "ABCD",
                                 {51U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -862,7 +897,7 @@ TEST_F(OrderBookTest, AmendAskOrderMatchBidPriceTest)
   //
   const OrderReply askReply1{orderDataAsk1.GetId(), orderDataAsk1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(askReply1, endpoint));
-  matchingEngine.OrderInsert(std::move(orderDataAsk1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
 
   // amend bid order to match the ask order
   const auto newAskVolume1{orderDataBid1.GetVolume()};
@@ -912,7 +947,7 @@ TEST_F(OrderBookTest, AmendBidOrderMatchAskPriceTest)
                                 "ABCD",
                                 {50U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 true,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -922,14 +957,14 @@ TEST_F(OrderBookTest, AmendBidOrderMatchAskPriceTest)
   //
   const OrderReply bidReply1{orderDataBid1.GetId(), orderDataBid1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(bidReply1, endpoint)).Times(1);
-  matchingEngine.OrderInsert(std::move(orderDataBid1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid1}, endpoint);
 
   // insert ask order
   OrderInsertData orderDataAsk1{"mobo",
                                 "ABCD",
                                 {51U * std::mega::num},
                                 100,
-                                "Limit",
+                                OrderType::Limit,
                                 false,
                                 std::chrono::high_resolution_clock::now(),
                                 std::chrono::milliseconds::duration::zero(),
@@ -939,7 +974,7 @@ TEST_F(OrderBookTest, AmendBidOrderMatchAskPriceTest)
   //
   const OrderReply askReply1{orderDataAsk1.GetId(), orderDataAsk1.GetClientId()};
   EXPECT_CALL(matchingEngine, CreateAndSendMessage(askReply1, endpoint));
-  matchingEngine.OrderInsert(std::move(orderDataAsk1), endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
 
   // amend bid order to match the ask order
   const auto newBidVolume1{orderDataAsk1.GetVolume()};
@@ -977,4 +1012,1498 @@ TEST_F(OrderBookTest, AmendBidOrderMatchAskPriceTest)
 
   EXPECT_TRUE(amendBidOrder1.Validate());
   matchingEngine.OrderAmend(amendBidOrder1, endpoint);
-}
\ No newline at end of file
+}
+
+TEST_F(OrderBookTest, InsertBidOrdersLadderTest)
+{
+  OrderBidLadderBook_t orderBook;
+
+  const std::vector<PriceType_t> prices{{51U * std::mega::num}, {50U * std::mega::num}, {53U * std::mega::num}, {52U * std::mega::num}};
+  for (const auto price : prices) {
+    OrderInsertData orderData{"mobo",
+                              "ABCD",
+                              price,
+                              10,
+                              OrderType::Limit,
+                              true,
+                              std::chrono::high_resolution_clock::now(),
+                              std::chrono::milliseconds::duration::zero(),
+                              std::to_string(price),
+                              std::to_string(price)};
+    EXPECT_NE(Insert(orderBook, orderData), nullptr);
+  }
+
+  // the levels are iterated from the highest to the lowest price
+  const auto &orderBookMap{orderBook.GetOrderBookMap()};
+  EXPECT_EQ(orderBookMap.size(), prices.size());
+
+  std::vector<PriceType_t> levelPrices;
+  for (const auto &[price, level] : orderBookMap) {
+    levelPrices.push_back(price);
+  }
+  const std::vector<PriceType_t> expectedPrices{{53U * std::mega::num}, {52U * std::mega::num}, {51U * std::mega::num}, {50U * std::mega::num}};
+  EXPECT_EQ(levelPrices, expectedPrices);
+
+  // remove the best level, the next best level becomes the top of the book
+  orderBook.RemoveLevelAtPrice(53U * std::mega::num);
+  EXPECT_EQ(orderBookMap.begin()->first, 52U * std::mega::num);
+  EXPECT_EQ(orderBookMap.size(), prices.size() - 1);
+}
+
+TEST_F(OrderBookTest, InsertAskOrdersLadderOutOfRangeTest)
+{
+  OrderAskLadderBook_t orderBook;
+
+  // price is not aligned on the tick size of the price ladder
+  OrderInsertData orderData{"mobo",
+                            "ABCD",
+                            {(50U * std::mega::num) + 1},
+                            10,
+                            OrderType::Limit,
+                            false,
+                            std::chrono::high_resolution_clock::now(),
+                            std::chrono::milliseconds::duration::zero(),
+                            "id=AskOrder1",
+                            "clientId=AskOrder1"};
+  EXPECT_EQ(Insert(orderBook, orderData), nullptr);
+  EXPECT_TRUE(orderBook.GetOrderBookMap().empty());
+}
+
+TEST_F(OrderBookTest, InsertAskOrdersConfiguredLadderTest)
+{
+  // tick size of 0.5 from 100.0, 8 levels up to and including 103.5
+  OrderAskLadderBook_t orderBook(PriceLadderConfig{100U * std::mega::num, std::mega::num / 2, 8});
+
+  const auto insert{[&](const PriceType_t price) {
+    OrderInsertData orderData{"mobo",
+                              "ABCD",
+                              price,
+                              10,
+                              OrderType::Limit,
+                              false,
+                              std::chrono::high_resolution_clock::now(),
+                              std::chrono::milliseconds::duration::zero(),
+                              std::to_string(price),
+                              std::to_string(price)};
+    return Insert(orderBook, orderData);
+  }};
+
+  EXPECT_NE(insert(100U * std::mega::num), nullptr);
+  EXPECT_NE(insert((103U * std::mega::num) + (std::mega::num / 2)), nullptr);
+  EXPECT_NE(insert((101U * std::mega::num) + (std::mega::num / 2)), nullptr);
+
+  // below the min price, above the last level and not aligned on the tick size
+  EXPECT_EQ(insert(99U * std::mega::num), nullptr);
+  EXPECT_EQ(insert(104U * std::mega::num), nullptr);
+  EXPECT_EQ(insert((101U * std::mega::num) + 10'000), nullptr);
+
+  EXPECT_EQ(orderBook.GetOrderBookMap().size(), 3);
+  EXPECT_EQ(orderBook.GetOrderBookMap().begin()->first, 100U * std::mega::num);
+}
+
+TEST_F(OrderBookTest, LadderAmendOffTickTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  LadderMatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  constexpr PriceType_t price{50U * std::mega::num};
+  const auto orderTime{std::chrono::high_resolution_clock::now()};
+
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(2);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const ErrorReply &>(), endpoint)).Times(1);
+
+  matchingEngine.OrderInsert(
+    OrderInsertData{"mobo", "ABCD", price, 10, OrderType::Limit, true, orderTime, {}, "Bid1", "clientId=Bid1"}, endpoint);
+
+  // the new price is not aligned on the tick size, the amend fails and the order stays on its level with its price and volume
+  matchingEngine.OrderAmend(
+    OrderAmendData{"mobo", "ABCD", price, price + 1, 10, 5, OrderType::Limit, true, orderTime, {}, "Bid1", "clientId=Bid1"}, endpoint);
+
+  const auto &bidOrderBookMap{matchingEngine.GetBidOrderBook().GetOrderBookMap()};
+  ASSERT_EQ(bidOrderBookMap.size(), 1);
+  EXPECT_EQ(bidOrderBookMap.begin()->first, price);
+  EXPECT_EQ(bidOrderBookMap.begin()->second.GetTotalVolume(), 10);
+  ASSERT_NE(matchingEngine.GetBidOrderBook().FindOrder("Bid1"), nullptr);
+  EXPECT_EQ(matchingEngine.GetBidOrderBook().FindOrder("Bid1")->order.GetPrice(), price);
+
+  // the order is still in the index
+  matchingEngine.OrderCancel(OrderCancelData{"ABCD", price, true, "Bid1", "clientId=Bid1"}, endpoint);
+  EXPECT_TRUE(bidOrderBookMap.empty());
+}
+
+TEST_F(OrderBookTest, LadderMultiLevelMatchOrderBidAndAskSideTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  LadderMatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  OrderInsertData orderDataAsk1{"mobo",
+                                "ABCD",
+                                {51U * std::mega::num},
+                                100,
+                                OrderType::Limit,
+                                false,
+                                std::chrono::high_resolution_clock::now(),
+                                std::chrono::milliseconds::duration::zero(),
+                                "id=AskOrder1",
+                                "clientId=AskOrder1"};
+
+  OrderInsertData orderDataAsk2{"mobo",
+                                "ABCD",
+                                {52U * std::mega::num},
+                                100,
+                                OrderType::Limit,
+                                false,
+                                std::chrono::high_resolution_clock::now(),
+                                std::chrono::milliseconds::duration::zero(),
+                                "id=AskOrder2",
+                                "clientId=AskOrder2"};
+
+  OrderInsertData orderDataBid1{"mobo",
+                                "ABCD",
+                                {52U * std::mega::num},
+                                150,
+                                OrderType::Limit,
+                                true,
+                                std::chrono::high_resolution_clock::now(),
+                                std::chrono::milliseconds::duration::zero(),
+                                "id=BidOrder1",
+                                "clientId=BidOrder1"};
+
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(3);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const Trade &>(), endpoint)).Times(4);
+
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk1}, endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataAsk2}, endpoint);
+  matchingEngine.OrderInsert(OrderInsertData{orderDataBid1}, endpoint);
+
+  // bid order fully matched, ask order 2 partially matched
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+
+  const auto &askOrderBookMap{matchingEngine.GetAskOrderBook().GetOrderBookMap()};
+  EXPECT_EQ(askOrderBookMap.size(), 1);
+  EXPECT_EQ(askOrderBookMap.begin()->second.GetTopLevel()->GetPrice(), orderDataAsk2.GetPrice());
+  EXPECT_EQ(askOrderBookMap.begin()->second.GetTopLevel()->GetVolume(), 50);
+}
+
+TEST_F(OrderBookTest, CancelOrderOnIdTest)
+{
+  OrderBidBook_t orderBook;
+
+  constexpr auto MAX_ORDER{10U};
+  constexpr PriceType_t price{10U * std::mega::num};
+
+  for (int i = {0U}; i < MAX_ORDER; i++) {
+    OrderInsertData orderData;
+    orderData.SetAccount("mobo");
+    orderData.SetIsBuySide(true);
+    orderData.SetPrice(price);
+    orderData.SetVolume(10);
+    orderData.SetType("Limit");
+    orderData.SetOrderTime(std::chrono::high_resolution_clock::now());
+    orderData.SetId(std::to_string(i));
+
+    EXPECT_NE(Insert(orderBook, orderData), nullptr);
+  }
+
+  // order ids must be unique
+  OrderInsertData duplicateOrderData;
+  duplicateOrderData.SetPrice(price);
+  duplicateOrderData.SetId("5");
+  EXPECT_EQ(Insert(orderBook, duplicateOrderData), nullptr);
+
+  // the order is found on id, the price of the cancel is not used to find the order
+  const OrderCancelData cancelOrder{"ABCD", {1U * std::mega::num}, true, "5", "clientId=CancelOrder5"};
+  EXPECT_TRUE(orderBook.Cancel(cancelOrder));
+  EXPECT_FALSE(orderBook.Cancel(cancelOrder));
+  EXPECT_EQ(orderBook.FindOrder("5"), nullptr);
+  EXPECT_NE(orderBook.FindOrder("6"), nullptr);
+  EXPECT_EQ((*orderBook.GetLevelAtPrice(price))->GetSize(), MAX_ORDER - 1);
+
+  // removing the level removes all its orders from the index
+  orderBook.RemoveLevelAtPrice(price);
+  EXPECT_EQ(orderBook.FindOrder("6"), nullptr);
+  EXPECT_TRUE(orderBook.GetOrderBookMap().empty());
+}
+
+TEST_F(OrderBookTest, AmendOrderToExistingLevelTest)
+{
+  OrderAskBook_t orderBook;
+
+  const std::vector<std::pair<PriceType_t, Id_t>> orders{{{50U * std::mega::num}, "AskOrder1"},
+                                                         {{51U * std::mega::num}, "AskOrder2"},
+                                                         {{51U * std::mega::num}, "AskOrder3"}};
+  for (const auto &[price, id] : orders) {
+    OrderInsertData orderData;
+    orderData.SetAccount("mobo");
+    orderData.SetIsBuySide(false);
+    orderData.SetPrice(price);
+    orderData.SetVolume(10);
+    orderData.SetType("Limit");
+    orderData.SetOrderTime(std::chrono::high_resolution_clock::now());
+    orderData.SetId(id);
+
+    EXPECT_NE(Insert(orderBook, orderData), nullptr);
+  }
+
+  // move the first order to the existing level at 51, it is queued behind the orders already on that level
+  const OrderAmendData amendOrder{"mobo",
+                                  "ABCD",
+                                  {50U * std::mega::num},
+                                  {51U * std::mega::num},
+                                  10,
+                                  20,
+                                  OrderType::Limit,
+                                  false,
+                                  std::chrono::high_resolution_clock::now(),
+                                  std::chrono::milliseconds::duration::zero(),
+                                  "AskOrder1",
+                                  "clientId=AmendAskOrder1"};
+  EXPECT_TRUE(orderBook.Amend(amendOrder));
+
+  const auto &orderBookMap{orderBook.GetOrderBookMap()};
+  EXPECT_EQ(orderBookMap.size(), 1);
+  EXPECT_EQ(orderBookMap.begin()->second.GetSize(), 3);
+
+  std::vector<Id_t> ids;
+  const auto collectIdsFn{[&ids](const OrderNode &orderNode) {
+    ids.push_back(orderNode.id);
+    return true;
+  }};
+  EXPECT_TRUE(orderBookMap.begin()->second.GetLevels(collectIdsFn));
+  EXPECT_EQ(ids, (std::vector<Id_t>{"AskOrder2", "AskOrder3", "AskOrder1"}));
+
+  const auto *amendedOrder{orderBook.FindOrder("AskOrder1")};
+  ASSERT_NE(amendedOrder, nullptr);
+  EXPECT_EQ(amendedOrder->order.GetPrice(), 51U * std::mega::num);
+  EXPECT_EQ(amendedOrder->order.GetVolume(), 20);
+}
+
+TEST_F(OrderBookTest, OrderPointerStableAfterCancelTest)
+{
+  OrderBidBook_t orderBook;
+
+  constexpr auto MAX_ORDER{10U};
+  constexpr PriceType_t price{10U * std::mega::num};
+
+  std::vector<const OrderNode *> insertedOrders;
+  for (int i = {0U}; i < MAX_ORDER; i++) {
+    OrderInsertData orderData;
+    orderData.SetAccount("mobo");
+    orderData.SetIsBuySide(true);
+    orderData.SetPrice(price);
+    orderData.SetVolume(10 + i);
+    orderData.SetType("Limit");
+    orderData.SetOrderTime(std::chrono::high_resolution_clock::now());
+    orderData.SetId(std::to_string(i));
+
+    insertedOrders.push_back(Insert(orderBook, orderData));
+  }
+
+  // cancel the even orders, the returned pointers of the odd orders stay valid
+  for (int i = {0U}; i < MAX_ORDER; i += 2) {
+    const OrderCancelData cancelOrder{"ABCD", price, true, std::to_string(i), "clientId"};
+    EXPECT_TRUE(orderBook.Cancel(cancelOrder));
+  }
+
+  for (int i = {1U}; i < MAX_ORDER; i += 2) {
+    EXPECT_EQ(insertedOrders[i], orderBook.FindOrder(std::to_string(i)));
+    EXPECT_EQ(insertedOrders[i]->order.GetVolume(), 10 + i);
+  }
+  EXPECT_EQ((*orderBook.GetLevelAtPrice(price))->GetSize(), MAX_ORDER / 2);
+}
+
+TEST_F(OrderBookTest, SymbolTableInternTest)
+{
+  SymbolTable symbols;
+
+  const auto mobo{symbols.Intern("mobo")};
+  const auto abcd{symbols.Intern("ABCD")};
+  EXPECT_NE(mobo, SymbolTable::EmptySymbolHandle);
+  EXPECT_NE(mobo, abcd);
+  EXPECT_EQ(symbols.Intern("mobo"), mobo);
+  EXPECT_EQ(symbols.Find("ABCD"), abcd);
+  EXPECT_FALSE(symbols.Find("unknown").has_value());
+  EXPECT_EQ(symbols.GetSymbol(mobo), "mobo");
+  EXPECT_EQ(symbols.GetSymbol(1'000), "");
+  EXPECT_EQ(symbols.Intern(""), SymbolTable::EmptySymbolHandle);
+}
+
+TEST_F(OrderBookTest, ConvertToOrderTest)
+{
+  const OrderInsertData orderData{"mobo",
+                                  "ABCD",
+                                  {50U * std::mega::num},
+                                  100,
+                                  OrderType::Limit,
+                                  false,
+                                  std::chrono::high_resolution_clock::now(),
+                                  std::chrono::milliseconds(1'500),
+                                  "id=AskOrder1",
+                                  "clientId=AskOrder1"};
+
+  const auto order{ToOrder(orderData, 12, symbolTable)};
+  ASSERT_TRUE(order.has_value());
+  EXPECT_EQ(order->GetId(), 12);
+  EXPECT_EQ(order->GetPrice(), orderData.GetPrice());
+  EXPECT_EQ(order->GetVolume(), orderData.GetVolume());
+  EXPECT_EQ(order->GetOrderTime(), orderData.GetOrderTime());
+  EXPECT_EQ(order->GetOrderDuration().count(), 1'500);
+  EXPECT_EQ(symbolTable.GetSymbol(order->GetAccount()), "mobo");
+  EXPECT_EQ(symbolTable.GetSymbol(order->GetInstrument()), "ABCD");
+  EXPECT_EQ(order->GetType(), OrderType::Limit);
+  EXPECT_FALSE(order->GetIsBuySide());
+
+  OrderInsertData unknownTypeOrderData{orderData};
+  unknownTypeOrderData.SetType("Iceberg");
+  EXPECT_FALSE(ToOrder(unknownTypeOrderData, 13, symbolTable).has_value());
+}
+
+TEST_F(OrderBookTest, InsertUnknownOrderTypeTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  OrderInsertData orderData{"mobo",
+                            "ABCD",
+                            {50U * std::mega::num},
+                            100,
+                            OrderType::Unknown,
+                            true,
+                            std::chrono::high_resolution_clock::now(),
+                            std::chrono::milliseconds::duration::zero(),
+                            "id=BidOrder1",
+                            "clientId=BidOrder1"};
+
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const ErrorReply &>(), endpoint)).Times(1);
+  matchingEngine.OrderInsert(std::move(orderData), endpoint);
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+}
+
+TEST_F(OrderBookTest, EngineThreadExecutesCommandsInOrderTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  constexpr PriceType_t price{10U * std::mega::num};
+
+  OrderInsertData orderDataBid{"mobo",
+                               "ABCD",
+                               price,
+                               100,
+                               OrderType::Limit,
+                               true,
+                               std::chrono::high_resolution_clock::now(),
+                               std::chrono::milliseconds::duration::zero(),
+                               "id=BidOrder1",
+                               "clientId=BidOrder1"};
+
+  OrderInsertData orderDataAsk{"mobo",
+                               "ABCD",
+                               price,
+                               100,
+                               OrderType::Limit,
+                               false,
+                               std::chrono::high_resolution_clock::now(),
+                               std::chrono::milliseconds::duration::zero(),
+                               "id=AskOrder1",
+                               "clientId=AskOrder1"};
+
+  // the bid is inserted before the ask, so the ask is the aggressor and both orders trade
+  std::atomic<int> numberOfTrades{};
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(2);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const Trade &>(), endpoint))
+    .Times(2)
+    .WillRepeatedly([&](const Trade &, const boost::asio::ip::tcp::endpoint &) { numberOfTrades++; });
+
+  {
+    MatchingEngineThread engineThread(0);
+    engineThread.Post(matchingEngine, OrderInsertData{orderDataBid}, endpoint);
+    engineThread.Post(matchingEngine, OrderInsertData{orderDataAsk}, endpoint);
+
+    const auto timeout{std::chrono::steady_clock::now() + std::chrono::seconds(5)};
+    while (numberOfTrades < 2 and std::chrono::steady_clock::now() < timeout) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }   // the engine thread is stopped, the matching engine can be read on this thread
+
+  EXPECT_EQ(numberOfTrades, 2);
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+  EXPECT_TRUE(matchingEngine.GetAskOrderBook().GetOrderBookMap().empty());
+}
+
+TEST_F(OrderBookTest, ShardSchedulerConsistentHashTest)
+{
+  EXPECT_FALSE(ShardScheduler({}).GetCpu("ABCN").has_value());
+
+  const ShardScheduler shardScheduler({2, 3, 4, 5});
+  EXPECT_EQ(shardScheduler.GetCpus().size(), 4);
+
+  // the instruments are spread over all cpus and an instrument is always scheduled on the same cpu
+  std::map<std::string, int> instrumentCpus;
+  std::map<int, std::size_t> instrumentsPerCpu;
+  for (int i = 0; i < 1000; i++) {
+    const auto instrument{fmt::format("INSTR{}", i)};
+    const auto cpu{shardScheduler.GetCpu(instrument)};
+    ASSERT_TRUE(cpu.has_value());
+    EXPECT_EQ(cpu, ShardScheduler({5, 4, 3, 2}).GetCpu(instrument));
+
+    instrumentCpus[instrument] = *cpu;
+    instrumentsPerCpu[*cpu]++;
+  }
+
+  EXPECT_EQ(instrumentsPerCpu.size(), 4);
+  for (const auto &[cpu, numberOfInstruments] : instrumentsPerCpu) {
+    EXPECT_GT(numberOfInstruments, 150) << "cpu " << cpu;
+  }
+
+  // adding a cpu only moves instruments to the new cpu
+  const ShardScheduler extendedShardScheduler({2, 3, 4, 5, 6});
+  std::size_t movedInstruments{};
+  for (const auto &[instrument, cpu] : instrumentCpus) {
+    const auto newCpu{extendedShardScheduler.GetCpu(instrument)};
+    if (newCpu != cpu) {
+      EXPECT_EQ(newCpu, 6);
+      movedInstruments++;
+    }
+  }
+  EXPECT_GT(movedInstruments, 0);
+  EXPECT_LT(movedInstruments, 400);
+}
+
+TEST_F(OrderBookTest, ReplyEncoderJsonTest)
+{
+  const std::string account{"mobo"};
+  const std::string id{"1700000000000000001"};
+  const std::string clientId{"1298749274982713"};
+  const Trade trade{account, 100500000, 55, id, clientId};
+
+  ReplyEncoder replyEncoder;
+  const auto toString{[](const boost::asio::const_buffer &buffer) {
+    return std::string(static_cast<const char *>(buffer.data()), buffer.size());
+  }};
+
+  const auto tradeReply{toString(replyEncoder.Encode(trade))};
+  EXPECT_EQ(tradeReply,
+            R"({"Trade":{"Id":"1700000000000000001","ClientId":"1298749274982713","Account":"mobo","TradedPrice":100500000,"TradedVolume":55}})");
+
+  // the encoder writes the same json as the message construction operators
+  std::ostringstream strm;
+  strm << trade;
+  EXPECT_EQ(tradeReply, strm.str());
+
+  // the buffer is reused, the next reply replaces the previous one
+  EXPECT_EQ(toString(replyEncoder.Encode(OrderReply{id, clientId})), R"({"OrderReply":{"Id":"1700000000000000001","ClientId":"1298749274982713"}})");
+  EXPECT_EQ(toString(replyEncoder.Encode(ErrorReply{clientId, "Failed to cancel order"})),
+            R"({"ErrorReply":{"ClientId":"1298749274982713","Error":"Failed to cancel order"}})");
+}
+
+TEST_F(OrderBookTest, ReplyEncoderBinaryTest)
+{
+  const std::string account{"mobo"};
+  const std::string id{"1700000000000000001"};
+  const std::string clientId{"1298749274982713"};
+
+  ReplyEncoder replyEncoder;
+  replyEncoder.SetFormat(ReplyFormat::Binary);
+
+  const auto tradeBuffer{replyEncoder.Encode(Trade{account, 100500000, 55, id, clientId})};
+  ASSERT_EQ(tradeBuffer.size(), sizeof(binary::TradeMessage));
+  const auto *const tradeHeader{binary::DecodeHeader(static_cast<const char *>(tradeBuffer.data()), tradeBuffer.size())};
+  ASSERT_NE(tradeHeader, nullptr);
+  const auto *const tradeMessage{binary::DecodeMessage<binary::TradeMessage>(*tradeHeader)};
+  ASSERT_NE(tradeMessage, nullptr);
+  EXPECT_EQ(tradeMessage->tradedPrice, 100500000);
+  EXPECT_EQ(tradeMessage->tradedVolume, 55);
+  EXPECT_EQ(tradeMessage->account.View(), account);
+  EXPECT_EQ(tradeMessage->id.View(), id);
+  EXPECT_EQ(tradeMessage->clientId.View(), clientId);
+
+  // the error message is truncated to the fixed length field
+  const std::string errorMessage(100, 'e');
+  const auto errorBuffer{replyEncoder.Encode(ErrorReply{clientId, errorMessage})};
+  const auto *const errorHeader{binary::DecodeHeader(static_cast<const char *>(errorBuffer.data()), errorBuffer.size())};
+  ASSERT_NE(errorHeader, nullptr);
+  const auto *const errorReplyMessage{binary::DecodeMessage<binary::ErrorReplyMessage>(*errorHeader)};
+  ASSERT_NE(errorReplyMessage, nullptr);
+  EXPECT_EQ(errorReplyMessage->clientId.View(), clientId);
+  EXPECT_EQ(errorReplyMessage->error.View(), errorMessage.substr(0, sizeof(errorReplyMessage->error.data)));
+}
+
+TEST_F(OrderBookTest, MarketDataPublishTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  ::testing::NiceMock<MatchingEngineMock> matchingEngine(channelInterface, "ABCD");
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  const boost::asio::ip::tcp::endpoint jsonSubscriber1(boost::asio::ip::make_address("127.0.0.1"), 5001);
+  const boost::asio::ip::tcp::endpoint jsonSubscriber2(boost::asio::ip::make_address("127.0.0.1"), 5002);
+  const boost::asio::ip::tcp::endpoint binarySubscriber(boost::asio::ip::make_address("127.0.0.1"), 5003);
+  constexpr PriceType_t price{10U * std::mega::num};
+
+  // the order book is empty, the subscribers receive an empty snapshot
+  EXPECT_CALL(*channelInterface, SendWebSocketData(::testing::_, ::testing::_)).Times(0);
+  matchingEngine.SubscribeMarketData(ReplyFormat::Json, jsonSubscriber1);
+  matchingEngine.SubscribeMarketData(ReplyFormat::Json, jsonSubscriber2);
+  matchingEngine.SubscribeMarketData(ReplyFormat::Binary, binarySubscriber);
+  EXPECT_EQ(matchingEngine.GetMarketDataPublisher().GetNumberOfSubscribers(), 3);
+
+  // every update is encoded once per format, the json subscribers share the same buffer
+  std::vector<std::string> jsonUpdates;
+  std::vector<std::string> binaryUpdates;
+  EXPECT_CALL(*channelInterface, PublishWebSocketData(::testing::_, ::testing::_, ::testing::_))
+    .WillRepeatedly([&](const moboware::common::SharedBuffer_t &sharedBuffer,
+                        const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+                        const moboware::common::ConflationKey_t) {
+      if (endpoints == std::vector{jsonSubscriber1, jsonSubscriber2}) {
+        jsonUpdates.push_back(*sharedBuffer);
+      } else {
+        EXPECT_EQ(endpoints, std::vector{binarySubscriber});
+        binaryUpdates.push_back(*sharedBuffer);
+      }
+    });
+
+  OrderInsertData orderDataBid{"mobo",
+                               "ABCD",
+                               price,
+                               10,
+                               OrderType::Limit,
+                               true,
+                               std::chrono::high_resolution_clock::now(),
+                               std::chrono::milliseconds::duration::zero(),
+                               "id=BidOrder1",
+                               "clientId=BidOrder1"};
+  matchingEngine.OrderInsert(std::move(orderDataBid), endpoint);
+
+  ASSERT_EQ(jsonUpdates.size(), 1);
+  EXPECT_EQ(jsonUpdates[0], R"({"LevelUpdate":{"Instrument":"ABCD","IsBuy":true,"Price":10000000,"Volume":10,"OrderCount":1}})");
+  ASSERT_EQ(binaryUpdates.size(), 1);
+  const auto *const header{binary::DecodeHeader(binaryUpdates[0].data(), binaryUpdates[0].size())};
+  ASSERT_NE(header, nullptr);
+  const auto *const levelUpdateMessage{binary::DecodeMessage<binary::LevelUpdateMessage>(*header)};
+  ASSERT_NE(levelUpdateMessage, nullptr);
+  EXPECT_EQ(levelUpdateMessage->price, price);
+  EXPECT_EQ(levelUpdateMessage->volume, 10);
+  EXPECT_EQ(levelUpdateMessage->orderCount, 1);
+  EXPECT_EQ(levelUpdateMessage->isBuySide, 1);
+  EXPECT_EQ(levelUpdateMessage->instrument.View(), "ABCD");
+
+  // the ask trades against the bid, the trade is published followed by the changed levels of the event. The ask is fully
+  // traded before it is inserted, its own side is not changed.
+  jsonUpdates.clear();
+  OrderInsertData orderDataAsk{"mobo",
+                               "ABCD",
+                               price,
+                               4,
+                               OrderType::Limit,
+                               false,
+                               std::chrono::high_resolution_clock::now(),
+                               std::chrono::milliseconds::duration::zero(),
+                               "id=AskOrder1",
+                               "clientId=AskOrder1"};
+  matchingEngine.OrderInsert(std::move(orderDataAsk), endpoint);
+
+  ASSERT_EQ(jsonUpdates.size(), 2);
+  EXPECT_EQ(jsonUpdates[0], R"({"PublicTrade":{"Instrument":"ABCD","IsBuy":false,"Price":10000000,"Volume":4}})");
+  EXPECT_EQ(jsonUpdates[1], R"({"LevelUpdate":{"Instrument":"ABCD","IsBuy":true,"Price":10000000,"Volume":6,"OrderCount":1}})");
+  EXPECT_EQ(binaryUpdates.size(), 3);
+
+  // a new subscriber receives the snapshot of the order book
+  EXPECT_CALL(*channelInterface, SendWebSocketData(::testing::_, endpoint)).Times(1);
+  matchingEngine.GetOrderBook(ReplyFormat::Json, endpoint);
+
+  // no updates after the unsubscribe
+  jsonUpdates.clear();
+  matchingEngine.UnsubscribeMarketData(jsonSubscriber1);
+  matchingEngine.UnsubscribeMarketData(jsonSubscriber2);
+  matchingEngine.UnsubscribeMarketData(binarySubscriber);
+  EXPECT_FALSE(matchingEngine.GetMarketDataPublisher().HasSubscribers());
+
+  const OrderCancelData orderCancel{"ABCD", price, true, "id=BidOrder1", "clientId=BidOrder1"};
+  matchingEngine.OrderCancel(orderCancel, endpoint);
+  EXPECT_TRUE(jsonUpdates.empty());
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+}
+
+TEST_F(OrderBookTest, LevelTotalsTest)
+{
+  OrderAskLadderBook_t orderBook;
+  constexpr PriceType_t price{10U * std::mega::num};
+  constexpr PriceType_t newPrice{11U * std::mega::num};
+
+  for (int i{}; i < 3; i++) {
+    OrderInsertData orderData{"mobo",
+                              "ABCD",
+                              price,
+                              10U * (i + 1),
+                              OrderType::Limit,
+                              false,
+                              std::chrono::high_resolution_clock::now(),
+                              std::chrono::milliseconds::duration::zero(),
+                              fmt::format("id=AskOrder{}", i),
+                              fmt::format("clientId=AskOrder{}", i)};
+    ASSERT_NE(Insert(orderBook, orderData), nullptr);
+  }
+
+  const auto getLevel{[&](const PriceType_t levelPrice) -> const OrderLevel & {
+    return orderBook.GetOrderBookMap().find(levelPrice)->second;
+  }};
+  EXPECT_EQ(getLevel(price).GetTotalVolume(), 60);
+  EXPECT_EQ(getLevel(price).GetSize(), 3);
+
+  // volume change on the level
+  OrderAmendData orderAmend;
+  orderAmend.SetId("id=AskOrder1");
+  orderAmend.SetPrice(price);
+  orderAmend.SetNewPrice(price);
+  orderAmend.SetNewVolume(5);
+  ASSERT_TRUE(orderBook.Amend(orderAmend));
+  EXPECT_EQ(getLevel(price).GetTotalVolume(), 45);
+
+  // move to another level
+  orderAmend.SetNewPrice(newPrice);
+  ASSERT_TRUE(orderBook.Amend(orderAmend));
+  EXPECT_EQ(getLevel(price).GetTotalVolume(), 40);
+  EXPECT_EQ(getLevel(price).GetSize(), 2);
+  EXPECT_EQ(getLevel(newPrice).GetTotalVolume(), 5);
+
+  // partial and full trades of the top level
+  EXPECT_EQ(orderBook.TradeTopLevel(4, [](const OrderNode &, const VolumeType_t) {}), 4);
+  EXPECT_EQ(getLevel(price).GetTotalVolume(), 36);
+  EXPECT_EQ(orderBook.TradeTopLevel(6, [](const OrderNode &, const VolumeType_t) {}), 6);
+  EXPECT_EQ(getLevel(price).GetTotalVolume(), 30);
+  EXPECT_EQ(getLevel(price).GetSize(), 1);
+
+  // the depth is read from the level totals
+  std::vector<std::tuple<PriceType_t, VolumeType_t, std::size_t>> depth;
+  orderBook.GetDepth(5, [&](const PriceType_t levelPrice, const OrderLevel &orderLevel) {
+    depth.emplace_back(levelPrice, orderLevel.GetTotalVolume(), orderLevel.GetSize());
+  });
+  EXPECT_THAT(depth, ::testing::ElementsAre(std::tuple{price, 30, 1}, std::tuple{newPrice, 5, 1}));
+
+  depth.clear();
+  orderBook.GetDepth(1, [&](const PriceType_t levelPrice, const OrderLevel &orderLevel) {
+    depth.emplace_back(levelPrice, orderLevel.GetTotalVolume(), orderLevel.GetSize());
+  });
+  EXPECT_EQ(depth.size(), 1);
+
+  ASSERT_TRUE(orderBook.Cancel(OrderCancelData{"ABCD", price, false, "id=AskOrder2", "clientId=AskOrder2"}));
+  EXPECT_EQ(orderBook.GetOrderBookMap().size(), 1);
+  EXPECT_EQ(getLevel(newPrice).GetTotalVolume(), 5);
+}
+
+TEST_F(OrderBookTest, OrderTypesBeforeInsertTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  constexpr PriceType_t price{10U * std::mega::num};
+  constexpr PriceType_t price2{11U * std::mega::num};
+
+  int orderNumber{};
+  const auto insertOrder{[&](const OrderType type, const PriceType_t orderPrice, const VolumeType_t volume, const bool isBuySide) {
+    orderNumber++;
+    matchingEngine.OrderInsert(OrderInsertData{"mobo",
+                                               "ABCD",
+                                               orderPrice,
+                                               volume,
+                                               type,
+                                               isBuySide,
+                                               std::chrono::high_resolution_clock::now(),
+                                               std::chrono::milliseconds::duration::zero(),
+                                               fmt::format("id=Order{}", orderNumber),
+                                               fmt::format("clientId=Order{}", orderNumber)},
+                               endpoint);
+  }};
+
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(7);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const ErrorReply &>(), endpoint)).Times(3);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const Trade &>(), endpoint)).Times(6);
+
+  insertOrder(OrderType::Limit, price, 10, false);
+  insertOrder(OrderType::Limit, price2, 10, false);
+  const auto &bidOrderBookMap{matchingEngine.GetBidOrderBook().GetOrderBookMap()};
+  const auto &askOrderBookMap{matchingEngine.GetAskOrderBook().GetOrderBookMap()};
+
+  // rejected, a post only order would trade and a fill or kill order can not be filled
+  insertOrder(OrderType::PostOnly, price, 5, true);
+  insertOrder(OrderType::FillOrKill, price2, 25, true);
+  EXPECT_TRUE(bidOrderBookMap.empty());
+  EXPECT_EQ(askOrderBookMap.size(), 2);
+
+  // rejected, a stop order is not supported
+  insertOrder(OrderType::Stop, price, 5, true);
+  EXPECT_TRUE(bidOrderBookMap.empty());
+
+  // the IOC order trades up to its price, the left volume does not rest in the book and gets a cancel reply
+  insertOrder(OrderType::ImmediateOrCancel, price, 15, true);
+  EXPECT_TRUE(bidOrderBookMap.empty());
+  ASSERT_EQ(askOrderBookMap.size(), 1);
+  EXPECT_EQ(askOrderBookMap.begin()->first, price2);
+
+  // the market order trades at any price
+  insertOrder(OrderType::Market, 0, 4, true);
+  EXPECT_TRUE(bidOrderBookMap.empty());
+  EXPECT_EQ(askOrderBookMap.begin()->second.GetTotalVolume(), 6);
+
+  insertOrder(OrderType::FillOrKill, price2, 6, true);
+  EXPECT_TRUE(bidOrderBookMap.empty());
+  EXPECT_TRUE(askOrderBookMap.empty());
+
+  // nothing to trade with, the post only order rests in the book
+  insertOrder(OrderType::PostOnly, price, 5, true);
+  ASSERT_EQ(bidOrderBookMap.size(), 1);
+  EXPECT_EQ(bidOrderBookMap.begin()->second.GetTotalVolume(), 5);
+}
+
+TEST_F(OrderBookTest, OrderDurationOutOfRangeTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  constexpr PriceType_t price{10U * std::mega::num};
+  const auto now{std::chrono::high_resolution_clock::now()};
+
+  const auto insertOrder{[&](const std::string &id, const std::chrono::milliseconds duration) {
+    matchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", price, 10, OrderType::Limit, true, now, duration, id, "clientId=" + id},
+                               endpoint);
+  }};
+
+  // a good till date of 30 days or a negative duration does not fit in the order, the order is rejected and does not become
+  // good till cancel
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(1);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const ErrorReply &>(), endpoint)).Times(2);
+  insertOrder("Order1", std::chrono::days(30));
+  insertOrder("Order2", std::chrono::milliseconds(-1));
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+
+  insertOrder("Order3", std::chrono::days(20));
+  EXPECT_EQ(matchingEngine.GetNumberOfExpiries(), 1);
+}
+
+TEST_F(OrderBookTest, OrderIdOnAcceptTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  constexpr PriceType_t bidPrice{9U * std::mega::num};
+  constexpr PriceType_t askPrice{10U * std::mega::num};
+  const auto now{std::chrono::high_resolution_clock::now()};
+
+  const auto insertOrder{[&](const std::string &id,
+                             const PriceType_t price,
+                             const VolumeType_t volume,
+                             const OrderType type,
+                             const bool isBuySide,
+                             const std::chrono::milliseconds duration) {
+    matchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", price, volume, type, isBuySide, now, duration, id, "clientId=" + id},
+                               endpoint);
+  }};
+
+  // a rejected order does not take an order id
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(2);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const ErrorReply &>(), endpoint)).Times(4);
+  insertOrder("Ask1", askPrice, 10, OrderType::Limit, false, {});
+  insertOrder("Stop", bidPrice, 10, OrderType::Stop, true, {});
+  insertOrder("PostOnly", askPrice, 10, OrderType::PostOnly, true, {});
+  insertOrder("FillOrKill", askPrice, 20, OrderType::FillOrKill, true, {});
+  insertOrder("Duration", bidPrice, 10, OrderType::Limit, true, std::chrono::days(30));
+  insertOrder("Bid1", bidPrice, 10, OrderType::Limit, true, {});
+
+  ASSERT_EQ(matchingEngine.GetBidOrderBook().GetOrderBookMap().size(), 1);
+  ASSERT_EQ(matchingEngine.GetAskOrderBook().GetOrderBookMap().size(), 1);
+  EXPECT_EQ(matchingEngine.GetAskOrderBook().GetOrderBookMap().begin()->second.GetTopOrder()->order.GetId(), 1);
+  EXPECT_EQ(matchingEngine.GetBidOrderBook().GetOrderBookMap().begin()->second.GetTopOrder()->order.GetId(), 2);
+}
+
+TEST_F(OrderBookTest, ExpireGoodTillDateOrdersTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  constexpr PriceType_t price{10U * std::mega::num};
+  constexpr PriceType_t price2{9U * std::mega::num};
+  const auto now{std::chrono::high_resolution_clock::now()};
+
+  const auto insertOrder{[&](const std::string &id, const PriceType_t orderPrice, const std::chrono::milliseconds duration) {
+    matchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", orderPrice, 10, OrderType::Limit, true, now, duration, id, "clientId=" + id},
+                               endpoint);
+  }};
+
+  // good till date orders on 2 levels, one is cancelled before it expires, and a good till cancel order
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(7);
+  insertOrder("Order1", price, std::chrono::milliseconds(5));
+  insertOrder("Order2", price, std::chrono::hours(1));
+  insertOrder("Order3", price, std::chrono::milliseconds(5));
+  insertOrder("Order4", price2, std::chrono::milliseconds(5));
+  insertOrder("Order5", price2, std::chrono::milliseconds::duration::zero());
+  insertOrder("Order6", price2, std::chrono::milliseconds(5));
+  EXPECT_EQ(matchingEngine.GetNumberOfExpiries(), 5);
+
+  matchingEngine.OrderCancel(OrderCancelData{"ABCD", price2, true, "Order6", "clientId=Order6"}, endpoint);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+
+  // nothing is expired yet
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), endpoint)).Times(0);
+  matchingEngine.ExpireOrders(now + std::chrono::milliseconds(1));
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+
+  // the expired orders are cancelled with a cancel reply, the cancelled order is skipped
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"Order1", "clientId=Order1"}, endpoint));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"Order3", "clientId=Order3"}, endpoint));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"Order4", "clientId=Order4"}, endpoint));
+  matchingEngine.ExpireOrders(now + std::chrono::milliseconds(10));
+
+  const auto &bidOrderBookMap{matchingEngine.GetBidOrderBook().GetOrderBookMap()};
+  ASSERT_EQ(bidOrderBookMap.size(), 2);
+  EXPECT_EQ(bidOrderBookMap.find(price)->second.GetSize(), 1);
+  EXPECT_EQ(bidOrderBookMap.find(price)->second.GetTopOrder()->id, "Order2");
+  EXPECT_EQ(bidOrderBookMap.find(price2)->second.GetSize(), 1);
+  EXPECT_EQ(bidOrderBookMap.find(price2)->second.GetTopOrder()->id, "Order5");
+  EXPECT_EQ(matchingEngine.GetNumberOfExpiries(), 1);
+}
+
+TEST_F(OrderBookTest, PassiveTradeToRestingSessionTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint1{boost::asio::ip::address_v4::loopback(), 1000};
+  const boost::asio::ip::tcp::endpoint endpoint2{boost::asio::ip::address_v4::loopback(), 2000};
+  const boost::asio::ip::tcp::endpoint endpoint3{boost::asio::ip::address_v4::loopback(), 3000};
+  constexpr PriceType_t bidPrice{9U * std::mega::num};
+  constexpr PriceType_t askPrice{10U * std::mega::num};
+  const auto orderTime{std::chrono::high_resolution_clock::now()};
+
+  const auto isTrade{[](const std::string &id) { return ::testing::Matcher<const Trade &>(::testing::Property(&Trade::GetId, id)); }};
+
+  // the aggressor gets its own trade, the trade of the resting order goes to the session that entered it
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), ::testing::_)).Times(4);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(isTrade("Ask1"), endpoint1)).Times(2);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(isTrade("Bid1"), endpoint2)).Times(1);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(isTrade("Bid2"), endpoint3)).Times(1);
+
+  matchingEngine.OrderInsert(
+    OrderInsertData{"mobo1", "ABCD", askPrice, 10, OrderType::Limit, false, orderTime, {}, "Ask1", "clientId=Ask1"}, endpoint1);
+  matchingEngine.OrderInsert(
+    OrderInsertData{"mobo2", "ABCD", askPrice, 4, OrderType::Limit, true, orderTime, {}, "Bid1", "clientId=Bid1"}, endpoint2);
+
+  // an amend that crosses the spread trades 2 resting orders, the trades go to the sessions of both orders and not to the
+  // session of the amend
+  matchingEngine.OrderInsert(
+    OrderInsertData{"mobo3", "ABCD", bidPrice, 4, OrderType::Limit, true, orderTime, {}, "Bid2", "clientId=Bid2"}, endpoint3);
+  matchingEngine.OrderAmend(
+    OrderAmendData{"mobo3", "ABCD", bidPrice, askPrice, 4, 4, OrderType::Limit, true, orderTime, {}, "Bid2", "clientId=Bid2"},
+    endpoint2);
+
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+  EXPECT_EQ(matchingEngine.GetAskOrderBook().GetOrderBookMap().begin()->second.GetTotalVolume(), 2);
+}
+
+TEST_F(OrderBookTest, WrongSideAmendAndCancelTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface);
+
+  const boost::asio::ip::tcp::endpoint endpoint;
+  constexpr PriceType_t price{10U * std::mega::num};
+  const auto orderTime{std::chrono::high_resolution_clock::now()};
+
+  const auto isError{[](const std::string &errorMessage) {
+    return ::testing::Matcher<const ErrorReply &>(::testing::Property(&ErrorReply::GetErrorMessage, errorMessage));
+  }};
+
+  // the order ids are unique per matching engine, an order of the other side with the same id is rejected
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"Bid1", "clientId=Bid1"}, endpoint)).Times(1);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(isError("Order id already in use"), endpoint)).Times(1);
+  matchingEngine.OrderInsert(
+    OrderInsertData{"mobo", "ABCD", price, 10, OrderType::Limit, true, orderTime, {}, "Bid1", "clientId=Bid1"}, endpoint);
+  matchingEngine.OrderInsert(
+    OrderInsertData{"mobo", "ABCD", price + 1, 10, OrderType::Limit, false, orderTime, {}, "Bid1", "clientId=Bid1"}, endpoint);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+  EXPECT_TRUE(matchingEngine.GetAskOrderBook().GetOrderBookMap().empty());
+
+  // the amend with the wrong side amends the order on the side it rests on
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"Bid1", "clientId=Amend"}, endpoint)).Times(1);
+  matchingEngine.OrderAmend(
+    OrderAmendData{"mobo", "ABCD", price, price, 10, 5, OrderType::Limit, false, orderTime, {}, "Bid1", "clientId=Amend"}, endpoint);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+  ASSERT_EQ(matchingEngine.GetBidOrderBook().GetOrderBookMap().size(), 1);
+  EXPECT_EQ(matchingEngine.GetBidOrderBook().GetOrderBookMap().begin()->second.GetTotalVolume(), 5);
+
+  // the cancel with the wrong side cancels the order, an unknown order is not found on either side
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"Bid1", "clientId=Cancel"}, endpoint)).Times(1);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(isError("Failed to cancel order"), endpoint)).Times(1);
+  matchingEngine.OrderCancel(OrderCancelData{"ABCD", price, false, "Bid1", "clientId=Cancel"}, endpoint);
+  matchingEngine.OrderCancel(OrderCancelData{"ABCD", price, false, "Unknown", "clientId=Unknown"}, endpoint);
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+}
+
+TEST_F(OrderBookTest, MassCancelTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface, "ABCD");
+
+  const boost::asio::ip::tcp::endpoint endpoint1{boost::asio::ip::address_v4::loopback(), 1000};
+  const boost::asio::ip::tcp::endpoint endpoint2{boost::asio::ip::address_v4::loopback(), 2000};
+  const boost::asio::ip::tcp::endpoint endpoint3{boost::asio::ip::address_v4::loopback(), 3000};
+  constexpr PriceType_t bidPrice{9U * std::mega::num};
+  constexpr PriceType_t askPrice{11U * std::mega::num};
+
+  const auto insertOrder{[&](const std::string &account, const std::string &id, const bool isBuy, const auto &endpoint) {
+    matchingEngine.OrderInsert(OrderInsertData{account,
+                                               "ABCD",
+                                               isBuy ? bidPrice : askPrice,
+                                               10,
+                                               OrderType::Limit,
+                                               isBuy,
+                                               std::chrono::high_resolution_clock::now(),
+                                               std::chrono::milliseconds::duration::zero(),
+                                               id,
+                                               "clientId=" + id},
+                               endpoint);
+  }};
+  const auto getNumberOfOrders{[&]() {
+    std::size_t numberOfOrders{};
+    for (const auto &[price, level] : matchingEngine.GetBidOrderBook().GetOrderBookMap()) {
+      numberOfOrders += level.GetSize();
+    }
+    for (const auto &[price, level] : matchingEngine.GetAskOrderBook().GetOrderBookMap()) {
+      numberOfOrders += level.GetSize();
+    }
+    return numberOfOrders;
+  }};
+
+  // 2 accounts with orders on both sides from 2 sessions
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), ::testing::_)).Times(5);
+  insertOrder("mobo", "A1", true, endpoint1);
+  insertOrder("mobo", "A2", false, endpoint1);
+  insertOrder("mobo", "A3", true, endpoint2);
+  insertOrder("other", "B1", true, endpoint1);
+  insertOrder("other", "B2", false, endpoint2);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+
+  // the orders of the account from the session that sends the mass cancel
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"A1", "clientId=A1"}, endpoint1));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"A2", "clientId=A2"}, endpoint1));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"ABCD", "mc1"}, endpoint1));
+  matchingEngine.OrderMassCancel(OrderMassCancelData{MassCancelAccount | MassCancelSession, "mobo", "", "mc1"}, endpoint1);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+  EXPECT_EQ(getNumberOfOrders(), 3);
+
+  // the orders of the account from all sessions, the reply goes to the session of the order
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"A3", "clientId=A3"}, endpoint2));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"ABCD", "mc2"}, endpoint1));
+  matchingEngine.OrderMassCancel(OrderMassCancelData{MassCancelAccount, "mobo", "", "mc2"}, endpoint1);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+
+  // a session and an account without orders cancel nothing, the mass cancel is still acknowledged
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"ABCD", "mc3"}, endpoint3));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"ABCD", "mc4"}, endpoint1));
+  matchingEngine.OrderMassCancel(OrderMassCancelData{MassCancelSession, "", "", "mc3"}, endpoint3);
+  matchingEngine.OrderMassCancel(OrderMassCancelData{MassCancelAccount, "nobody", "", "mc4"}, endpoint1);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+  EXPECT_EQ(getNumberOfOrders(), 2);
+
+  // the orders of the session
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"B1", "clientId=B1"}, endpoint1));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"ABCD", "mc5"}, endpoint1));
+  matchingEngine.OrderMassCancel(OrderMassCancelData{MassCancelSession, "", "", "mc5"}, endpoint1);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+
+  // all orders of the instrument
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), ::testing::_));
+  insertOrder("mobo", "A4", true, endpoint1);
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"A4", "clientId=A4"}, endpoint1));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"B2", "clientId=B2"}, endpoint2));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"ABCD", "mc6"}, endpoint1));
+  matchingEngine.OrderMassCancel(OrderMassCancelData{MassCancelInstrument, "", "ABCD", "mc6"}, endpoint1);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+  EXPECT_EQ(getNumberOfOrders(), 0);
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+  EXPECT_TRUE(matchingEngine.GetAskOrderBook().GetOrderBookMap().empty());
+
+  // the orders of a closed session are cancelled without replies
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), ::testing::_)).Times(2);
+  insertOrder("mobo", "A5", true, endpoint1);
+  insertOrder("mobo", "A6", false, endpoint2);
+  ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), ::testing::_)).Times(0);
+  matchingEngine.CancelSessionOrders(endpoint2);
+  EXPECT_EQ(getNumberOfOrders(), 1);
+  EXPECT_EQ(matchingEngine.GetBidOrderBook().GetOrderBookMap().find(bidPrice)->second.GetTopOrder()->id, "A5");
+}
+
+TEST_F(OrderBookTest, SessionHandleRecycleTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface, "ABCD");
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), ::testing::_)).Times(::testing::AnyNumber());
+
+  constexpr PriceType_t price{10U * std::mega::num};
+  const auto orderTime{std::chrono::high_resolution_clock::now()};
+  const auto insertOrder{[&](const std::string &id, const boost::asio::ip::tcp::endpoint &endpoint) {
+    matchingEngine.OrderInsert(
+      OrderInsertData{"mobo", "ABCD", price, 10, OrderType::Limit, true, orderTime, {}, id, "clientId=" + id}, endpoint);
+  }};
+
+  // a session with a resting order keeps its handle
+  const boost::asio::ip::tcp::endpoint restingEndpoint{boost::asio::ip::address_v4::loopback(), 1000};
+  insertOrder("Resting", restingEndpoint);
+
+  // the handle of a session without resting orders is reused, the sessions do not grow with the connections
+  for (unsigned short port{2000}; port < 2100; port++) {
+    const boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::address_v4::loopback(), port};
+    const auto id{std::to_string(port)};
+    insertOrder(id, endpoint);
+    matchingEngine.OrderCancel(OrderCancelData{"ABCD", price, true, id, "clientId=" + id}, endpoint);
+  }
+  EXPECT_LE(matchingEngine.GetNumberOfSessions(), 4);
+  EXPECT_LE(matchingEngine.CaptureSnapshot().sessions.size(), 4);
+
+  // a closed session is released after its orders are cancelled
+  const boost::asio::ip::tcp::endpoint closedEndpoint{boost::asio::ip::address_v4::loopback(), 3000};
+  insertOrder("Closed", closedEndpoint);
+  const auto numberOfSessions{matchingEngine.GetNumberOfSessions()};
+  matchingEngine.CancelSessionOrders(closedEndpoint);
+  EXPECT_EQ(matchingEngine.GetNumberOfSessions(), numberOfSessions - 1);
+
+  // the resting order still has its session
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::Matcher<const Trade &>(::testing::Property(&Trade::GetId, "Resting")),
+                                                   restingEndpoint));
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::Matcher<const Trade &>(::testing::Property(&Trade::GetId, "Sell")),
+                                                   closedEndpoint));
+  matchingEngine.OrderInsert(
+    OrderInsertData{"mobo", "ABCD", price, 10, OrderType::Limit, false, orderTime, {}, "Sell", "clientId=Sell"}, closedEndpoint);
+  EXPECT_TRUE(matchingEngine.GetBidOrderBook().GetOrderBookMap().empty());
+}
+
+TEST_F(OrderBookTest, JournalTest)
+{
+  const auto channelInterface{std::make_shared<ChannelInterfaceMock>()};
+  MatchingEngineMock matchingEngine(channelInterface, "ABCD");
+  EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const OrderReply &>(), ::testing::_)).Times(3);
+
+  const auto directory{std::filesystem::temp_directory_path() / "moboware_journal_test"};
+  std::filesystem::remove_all(directory);
+
+  const boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::make_address("10.1.2.3"), 4401};
+  const auto orderTime{std::chrono::high_resolution_clock::now()};
+  // a segment of 2 insert records, the third record goes into the next segment
+  const auto segmentSize{sizeof(journal::SegmentHeader) + 2 * sizeof(journal::InsertRecord)};
+  {
+    Journal journal(JournalConfig{directory.string(), segmentSize, FsyncPolicy::Batch});
+    ASSERT_TRUE(journal.Open());
+    matchingEngine.SetJournal(&journal);
+
+    matchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", 10, 100, OrderType::Limit, true, orderTime, {}, "A1", "clientId=A1"}, endpoint);
+    matchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", 11, 100, OrderType::Limit, false, orderTime, {}, "A2", "clientId=A2"}, endpoint);
+    matchingEngine.OrderCancel(OrderCancelData{"ABCD", 10, true, "A1", "clientId=A1"}, endpoint);
+
+    // the writer thread writes the records asynchronously
+    for (int i{}; i < 1000 and journal.GetLastSequence() < 3; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(journal.GetLastSequence(), 3);
+    matchingEngine.SetJournal(nullptr);
+
+    const auto stats{journal.GetStats()};
+    EXPECT_EQ(stats.writtenRecords, 3);
+    EXPECT_EQ(stats.segmentCount, 2);
+    EXPECT_EQ(stats.ringFullCount, 0);
+  }
+
+  // the first segment is full, the second segment is truncated to its records
+  moboware::common::MappedFile segment;
+  ASSERT_TRUE(segment.Open((directory / journal::GetSegmentFileName(1)).string()));
+  ASSERT_EQ(segment.GetSize(), segmentSize);
+
+  const auto &segmentHeader{*reinterpret_cast<const journal::SegmentHeader *>(segment.GetData())};
+  EXPECT_TRUE(std::equal(std::begin(journal::SegmentMagic), std::end(journal::SegmentMagic), segmentHeader.magic));
+  EXPECT_EQ(segmentHeader.firstSequence, 1);
+
+  const auto *record{segment.GetData() + sizeof(journal::SegmentHeader)};
+  for (const auto *const id : {"A1", "A2"}) {
+    const auto &insertRecord{*reinterpret_cast<const journal::InsertRecord *>(record)};
+    EXPECT_EQ(insertRecord.header.type, journal::RecordType::Insert);
+    EXPECT_EQ(insertRecord.header.instrument.View(), "ABCD");
+    EXPECT_EQ(insertRecord.header.time, journal::ToJournalTime(orderTime));
+    EXPECT_EQ(journal::ToEndpoint(insertRecord.header.session), endpoint);
+    EXPECT_EQ(insertRecord.id.View(), id);
+    EXPECT_EQ(insertRecord.message.account.View(), "mobo");
+    EXPECT_EQ(insertRecord.message.volume, 100);
+    record += insertRecord.header.length;
+  }
+  EXPECT_EQ(reinterpret_cast<const journal::RecordHeader *>(segment.GetData() + sizeof(journal::SegmentHeader))->sequence, 1);
+
+  ASSERT_TRUE(segment.Open((directory / journal::GetSegmentFileName(3)).string()));
+  ASSERT_EQ(segment.GetSize(), sizeof(journal::SegmentHeader) + sizeof(journal::CancelRecord));
+  const auto &cancelRecord{*reinterpret_cast<const journal::CancelRecord *>(segment.GetData() + sizeof(journal::SegmentHeader))};
+  EXPECT_EQ(cancelRecord.header.type, journal::RecordType::Cancel);
+  EXPECT_EQ(cancelRecord.header.sequence, 3);
+  EXPECT_EQ(cancelRecord.message.id.View(), "A1");
+  EXPECT_EQ(cancelRecord.message.price, 10);
+
+  segment.Close();
+  std::filesystem::remove_all(directory);
+}
+
+TEST_F(OrderBookTest, JournalReplayTest)
+{
+  const auto directory{std::filesystem::temp_directory_path() / "moboware_journal_replay_test"};
+  std::filesystem::remove_all(directory);
+  const auto journalDirectory{(directory / "journal").string()};
+  const auto snapshotDirectory{(directory / "snapshot").string()};
+
+  // the resting orders of both sides in price and time priority
+  const auto getOrders{[](const MatchingEngine &matchingEngine) {
+    std::vector<std::tuple<bool, PriceType_t, Id_t, VolumeType_t, SessionHandle_t>> orders;
+    const auto addOrders{[&](const auto &orderBook) {
+      for (const auto &[price, orderLevel] : orderBook.GetOrderBookMap()) {
+        for (const auto *node{orderLevel.GetTopOrder()}; node != nullptr; node = node->next) {
+          orders.emplace_back(node->order.GetIsBuySide(), price, node->id, node->order.GetVolume(), node->session);
+        }
+      }
+    }};
+    addOrders(matchingEngine.GetBidOrderBook());
+    addOrders(matchingEngine.GetAskOrderBook());
+    return orders;
+  }};
+
+  const auto liveChannel{std::make_shared<ReplayChannel>()};
+  MatchingEngine liveMatchingEngine(liveChannel, "ABCD");
+
+  const boost::asio::ip::tcp::endpoint endpoint1{boost::asio::ip::make_address("10.1.2.3"), 4401};
+  const boost::asio::ip::tcp::endpoint endpoint2{boost::asio::ip::make_address("10.1.2.4"), 4402};
+  const auto orderTime{std::chrono::high_resolution_clock::now()};
+  {
+    Journal journal(JournalConfig{journalDirectory, 1024 * 1024, FsyncPolicy::None});
+    ASSERT_TRUE(journal.Open());
+    liveMatchingEngine.SetJournal(&journal);
+
+    liveMatchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", 10, 100, OrderType::Limit, true, orderTime, {}, "A1", "clientId=A1"},
+                                   endpoint1);
+    liveMatchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", 11, 100, OrderType::Limit, false, orderTime, {}, "A2", "clientId=A2"},
+                                   endpoint2);
+    // good till date, expires after the snapshot
+    liveMatchingEngine.OrderInsert(
+      OrderInsertData{"mobo", "ABCD", 9, 100, OrderType::Limit, true, orderTime, std::chrono::milliseconds(1'000), "A3", "clientId=A3"},
+      endpoint1);
+    ASSERT_TRUE(liveMatchingEngine.WriteSnapshot(snapshotDirectory));
+
+    liveMatchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", 11, 40, OrderType::Limit, true, orderTime, {}, "A4", "clientId=A4"},
+                                   endpoint1);
+    liveMatchingEngine.OrderAmend(
+      OrderAmendData{"mobo", "ABCD", 10, 10, 100, 80, OrderType::Limit, true, orderTime, {}, "A1", "clientId=A1"}, endpoint1);
+    liveMatchingEngine.ExpireOrders(orderTime + std::chrono::milliseconds(2'000));
+    liveMatchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", 12, 50, OrderType::Limit, false, orderTime, {}, "A5", "clientId=A5"},
+                                   endpoint2);
+    liveMatchingEngine.OrderCancel(OrderCancelData{"ABCD", 11, false, "A2", "clientId=A2"}, endpoint2);
+    EXPECT_EQ(liveMatchingEngine.GetInputSequence(), 8);
+
+    for (int i{}; i < 1000 and journal.GetLastSequence() < 8; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(journal.GetLastSequence(), 8);
+    liveMatchingEngine.SetJournal(nullptr);
+  }
+
+  const auto liveOrders{getOrders(liveMatchingEngine)};
+  ASSERT_EQ(liveOrders.size(), 2);
+  EXPECT_EQ(std::get<2>(liveOrders[0]), "A1");
+  EXPECT_EQ(std::get<3>(liveOrders[0]), 80);
+  EXPECT_EQ(std::get<2>(liveOrders[1]), "A5");
+  EXPECT_EQ(liveMatchingEngine.GetNumberOfExpiries(), 0);
+
+  // a full replay into an empty engine gives the same order books and the same replies
+  {
+    const auto replayChannel{std::make_shared<ReplayChannel>()};
+    MatchingEngine matchingEngine(replayChannel, "ABCD");
+    JournalReplay journalReplay([&](const std::string_view instrument) { return instrument == "ABCD" ? &matchingEngine : nullptr; });
+
+    JournalReader journalReader;
+    ASSERT_TRUE(journalReader.Open(journalDirectory));
+    EXPECT_EQ(journalReplay.Replay(journalReader), 8);
+    EXPECT_EQ(journalReader.GetLastSequence(), 8);
+
+    const auto &stats{journalReplay.GetStats()};
+    EXPECT_EQ(stats.appliedRecords, 8);
+    EXPECT_EQ(stats.divergedRecords, 0);
+    EXPECT_EQ(matchingEngine.GetInputSequence(), 8);
+    EXPECT_EQ(getOrders(matchingEngine), liveOrders);
+    EXPECT_EQ(replayChannel->GetReplyCount(), liveChannel->GetReplyCount());
+    EXPECT_EQ(replayChannel->GetChecksum(), liveChannel->GetChecksum());
+  }
+
+  // the snapshot and the journal records after it give the same order books, the expiry is restored from the snapshot
+  {
+    MatchingEngine matchingEngine(std::make_shared<ReplayChannel>(), "ABCD");
+    const auto snapshotPath{snapshot::FindLatestSnapshot(snapshotDirectory, "ABCD")};
+    ASSERT_TRUE(snapshotPath);
+    EXPECT_EQ(std::filesystem::path(*snapshotPath).filename(), snapshot::GetSnapshotFileName("ABCD", 3));
+    ASSERT_TRUE(matchingEngine.LoadSnapshot(*snapshotPath));
+    EXPECT_EQ(matchingEngine.GetInputSequence(), 3);
+    EXPECT_EQ(matchingEngine.GetNumberOfExpiries(), 1);
+    EXPECT_EQ(getOrders(matchingEngine).size(), 3);
+
+    JournalReplay journalReplay([&](const std::string_view instrument) { return instrument == "ABCD" ? &matchingEngine : nullptr; });
+    JournalReader journalReader;
+    ASSERT_TRUE(journalReader.Open(journalDirectory));
+    EXPECT_EQ(journalReplay.Replay(journalReader), 8);
+
+    const auto &stats{journalReplay.GetStats()};
+    EXPECT_EQ(stats.skippedRecords, 3);
+    EXPECT_EQ(stats.appliedRecords, 5);
+    EXPECT_EQ(stats.divergedRecords, 0);
+    EXPECT_EQ(getOrders(matchingEngine), liveOrders);
+
+    // a snapshot is only loaded into an engine without inputs
+    EXPECT_FALSE(matchingEngine.LoadSnapshot(*snapshotPath));
+  }
+
+  // an empty journal directory is an empty journal
+  JournalReader journalReader;
+  ASSERT_TRUE(journalReader.Open((directory / "none").string()));
+  EXPECT_EQ(journalReader.ForEach([](const journal::RecordHeader &) {}), 0);
+  EXPECT_FALSE(snapshot::FindLatestSnapshot(snapshotDirectory, "ABC"));
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST_F(OrderBookTest, SnapshotCaptureTest)
+{
+  const auto directory{std::filesystem::temp_directory_path() / "moboware_snapshot_capture_test"};
+  std::filesystem::remove_all(directory);
+
+  using Orders_t = std::vector<std::tuple<bool, PriceType_t, Id_t, VolumeType_t>>;
+  const auto getOrders{[](const MatchingEngine &matchingEngine) {
+    Orders_t orders;
+    const auto addOrders{[&](const auto &orderBook) {
+      for (const auto &[price, orderLevel] : orderBook.GetOrderBookMap()) {
+        for (const auto *node{orderLevel.GetTopOrder()}; node != nullptr; node = node->next) {
+          orders.emplace_back(node->order.GetIsBuySide(), price, node->id, node->order.GetVolume());
+        }
+      }
+    }};
+    addOrders(matchingEngine.GetBidOrderBook());
+    addOrders(matchingEngine.GetAskOrderBook());
+    std::sort(std::begin(orders), std::end(orders));
+    return orders;
+  }};
+  // the levels of an image are in no particular order, the orders of a level in time priority
+  const auto getImageOrders{[](const snapshot::SnapshotImage &image) {
+    Orders_t orders;
+    for (const auto &level : image.levels) {
+      for (const auto &order : *level) {
+        orders.emplace_back(order.isBuySide != 0, order.price, Id_t(order.id.View()), order.volume);
+      }
+    }
+    std::sort(std::begin(orders), std::end(orders));
+    return orders;
+  }};
+  const auto findLevel{[](const snapshot::SnapshotImage &image, const bool isBuySide, const PriceType_t price) {
+    const auto iter{std::find_if(std::begin(image.levels), std::end(image.levels), [&](const snapshot::SnapshotLevel_t &level) {
+      return level->front().price == price and (level->front().isBuySide != 0) == isBuySide;
+    })};
+    return iter != std::end(image.levels) ? *iter : snapshot::SnapshotLevel_t{};
+  }};
+
+  MatchingEngine matchingEngine(std::make_shared<ReplayChannel>(), "ABCD");
+  const boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::make_address("10.1.2.3"), 4401};
+  const auto orderTime{std::chrono::high_resolution_clock::now()};
+  const auto insertOrder{[&](const PriceType_t price, const VolumeType_t volume, const bool isBuySide, const std::string &id) {
+    matchingEngine.OrderInsert(OrderInsertData{"mobo", "ABCD", price, volume, OrderType::Limit, isBuySide, orderTime, {}, id, id}, endpoint);
+  }};
+
+  insertOrder(10, 100, true, "B1");
+  insertOrder(10, 100, true, "B2");
+  insertOrder(9, 100, true, "B3");
+  insertOrder(12, 100, false, "S1");
+  insertOrder(13, 100, false, "S2");
+
+  const auto firstImage{matchingEngine.CaptureSnapshot()};
+  EXPECT_EQ(firstImage.inputSequence, 5);
+  EXPECT_EQ(firstImage.sessions.size(), 1);
+  EXPECT_EQ(firstImage.levels.size(), 4);
+  EXPECT_EQ(getImageOrders(firstImage), getOrders(matchingEngine));
+
+  // a new level, a partially traded level, a removed level and an amended order
+  insertOrder(11, 100, true, "B4");
+  insertOrder(11, 40, false, "S3");
+  matchingEngine.OrderCancel(OrderCancelData{"ABCD", 13, false, "S2", "S2"}, endpoint);
+  matchingEngine.OrderAmend(OrderAmendData{"mobo", "ABCD", 9, 9, 100, 60, OrderType::Limit, true, orderTime, {}, "B3", "B3"}, endpoint);
+
+  const auto secondImage{matchingEngine.CaptureSnapshot()};
+  EXPECT_EQ(secondImage.inputSequence, 9);
+  EXPECT_EQ(secondImage.levels.size(), 4);
+  EXPECT_EQ(getImageOrders(secondImage), getOrders(matchingEngine));
+
+  // the unchanged levels are shared with the previous image, the changed levels are copied
+  EXPECT_EQ(findLevel(firstImage, true, 10), findLevel(secondImage, true, 10));
+  EXPECT_EQ(findLevel(firstImage, false, 12), findLevel(secondImage, false, 12));
+  EXPECT_NE(findLevel(firstImage, true, 9), findLevel(secondImage, true, 9));
+  EXPECT_EQ(findLevel(firstImage, true, 9)->front().volume, 100);
+  EXPECT_EQ(findLevel(secondImage, true, 11)->front().volume, 60);
+  EXPECT_FALSE(findLevel(secondImage, false, 13));
+
+  // the writer keeps the latest snapshots of the instrument
+  {
+    snapshot::SnapshotWriter snapshotWriter(directory.string(), 2);
+    const auto writeImage{[&](snapshot::SnapshotImage &&image, const std::uint64_t writtenSnapshots) {
+      snapshotWriter.Write(std::move(image));
+      for (int i{}; i < 1000 and snapshotWriter.GetStats().writtenSnapshots < writtenSnapshots; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      EXPECT_EQ(snapshotWriter.GetStats().writtenSnapshots, writtenSnapshots);
+    }};
+
+    writeImage(snapshot::SnapshotImage{firstImage}, 1);
+    writeImage(snapshot::SnapshotImage{secondImage}, 2);
+    insertOrder(8, 100, true, "B5");
+    writeImage(matchingEngine.CaptureSnapshot(), 3);
+    EXPECT_EQ(snapshotWriter.GetStats().failedSnapshots, 0);
+  }
+
+  const auto snapshots{snapshot::ListSnapshots(directory.string(), "ABCD")};
+  ASSERT_EQ(snapshots.size(), 2);
+  EXPECT_EQ(std::filesystem::path(snapshots[0]).filename(), snapshot::GetSnapshotFileName("ABCD", 9));
+  EXPECT_EQ(std::filesystem::path(snapshots[1]).filename(), snapshot::GetSnapshotFileName("ABCD", 10));
+
+  // the incremental snapshot loads into the same order books
+  MatchingEngine loadedMatchingEngine(std::make_shared<ReplayChannel>(), "ABCD");
+  ASSERT_TRUE(loadedMatchingEngine.LoadSnapshot(snapshots[1]));
+  EXPECT_EQ(loadedMatchingEngine.GetInputSequence(), 10);
+  EXPECT_EQ(getOrders(loadedMatchingEngine), getOrders(matchingEngine));
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST_F(OrderBookTest, SelfTradePreventionTest)
+{
+  const boost::asio::ip::tcp::endpoint endpoint1{boost::asio::ip::address_v4::loopback(), 1000};
+  const boost::asio::ip::tcp::endpoint endpoint2{boost::asio::ip::address_v4::loopback(), 2000};
+  constexpr PriceType_t price{11U * std::mega::num};
+
+  const auto insertOrder{[&](MatchingEngineMock &matchingEngine,
+                             const std::string &account,
+                             const std::string &id,
+                             const bool isBuy,
+                             const VolumeType_t volume,
+                             const OrderType type,
+                             const auto &endpoint) {
+    matchingEngine.OrderInsert(OrderInsertData{account,
+                                               "ABCD",
+                                               price,
+                                               volume,
+                                               type,
+                                               isBuy,
+                                               std::chrono::high_resolution_clock::now(),
+                                               std::chrono::milliseconds::duration::zero(),
+                                               id,
+                                               "clientId=" + id},
+                               endpoint);
+  }};
+  const auto getOrders{[](const auto &orderBook) {
+    std::vector<std::pair<Id_t, VolumeType_t>> orders;
+    for (const auto &[price, orderLevel] : orderBook.GetOrderBookMap()) {
+      for (const auto *node{orderLevel.GetTopOrder()}; node != nullptr; node = node->next) {
+        orders.emplace_back(node->id, node->order.GetVolume());
+      }
+    }
+    return orders;
+  }};
+
+  // an own ask is at the top of the book, followed by an ask of an other account
+  const auto createMatchingEngine{[&](const SelfTradePrevention selfTradePrevention) {
+    auto matchingEngine{std::make_unique<::testing::NiceMock<MatchingEngineMock>>(std::make_shared<ChannelInterfaceMock>())};
+    matchingEngine->SetSelfTradePrevention(selfTradePrevention);
+    insertOrder(*matchingEngine, "mobo", "S1", false, 10, OrderType::Limit, endpoint2);
+    insertOrder(*matchingEngine, "other", "S2", false, 10, OrderType::Limit, endpoint2);
+    return matchingEngine;
+  }};
+
+  // the new order is cancelled, the resting orders stay
+  {
+    auto matchingEngine{createMatchingEngine(SelfTradePrevention::CancelNewest)};
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(OrderReply{"B1", "clientId=B1"}, endpoint1)).Times(2);
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(::testing::An<const Trade &>(), ::testing::_)).Times(0);
+    insertOrder(*matchingEngine, "mobo", "B1", true, 15, OrderType::Limit, endpoint1);
+    ::testing::Mock::VerifyAndClearExpectations(matchingEngine.get());
+    EXPECT_TRUE(getOrders(matchingEngine->GetBidOrderBook()).empty());
+    EXPECT_EQ(getOrders(matchingEngine->GetAskOrderBook()), (std::vector<std::pair<Id_t, VolumeType_t>>{{"S1", 10}, {"S2", 10}}));
+
+    // a fill or kill order that meets an own order first is not filled
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(::testing::An<const ErrorReply &>(), endpoint1));
+    insertOrder(*matchingEngine, "mobo", "B2", true, 5, OrderType::FillOrKill, endpoint1);
+    ::testing::Mock::VerifyAndClearExpectations(matchingEngine.get());
+  }
+
+  // the resting own order is cancelled, the new order trades with the next order and rests
+  {
+    auto matchingEngine{createMatchingEngine(SelfTradePrevention::CancelOldest)};
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(OrderReply{"B1", "clientId=B1"}, endpoint1));
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(OrderReply{"S1", "clientId=S1"}, endpoint2));
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(::testing::An<const Trade &>(), ::testing::_)).Times(2);
+    insertOrder(*matchingEngine, "mobo", "B1", true, 15, OrderType::Limit, endpoint1);
+    ::testing::Mock::VerifyAndClearExpectations(matchingEngine.get());
+    EXPECT_EQ(getOrders(matchingEngine->GetBidOrderBook()), (std::vector<std::pair<Id_t, VolumeType_t>>{{"B1", 5}}));
+    EXPECT_TRUE(getOrders(matchingEngine->GetAskOrderBook()).empty());
+  }
+
+  // the volume of the own order is removed from both orders, the left volume trades with the next order
+  {
+    auto matchingEngine{createMatchingEngine(SelfTradePrevention::DecrementBoth)};
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(OrderReply{"B1", "clientId=B1"}, endpoint1));
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(OrderReply{"S1", "clientId=S1"}, endpoint2));
+    EXPECT_CALL(*matchingEngine, CreateAndSendMessage(::testing::An<const Trade &>(), ::testing::_)).Times(2);
+    insertOrder(*matchingEngine, "mobo", "B1", true, 15, OrderType::Limit, endpoint1);
+    ::testing::Mock::VerifyAndClearExpectations(matchingEngine.get());
+    EXPECT_TRUE(getOrders(matchingEngine->GetBidOrderBook()).empty());
+    EXPECT_EQ(getOrders(matchingEngine->GetAskOrderBook()), (std::vector<std::pair<Id_t, VolumeType_t>>{{"S2", 5}}));
+  }
+
+  // an amended order that crosses an own order, the amended order is the newest order
+  {
+    ::testing::NiceMock<MatchingEngineMock> matchingEngine(std::make_shared<ChannelInterfaceMock>());
+    matchingEngine.SetSelfTradePrevention(SelfTradePrevention::CancelNewest);
+    insertOrder(matchingEngine, "mobo", "S1", false, 10, OrderType::Limit, endpoint2);
+    matchingEngine.OrderInsert(OrderInsertData{"mobo",
+                                               "ABCD",
+                                               price - 1,
+                                               10,
+                                               OrderType::Limit,
+                                               true,
+                                               std::chrono::high_resolution_clock::now(),
+                                               std::chrono::milliseconds::duration::zero(),
+                                               "B1",
+                                               "clientId=B1"},
+                               endpoint1);
+
+    EXPECT_CALL(matchingEngine, CreateAndSendMessage(OrderReply{"B1", "clientId=B1"}, endpoint1)).Times(2);
+    EXPECT_CALL(matchingEngine, CreateAndSendMessage(::testing::An<const Trade &>(), ::testing::_)).Times(0);
+    matchingEngine.OrderAmend(OrderAmendData{"mobo",
+                                             "ABCD",
+                                             price - 1,
+                                             price,
+                                             10,
+                                             10,
+                                             OrderType::Limit,
+                                             true,
+                                             std::chrono::high_resolution_clock::now(),
+                                             {},
+                                             "B1",
+                                             "clientId=B1"},
+                              endpoint1);
+    ::testing::Mock::VerifyAndClearExpectations(&matchingEngine);
+    EXPECT_TRUE(getOrders(matchingEngine.GetBidOrderBook()).empty());
+    EXPECT_EQ(getOrders(matchingEngine.GetAskOrderBook()), (std::vector<std::pair<Id_t, VolumeType_t>>{{"S1", 10}}));
+  }
+}
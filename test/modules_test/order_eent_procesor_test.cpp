@@ -13,7 +13,15 @@ public:
 
   MOCK_METHOD(void, HandleOrderCancel, (const OrderCancelData &orderCancel, const boost::asio::ip::tcp::endpoint &endpoint));
 
-  MOCK_METHOD(void, GetOrderBook, (const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint));
+  MOCK_METHOD(void, HandleOrderMassCancel, (const OrderMassCancelData &orderMassCancel, const boost::asio::ip::tcp::endpoint &endpoint));
+
+  MOCK_METHOD(void, GetOrderBook, (const std::string &instrument, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint));
+
+  MOCK_METHOD(void,
+              SubscribeMarketData,
+              (const std::string &instrument, const ReplyFormat format, const boost::asio::ip::tcp::endpoint &endpoint));
+
+  MOCK_METHOD(void, UnsubscribeMarketData, (const std::string &instrument, const boost::asio::ip::tcp::endpoint &endpoint));
 };
 
 TEST(OrderEventProcessorTest, InsertOrderTest)
@@ -78,6 +86,171 @@ TEST(OrderEventProcessorTest, GetOrderBookTest)
   memcpy(buffer.prepare(orderRequest.size()).data(), orderRequest.c_str(), orderRequest.size());
   buffer.commit(orderRequest.size());
 
-  EXPECT_CALL(*mock, GetOrderBook(::testing::_, ::testing::_));
+  EXPECT_CALL(*mock, GetOrderBook(::testing::_, ReplyFormat::Json, ::testing::_));
   eventProcessor.Process(buffer);
-}
\ No newline at end of file
+}
+TEST(OrderEventProcessorTest, ReusedProcessorTest)
+{
+  const auto mock{std::make_shared<IOrderHandlerMock>()};
+  OrderEventProcessor eventProcessor(mock, boost::asio::ip::tcp::endpoint());
+
+  // the parser and the arena of the processor are reused for every message of the session, also after an invalid message
+  const std::string orderRequest{"{\"Action\":\"Cancel\",\"Data\":{\"Instrument\":\"ABCN\",\"Price\":100500000,\"IsBuy\":"
+                                 "false,\"Id\":\"309458290485\",\"ClientId\":\"1298749274982713\"}}"};
+  const std::string invalidRequest{"{\"Action\":\"Cancel\",\"Data\":{\"Instr"};
+
+  const auto processFn{[&](const std::string &request) {
+    boost::beast::flat_buffer buffer{1 * 1'024U};
+    memcpy(buffer.prepare(request.size()).data(), request.c_str(), request.size());
+    buffer.commit(request.size());
+    eventProcessor.Process(buffer);
+  }};
+
+  EXPECT_CALL(*mock, HandleOrderCancel(::testing::_, ::testing::_)).Times(3);
+  processFn(orderRequest);
+  processFn(orderRequest);
+  processFn(invalidRequest);
+  processFn(orderRequest);
+}
+
+TEST(OrderEventProcessorTest, BinaryInsertOrderTest)
+{
+  const auto mock{std::make_shared<IOrderHandlerMock>()};
+  OrderEventProcessor eventProcessor(mock, boost::asio::ip::tcp::endpoint());
+
+  OrderInsertData orderInsert;
+  orderInsert.SetAccount("mobo");
+  orderInsert.SetInstrument("ABCN");
+  orderInsert.SetPrice(100500000);
+  orderInsert.SetVolume(55);
+  orderInsert.SetType("Limit");
+  orderInsert.SetIsBuySide(false);
+  orderInsert.SetClientId("1298749274982713");
+
+  binary::OrderInsertMessage message;
+  ASSERT_TRUE(binary::Encode(orderInsert, message));
+
+  boost::beast::flat_buffer buffer{1 * 1'024U};
+  memcpy(buffer.prepare(sizeof(message)).data(), &message, sizeof(message));
+  buffer.commit(sizeof(message));
+
+  OrderInsertData receivedOrderInsert;
+  EXPECT_CALL(*mock, HandleOrderInsert(::testing::_, ::testing::_))
+    .WillOnce([&](OrderInsertData &&orderInsert, const boost::asio::ip::tcp::endpoint &) { receivedOrderInsert = std::move(orderInsert); });
+  eventProcessor.Process(buffer);
+
+  EXPECT_EQ(receivedOrderInsert.GetAccount(), "mobo");
+  EXPECT_EQ(receivedOrderInsert.GetInstrument(), "ABCN");
+  EXPECT_EQ(receivedOrderInsert.GetPrice(), 100500000);
+  EXPECT_EQ(receivedOrderInsert.GetVolume(), 55);
+  EXPECT_EQ(receivedOrderInsert.GetType(), OrderType::Limit);
+  EXPECT_FALSE(receivedOrderInsert.GetIsBuySide());
+  EXPECT_EQ(receivedOrderInsert.GetClientId(), "1298749274982713");
+  EXPECT_FALSE(receivedOrderInsert.GetId().empty());
+}
+
+TEST(OrderEventProcessorTest, BinaryInvalidOrderTypeTest)
+{
+  const auto mock{std::make_shared<IOrderHandlerMock>()};
+  OrderEventProcessor eventProcessor(mock, boost::asio::ip::tcp::endpoint());
+
+  OrderInsertData orderInsert;
+  orderInsert.SetAccount("mobo");
+  orderInsert.SetInstrument("ABCN");
+  orderInsert.SetPrice(100500000);
+  orderInsert.SetVolume(55);
+  orderInsert.SetType("Limit");
+  orderInsert.SetClientId("1298749274982713");
+
+  binary::OrderInsertMessage message;
+  ASSERT_TRUE(binary::Encode(orderInsert, message));
+  // an order type byte after the last order type is rejected in the decode
+  message.orderType = static_cast<OrderType>(static_cast<std::uint8_t>(OrderType::PostOnly) + 1);
+
+  EXPECT_CALL(*mock, HandleOrderInsert(::testing::_, ::testing::_)).Times(0);
+  EXPECT_EQ(eventProcessor.ProcessStream(reinterpret_cast<const char *>(&message), sizeof(message)), sizeof(message));
+}
+
+TEST(OrderEventProcessorTest, BinaryStreamTest)
+{
+  const auto mock{std::make_shared<IOrderHandlerMock>()};
+  OrderEventProcessor eventProcessor(mock, boost::asio::ip::tcp::endpoint());
+
+  const OrderCancelData orderCancel{"ABCN", 100500000, false, "309458290485", "1298749274982713"};
+  binary::OrderCancelMessage cancelMessage;
+  ASSERT_TRUE(binary::Encode(orderCancel, cancelMessage));
+
+  binary::GetBookMessage getBookMessage;
+  ASSERT_TRUE(binary::Encode("ABCN", getBookMessage));
+
+  // two messages back to back, the second message is received in two parts
+  std::string stream;
+  stream.append(reinterpret_cast<const char *>(&cancelMessage), sizeof(cancelMessage));
+  stream.append(reinterpret_cast<const char *>(&getBookMessage), sizeof(getBookMessage));
+  const auto firstPartSize{sizeof(cancelMessage) + 10};
+
+  EXPECT_CALL(*mock, HandleOrderCancel(::testing::_, ::testing::_)).WillOnce([&](const OrderCancelData &data, const auto &) {
+    EXPECT_EQ(data.GetInstrument(), "ABCN");
+    EXPECT_EQ(data.GetId(), "309458290485");
+    EXPECT_EQ(data.GetClientId(), "1298749274982713");
+    EXPECT_FALSE(data.GetIsBuySide());
+  });
+  EXPECT_EQ(eventProcessor.ProcessStream(stream.data(), firstPartSize), sizeof(cancelMessage));
+
+  EXPECT_CALL(*mock, GetOrderBook("ABCN", ReplyFormat::Binary, ::testing::_));
+  EXPECT_EQ(eventProcessor.ProcessStream(stream.data() + sizeof(cancelMessage), sizeof(getBookMessage)), sizeof(getBookMessage));
+
+  // a stream that does not start with a binary message is dropped
+  const std::string invalidStream{"{\"Action\":\"GetBook\"}"};
+  EXPECT_EQ(eventProcessor.ProcessStream(invalidStream.data(), invalidStream.size()), invalidStream.size());
+}
+
+TEST(OrderEventProcessorTest, BinarySubscribeMarketDataTest)
+{
+  const auto mock{std::make_shared<IOrderHandlerMock>()};
+  OrderEventProcessor eventProcessor(mock, boost::asio::ip::tcp::endpoint());
+
+  binary::SubscribeMessage subscribeMessage;
+  ASSERT_TRUE(binary::Encode("ABCN", subscribeMessage));
+  binary::UnsubscribeMessage unsubscribeMessage;
+  ASSERT_TRUE(binary::Encode("ABCN", unsubscribeMessage));
+
+  std::string stream;
+  stream.append(reinterpret_cast<const char *>(&subscribeMessage), sizeof(subscribeMessage));
+  stream.append(reinterpret_cast<const char *>(&unsubscribeMessage), sizeof(unsubscribeMessage));
+
+  // a binary subscriber receives the market data in the binary format
+  ::testing::InSequence sequence;
+  EXPECT_CALL(*mock, SubscribeMarketData("ABCN", ReplyFormat::Binary, ::testing::_));
+  EXPECT_CALL(*mock, UnsubscribeMarketData("ABCN", ::testing::_));
+  EXPECT_EQ(eventProcessor.ProcessStream(stream.data(), stream.size()), stream.size());
+}
+
+TEST(OrderEventProcessorTest, BinaryMassCancelTest)
+{
+  const auto mock{std::make_shared<IOrderHandlerMock>()};
+  OrderEventProcessor eventProcessor(mock, boost::asio::ip::tcp::endpoint());
+
+  const OrderMassCancelData orderMassCancel{MassCancelAccount | MassCancelSession, "mobo", "", "1298749274982713"};
+  binary::MassCancelMessage message;
+  ASSERT_TRUE(binary::Encode(orderMassCancel, message));
+
+  // an instrument scope without an instrument is not valid
+  const OrderMassCancelData invalidMassCancel{MassCancelInstrument, "", "", "1298749274982714"};
+  binary::MassCancelMessage invalidMessage;
+  ASSERT_TRUE(binary::Encode(invalidMassCancel, invalidMessage));
+
+  std::string stream;
+  stream.append(reinterpret_cast<const char *>(&message), sizeof(message));
+  stream.append(reinterpret_cast<const char *>(&invalidMessage), sizeof(invalidMessage));
+
+  EXPECT_CALL(*mock, HandleOrderMassCancel(::testing::_, ::testing::_)).WillOnce([&](const OrderMassCancelData &data, const auto &) {
+    EXPECT_TRUE(data.HasScope(MassCancelAccount));
+    EXPECT_TRUE(data.HasScope(MassCancelSession));
+    EXPECT_FALSE(data.HasScope(MassCancelInstrument));
+    EXPECT_EQ(data.GetAccount(), "mobo");
+    EXPECT_EQ(data.GetClientId(), "1298749274982713");
+    EXPECT_EQ(data.GetReplyFormat(), ReplyFormat::Binary);
+  });
+  EXPECT_EQ(eventProcessor.ProcessStream(stream.data(), stream.size()), stream.size());
+}